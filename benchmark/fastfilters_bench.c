@@ -0,0 +1,409 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fastfilters.h"
+#include "common.h"
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Micro-benchmark of the fir kernels. It is linked against the library objects so that the pass kernels of every cpu
+// level can be called directly, independent of the dispatch in fir_convolve.c.
+//
+// usage: fastfilters_bench [--quick] [--section pass|filter] [--level name] [--min-time seconds] [--output file]
+//
+// The pass section times single threaded inner and outer passes per level, border mode, order, sigma, channel count
+// and shape. The filter section times the public 2D and 3D gaussians with fir and iir kernels per level and thread
+// count, the sigma at which iir overtakes fir is the crossover used by fastfilters_iir_set_crossover. Results are
+// written as JSON, progress goes to stderr.
+
+typedef bool (*bench_pass_fn_t)(const float *, size_t, size_t, size_t, size_t, float *, size_t,
+                                fastfilters_kernel_fir_t, fastfilters_border_treatment_t,
+                                fastfilters_border_treatment_t, const float *, const float *, size_t);
+
+typedef struct {
+    const char *name;
+    bench_pass_fn_t inner;
+    bench_pass_fn_t outer;
+    fastfilters_cpu_feature_t feature;
+    bool needs_feature;
+    // features enabled while the filter section runs at this level
+    bool avx, fma, avx512f, neon;
+} bench_level_t;
+
+static const bench_level_t g_levels[] = {
+    {"nosimd", fastfilters_fir_convolve_fir_inner, fastfilters_fir_convolve_fir_outer, FASTFILTERS_CPU_AVX, false,
+     false, false, false, false},
+#ifndef _USE_SIMDE_ON_ARM_
+    {"avx", fastfilters_fir_convolve_fir_inner_avx, fastfilters_fir_convolve_fir_outer_avx, FASTFILTERS_CPU_AVX, true,
+     true, false, false, false},
+    {"avxfma", fastfilters_fir_convolve_fir_inner_avxfma, fastfilters_fir_convolve_fir_outer_avxfma,
+     FASTFILTERS_CPU_FMA, true, true, true, false, false},
+#ifdef HAVE_AVX512F
+    {"avx512", fastfilters_fir_convolve_fir_inner_avx512, fastfilters_fir_convolve_fir_outer_avx512,
+     FASTFILTERS_CPU_AVX512F, true, true, true, true, false},
+#endif
+#else
+    {"avxfma", fastfilters_fir_convolve_fir_inner_avxfma, fastfilters_fir_convolve_fir_outer_avxfma,
+     FASTFILTERS_CPU_FMA, false, false, false, false, false},
+#ifdef HAVE_NEON
+    {"neon", fastfilters_fir_convolve_fir_inner_neon, fastfilters_fir_convolve_fir_outer_neon, FASTFILTERS_CPU_NEON,
+     true, false, false, false, true},
+#endif
+#endif
+};
+
+static const bench_level_t g_all_features = {"all", NULL, NULL, FASTFILTERS_CPU_AVX, false, true, true, true, true};
+
+static const char *g_border_names[] = {"mirror", "optimistic", "ptr"};
+
+typedef struct {
+    bool quick;
+    bool run_pass;
+    bool run_filter;
+    const char *level;
+    double min_time;
+    FILE *out;
+    bool first_result;
+    bool available[ARRAY_LENGTH(g_levels)];
+} bench_t;
+
+static double bench_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
+static float *bench_alloc(size_t n)
+{
+    float *ptr = fastfilters_memory_align(64, n * sizeof(float));
+
+    if (!ptr) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        ptr[i] = (float)((i * 7919) % 1024) / 1024.0f;
+
+    return ptr;
+}
+
+static void bench_result_begin(bench_t *bench, const char *section, const char *level)
+{
+    fprintf(bench->out, "%s\n    {\"section\": \"%s\", \"level\": \"%s\"", bench->first_result ? "" : ",", section,
+            level);
+    bench->first_result = false;
+}
+
+static void bench_result_end(bench_t *bench, double seconds, size_t n_pixels, size_t n_bytes)
+{
+    fprintf(bench->out, ", \"seconds\": %.9f, \"pixels_per_s\": %.6e, \"gb_per_s\": %.4f}", seconds,
+            (double)n_pixels / seconds, (double)n_bytes / seconds * 1e-9);
+    fflush(bench->out);
+}
+
+// shortest run time of the pass or filter, repeated until min_time has passed
+#define BENCH_TIME(bench, seconds, ok, expr)                                                                          \
+    do {                                                                                                             \
+        double start_ = bench_now(), end_;                                                                           \
+        (ok) = (expr);                                                                                               \
+        (seconds) = bench_now() - start_;                                                                            \
+        for (double total_ = (seconds); (ok) && total_ < (bench)->min_time; total_ += end_ - start_) {               \
+            start_ = bench_now();                                                                                    \
+            (ok) = (expr);                                                                                           \
+            end_ = bench_now();                                                                                      \
+            if (end_ - start_ < (seconds))                                                                           \
+                (seconds) = end_ - start_;                                                                           \
+        }                                                                                                            \
+    } while (0)
+
+static bool bench_pass(bench_t *bench, const bench_level_t *level, bool outer, fastfilters_border_treatment_t border,
+                       fastfilters_kernel_fir_t kernel, unsigned int order, double sigma, size_t n_channels,
+                       size_t n_x, size_t n_y)
+{
+    const size_t len = fastfilters_kernel_fir_get_length(kernel);
+    const size_t row_stride = n_x * n_channels;
+    // room for the optimistic borders, which read the kernel radius beyond both ends
+    const size_t pad = (len + 1) * row_stride;
+    const size_t n = n_y * row_stride + 2 * pad;
+    // ptr borders hold len pixels per line for the inner pass and len rows for the outer pass, see
+    // fastfilters_fir_borders_t
+    const size_t border_stride = outer ? row_stride : (len + 1) * n_channels;
+    const size_t border_n = outer ? (len + 1) * row_stride : n_y * border_stride;
+    float *in = bench_alloc(n), *out = bench_alloc(n);
+    float *border_left = NULL, *border_right = NULL;
+    double seconds;
+    bool ok;
+
+    if (border == FASTFILTERS_BORDER_PTR) {
+        border_left = bench_alloc(border_n);
+        border_right = bench_alloc(border_n);
+    }
+
+    if (outer)
+        BENCH_TIME(bench, seconds, ok,
+                   level->outer(in + pad, n_y, row_stride, row_stride, 1, out + pad, row_stride, kernel, border, border,
+                                border_left, border_right, border_stride));
+    else
+        BENCH_TIME(bench, seconds, ok,
+                   level->inner(in + pad, n_x, n_channels, n_y, row_stride, out + pad, row_stride, kernel, border,
+                                border, border_left, border_right, border_stride));
+
+    if (ok) {
+        bench_result_begin(bench, "pass", level->name);
+        fprintf(bench->out,
+                ", \"pass\": \"%s\", \"border\": \"%s\", \"order\": %u, \"sigma\": %g, \"kernel_len\": %zu, "
+                "\"channels\": %zu, \"shape\": [%zu, %zu]",
+                outer ? "outer" : "inner", g_border_names[border], order, sigma, len, n_channels, n_x, n_y);
+        bench_result_end(bench, seconds, n_x * n_y, 2 * n_y * row_stride * sizeof(float));
+    } else {
+        fprintf(stderr, "%s %s pass failed (border %s, order %u, sigma %g, %zu channels)\n", level->name,
+                outer ? "outer" : "inner", g_border_names[border], order, sigma, n_channels);
+    }
+
+    fastfilters_memory_align_free(in);
+    fastfilters_memory_align_free(out);
+    if (border_left) {
+        fastfilters_memory_align_free(border_left);
+        fastfilters_memory_align_free(border_right);
+    }
+
+    return ok;
+}
+
+static bool bench_passes(bench_t *bench)
+{
+    static const double sigmas[] = {1.0, 2.0, 3.0, 5.0, 8.0};
+    static const size_t shapes[][2] = {{512, 512}, {2048, 1024}};
+    const size_t n_sigmas = bench->quick ? 2 : ARRAY_LENGTH(sigmas);
+    const size_t n_shapes = bench->quick ? 1 : ARRAY_LENGTH(shapes);
+    const size_t max_channels = bench->quick ? 3 : 7;
+    bool result = true;
+
+    for (size_t l = 0; l < ARRAY_LENGTH(g_levels); ++l) {
+        if (!bench->available[l])
+            continue;
+
+        fprintf(stderr, "pass kernels: %s\n", g_levels[l].name);
+
+        for (size_t s = 0; s < n_sigmas; ++s) {
+            for (unsigned int order = 0; order < 3; ++order) {
+                fastfilters_kernel_fir_t kernel = fastfilters_kernel_fir_gaussian(order, sigmas[s], 0.0);
+                if (!kernel)
+                    return false;
+
+                for (size_t shape = 0; shape < n_shapes; ++shape) {
+                    const size_t n_x = shapes[shape][0], n_y = shapes[shape][1];
+
+                    for (unsigned int border = 0; border < ARRAY_LENGTH(g_border_names); ++border) {
+                        for (size_t n_channels = 1; n_channels <= max_channels; ++n_channels)
+                            result &= bench_pass(bench, &g_levels[l], false, border, kernel, order, sigmas[s],
+                                                 n_channels, n_x, n_y);
+
+                        result &= bench_pass(bench, &g_levels[l], true, border, kernel, order, sigmas[s], 1, n_x, n_y);
+                    }
+                }
+
+                fastfilters_kernel_fir_free(kernel);
+            }
+        }
+    }
+
+    return result;
+}
+
+static void bench_select_level(const bench_level_t *level)
+{
+    fastfilters_cpu_enable(FASTFILTERS_CPU_AVX, level->avx);
+    fastfilters_cpu_enable(FASTFILTERS_CPU_FMA, level->fma);
+    fastfilters_cpu_enable(FASTFILTERS_CPU_AVX2, level->fma);
+    fastfilters_cpu_enable(FASTFILTERS_CPU_AVX512F, level->avx512f);
+    fastfilters_cpu_enable(FASTFILTERS_CPU_NEON, level->neon);
+
+    fastfilters_linalg_init();
+    fastfilters_fir_init();
+    fastfilters_iir_init();
+}
+
+static bool bench_filters(bench_t *bench)
+{
+    static const double sigmas[] = {1.0, 2.0, 3.0, 5.0, 8.0, 12.0};
+    const size_t n_sigmas = bench->quick ? 2 : ARRAY_LENGTH(sigmas);
+    const size_t n_x = bench->quick ? 1024 : 2048, n_z = bench->quick ? 96 : 192;
+    const unsigned int old_threads = fastfilters_get_num_threads();
+    const double old_crossover = fastfilters_iir_get_crossover();
+    unsigned int max_threads;
+    bool result = true;
+
+    if (!fastfilters_set_num_threads(0))
+        return false;
+    max_threads = fastfilters_get_num_threads();
+
+    float *in = bench_alloc(n_x * n_x > n_z * n_z * n_z ? n_x * n_x : n_z * n_z * n_z);
+    float *out = bench_alloc(n_x * n_x > n_z * n_z * n_z ? n_x * n_x : n_z * n_z * n_z);
+
+    fastfilters_array2d_t in2d = {in, n_x, n_x, 1, n_x, 1, FASTFILTERS_TYPE_FLOAT32};
+    fastfilters_array2d_t out2d = {out, n_x, n_x, 1, n_x, 1, FASTFILTERS_TYPE_FLOAT32};
+    fastfilters_array3d_t in3d = {in, n_z, n_z, n_z, 1, n_z, n_z * n_z, 1, FASTFILTERS_TYPE_FLOAT32};
+    fastfilters_array3d_t out3d = {out, n_z, n_z, n_z, 1, n_z, n_z * n_z, 1, FASTFILTERS_TYPE_FLOAT32};
+
+    for (size_t l = 0; l < ARRAY_LENGTH(g_levels); ++l) {
+        if (!bench->available[l])
+            continue;
+
+        fprintf(stderr, "filters: %s\n", g_levels[l].name);
+        bench_select_level(&g_levels[l]);
+
+        // powers of two and all cpus
+        for (unsigned int n_threads = 1;; n_threads = 2 * n_threads < max_threads ? 2 * n_threads : max_threads) {
+            fastfilters_set_num_threads(n_threads);
+
+            for (size_t s = 0; s < n_sigmas; ++s) {
+                // the crossover at the timed sigma selects the iir kernels, exact_fir the fir kernels
+                fastfilters_iir_set_crossover(sigmas[s]);
+
+                for (unsigned int iir = 0; iir < 2; ++iir) {
+                    fastfilters_options_t opt = {.exact_fir = !iir};
+
+                    for (unsigned int order = 0; order < 3; ++order) {
+                        for (unsigned int ndim = 2; ndim <= 3; ++ndim) {
+                            const size_t n_pixels = ndim == 2 ? n_x * n_x : n_z * n_z * n_z;
+                            double seconds;
+                            bool ok;
+
+                            if (ndim == 2)
+                                BENCH_TIME(bench, seconds, ok,
+                                           fastfilters_fir_gaussian2d(&in2d, order, sigmas[s], &out2d, &opt));
+                            else
+                                BENCH_TIME(bench, seconds, ok,
+                                           fastfilters_fir_gaussian3d(&in3d, order, sigmas[s], &out3d, &opt));
+
+                            if (!ok) {
+                                fprintf(stderr, "%s gaussian%ud failed (%s, order %u, sigma %g)\n", g_levels[l].name,
+                                        ndim, iir ? "iir" : "fir", order, sigmas[s]);
+                                result = false;
+                                continue;
+                            }
+
+                            bench_result_begin(bench, "filter", g_levels[l].name);
+                            fprintf(bench->out,
+                                    ", \"filter\": \"gaussian%ud\", \"kernel\": \"%s\", \"order\": %u, "
+                                    "\"sigma\": %g, \"threads\": %u, \"shape\": [%zu, %zu, %zu]",
+                                    ndim, iir ? "iir" : "fir", order, sigmas[s], n_threads, ndim == 2 ? n_x : n_z,
+                                    ndim == 2 ? n_x : n_z, ndim == 2 ? (size_t)1 : n_z);
+                            bench_result_end(bench, seconds, n_pixels, 2 * n_pixels * sizeof(float));
+                        }
+                    }
+                }
+            }
+
+            if (n_threads == max_threads)
+                break;
+        }
+    }
+
+    fastfilters_set_num_threads(old_threads);
+    fastfilters_iir_set_crossover(old_crossover);
+    bench_select_level(&g_all_features);
+    fastfilters_memory_align_free(in);
+    fastfilters_memory_align_free(out);
+
+    return result;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [--quick] [--section pass|filter] [--level name] [--min-time seconds] "
+                    "[--output file]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    bench_t bench = {.run_pass = true, .run_filter = true, .min_time = 0.02, .out = stdout, .first_result = true};
+    bool result = true;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--quick")) {
+            bench.quick = true;
+        } else if (!strcmp(argv[i], "--section") && i + 1 < argc) {
+            ++i;
+            bench.run_pass = !strcmp(argv[i], "pass");
+            bench.run_filter = !strcmp(argv[i], "filter");
+        } else if (!strcmp(argv[i], "--level") && i + 1 < argc) {
+            bench.level = argv[++i];
+        } else if (!strcmp(argv[i], "--min-time") && i + 1 < argc) {
+            bench.min_time = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+            bench.out = fopen(argv[++i], "w");
+            if (!bench.out) {
+                perror(argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    fastfilters_init();
+
+    fprintf(bench.out, "{\n  \"levels\": [");
+    for (size_t l = 0, n = 0; l < ARRAY_LENGTH(g_levels); ++l) {
+        bench.available[l] = !g_levels[l].needs_feature || fastfilters_cpu_check(g_levels[l].feature);
+        if (bench.level && strcmp(bench.level, g_levels[l].name))
+            bench.available[l] = false;
+        if (bench.available[l])
+            fprintf(bench.out, "%s\"%s\"", n++ ? ", " : "", g_levels[l].name);
+    }
+    fprintf(bench.out, "],\n  \"results\": [");
+
+    if (bench.run_pass)
+        result &= bench_passes(&bench);
+    if (bench.run_filter)
+        result &= bench_filters(&bench);
+
+    fprintf(bench.out, "\n  ]\n}\n");
+    if (bench.out != stdout)
+        fclose(bench.out);
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,20 @@
+# Cross compiles for aarch64 linux with the Debian/Ubuntu gcc-aarch64-linux-gnu toolchain. ctest runs the native tests
+# through qemu-user, e.g.:
+#
+#   cmake -DCMAKE_TOOLCHAIN_FILE=cmake/toolchain-aarch64.cmake -DUSE_SIMDE_ON_ARM=ON -DWITH_PYTHON=OFF ..
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR aarch64)
+
+set(CROSS_PREFIX aarch64-linux-gnu CACHE STRING "prefix of the cross compiler binaries")
+set(CROSS_SYSROOT /usr/${CROSS_PREFIX} CACHE PATH "target libraries for the cross compiler and qemu")
+
+set(CMAKE_C_COMPILER ${CROSS_PREFIX}-gcc)
+set(CMAKE_CXX_COMPILER ${CROSS_PREFIX}-g++)
+
+set(CMAKE_FIND_ROOT_PATH ${CROSS_SYSROOT})
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
+
+set(CMAKE_CROSSCOMPILING_EMULATOR qemu-aarch64 -L ${CROSS_SYSROOT})
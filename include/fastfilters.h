@@ -53,10 +53,45 @@ extern "C" {
 #endif
 #endif
 
+// Incremented whenever the layout of a public struct changes, the shared library carries it as its SOVERSION. Version 2
+// appended the type field to fastfilters_array2d_t/fastfilters_array3d_t and exact_fir to fastfilters_options_t, see
+// CHANGELOG.md. Code built against version 1 has to be recompiled.
+#define FASTFILTERS_ABI_VERSION 2
+
 typedef struct _fastfilters_kernel_fir_t *fastfilters_kernel_fir_t;
+typedef struct _fastfilters_kernel_iir_t *fastfilters_kernel_iir_t;
+
+typedef enum {
+    FASTFILTERS_CPU_AVX,
+    FASTFILTERS_CPU_FMA,
+    FASTFILTERS_CPU_AVX2,
+    FASTFILTERS_CPU_AVX512F,
+    FASTFILTERS_CPU_NEON
+} fastfilters_cpu_feature_t;
+
+typedef enum {
+    FASTFILTERS_KERNEL_SYMMETRIC,
+    FASTFILTERS_KERNEL_ANTISYMMETRIC,
+    FASTFILTERS_KERNEL_GENERAL
+} fastfilters_kernel_symmetry_t;
 
-typedef enum { FASTFILTERS_CPU_AVX, FASTFILTERS_CPU_FMA, FASTFILTERS_CPU_AVX2 } fastfilters_cpu_feature_t;
+// element type of an array. Filter outputs are FASTFILTERS_TYPE_FLOAT32 unless documented otherwise, the convolution,
+// gaussian, hog, combine, eigenvalue, filter bank and scale space functions can also store FASTFILTERS_TYPE_FLOAT16
+// (IEEE half) or FASTFILTERS_TYPE_BFLOAT16 (upper half of a float32), rounded to nearest even. All arithmetic is done
+// in float32.
+typedef enum {
+    FASTFILTERS_TYPE_FLOAT32,
+    FASTFILTERS_TYPE_UINT8,
+    FASTFILTERS_TYPE_UINT16,
+    FASTFILTERS_TYPE_INT16,
+    FASTFILTERS_TYPE_FLOAT64,
+    FASTFILTERS_TYPE_FLOAT16,
+    FASTFILTERS_TYPE_BFLOAT16
+} fastfilters_type_t;
 
+// ptr points to elements of the given type (cast to float *), strides are counted in elements. type was added in ABI
+// version 2: callers that fill the fields one by one have to set it as well, zero-initialized arrays default to
+// FASTFILTERS_TYPE_FLOAT32. Unknown types are rejected.
 typedef struct _fastfilters_array2d_t {
     float *ptr;
     size_t n_x;
@@ -64,6 +99,7 @@ typedef struct _fastfilters_array2d_t {
     size_t stride_x;
     size_t stride_y;
     size_t n_channels;
+    fastfilters_type_t type;
 } fastfilters_array2d_t;
 
 typedef struct _fastfilters_array3d_t {
@@ -75,26 +111,100 @@ typedef struct _fastfilters_array3d_t {
     size_t stride_y;
     size_t stride_z;
     size_t n_channels;
+    fastfilters_type_t type;
 } fastfilters_array3d_t;
 
+// zero-initialize options so that fields added later keep their defaults
 typedef struct _fastfilters_options_t {
     float window_ratio;
+    // use the sampled fir gaussian at every sigma instead of the iir approximation, see fastfilters_iir_set_crossover
+    bool exact_fir;
 } fastfilters_options_t;
 
+typedef enum {
+    FASTFILTERS_FEATURE_GAUSSIAN,
+    FASTFILTERS_FEATURE_GRADMAG,
+    FASTFILTERS_FEATURE_LAPLACIAN,
+    FASTFILTERS_FEATURE_HOG_EV,
+    FASTFILTERS_FEATURE_ST_EV
+} fastfilters_feature_type_t;
+
+typedef struct _fastfilters_feature_t {
+    fastfilters_feature_type_t type;
+    double sigma;
+    // smoothing scale of FASTFILTERS_FEATURE_ST_EV (sigma is the derivative scale), ignored otherwise
+    double sigma_outer;
+} fastfilters_feature_t;
+
+typedef enum {
+    // Frangi vesselness: lines (2D) or tubes (3D)
+    FASTFILTERS_HESSIAN_VESSELNESS,
+    // Li's dot enhancement: the smallest eigenvalue magnitude squared over the largest where all are negative
+    FASTFILTERS_HESSIAN_BLOBNESS,
+    // Sato's line measure
+    FASTFILTERS_HESSIAN_RIDGE
+} fastfilters_hessian_measure_type_t;
+
+typedef struct _fastfilters_hessian_measure_t {
+    fastfilters_hessian_measure_type_t type;
+    // respond to dark structures on a bright background instead of bright ones
+    bool dark;
+    // vesselness: Frangi's alpha (3D only), beta and c, the structure term is left out for c <= 0
+    // ridge: Sato's alpha1 (alpha) and alpha2 (beta) weighting a same or opposite signed first eigenvalue
+    float alpha;
+    float beta;
+    float c;
+} fastfilters_hessian_measure_t;
+
 typedef void *(*fastfilters_alloc_fn_t)(size_t size);
 typedef void (*fastfilters_free_fn_t)(void *);
 
 void DLL_PUBLIC fastfilters_init(void);
+// FASTFILTERS_ABI_VERSION of the loaded library, to detect a header/library mismatch at run time
+unsigned int DLL_PUBLIC fastfilters_abi_version(void);
 void DLL_PUBLIC fastfilters_init_ex(fastfilters_alloc_fn_t alloc_fn, fastfilters_free_fn_t free_fn);
 
+// Temporary buffers can be pooled in per-thread caches on top of the allocator, so that repeated filter calls reuse
+// them. The pool is off by default; once enabled, freed blocks of up to 16 MB stay cached, at most 16 MB per cache and
+// 256 MB in total, until fastfilters_memory_trim is called or the pool is disabled again. huge_pages backs blocks of
+// 2 MB and more with transparent huge pages (Linux only).
+typedef struct _fastfilters_memory_stats_t {
+    size_t allocations;
+    size_t pool_hits;
+    size_t bytes_in_use;
+    size_t bytes_cached;
+} fastfilters_memory_stats_t;
+
+void DLL_PUBLIC fastfilters_memory_pool_configure(bool enable, bool huge_pages);
+void DLL_PUBLIC fastfilters_memory_trim(void);
+void DLL_PUBLIC fastfilters_memory_stats(fastfilters_memory_stats_t *stats);
+
 bool DLL_PUBLIC fastfilters_cpu_check(fastfilters_cpu_feature_t feature);
 bool DLL_PUBLIC fastfilters_cpu_enable(fastfilters_cpu_feature_t feature, bool enable);
 
+// 0 selects one thread per online CPU; the default (1) can also be set with FASTFILTERS_NUM_THREADS.
+// Concurrent calls are serialized and wait for the parallel loop running on the pool. If not all threads can be
+// started, false is returned and the library falls back to a single thread.
+bool DLL_PUBLIC fastfilters_set_num_threads(unsigned int n_threads);
+unsigned int DLL_PUBLIC fastfilters_get_num_threads(void);
+
 fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_gaussian(unsigned int order, double sigma,
                                                                     float window_ratio);
+// User-defined kernel, applied along an axis as out[i] = sum of coefs[k] * in[i + k] for -len <= k <= len with
+// mirrored borders. Symmetric and antisymmetric kernels are given by their len + 1 taps for k = 0 .. len (the center
+// tap is used as given for antisymmetric ones), general kernels by all 2 * len + 1 taps starting at k = -len. General
+// kernels run as a symmetric plus an antisymmetric pass and cost about twice as much. The coefficients are copied,
+// the kernel is not cached and has to be released with fastfilters_kernel_fir_free. Returns NULL for len == 0.
+fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_create(const float *coefs, unsigned int len,
+                                                                  fastfilters_kernel_symmetry_t symmetry);
 unsigned int DLL_PUBLIC fastfilters_kernel_fir_get_length(fastfilters_kernel_fir_t kernel);
 void DLL_PUBLIC fastfilters_kernel_fir_free(fastfilters_kernel_fir_t kernel);
 
+// fastfilters_kernel_fir_gaussian hands out shared kernels from a small LRU cache. Dropping cache entries does not
+// affect kernels that are still in use, they stay valid until freed.
+void DLL_PUBLIC fastfilters_kernel_cache_invalidate(unsigned int order, double sigma, float window_ratio);
+void DLL_PUBLIC fastfilters_kernel_cache_clear(void);
+
 bool DLL_PUBLIC fastfilters_fir_convolve2d(const fastfilters_array2d_t *inarray, const fastfilters_kernel_fir_t kernelx,
                                            const fastfilters_kernel_fir_t kernely,
                                            const fastfilters_array2d_t *outarray, const fastfilters_options_t *options);
@@ -103,12 +213,108 @@ bool DLL_PUBLIC fastfilters_fir_convolve3d(const fastfilters_array3d_t *inarray,
                                            const fastfilters_kernel_fir_t kernelz,
                                            const fastfilters_array3d_t *outarray, const fastfilters_options_t *options);
 
+// Volume that is read and written plane by plane through callbacks. read fills buf with the n_z planes starting at z as
+// dense elements of in_type (stride_x == n_channels, stride_y == n_x * n_channels, ...), write gets planes of the
+// result the same way as elements of out_type. Both return false on errors. They run on a helper thread so that I/O
+// overlaps filtering; read and write may run at the same time, but neither runs concurrently with itself.
+typedef bool (*fastfilters_chunk_read_fn_t)(void *ctx, size_t z, size_t n_z, void *buf);
+typedef bool (*fastfilters_chunk_write_fn_t)(void *ctx, size_t z, size_t n_z, const void *buf);
+
+typedef struct _fastfilters_volume_io_t {
+    size_t n_x;
+    size_t n_y;
+    size_t n_z;
+    size_t n_channels;
+    fastfilters_type_t in_type;
+    fastfilters_type_t out_type;
+    fastfilters_chunk_read_fn_t read;
+    fastfilters_chunk_write_fn_t write;
+    void *ctx;
+} fastfilters_volume_io_t;
+
+// fastfilters_fir_convolve3d for volumes that don't fit into memory. The volume is processed in slabs of slab_planes z
+// planes (0 picks slabs of about 64 MB of float32, never fewer than twice the kernelz length), each read together with
+// the kernelz length of planes on both sides.
+// The result is bit-identical to fastfilters_fir_convolve3d. Peak memory is about two input and two output slabs plus
+// one float32 slab including the overlap.
+bool DLL_PUBLIC fastfilters_fir_convolve3d_chunked(const fastfilters_volume_io_t *io, size_t slab_planes,
+                                                   const fastfilters_kernel_fir_t kernelx,
+                                                   const fastfilters_kernel_fir_t kernely,
+                                                   const fastfilters_kernel_fir_t kernelz,
+                                                   const fastfilters_options_t *options);
+
+// Convolution of one block of a larger image that reads the pixels around the block from halos instead of mirroring at
+// the block borders, so that blocks filtered one by one match filtering the whole image up to float rounding (the
+// vector loops split block lines differently). halos holds 4 (2D) or 6 (3D) arrays ordered x left, x right, y left, y
+// right, z left, z right; a halo with a NULL ptr, or halos == NULL, marks a side at the border of the image, which is
+// mirrored. A halo is as long as the kernel along its own axis and as long as the block along later axes. Along earlier
+// axes it also spans the halos given for that axis (the corners), e.g. a y halo covers x = -len_x .. n_x + len_x - 1 if
+// both x halos exist. Halos are only filtered along these earlier axes, the block itself never convolves halo pixels.
+// Input and halos are FASTFILTERS_TYPE_FLOAT32, halos are dense (stride_x == n_channels, stride_y == n_x * n_channels,
+// ...) and every block axis is at least twice the kernel length.
+bool DLL_PUBLIC fastfilters_fir_convolve_block2d(const fastfilters_array2d_t *inarray,
+                                                 const fastfilters_array2d_t *halos,
+                                                 const fastfilters_kernel_fir_t kernelx,
+                                                 const fastfilters_kernel_fir_t kernely,
+                                                 const fastfilters_array2d_t *outarray,
+                                                 const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_convolve_block3d(const fastfilters_array3d_t *inarray,
+                                                 const fastfilters_array3d_t *halos,
+                                                 const fastfilters_kernel_fir_t kernelx,
+                                                 const fastfilters_kernel_fir_t kernely,
+                                                 const fastfilters_kernel_fir_t kernelz,
+                                                 const fastfilters_array3d_t *outarray,
+                                                 const fastfilters_options_t *options);
+
+// Recursive (Young - van Vliet) gaussian of the given order (0-2). Its cost per pixel does not depend on sigma. For
+// sigma >= 5 the impulse response is within 0.1% (order 0), 0.4% (order 1) and 0.8% (order 2) of the peak of the
+// sampled fir kernel, smaller sigmas are less accurate. Sigmas below 0.5 (0.8 for order 1) are rejected.
+fastfilters_kernel_iir_t DLL_PUBLIC fastfilters_kernel_iir_gaussian(unsigned int order, double sigma);
+void DLL_PUBLIC fastfilters_kernel_iir_free(fastfilters_kernel_iir_t kernel);
+
+bool DLL_PUBLIC fastfilters_iir_convolve2d(const fastfilters_array2d_t *inarray, const fastfilters_kernel_iir_t kernelx,
+                                           const fastfilters_kernel_iir_t kernely,
+                                           const fastfilters_array2d_t *outarray, const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_iir_convolve3d(const fastfilters_array3d_t *inarray, const fastfilters_kernel_iir_t kernelx,
+                                           const fastfilters_kernel_iir_t kernely,
+                                           const fastfilters_kernel_iir_t kernelz,
+                                           const fastfilters_array3d_t *outarray, const fastfilters_options_t *options);
+
+// The gaussian, hog, gradmag and laplacian filters switch to iir kernels when the sigmas of all axes reach the
+// crossover (6 by default) unless a window ratio or exact_fir is given in the options, the structure tensor and the
+// filter bank always use fir kernels. A crossover of 0 keeps all filters on fir kernels.
+void DLL_PUBLIC fastfilters_iir_set_crossover(double sigma);
+double DLL_PUBLIC fastfilters_iir_get_crossover(void);
+
 void DLL_PUBLIC fastfilters_linalg_ev2d(const float *xx, const float *xy, const float *yy, float *ev_small,
                                         float *ev_big, const size_t len);
 void DLL_PUBLIC fastfilters_linalg_ev3d(const float *a00, const float *a01, const float *a02, const float *a11,
                                         const float *a12, const float *a22, float *ev0, float *ev1, float *ev2,
                                         const size_t len);
 
+// like fastfilters_linalg_ev2d/ev3d, but the eigenvalues are stored as elements of out_type
+void DLL_PUBLIC fastfilters_linalg_ev2d_ex(const float *xx, const float *xy, const float *yy, void *ev_small,
+                                           void *ev_big, const size_t len, fastfilters_type_t out_type);
+void DLL_PUBLIC fastfilters_linalg_ev3d_ex(const float *a00, const float *a01, const float *a02, const float *a11,
+                                           const float *a12, const float *a22, void *ev0, void *ev1, void *ev2,
+                                           const size_t len, fastfilters_type_t out_type);
+
+// Eigenvalues in the order of fastfilters_linalg_ev2d/ev3d together with their unit eigenvectors. vec[k * 2 + j] (2D)
+// or vec[k * 3 + j] (3D) receives component j of the eigenvector of the k-th eigenvalue, where component j belongs to
+// row j of the matrix as it is passed in. The sign of each eigenvector is arbitrary, repeated eigenvalues still get an
+// orthonormal set.
+void DLL_PUBLIC fastfilters_linalg_eigen2d(const float *xx, const float *xy, const float *yy, float *ev0, float *ev1,
+                                           float *const *vec, const size_t len);
+void DLL_PUBLIC fastfilters_linalg_eigen3d(const float *a00, const float *a01, const float *a02, const float *a11,
+                                           const float *a12, const float *a22, float *ev0, float *ev1, float *ev2,
+                                           float *const *vec, const size_t len);
+void DLL_PUBLIC fastfilters_linalg_eigen2d_ex(const float *xx, const float *xy, const float *yy, void *ev0, void *ev1,
+                                              void *const *vec, const size_t len, fastfilters_type_t out_type);
+void DLL_PUBLIC fastfilters_linalg_eigen3d_ex(const float *a00, const float *a01, const float *a02, const float *a11,
+                                              const float *a12, const float *a22, void *ev0, void *ev1, void *ev2,
+                                              void *const *vec, const size_t len, fastfilters_type_t out_type);
+
+// the combine functions read float32 arrays and store elements of out->type
 void DLL_PUBLIC fastfilters_combine_add2d(const fastfilters_array2d_t *a, const fastfilters_array2d_t *b,
                                           fastfilters_array2d_t *out);
 void DLL_PUBLIC fastfilters_combine_add3d(const fastfilters_array3d_t *a, const fastfilters_array3d_t *b,
@@ -130,6 +336,14 @@ DLL_PUBLIC void fastfilters_array2d_free(fastfilters_array2d_t *v);
 DLL_PUBLIC fastfilters_array3d_t *fastfilters_array3d_alloc(size_t n_x, size_t n_y, size_t n_z, size_t channels);
 DLL_PUBLIC void fastfilters_array3d_free(fastfilters_array3d_t *v);
 
+// Maps a raw file of dense elements of type ([z][y][x][channel]) as an array without copying it. Read-only mappings
+// require the file to be large enough, writable ones create or grow it and write through to it. Returns NULL on errors.
+// Mappings are tuned for fastfilters_fir_convolve3d: read-only inputs for one sequential pass, writable outputs for the
+// plane strided y and z passes.
+DLL_PUBLIC fastfilters_array3d_t *fastfilters_array3d_map(const char *path, size_t n_x, size_t n_y, size_t n_z,
+                                                          size_t channels, fastfilters_type_t type, bool writable);
+DLL_PUBLIC void fastfilters_array3d_unmap(fastfilters_array3d_t *v);
+
 bool DLL_PUBLIC fastfilters_fir_gaussian2d(const fastfilters_array2d_t *inarray, unsigned order, double sigma,
                                            fastfilters_array2d_t *outarray, const fastfilters_options_t *options);
 bool DLL_PUBLIC fastfilters_fir_gaussian3d(const fastfilters_array3d_t *inarray, unsigned order, double sigma,
@@ -138,6 +352,9 @@ bool DLL_PUBLIC fastfilters_fir_gaussian3d(const fastfilters_array3d_t *inarray,
 bool DLL_PUBLIC fastfilters_fir_hog2d(const fastfilters_array2d_t *inarray, double sigma, fastfilters_array2d_t *out_xx,
                                       fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
                                       const fastfilters_options_t *options);
+// The 3D components share their z passes, which run before the x and y passes instead of after them. The results
+// therefore differ from fastfilters_fir_convolve3d with the same kernels by float rounding, within 1e-6 of the largest
+// magnitude of a component.
 DLL_PUBLIC bool fastfilters_fir_hog3d(const fastfilters_array3d_t *inarray, double sigma, fastfilters_array3d_t *out_xx,
                                       fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
                                       fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
@@ -162,6 +379,156 @@ bool DLL_PUBLIC fastfilters_fir_structure_tensor3d(const fastfilters_array3d_t *
                                                    fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
                                                    fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
                                                    fastfilters_array3d_t *out_yz, const fastfilters_options_t *options);
+
+// Anisotropic variants take one sigma per axis in x, y(, z) order and build separate kernels for every axis.
+// window_ratios holds one window ratio per axis as well, NULL uses options->window_ratio on all axes. Derivatives are
+// taken with respect to pixel coordinates, divide by the sample spacing for physical units.
+bool DLL_PUBLIC fastfilters_fir_gaussian2d_aniso(const fastfilters_array2d_t *inarray, unsigned order,
+                                                 const double *sigmas, const float *window_ratios,
+                                                 fastfilters_array2d_t *outarray, const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_gaussian3d_aniso(const fastfilters_array3d_t *inarray, unsigned order,
+                                                 const double *sigmas, const float *window_ratios,
+                                                 fastfilters_array3d_t *outarray, const fastfilters_options_t *options);
+
+bool DLL_PUBLIC fastfilters_fir_hog2d_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                            const float *window_ratios, fastfilters_array2d_t *out_xx,
+                                            fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
+                                            const fastfilters_options_t *options);
+DLL_PUBLIC bool fastfilters_fir_hog3d_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                            const float *window_ratios, fastfilters_array3d_t *out_xx,
+                                            fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
+                                            fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
+                                            fastfilters_array3d_t *out_yz, const fastfilters_options_t *options);
+
+bool DLL_PUBLIC fastfilters_fir_gradmag2d_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                const float *window_ratios, fastfilters_array2d_t *outarray,
+                                                const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_gradmag3d_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                const float *window_ratios, fastfilters_array3d_t *outarray,
+                                                const fastfilters_options_t *options);
+
+bool DLL_PUBLIC fastfilters_fir_laplacian2d_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                  const float *window_ratios, fastfilters_array2d_t *outarray,
+                                                  const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_laplacian3d_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                  const float *window_ratios, fastfilters_array3d_t *outarray,
+                                                  const fastfilters_options_t *options);
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_aniso(const fastfilters_array2d_t *inarray,
+                                                         const double *sigma_outer, const double *sigma_inner,
+                                                         const float *window_ratios, fastfilters_array2d_t *out_xx,
+                                                         fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
+                                                         const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_aniso(const fastfilters_array3d_t *inarray,
+                                                         const double *sigma_outer, const double *sigma_inner,
+                                                         const float *window_ratios, fastfilters_array3d_t *out_xx,
+                                                         fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
+                                                         fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
+                                                         fastfilters_array3d_t *out_yz,
+                                                         const fastfilters_options_t *options);
+
+// Eigenvalues of the Hessian or structure tensor without full-size tensor arrays: the tensor is computed in slabs
+// along the last axis and turned into eigenvalues tile by tile. The eigenvalue arrays are shaped like the input, dense
+// within each row (2D) or plane (3D) and may have any output type, shared by all of them. The order of the eigenvalues
+// matches fastfilters_linalg_ev2d/ev3d called on the tensor.
+bool DLL_PUBLIC fastfilters_fir_hog2d_eigenvalues(const fastfilters_array2d_t *inarray, double sigma,
+                                                  fastfilters_array2d_t *ev_small, fastfilters_array2d_t *ev_big,
+                                                  const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_hog3d_eigenvalues(const fastfilters_array3d_t *inarray, double sigma,
+                                                  fastfilters_array3d_t *ev0, fastfilters_array3d_t *ev1,
+                                                  fastfilters_array3d_t *ev2, const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_hog2d_eigenvalues_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                        const float *window_ratios, fastfilters_array2d_t *ev_small,
+                                                        fastfilters_array2d_t *ev_big,
+                                                        const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_hog3d_eigenvalues_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                        const float *window_ratios, fastfilters_array3d_t *ev0,
+                                                        fastfilters_array3d_t *ev1, fastfilters_array3d_t *ev2,
+                                                        const fastfilters_options_t *options);
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_eigenvalues(const fastfilters_array2d_t *inarray,
+                                                               double sigma_outer, double sigma_inner,
+                                                               fastfilters_array2d_t *ev_small,
+                                                               fastfilters_array2d_t *ev_big,
+                                                               const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_eigenvalues(const fastfilters_array3d_t *inarray,
+                                                               double sigma_outer, double sigma_inner,
+                                                               fastfilters_array3d_t *ev0, fastfilters_array3d_t *ev1,
+                                                               fastfilters_array3d_t *ev2,
+                                                               const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_eigenvalues_aniso(
+    const fastfilters_array2d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array2d_t *ev_small, fastfilters_array2d_t *ev_big,
+    const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_eigenvalues_aniso(
+    const fastfilters_array3d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array3d_t *ev0, fastfilters_array3d_t *ev1, fastfilters_array3d_t *ev2,
+    const fastfilters_options_t *options);
+
+// Eigenvalues evs[k] together with the unit eigenvectors: vecs[k * ndim + j] receives component j (x first) of the
+// eigenvector of evs[k]. All arrays follow the rules of the eigenvalue arrays above.
+bool DLL_PUBLIC fastfilters_fir_hog2d_eigenvectors_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                         const float *window_ratios, fastfilters_array2d_t *const *evs,
+                                                         fastfilters_array2d_t *const *vecs,
+                                                         const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_hog3d_eigenvectors_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                         const float *window_ratios, fastfilters_array3d_t *const *evs,
+                                                         fastfilters_array3d_t *const *vecs,
+                                                         const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_eigenvectors_aniso(
+    const fastfilters_array2d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array2d_t *const *evs, fastfilters_array2d_t *const *vecs,
+    const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_eigenvectors_aniso(
+    const fastfilters_array3d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array3d_t *const *evs, fastfilters_array3d_t *const *vecs,
+    const fastfilters_options_t *options);
+
+// Multi-scale Hessian measures: the maximum over all scales of the measure of the eigenvalues of sigma^2 times the
+// Hessian of Gaussian at sigma = sigmas[0..n_scales). Each scale runs the tile-wise eigenvalue path above and only
+// updates the maximum in out, a float32 array following the rules of the eigenvalue arrays.
+bool DLL_PUBLIC fastfilters_fir_hessian_measure2d(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                  size_t n_scales, const fastfilters_hessian_measure_t *measure,
+                                                  fastfilters_array2d_t *out, const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_hessian_measure3d(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                  size_t n_scales, const fastfilters_hessian_measure_t *measure,
+                                                  fastfilters_array3d_t *out, const fastfilters_options_t *options);
+
+// Filter banks write the outputs of all features back to back into outptr, each output is a dense array shaped like
+// the input. Eigenvalue features produce 2 (2D) or 3 (3D) outputs, all other features one.
+unsigned int DLL_PUBLIC fastfilters_feature_get_n_outputs(fastfilters_feature_type_t type, unsigned int ndim);
+bool DLL_PUBLIC fastfilters_fir_filter_bank2d(const fastfilters_array2d_t *inarray,
+                                              const fastfilters_feature_t *features, size_t n_features, float *outptr,
+                                              const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_filter_bank3d(const fastfilters_array3d_t *inarray,
+                                              const fastfilters_feature_t *features, size_t n_features, float *outptr,
+                                              const fastfilters_options_t *options);
+
+// filter banks that store their outputs as elements of out_type
+bool DLL_PUBLIC fastfilters_fir_filter_bank2d_ex(const fastfilters_array2d_t *inarray,
+                                                 const fastfilters_feature_t *features, size_t n_features,
+                                                 void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_filter_bank3d_ex(const fastfilters_array3d_t *inarray,
+                                                 const fastfilters_feature_t *features, size_t n_features,
+                                                 void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options);
+
+// Scale spaces write the gaussian smoothings at n_scales positive, strictly increasing sigmas back to back into outptr,
+// or with dog the n_scales - 1 differences of consecutive smoothings (the finer one subtracted), each a dense array
+// shaped like the input. Every level is smoothed from the previous one, so all kernels stay short.
+bool DLL_PUBLIC fastfilters_fir_scale_space2d(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                              size_t n_scales, bool dog, float *outptr,
+                                              const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_scale_space3d(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                              size_t n_scales, bool dog, float *outptr,
+                                              const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_scale_space2d_ex(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                 size_t n_scales, bool dog, void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options);
+bool DLL_PUBLIC fastfilters_fir_scale_space3d_ex(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                 size_t n_scales, bool dog, void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options);
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,8 @@
 #include "fastfilters.h"
 #include "common.h"
 
+#include <string.h>
+
 DLL_PUBLIC fastfilters_array2d_t *fastfilters_array2d_alloc(size_t n_x, size_t n_y, size_t channels)
 {
     fastfilters_array2d_t *result = NULL;
@@ -32,6 +34,7 @@ DLL_PUBLIC fastfilters_array2d_t *fastfilters_array2d_alloc(size_t n_x, size_t n
     result->stride_x = channels;
     result->stride_y = channels * n_x;
     result->n_channels = channels;
+    result->type = FASTFILTERS_TYPE_FLOAT32;
     result->ptr = fastfilters_memory_alloc(channels * n_y * n_x * sizeof(float));
     if (!result->ptr)
         goto error_out;
@@ -68,6 +71,7 @@ DLL_PUBLIC fastfilters_array3d_t *fastfilters_array3d_alloc(size_t n_x, size_t n
     result->stride_y = channels * n_x;
     result->stride_z = channels * n_x * n_y;
     result->n_channels = channels;
+    result->type = FASTFILTERS_TYPE_FLOAT32;
     result->ptr = fastfilters_memory_alloc(channels * n_y * n_x * n_z * sizeof(float));
     if (!result->ptr)
         goto error_out;
@@ -87,4 +91,182 @@ DLL_PUBLIC void fastfilters_array3d_free(fastfilters_array3d_t *v)
 {
     fastfilters_memory_free(v->ptr);
     fastfilters_memory_free(v);
-}
\ No newline at end of file
+}
+size_t fastfilters_type_size(fastfilters_type_t type)
+{
+    switch (type) {
+    case FASTFILTERS_TYPE_FLOAT32:
+        return sizeof(float);
+    case FASTFILTERS_TYPE_UINT8:
+        return sizeof(uint8_t);
+    case FASTFILTERS_TYPE_UINT16:
+        return sizeof(uint16_t);
+    case FASTFILTERS_TYPE_INT16:
+        return sizeof(int16_t);
+    case FASTFILTERS_TYPE_FLOAT64:
+        return sizeof(double);
+    case FASTFILTERS_TYPE_FLOAT16:
+    case FASTFILTERS_TYPE_BFLOAT16:
+        return sizeof(uint16_t);
+    default:
+        return 0;
+    }
+}
+
+bool fastfilters_type_is_output(fastfilters_type_t type)
+{
+    return type == FASTFILTERS_TYPE_FLOAT32 || type == FASTFILTERS_TYPE_FLOAT16 || type == FASTFILTERS_TYPE_BFLOAT16;
+}
+
+static inline float half_to_float(uint16_t h)
+{
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t bits = h & 0x7fff;
+    uint32_t x;
+    float f;
+
+    if (bits >= 0x7c00) {
+        x = sign | 0x7f800000 | ((bits & 0x3ff) << 13);
+    } else if (bits >= 0x400) {
+        x = sign | ((bits << 13) + 0x38000000);
+    } else {
+        // subnormal, exactly representable as float
+        f = (float)bits * 5.9604644775390625e-8f;
+        memcpy(&x, &f, sizeof(x));
+        x |= sign;
+    }
+
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static inline uint16_t float_to_half(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    const uint16_t sign = (x >> 16) & 0x8000;
+    uint32_t bits = x & 0x7fffffff;
+
+    if (bits > 0x7f800000)
+        return sign | 0x7e00;
+    // everything from 65520 on rounds to infinity
+    if (bits >= 0x477ff000)
+        return sign | 0x7c00;
+
+    if (bits < 0x38800000) {
+        // subnormal or zero: adding 0.5 lets the fpu round the mantissa at the half subnormal position
+        float a;
+        memcpy(&a, &bits, sizeof(a));
+        a += 0.5f;
+        memcpy(&bits, &a, sizeof(bits));
+        return sign | (uint16_t)(bits - 0x3f000000);
+    }
+
+    // rebias the exponent and round to nearest even
+    bits += 0xc8000fff + ((bits >> 13) & 1);
+    return sign | (uint16_t)(bits >> 13);
+}
+
+static inline float bfloat16_to_float(uint16_t h)
+{
+    const uint32_t x = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static inline uint16_t float_to_bfloat16(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    if ((x & 0x7fffffff) > 0x7f800000)
+        return (x >> 16) | 0x40;
+
+    x += 0x7fff + ((x >> 16) & 1);
+    return x >> 16;
+}
+
+void fastfilters_type_convert(const void *inptr, fastfilters_type_t type, size_t offset, size_t n, float *outptr)
+{
+    switch (type) {
+    case FASTFILTERS_TYPE_FLOAT32: {
+        const float *in = (const float *)inptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = in[i];
+        break;
+    }
+    case FASTFILTERS_TYPE_UINT8: {
+        const uint8_t *in = (const uint8_t *)inptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = in[i];
+        break;
+    }
+    case FASTFILTERS_TYPE_UINT16: {
+        const uint16_t *in = (const uint16_t *)inptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = in[i];
+        break;
+    }
+    case FASTFILTERS_TYPE_INT16: {
+        const int16_t *in = (const int16_t *)inptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = in[i];
+        break;
+    }
+    case FASTFILTERS_TYPE_FLOAT64: {
+        const double *in = (const double *)inptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = (float)in[i];
+        break;
+    }
+    case FASTFILTERS_TYPE_FLOAT16: {
+        const uint16_t *in = (const uint16_t *)inptr + offset;
+#ifdef HAVE_F16C
+        if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX2)) {
+            fastfilters_type_convert_f16c(in, n, outptr);
+            break;
+        }
+#endif
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = half_to_float(in[i]);
+        break;
+    }
+    case FASTFILTERS_TYPE_BFLOAT16: {
+        const uint16_t *in = (const uint16_t *)inptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            outptr[i] = bfloat16_to_float(in[i]);
+        break;
+    }
+    }
+}
+
+void fastfilters_type_store(const float *inptr, size_t n, void *outptr, fastfilters_type_t type, size_t offset)
+{
+    switch (type) {
+    case FASTFILTERS_TYPE_FLOAT32:
+        memcpy((float *)outptr + offset, inptr, n * sizeof(float));
+        break;
+    case FASTFILTERS_TYPE_FLOAT16: {
+        uint16_t *out = (uint16_t *)outptr + offset;
+#ifdef HAVE_F16C
+        if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX2)) {
+            fastfilters_type_store_f16c(inptr, n, out);
+            break;
+        }
+#endif
+        for (size_t i = 0; i < n; ++i)
+            out[i] = float_to_half(inptr[i]);
+        break;
+    }
+    case FASTFILTERS_TYPE_BFLOAT16: {
+        uint16_t *out = (uint16_t *)outptr + offset;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = float_to_bfloat16(inptr[i]);
+        break;
+    }
+    default:
+        break;
+    }
+}
@@ -0,0 +1,163 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+static void *map_file(const char *path, size_t size, bool writable)
+{
+    void *ptr = NULL;
+    HANDLE mapping = NULL;
+    HANDLE file = CreateFileA(path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, NULL,
+                              writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+        goto out;
+    if (!writable && (unsigned long long)file_size.QuadPart < (unsigned long long)size)
+        goto out;
+
+    // a writable mapping larger than the file grows it
+    const unsigned long long map_size = writable ? (unsigned long long)size : 0;
+    mapping = CreateFileMappingA(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, (DWORD)(map_size >> 32),
+                                 (DWORD)map_size, NULL);
+    if (!mapping)
+        goto out;
+
+    ptr = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+
+out:
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+    return ptr;
+}
+
+static void unmap_file(void *ptr, size_t size)
+{
+    (void)size;
+    UnmapViewOfFile(ptr);
+}
+
+#else
+
+static void *map_file(const char *path, size_t size, bool writable)
+{
+    void *ptr = NULL;
+    struct stat st;
+    int fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0)
+        goto out;
+    if ((unsigned long long)st.st_size < (unsigned long long)size) {
+        if (!writable || ftruncate(fd, (off_t)size) != 0)
+            goto out;
+    }
+
+    ptr = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        ptr = NULL;
+        goto out;
+    }
+
+    // Inputs are only streamed once by the x pass. Outputs are also the work buffer of the y and z passes, which walk
+    // all planes for every tile of columns: ask for huge pages to keep the plane strided accesses from thrashing the
+    // TLB. Outputs are not prefetched, that would read the whole file before the x pass overwrites it and keep it
+    // resident however large it is. The hints are best effort, failures are ignored.
+    if (writable) {
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    } else {
+        madvise(ptr, size, MADV_SEQUENTIAL);
+    }
+
+out:
+    close(fd);
+    return ptr;
+}
+
+static void unmap_file(void *ptr, size_t size)
+{
+    munmap(ptr, size);
+}
+
+#endif
+
+static size_t mapped_size(const fastfilters_array3d_t *v)
+{
+    return v->n_z * v->stride_z * fastfilters_type_size(v->type);
+}
+
+DLL_PUBLIC fastfilters_array3d_t *fastfilters_array3d_map(const char *path, size_t n_x, size_t n_y, size_t n_z,
+                                                          size_t channels, fastfilters_type_t type, bool writable)
+{
+    fastfilters_array3d_t *result = NULL;
+
+    if (!fastfilters_type_size(type) || !n_x || !n_y || !n_z || !channels)
+        return NULL;
+
+    result = fastfilters_memory_alloc(sizeof(*result));
+    if (!result)
+        return NULL;
+
+    result->n_x = n_x;
+    result->n_y = n_y;
+    result->n_z = n_z;
+    result->stride_x = channels;
+    result->stride_y = channels * n_x;
+    result->stride_z = channels * n_x * n_y;
+    result->n_channels = channels;
+    result->type = type;
+    result->ptr = map_file(path, mapped_size(result), writable);
+    if (!result->ptr) {
+        fastfilters_memory_free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+DLL_PUBLIC void fastfilters_array3d_unmap(fastfilters_array3d_t *v)
+{
+    unmap_file(v->ptr, mapped_size(v));
+    fastfilters_memory_free(v);
+}
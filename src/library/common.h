@@ -54,14 +54,59 @@ extern "C" {
 
 #define ARRAY_LENGTH(x) (sizeof((x)) / sizeof((x)[0]))
 
+// the outer pass works on column tiles of at most FF_OUTER_TILE_BYTES working set (but at least
+// FF_OUTER_TILE_MIN columns) instead of keeping ring buffer rows as wide as the whole plane/volume
+#ifndef FF_OUTER_TILE_BYTES
+#define FF_OUTER_TILE_BYTES (256 * 1024)
+#endif
+#define FF_OUTER_TILE_MIN 64
+
+// input that is not FASTFILTERS_TYPE_FLOAT32 is converted by the first pass in blocks of about this size
+#ifndef FF_CONVERT_BLOCK_BYTES
+#define FF_CONVERT_BLOCK_BYTES (64 * 1024)
+#endif
+
+// once enabled, fastfilters_memory_align pools blocks up to 1 << FF_POOL_MAX_SHIFT bytes in FF_POOL_SHARDS per-thread
+// caches that keep at most FF_POOL_SHARD_BYTES each
+#ifndef FF_POOL_MAX_SHIFT
+#define FF_POOL_MAX_SHIFT 24
+#endif
+#ifndef FF_POOL_SHARDS
+#define FF_POOL_SHARDS 16
+#endif
+#ifndef FF_POOL_SHARD_BYTES
+#define FF_POOL_SHARD_BYTES ((size_t)16 * 1024 * 1024)
+#endif
+
+// number of gaussian kernels kept alive for reuse by later calls with the same parameters
+#ifndef FF_KERNEL_CACHE_SIZE
+#define FF_KERNEL_CACHE_SIZE 32
+#endif
+
+// slices along the slowest axis that fastfilters_fir_convolve2d_sum/3d_sum filter at once, the carriers of such a block
+// are read back by the remaining passes while they are still in cache
+#ifndef FF_SUM_BLOCK_BYTES
+#define FF_SUM_BLOCK_BYTES (1024 * 1024)
+#endif
+
+// default size of the float work slab of fastfilters_fir_convolve3d_chunked
+#ifndef FF_CHUNK_SLAB_BYTES
+#define FF_CHUNK_SLAB_BYTES (64 * 1024 * 1024)
+#endif
+
 typedef bool (*impl_fn_t)(const float *, const float *, const float *, size_t, size_t, size_t, size_t, float *, size_t,
                           size_t, const fastfilters_kernel_fir_t kernel);
 
-struct _fastfilters_kernel_fir_t {
-    size_t len;
-    bool is_symmetric;
-    float *coefs;
+typedef enum {
+    FASTFILTERS_FIR_IMPL_NOSIMD,
+    FASTFILTERS_FIR_IMPL_AVX,
+    FASTFILTERS_FIR_IMPL_AVXFMA,
+    FASTFILTERS_FIR_IMPL_AVX512,
+    FASTFILTERS_FIR_IMPL_NEON,
+    FASTFILTERS_FIR_N_IMPLS
+} fastfilters_fir_impl_t;
 
+typedef struct {
     impl_fn_t fn_inner_mirror;
     impl_fn_t fn_inner_ptr;
     impl_fn_t fn_inner_optimistic;
@@ -69,6 +114,22 @@ struct _fastfilters_kernel_fir_t {
     impl_fn_t fn_outer_mirror;
     impl_fn_t fn_outer_ptr;
     impl_fn_t fn_outer_optimistic;
+} fastfilters_fir_dispatch_t;
+
+struct _fastfilters_kernel_fir_t {
+    size_t len;
+    bool is_symmetric;
+    float *coefs;
+
+    // antisymmetric part of general kernels, which run as the sum of this symmetric kernel and odd; NULL otherwise
+    struct _fastfilters_kernel_fir_t *odd;
+
+    // owners of the kernel, including the kernel cache; only changed with the cache lock held
+    unsigned int refcount;
+
+    // filled for every compiled implementation by fastfilters_fir_resolve when the kernel is created and never
+    // written afterwards, so that kernels can be shared between threads and survive cpu feature changes
+    fastfilters_fir_dispatch_t dispatch[FASTFILTERS_FIR_N_IMPLS];
 };
 
 typedef enum {
@@ -88,7 +149,123 @@ void DLL_LOCAL fastfilters_memory_free(void *ptr);
 void DLL_LOCAL *fastfilters_memory_align(size_t alignment, size_t size);
 void DLL_LOCAL fastfilters_memory_align_free(void *ptr);
 
+// element size of type, 0 for unknown types
+size_t DLL_LOCAL fastfilters_type_size(fastfilters_type_t type);
+// converts n elements starting at element offset of inptr to float
+void DLL_LOCAL fastfilters_type_convert(const void *inptr, fastfilters_type_t type, size_t offset, size_t n,
+                                        float *outptr);
+// types filters can store their results as
+bool DLL_LOCAL fastfilters_type_is_output(fastfilters_type_t type);
+// stores n floats as elements of an output type starting at element offset of outptr
+void DLL_LOCAL fastfilters_type_store(const float *inptr, size_t n, void *outptr, fastfilters_type_t type,
+                                      size_t offset);
+
+// out = sum of n_terms (2 or 3) arrays of n floats, or the square root of the sum of their squares
+void DLL_LOCAL fastfilters_combine_sum(const float *const *terms, size_t n_terms, bool sqrt_of_squares, float *out,
+                                       size_t n);
+
+// Hessian measure of n eigenvalue tuples ev[0..ndim) in descending order, scaled by norm first (in place). Stored into
+// out or combined by maximum with its contents.
+void DLL_LOCAL fastfilters_hessian_measure_apply(const fastfilters_hessian_measure_t *measure, unsigned int ndim,
+                                                 float *const *ev, float norm, size_t n, float *out, bool combine_max);
+
+// F16C half conversions, only called when avx2 is available (every avx2 capable cpu also implements F16C)
+#ifdef HAVE_F16C
+void DLL_LOCAL fastfilters_type_convert_f16c(const uint16_t *inptr, size_t n, float *outptr);
+void DLL_LOCAL fastfilters_type_store_f16c(const float *inptr, size_t n, uint16_t *outptr);
+#endif
+
+// typed outputs are computed into float blocks of this many elements and then stored
+#define FF_STORE_BLOCK 1024
+
+// smallest incremental sigma a scale space smooths its previous level with, smaller steps restart from the input
+#ifndef FF_SCALE_SPACE_MIN_STEP
+#define FF_SCALE_SPACE_MIN_STEP 1.0
+#endif
+
 void DLL_LOCAL fastfilters_fir_init(void);
+void DLL_LOCAL fastfilters_fir_resolve(fastfilters_kernel_fir_t kernel);
+
+void DLL_LOCAL fastfilters_fir_resolve_fir(fastfilters_kernel_fir_t kernel);
+void DLL_LOCAL fastfilters_fir_resolve_fir_avx(fastfilters_kernel_fir_t kernel);
+void DLL_LOCAL fastfilters_fir_resolve_fir_avxfma(fastfilters_kernel_fir_t kernel);
+void DLL_LOCAL fastfilters_fir_resolve_fir_avx512(fastfilters_kernel_fir_t kernel);
+void DLL_LOCAL fastfilters_fir_resolve_fir_neon(fastfilters_kernel_fir_t kernel);
+
+bool DLL_LOCAL fastfilters_kernel_fir_equal(const fastfilters_kernel_fir_t a, const fastfilters_kernel_fir_t b);
+
+// one output of a fused 2D convolution, see fastfilters_fir_convolve2d_multi
+typedef struct {
+    const fastfilters_array2d_t *in;
+    fastfilters_kernel_fir_t kx;
+    fastfilters_kernel_fir_t ky;
+    const fastfilters_array2d_t *out;
+} fastfilters_fir_target2d_t;
+
+bool DLL_LOCAL fastfilters_fir_convolve2d_multi(const fastfilters_fir_target2d_t *targets, size_t n_targets,
+                                                const fastfilters_options_t *options);
+
+// one output of a fused 3D convolution, see fastfilters_fir_convolve3d_multi
+typedef struct {
+    const fastfilters_array3d_t *in;
+    fastfilters_kernel_fir_t kx;
+    fastfilters_kernel_fir_t ky;
+    fastfilters_kernel_fir_t kz;
+    const fastfilters_array3d_t *out;
+} fastfilters_fir_target3d_t;
+
+bool DLL_LOCAL fastfilters_fir_convolve3d_multi(const fastfilters_fir_target3d_t *targets, size_t n_targets,
+                                                const fastfilters_options_t *options);
+
+// Sum of n_terms (2 or 3) convolutions of the same input, or the square root of the sum of their squares, fused so
+// that the output is written once without a separate combine sweep and no temporary is as large as the image. Needs a
+// dense float32 output that does not alias the input and an input with stride_x == n_channels, returns false otherwise.
+bool DLL_LOCAL fastfilters_fir_convolve2d_sum(const fastfilters_array2d_t *inarray,
+                                              const fastfilters_kernel_fir_t (*kernels)[2], size_t n_terms,
+                                              bool sqrt_of_squares, const fastfilters_array2d_t *outarray);
+bool DLL_LOCAL fastfilters_fir_convolve3d_sum(const fastfilters_array3d_t *inarray,
+                                              const fastfilters_kernel_fir_t (*kernels)[3], size_t n_terms,
+                                              bool sqrt_of_squares, const fastfilters_array3d_t *outarray);
+
+// single parallel passes with the current implementation; the inner pass uses mirror borders and reads inptr as
+// elements of in_type, the outer one runs on n_planes planes that are plane_stride apart in both input and output
+bool DLL_LOCAL fastfilters_fir_pass_inner(const void *inptr, fastfilters_type_t in_type, size_t n_pixels,
+                                          size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr,
+                                          size_t outptr_stride, fastfilters_kernel_fir_t kernel);
+bool DLL_LOCAL fastfilters_fir_pass_outer(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                                          float *outptr, size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                          size_t n_planes, size_t plane_stride,
+                                          fastfilters_border_treatment_t border);
+
+// borders of a pass. Pixels beyond a FASTFILTERS_BORDER_PTR side are read from left / right instead of the input: for
+// the inner pass pixel -K + i of line l is at left[l * stride + i * pixel_stride] and pixel n_pixels + i at
+// right[l * stride + i * pixel_stride], for the outer pass row -K + i of column j is at left[i * stride + j] and row
+// n_pixels + i at right[i * stride + j], planes of the outer pass are plane_stride apart. K is the kernel length and
+// lines must be at least 2 * K long.
+typedef struct {
+    fastfilters_border_treatment_t left_border;
+    fastfilters_border_treatment_t right_border;
+    const float *left;
+    const float *right;
+    size_t stride;
+    size_t plane_stride;
+} fastfilters_fir_borders_t;
+
+bool DLL_LOCAL fastfilters_fir_pass_inner_borders(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                                  size_t n_outer, size_t outer_stride, float *outptr,
+                                                  size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                                  const fastfilters_fir_borders_t *borders);
+bool DLL_LOCAL fastfilters_fir_pass_outer_borders(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                                  size_t n_outer, void *outptr, fastfilters_type_t out_type,
+                                                  size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                                  size_t n_planes, size_t plane_stride, size_t outptr_plane_stride,
+                                                  const fastfilters_fir_borders_t *borders);
+
+typedef bool (*fastfilters_parallel_fn_t)(void *ctx, size_t begin, size_t end);
+
+void DLL_LOCAL fastfilters_parallel_init(void);
+size_t DLL_LOCAL fastfilters_parallel_chunk_size(size_t n, size_t n_outer, size_t alignment);
+bool DLL_LOCAL fastfilters_parallel_for(size_t n, size_t chunk_size, fastfilters_parallel_fn_t fn, void *ctx);
 
 bool DLL_LOCAL fastfilters_fir_convolve_fir_inner(const float *inptr, size_t n_pixels, size_t pixel_stride,
                                                   size_t n_outer, size_t outer_stride, float *outptr,
@@ -134,6 +311,72 @@ bool DLL_LOCAL fastfilters_fir_convolve_fir_outer_avxfma(const float *inptr, siz
                                                          const float *borderptr_left, const float *borderptr_right,
                                                          size_t border_outer_stride);
 
+bool DLL_LOCAL fastfilters_fir_convolve_fir_inner_avx512(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                                         size_t n_outer, size_t outer_stride, float *outptr,
+                                                         size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                                         fastfilters_border_treatment_t left_border,
+                                                         fastfilters_border_treatment_t right_border,
+                                                         const float *borderptr_left, const float *borderptr_right,
+                                                         size_t border_outer_stride);
+bool DLL_LOCAL fastfilters_fir_convolve_fir_outer_avx512(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                                         size_t n_outer, size_t outer_stride, float *outptr,
+                                                         size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                                         fastfilters_border_treatment_t left_border,
+                                                         fastfilters_border_treatment_t right_border,
+                                                         const float *borderptr_left, const float *borderptr_right,
+                                                         size_t border_outer_stride);
+
+bool DLL_LOCAL fastfilters_fir_convolve_fir_inner_neon(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                                       size_t n_outer, size_t outer_stride, float *outptr,
+                                                       size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                                       fastfilters_border_treatment_t left_border,
+                                                       fastfilters_border_treatment_t right_border,
+                                                       const float *borderptr_left, const float *borderptr_right,
+                                                       size_t border_outer_stride);
+bool DLL_LOCAL fastfilters_fir_convolve_fir_outer_neon(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                                       size_t n_outer, size_t outer_stride, float *outptr,
+                                                       size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                                       fastfilters_border_treatment_t left_border,
+                                                       fastfilters_border_treatment_t right_border,
+                                                       const float *borderptr_left, const float *borderptr_right,
+                                                       size_t border_outer_stride);
+
+// recursive gaussian: the causal and the anticausal pass are each a cascade of FF_IIR_SECTIONS sections
+// y[i] = g x[i] + c1 y[i-1] + c2 y[i-2] with unit dc gain, derivatives are central differences of the smoothed lines
+#define FF_IIR_SECTIONS 3
+
+struct _fastfilters_kernel_iir_t {
+    unsigned int order;
+    double sigma;
+    float g[FF_IIR_SECTIONS];
+    float c1[FF_IIR_SECTIONS];
+    float c2[FF_IIR_SECTIONS];
+
+    // mirrored samples added at both ends of a line, the recursion settles on them before the first real sample
+    size_t margin;
+};
+
+// smallest sigma of all axes at which the gaussian filters switch from fir to iir kernels
+#ifndef FF_IIR_CROSSOVER
+#define FF_IIR_CROSSOVER 6.0
+#endif
+
+// lines are filtered in groups of lanes, buf holds len samples of all lanes of a group interleaved; the functions run
+// the causal and then the anticausal recursion in place
+#define FF_IIR_LANES_NOSIMD 8
+#define FF_IIR_LANES_AVX 16
+#define FF_IIR_LANES_AVX512 32
+#define FF_IIR_MAX_LANES 32
+
+void DLL_LOCAL fastfilters_iir_init(void);
+void DLL_LOCAL fastfilters_iir_run(const fastfilters_kernel_iir_t kernel, float *buf, size_t len);
+void DLL_LOCAL fastfilters_iir_run_avxfma(const fastfilters_kernel_iir_t kernel, float *buf, size_t len);
+void DLL_LOCAL fastfilters_iir_run_avx512(const fastfilters_kernel_iir_t kernel, float *buf, size_t len);
+
+// true if the gaussian filters should use iir kernels for these per axis sigmas and window ratios
+bool DLL_LOCAL fastfilters_iir_select(const double *sigmas, unsigned int ndim, const float *window_ratios,
+                                      const fastfilters_options_t *options);
+
 static inline double opt_window_ratio(const fastfilters_options_t *options)
 {
     if (!options)
@@ -141,6 +384,20 @@ static inline double opt_window_ratio(const fastfilters_options_t *options)
     return options->window_ratio;
 }
 
+static inline bool opt_exact_fir(const fastfilters_options_t *options)
+{
+    return options && options->exact_fir;
+}
+
+// window ratio of one axis for the anisotropic filters, window_ratios may be NULL
+static inline double axis_window_ratio(const float *window_ratios, unsigned int axis,
+                                       const fastfilters_options_t *options)
+{
+    if (window_ratios)
+        return window_ratios[axis];
+    return opt_window_ratio(options);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,58 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <string.h>
+#include <immintrin.h>
+
+void fastfilters_type_convert_f16c(const uint16_t *inptr, size_t n, float *outptr)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(outptr + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(inptr + i))));
+
+    if (i < n) {
+        uint16_t in[8] = {0};
+        float out[8];
+
+        memcpy(in, inptr + i, (n - i) * sizeof(*in));
+        _mm256_storeu_ps(out, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)in)));
+        memcpy(outptr + i, out, (n - i) * sizeof(*out));
+    }
+}
+
+void fastfilters_type_store_f16c(const float *inptr, size_t n, uint16_t *outptr)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128((__m128i *)(outptr + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(inptr + i), _MM_FROUND_TO_NEAREST_INT));
+
+    if (i < n) {
+        float in[8] = {0};
+        uint16_t out[8];
+
+        memcpy(in, inptr + i, (n - i) * sizeof(*in));
+        _mm_storeu_si128((__m128i *)out, _mm256_cvtps_ph(_mm256_loadu_ps(in), _MM_FROUND_TO_NEAREST_INT));
+        memcpy(outptr + i, out, (n - i) * sizeof(*out));
+    }
+}
@@ -38,16 +38,35 @@ static bool _supports_fma()
     return true;
 }
 
+static bool _supports_avx512f()
+{
+    return false;
+}
+
+// advanced SIMD is mandatory on aarch64, the native kernels are not built for 32 bit ARM
+static bool _supports_neon()
+{
+#if defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
 
 static bool g_supports_avx = false;
 static bool g_supports_fma = false;
 static bool g_supports_avx2 = false;
+static bool g_supports_avx512f = false;
+static bool g_supports_neon = false;
 
 void fastfilters_cpu_init(void)
 {
     g_supports_avx = _supports_avx();
     g_supports_fma = _supports_fma();
     g_supports_avx2 = _supports_avx2();
+    g_supports_avx512f = _supports_avx512f();
+    g_supports_neon = _supports_neon();
 }
 
 bool DLL_PUBLIC fastfilters_cpu_enable(fastfilters_cpu_feature_t feature, bool enable)
@@ -71,6 +90,18 @@ bool DLL_PUBLIC fastfilters_cpu_enable(fastfilters_cpu_feature_t feature, bool e
         else
             g_supports_avx2 = false;
         break;
+    case FASTFILTERS_CPU_AVX512F:
+        if (enable)
+            g_supports_avx512f = _supports_avx512f();
+        else
+            g_supports_avx512f = false;
+        break;
+    case FASTFILTERS_CPU_NEON:
+        if (enable)
+            g_supports_neon = _supports_neon();
+        else
+            g_supports_neon = false;
+        break;
     default:
         return false;
     }
@@ -87,6 +118,10 @@ bool DLL_PUBLIC fastfilters_cpu_check(fastfilters_cpu_feature_t feature)
         return g_supports_fma;
     case FASTFILTERS_CPU_AVX2:
         return g_supports_avx2;
+    case FASTFILTERS_CPU_AVX512F:
+        return g_supports_avx512f;
+    case FASTFILTERS_CPU_NEON:
+        return g_supports_neon;
     default:
         return false;
     }
@@ -42,9 +42,11 @@
 #define cpuid_bit_AVX 0x10000000
 #define cpuid_bit_FMA 0x00001000
 #define cpuid7_bit_AVX2 0x00000020
+#define cpuid7_bit_AVX512F 0x00010000
 
 #define xcr0_bit_XMM 0x00000002
 #define xcr0_bit_YMM 0x00000004
+#define xcr0_bits_AVX512 0x000000e0
 
 typedef struct {
     unsigned int eax;
@@ -224,15 +226,58 @@ static bool _supports_fma()
 
 #endif
 
+#if defined(HAVE_GNU_CPU_SUPPORTS_AVX512F)
+
+static bool _supports_avx512f()
+{
+    if (__builtin_cpu_supports("avx512f") && _supports_fma())
+        return true;
+    else
+        return false;
+}
+
+#else
+
+static bool _supports_avx512f()
+{
+    cpuid_t cpuid;
+
+    // the avx512 kernels use fma as well
+    if (!_supports_fma())
+        return false;
+
+    // CPUID.(EAX=07H, ECX=0H):EBX.AVX512F[bit 16]==1
+    int res = get_cpuid(7, &cpuid);
+
+    if (!res)
+        return false;
+
+    if ((cpuid.ebx & cpuid7_bit_AVX512F) != cpuid7_bit_AVX512F)
+        return false;
+
+    // check for OS support: XCR0[7:5] (opmask, upper halves of zmm0-15 and zmm16-31)
+    xgetbv_t xcr0;
+    xcr0 = xgetbv();
+
+    if ((xcr0 & xcr0_bits_AVX512) != xcr0_bits_AVX512)
+        return false;
+
+    return true;
+}
+
+#endif
+
 static bool g_supports_avx = false;
 static bool g_supports_fma = false;
 static bool g_supports_avx2 = false;
+static bool g_supports_avx512f = false;
 
 void fastfilters_cpu_init(void)
 {
     g_supports_avx = _supports_avx();
     g_supports_fma = _supports_fma();
     g_supports_avx2 = _supports_avx2();
+    g_supports_avx512f = _supports_avx512f();
 }
 
 bool DLL_PUBLIC fastfilters_cpu_enable(fastfilters_cpu_feature_t feature, bool enable)
@@ -256,6 +301,12 @@ bool DLL_PUBLIC fastfilters_cpu_enable(fastfilters_cpu_feature_t feature, bool e
         else
             g_supports_avx2 = false;
         break;
+    case FASTFILTERS_CPU_AVX512F:
+        if (enable)
+            g_supports_avx512f = _supports_avx512f();
+        else
+            g_supports_avx512f = false;
+        break;
     default:
         return false;
     }
@@ -272,6 +323,8 @@ bool DLL_PUBLIC fastfilters_cpu_check(fastfilters_cpu_feature_t feature)
         return g_supports_fma;
     case FASTFILTERS_CPU_AVX2:
         return g_supports_avx2;
+    case FASTFILTERS_CPU_AVX512F:
+        return g_supports_avx512f;
     default:
         return false;
     }
@@ -25,13 +25,22 @@
 
 void DLL_PUBLIC fastfilters_init_ex(fastfilters_alloc_fn_t alloc_fn, fastfilters_free_fn_t free_fn)
 {
+    // cached kernels were allocated with the previous allocator
+    fastfilters_kernel_cache_clear();
     fastfilters_cpu_init();
     fastfilters_memory_init(alloc_fn, free_fn);
     fastfilters_linalg_init();
     fastfilters_fir_init();
+    fastfilters_iir_init();
+    fastfilters_parallel_init();
 }
 
 void DLL_PUBLIC fastfilters_init(void)
 {
     fastfilters_init_ex(NULL, NULL);
+}
+
+unsigned int DLL_PUBLIC fastfilters_abi_version(void)
+{
+    return FASTFILTERS_ABI_VERSION;
 }
\ No newline at end of file
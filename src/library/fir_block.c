@@ -0,0 +1,288 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Block convolution with halos. The block is filtered along x, y and z in turn. Before the pass along an axis its
+// halos are brought to the same state as the block, i.e. filtered along all earlier axes, using the corners they
+// carry for those axes (optimistic borders) or mirroring where the image ends. The block pass then reads them through
+// FASTFILTERS_BORDER_PTR borders.
+
+typedef struct {
+    const fastfilters_array3d_t *left;
+    const fastfilters_array3d_t *right;
+    fastfilters_kernel_fir_t kernel;
+    size_t n;
+} block_axis_t;
+
+static bool block_halo_check(const fastfilters_array3d_t *halo, size_t n_x, size_t n_y, size_t n_z, size_t n_channels)
+{
+    return halo->type == FASTFILTERS_TYPE_FLOAT32 && halo->n_channels == n_channels && halo->n_x == n_x &&
+           halo->n_y == n_y && halo->n_z == n_z && halo->stride_x == n_channels &&
+           halo->stride_y == n_x * n_channels && halo->stride_z == n_y * n_x * n_channels;
+}
+
+// number of pixels that the halos of an axis add to the arrays of later axes on the left / right side
+static size_t block_margin_left(const block_axis_t *axis)
+{
+    return axis->left ? axis->kernel->len : 0;
+}
+
+static size_t block_margin_right(const block_axis_t *axis)
+{
+    return axis->right ? axis->kernel->len : 0;
+}
+
+static size_t block_extent(const block_axis_t *axis)
+{
+    return block_margin_left(axis) + axis->n + block_margin_right(axis);
+}
+
+// borders of a pass over data whose halos along the pass axis are stored contiguously next to it
+static fastfilters_fir_borders_t block_corner_borders(const block_axis_t *axis)
+{
+    fastfilters_fir_borders_t borders = {
+        .left_border = axis->left ? FASTFILTERS_BORDER_OPTIMISTIC : FASTFILTERS_BORDER_MIRROR,
+        .right_border = axis->right ? FASTFILTERS_BORDER_OPTIMISTIC : FASTFILTERS_BORDER_MIRROR};
+
+    return borders;
+}
+
+// borders of a block pass that reads the filtered halos left / right, both stride apart per line or row
+static fastfilters_fir_borders_t block_halo_borders(const float *left, const float *right, size_t stride,
+                                                    size_t plane_stride)
+{
+    fastfilters_fir_borders_t borders = {.left_border = left ? FASTFILTERS_BORDER_PTR : FASTFILTERS_BORDER_MIRROR,
+                                         .right_border = right ? FASTFILTERS_BORDER_PTR : FASTFILTERS_BORDER_MIRROR,
+                                         .left = left,
+                                         .right = right,
+                                         .stride = stride,
+                                         .plane_stride = plane_stride};
+
+    return borders;
+}
+
+// x pass of a halo that spans the x halos of the block as corners, into a dense buffer of n_x pixels per line
+static bool block_halo_pass_x(const fastfilters_array3d_t *halo, const block_axis_t *x, float *out)
+{
+    const fastfilters_fir_borders_t borders = block_corner_borders(x);
+    const size_t n_channels = halo->n_channels;
+
+    return fastfilters_fir_pass_inner_borders(halo->ptr + block_margin_left(x) * n_channels, x->n, n_channels,
+                                              halo->n_y * halo->n_z, halo->stride_y, out, x->n * n_channels,
+                                              x->kernel, &borders);
+}
+
+static bool block_convolve(const fastfilters_array3d_t *inarray, const block_axis_t *axes, size_t n_axes,
+                           const fastfilters_array3d_t *outarray)
+{
+    const block_axis_t *x = &axes[0];
+    const block_axis_t *y = &axes[1];
+    const block_axis_t *z = n_axes > 2 ? &axes[2] : NULL;
+    const size_t n_channels = inarray->n_channels;
+    const size_t row_len = x->n * n_channels;
+    bool result = false;
+
+    float *tmp = NULL;
+    float *halo_y[2] = {NULL, NULL};
+    float *halo_z[2] = {NULL, NULL};
+    float *halo_zy[2] = {NULL, NULL};
+    float *work = outarray->ptr;
+
+    if (inarray->type != FASTFILTERS_TYPE_FLOAT32 || !fastfilters_type_is_output(outarray->type))
+        return false;
+    if (inarray->stride_x != n_channels || outarray->n_channels != n_channels || outarray->stride_x != n_channels)
+        return false;
+    if (inarray->ptr == outarray->ptr)
+        return false;
+    // lines of all planes are handled as one batch like in fastfilters_fir_convolve3d
+    if (inarray->stride_z != y->n * inarray->stride_y || outarray->stride_z != y->n * outarray->stride_y)
+        return false;
+    if (z && outarray->stride_y != row_len)
+        return false;
+
+    for (size_t i = 0; i < n_axes; ++i) {
+        if (axes[i].n < 2 * axes[i].kernel->len)
+            return false;
+
+        for (unsigned int side = 0; side < 2; ++side) {
+            const fastfilters_array3d_t *halo = side ? axes[i].right : axes[i].left;
+            size_t extent[3] = {x->n, y->n, z ? z->n : 1};
+
+            if (!halo)
+                continue;
+
+            for (size_t j = 0; j < i; ++j)
+                extent[j] = block_extent(&axes[j]);
+            extent[i] = axes[i].kernel->len;
+
+            if (!block_halo_check(halo, extent[0], extent[1], extent[2], n_channels))
+                return false;
+        }
+    }
+
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32) {
+        tmp = fastfilters_memory_align(32, outarray->n_z * outarray->stride_z * sizeof(float));
+        if (!tmp)
+            goto out;
+        work = tmp;
+    }
+
+    // x: halos of the later axes, then the block
+    for (unsigned int side = 0; side < 2; ++side) {
+        const fastfilters_array3d_t *hy = side ? y->right : y->left;
+        const fastfilters_array3d_t *hz = z ? (side ? z->right : z->left) : NULL;
+
+        if (hy) {
+            halo_y[side] = fastfilters_memory_align(32, hy->n_y * hy->n_z * row_len * sizeof(float));
+            if (!halo_y[side] || !block_halo_pass_x(hy, x, halo_y[side]))
+                goto out;
+        }
+
+        if (hz) {
+            halo_z[side] = fastfilters_memory_align(32, hz->n_y * hz->n_z * row_len * sizeof(float));
+            if (!halo_z[side] || !block_halo_pass_x(hz, x, halo_z[side]))
+                goto out;
+        }
+    }
+
+    fastfilters_fir_borders_t borders =
+        block_halo_borders(x->left ? x->left->ptr : NULL, x->right ? x->right->ptr : NULL,
+                           x->kernel->len * n_channels, 0);
+    if (!fastfilters_fir_pass_inner_borders(inarray->ptr, x->n, n_channels, y->n * inarray->n_z, inarray->stride_y,
+                                            work, outarray->stride_y, x->kernel, &borders))
+        goto out;
+
+    // y: z halos, then the block
+    if (z) {
+        const fastfilters_fir_borders_t corners = block_corner_borders(y);
+        const size_t extent_y = block_extent(y);
+
+        for (unsigned int side = 0; side < 2; ++side) {
+            if (!halo_z[side])
+                continue;
+
+            halo_zy[side] = fastfilters_memory_align(32, z->kernel->len * y->n * row_len * sizeof(float));
+            if (!halo_zy[side])
+                goto out;
+
+            if (!fastfilters_fir_pass_outer_borders(halo_z[side] + block_margin_left(y) * row_len, y->n, row_len,
+                                                    row_len, halo_zy[side], FASTFILTERS_TYPE_FLOAT32, row_len,
+                                                    y->kernel, z->kernel->len, extent_y * row_len, y->n * row_len,
+                                                    &corners))
+                goto out;
+        }
+
+        borders = block_halo_borders(halo_y[0], halo_y[1], row_len, y->kernel->len * row_len);
+        if (!fastfilters_fir_pass_outer_borders(work, y->n, outarray->stride_y, row_len, work,
+                                                FASTFILTERS_TYPE_FLOAT32, outarray->stride_y, y->kernel, z->n,
+                                                outarray->stride_z, outarray->stride_z, &borders))
+            goto out;
+
+        borders = block_halo_borders(halo_zy[0], halo_zy[1], y->n * row_len, 0);
+        result = fastfilters_fir_pass_outer_borders(work, z->n, outarray->stride_z, y->n * row_len, outarray->ptr,
+                                                    outarray->type, outarray->stride_z, z->kernel, 1, 0, 0, &borders);
+    } else {
+        borders = block_halo_borders(halo_y[0], halo_y[1], row_len, 0);
+        result = fastfilters_fir_pass_outer_borders(work, y->n, outarray->stride_y, row_len, outarray->ptr,
+                                                    outarray->type, outarray->stride_y, y->kernel, 1, 0, 0, &borders);
+    }
+
+out:
+    for (unsigned int side = 0; side < 2; ++side) {
+        if (halo_y[side])
+            fastfilters_memory_align_free(halo_y[side]);
+        if (halo_z[side])
+            fastfilters_memory_align_free(halo_z[side]);
+        if (halo_zy[side])
+            fastfilters_memory_align_free(halo_zy[side]);
+    }
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    return result;
+}
+
+static const fastfilters_array3d_t *block_halo(const fastfilters_array3d_t *halos, unsigned int i)
+{
+    return halos && halos[i].ptr ? &halos[i] : NULL;
+}
+
+// 2D arrays are handled as a single z plane
+static fastfilters_array3d_t block_array3d(const fastfilters_array2d_t *array)
+{
+    fastfilters_array3d_t result = {.ptr = array->ptr,
+                                    .n_x = array->n_x,
+                                    .n_y = array->n_y,
+                                    .n_z = 1,
+                                    .stride_x = array->stride_x,
+                                    .stride_y = array->stride_y,
+                                    .stride_z = array->n_y * array->stride_y,
+                                    .n_channels = array->n_channels,
+                                    .type = array->type};
+
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_convolve_block2d(const fastfilters_array2d_t *inarray,
+                                                 const fastfilters_array2d_t *halos,
+                                                 const fastfilters_kernel_fir_t kernelx,
+                                                 const fastfilters_kernel_fir_t kernely,
+                                                 const fastfilters_array2d_t *outarray,
+                                                 const fastfilters_options_t *options)
+{
+    (void)options;
+    fastfilters_array3d_t halos3d[4];
+
+    if (halos)
+        for (unsigned int i = 0; i < 4; ++i)
+            halos3d[i] = block_array3d(&halos[i]);
+
+    const fastfilters_array3d_t *h = halos ? halos3d : NULL;
+    const fastfilters_array3d_t in = block_array3d(inarray);
+    const fastfilters_array3d_t out = block_array3d(outarray);
+    const block_axis_t axes[2] = {{block_halo(h, 0), block_halo(h, 1), kernelx, inarray->n_x},
+                                  {block_halo(h, 2), block_halo(h, 3), kernely, inarray->n_y}};
+
+    if (outarray->n_x != inarray->n_x || outarray->n_y != inarray->n_y)
+        return false;
+
+    return block_convolve(&in, axes, 2, &out);
+}
+
+bool DLL_PUBLIC fastfilters_fir_convolve_block3d(const fastfilters_array3d_t *inarray,
+                                                 const fastfilters_array3d_t *halos,
+                                                 const fastfilters_kernel_fir_t kernelx,
+                                                 const fastfilters_kernel_fir_t kernely,
+                                                 const fastfilters_kernel_fir_t kernelz,
+                                                 const fastfilters_array3d_t *outarray,
+                                                 const fastfilters_options_t *options)
+{
+    (void)options;
+    const block_axis_t axes[3] = {{block_halo(halos, 0), block_halo(halos, 1), kernelx, inarray->n_x},
+                                  {block_halo(halos, 2), block_halo(halos, 3), kernely, inarray->n_y},
+                                  {block_halo(halos, 4), block_halo(halos, 5), kernelz, inarray->n_z}};
+
+    if (outarray->n_x != inarray->n_x || outarray->n_y != inarray->n_y || outarray->n_z != inarray->n_z)
+        return false;
+
+    return block_convolve(inarray, axes, 3, outarray);
+}
@@ -0,0 +1,211 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "parallel.h"
+
+// Slabs split the volume along z. Each one is read with the kernelz length of planes on both sides (clamped to the
+// volume), filtered along x and y as a whole and along z only for its own planes. The z pass uses optimistic borders
+// inside the volume and mirrored ones at its ends, which computes every plane with the same code path as the in-memory
+// pass as long as slabs are at least twice as long as the kernel. The next slab is read and the previous one written
+// on helper threads while the current one is filtered.
+
+typedef struct {
+    const fastfilters_volume_io_t *io;
+    size_t z;
+    size_t n_z;
+    void *buf;
+} chunk_io_t;
+
+typedef struct {
+    const fastfilters_volume_io_t *io;
+    fastfilters_kernel_fir_t kernelx;
+    fastfilters_kernel_fir_t kernely;
+    fastfilters_kernel_fir_t kernelz;
+    size_t slab_planes;
+    size_t n_slabs;
+} chunked_t;
+
+static bool chunk_read(void *ctx)
+{
+    chunk_io_t *chunk = ctx;
+    return chunk->io->read(chunk->io->ctx, chunk->z, chunk->n_z, chunk->buf);
+}
+
+static bool chunk_write(void *ctx)
+{
+    chunk_io_t *chunk = ctx;
+    return chunk->io->write(chunk->io->ctx, chunk->z, chunk->n_z, chunk->buf);
+}
+
+// output planes z0 .. z1 - 1 and input planes in0 .. in1 - 1 of a slab, the last slab takes the remainder
+static void chunk_range(const chunked_t *c, size_t slab, size_t *z0, size_t *z1, size_t *in0, size_t *in1)
+{
+    const size_t len_z = c->kernelz->len;
+    const size_t n_z = c->io->n_z;
+
+    *z0 = slab * c->slab_planes;
+    *z1 = slab + 1 == c->n_slabs ? n_z : *z0 + c->slab_planes;
+    *in0 = *z0 > len_z ? *z0 - len_z : 0;
+    *in1 = n_z - *z1 > len_z ? *z1 + len_z : n_z;
+}
+
+static bool chunk_filter(const chunked_t *c, const void *in, size_t in0, size_t in1, size_t z0, size_t z1,
+                         float *work, void *out)
+{
+    const fastfilters_volume_io_t *io = c->io;
+    const size_t row_len = io->n_x * io->n_channels;
+    const size_t plane_len = io->n_y * row_len;
+    const size_t n_in = in1 - in0;
+
+    if (!fastfilters_fir_pass_inner(in, io->in_type, io->n_x, io->n_channels, io->n_y * n_in, row_len, work, row_len,
+                                    c->kernelx))
+        return false;
+
+    if (!fastfilters_fir_pass_outer(work, io->n_y, row_len, row_len, work, row_len, c->kernely, n_in, plane_len,
+                                    FASTFILTERS_BORDER_MIRROR))
+        return false;
+
+    const fastfilters_fir_borders_t borders = {
+        .left_border = z0 == 0 ? FASTFILTERS_BORDER_MIRROR : FASTFILTERS_BORDER_OPTIMISTIC,
+        .right_border = z1 == io->n_z ? FASTFILTERS_BORDER_MIRROR : FASTFILTERS_BORDER_OPTIMISTIC};
+
+    return fastfilters_fir_pass_outer_borders(work + (z0 - in0) * plane_len, z1 - z0, plane_len, plane_len, out,
+                                              io->out_type, plane_len, c->kernelz, 1, 0, 0, &borders);
+}
+
+bool DLL_PUBLIC fastfilters_fir_convolve3d_chunked(const fastfilters_volume_io_t *io, size_t slab_planes,
+                                                   const fastfilters_kernel_fir_t kernelx,
+                                                   const fastfilters_kernel_fir_t kernely,
+                                                   const fastfilters_kernel_fir_t kernelz,
+                                                   const fastfilters_options_t *options)
+{
+    (void)options;
+    bool result = false;
+    bool reading = false;
+    bool writing = false;
+    void *in_buf[2] = {NULL, NULL};
+    void *out_buf[2] = {NULL, NULL};
+    float *work = NULL;
+    fastfilters_task_t reader, writer;
+    chunk_io_t read_io, write_io;
+
+    const size_t plane_len = io->n_x * io->n_y * io->n_channels;
+    const size_t in_size = fastfilters_type_size(io->in_type);
+    const size_t out_size = fastfilters_type_size(io->out_type);
+    const size_t len_z = kernelz->len;
+
+    if (!in_size || !fastfilters_type_is_output(io->out_type) || !io->read || !io->write)
+        return false;
+    if (plane_len == 0 || io->n_z == 0)
+        return true;
+
+    if (slab_planes == 0)
+        slab_planes = FF_CHUNK_SLAB_BYTES / (plane_len * sizeof(float));
+    if (slab_planes < 2 * len_z)
+        slab_planes = 2 * len_z;
+    if (slab_planes == 0)
+        slab_planes = 1;
+    if (slab_planes > io->n_z)
+        slab_planes = io->n_z;
+
+    chunked_t c = {.io = io,
+                   .kernelx = kernelx,
+                   .kernely = kernely,
+                   .kernelz = kernelz,
+                   .slab_planes = slab_planes,
+                   .n_slabs = io->n_z / slab_planes};
+
+    // the last slab is the largest one
+    size_t z0, z1, in0, in1;
+    chunk_range(&c, c.n_slabs - 1, &z0, &z1, &in0, &in1);
+    const size_t max_out = z1 - z0;
+    const size_t max_in = max_out + 2 * len_z < io->n_z ? max_out + 2 * len_z : io->n_z;
+
+    work = fastfilters_memory_align(32, max_in * plane_len * sizeof(float));
+    if (!work)
+        goto out;
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        in_buf[i] = fastfilters_memory_align(32, max_in * plane_len * in_size);
+        out_buf[i] = fastfilters_memory_align(32, max_out * plane_len * out_size);
+        if (!in_buf[i] || !out_buf[i])
+            goto out;
+    }
+
+    chunk_range(&c, 0, &z0, &z1, &in0, &in1);
+    read_io = (chunk_io_t){.io = io, .z = in0, .n_z = in1 - in0, .buf = in_buf[0]};
+    if (!chunk_read(&read_io))
+        goto out;
+
+    for (size_t slab = 0; slab < c.n_slabs; ++slab) {
+        chunk_range(&c, slab, &z0, &z1, &in0, &in1);
+
+        if (slab + 1 < c.n_slabs) {
+            size_t next_z0, next_z1, next_in0, next_in1;
+            chunk_range(&c, slab + 1, &next_z0, &next_z1, &next_in0, &next_in1);
+
+            read_io = (chunk_io_t){.io = io, .z = next_in0, .n_z = next_in1 - next_in0, .buf = in_buf[(slab + 1) % 2]};
+            fastfilters_task_start(&reader, chunk_read, &read_io);
+            reading = true;
+        }
+
+        if (!chunk_filter(&c, in_buf[slab % 2], in0, in1, z0, z1, work, out_buf[slab % 2]))
+            goto out;
+
+        if (writing) {
+            writing = false;
+            if (!fastfilters_task_join(&writer))
+                goto out;
+        }
+
+        write_io = (chunk_io_t){.io = io, .z = z0, .n_z = z1 - z0, .buf = out_buf[slab % 2]};
+        fastfilters_task_start(&writer, chunk_write, &write_io);
+        writing = true;
+
+        if (reading) {
+            reading = false;
+            if (!fastfilters_task_join(&reader))
+                goto out;
+        }
+    }
+
+    writing = false;
+    result = fastfilters_task_join(&writer);
+
+out:
+    if (reading)
+        fastfilters_task_join(&reader);
+    if (writing)
+        fastfilters_task_join(&writer);
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        if (in_buf[i])
+            fastfilters_memory_align_free(in_buf[i]);
+        if (out_buf[i])
+            fastfilters_memory_align_free(out_buf[i]);
+    }
+    if (work)
+        fastfilters_memory_align_free(work);
+    return result;
+}
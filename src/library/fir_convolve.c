@@ -19,6 +19,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "fastfilters.h"
 #include "common.h"
@@ -33,6 +34,14 @@ static fir_convolve_fn_t g_convolve_outer = NULL;
 void fastfilters_fir_init(void)
 {
     #ifndef _USE_SIMDE_ON_ARM_
+    #ifdef HAVE_AVX512F
+    if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX512F)) {
+        g_convolve_outer = &fastfilters_fir_convolve_fir_outer_avx512;
+        g_convolve_inner = &fastfilters_fir_convolve_fir_inner_avx512;
+        return;
+    }
+    #endif
+
     if (fastfilters_cpu_check(FASTFILTERS_CPU_FMA)) {
         g_convolve_outer = &fastfilters_fir_convolve_fir_outer_avxfma;
         g_convolve_inner = &fastfilters_fir_convolve_fir_inner_avxfma;
@@ -44,24 +53,456 @@ void fastfilters_fir_init(void)
         g_convolve_inner = &fastfilters_fir_convolve_fir_inner;
     }
     #else
+    #ifdef HAVE_NEON
+    if (fastfilters_cpu_check(FASTFILTERS_CPU_NEON)) {
+        g_convolve_outer = &fastfilters_fir_convolve_fir_outer_neon;
+        g_convolve_inner = &fastfilters_fir_convolve_fir_inner_neon;
+        return;
+    }
+    #endif
+
         g_convolve_outer = &fastfilters_fir_convolve_fir_outer_avxfma;
         g_convolve_inner = &fastfilters_fir_convolve_fir_inner_avxfma;
     #endif
 }
 
+void fastfilters_fir_resolve(fastfilters_kernel_fir_t kernel)
+{
+    fastfilters_fir_resolve_fir(kernel);
+#ifndef _USE_SIMDE_ON_ARM_
+    fastfilters_fir_resolve_fir_avx(kernel);
+#endif
+#ifdef HAVE_AVX512F
+    fastfilters_fir_resolve_fir_avx512(kernel);
+#endif
+#ifdef HAVE_NEON
+    fastfilters_fir_resolve_fir_neon(kernel);
+#endif
+    fastfilters_fir_resolve_fir_avxfma(kernel);
+}
+
+// border pointers of lines / columns starting at offset, NULL pointers stay NULL
+static const float *fir_pass_border_ptr(const float *ptr, size_t offset)
+{
+    return ptr ? ptr + offset : NULL;
+}
+
+// column blocks of the outer pass are multiples of a cache line so that workers never share one
+#define OUTER_BLOCK_ALIGNMENT 16
+
+// general kernels run as their symmetric part plus their antisymmetric part. Both run on tiles of whole lines (inner
+// pass) or columns (outer pass) that fit into FF_CONVERT_BLOCK_BYTES: the odd part goes into a tile sized buffer
+// first, so that passes can still run in place, and is added to the output tile while it is in cache.
+static bool fir_run_general(fir_convolve_fn_t fn, bool is_outer, const float *inptr, size_t n_pixels,
+                            size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr,
+                            size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                            fastfilters_border_treatment_t left_border, fastfilters_border_treatment_t right_border,
+                            const float *borderptr_left, const float *borderptr_right, size_t borderptr_outer_stride)
+{
+    // inner tiles hold tile_size lines of line_len, outer ones n_pixels rows of tile_size columns
+    const size_t line_len = n_pixels * pixel_stride;
+    size_t tile_size;
+
+    if (n_outer == 0 || n_pixels == 0)
+        return true;
+
+    if (is_outer) {
+        tile_size = FF_CONVERT_BLOCK_BYTES / (n_pixels * sizeof(float));
+        tile_size -= tile_size % OUTER_BLOCK_ALIGNMENT;
+        if (tile_size < OUTER_BLOCK_ALIGNMENT)
+            tile_size = OUTER_BLOCK_ALIGNMENT;
+    } else {
+        tile_size = FF_CONVERT_BLOCK_BYTES / (line_len * sizeof(float));
+        if (tile_size == 0)
+            tile_size = 1;
+    }
+    if (tile_size > n_outer)
+        tile_size = n_outer;
+
+    const size_t tile_stride = is_outer ? tile_size : line_len;
+    float *odd = fastfilters_memory_align(32, (is_outer ? n_pixels : tile_size) * tile_stride * sizeof(float));
+    if (!odd)
+        return false;
+
+    bool result = true;
+    for (size_t start = 0; start < n_outer && result; start += tile_size) {
+        const size_t n = n_outer - start < tile_size ? n_outer - start : tile_size;
+        const float *in = inptr + start * outer_stride;
+        float *out = outptr + (is_outer ? start : start * outptr_stride);
+        const size_t border_offset = is_outer ? start : start * borderptr_outer_stride;
+
+        result = fn(in, n_pixels, pixel_stride, n, outer_stride, odd, tile_stride, kernel->odd, left_border,
+                    right_border, fir_pass_border_ptr(borderptr_left, border_offset),
+                    fir_pass_border_ptr(borderptr_right, border_offset), borderptr_outer_stride) &&
+                 fn(in, n_pixels, pixel_stride, n, outer_stride, out, outptr_stride, kernel, left_border,
+                    right_border, fir_pass_border_ptr(borderptr_left, border_offset),
+                    fir_pass_border_ptr(borderptr_right, border_offset), borderptr_outer_stride);
+
+        const size_t n_rows = is_outer ? n_pixels : n;
+        const size_t row_len = is_outer ? n : line_len;
+        for (size_t i = 0; i < n_rows && result; ++i) {
+            const float *terms[2] = {out + i * outptr_stride, odd + i * tile_stride};
+            fastfilters_combine_sum(terms, 2, false, out + i * outptr_stride, row_len);
+        }
+    }
+
+    fastfilters_memory_align_free(odd);
+    return result;
+}
+
+static bool fir_run_inner(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                          size_t outer_stride, float *outptr, size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                          fastfilters_border_treatment_t left_border, fastfilters_border_treatment_t right_border,
+                          const float *borderptr_left, const float *borderptr_right, size_t borderptr_outer_stride)
+{
+    if (kernel->odd)
+        return fir_run_general(g_convolve_inner, false, inptr, n_pixels, pixel_stride, n_outer, outer_stride, outptr,
+                               outptr_stride, kernel, left_border, right_border, borderptr_left, borderptr_right,
+                               borderptr_outer_stride);
+
+    return g_convolve_inner(inptr, n_pixels, pixel_stride, n_outer, outer_stride, outptr, outptr_stride, kernel,
+                            left_border, right_border, borderptr_left, borderptr_right, borderptr_outer_stride);
+}
+
+static bool fir_run_outer(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                          size_t outer_stride, float *outptr, size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                          fastfilters_border_treatment_t left_border, fastfilters_border_treatment_t right_border,
+                          const float *borderptr_left, const float *borderptr_right, size_t borderptr_outer_stride)
+{
+    if (kernel->odd)
+        return fir_run_general(g_convolve_outer, true, inptr, n_pixels, pixel_stride, n_outer, outer_stride, outptr,
+                               outptr_stride, kernel, left_border, right_border, borderptr_left, borderptr_right,
+                               borderptr_outer_stride);
+
+    return g_convolve_outer(inptr, n_pixels, pixel_stride, n_outer, outer_stride, outptr, outptr_stride, kernel,
+                            left_border, right_border, borderptr_left, borderptr_right, borderptr_outer_stride);
+}
+
+typedef struct {
+    fir_convolve_fn_t fn;
+    const void *inptr;
+    fastfilters_type_t in_type;
+    void *outptr;
+    fastfilters_type_t out_type;
+    size_t n_pixels;
+    size_t pixel_stride;
+    size_t n_outer;
+    size_t outer_stride;
+    size_t outptr_stride;
+    size_t plane_stride;
+    size_t outptr_plane_stride;
+    size_t block_size;
+    size_t n_blocks;
+    fastfilters_kernel_fir_t kernel;
+    fastfilters_fir_borders_t borders;
+} fir_pass_t;
+
+static const fastfilters_fir_borders_t g_mirror_borders = {.left_border = FASTFILTERS_BORDER_MIRROR,
+                                                           .right_border = FASTFILTERS_BORDER_MIRROR};
+
+// converts blocks of lines that fit into FF_CONVERT_BLOCK_BYTES and runs the pass on them
+static bool fir_pass_inner_convert(const fir_pass_t *pass, size_t begin, size_t end)
+{
+    const size_t line_len = pass->n_pixels * pass->pixel_stride;
+    size_t block_lines = FF_CONVERT_BLOCK_BYTES / (line_len * sizeof(float));
+    if (block_lines == 0)
+        block_lines = 1;
+    if (block_lines > end - begin)
+        block_lines = end - begin;
+
+    float *tmp = fastfilters_memory_align(32, block_lines * line_len * sizeof(float));
+    if (!tmp)
+        return false;
+
+    bool result = true;
+    for (size_t line = begin; line < end && result; line += block_lines) {
+        const size_t n_lines = end - line < block_lines ? end - line : block_lines;
+
+        for (size_t i = 0; i < n_lines; ++i)
+            fastfilters_type_convert(pass->inptr, pass->in_type, (line + i) * pass->outer_stride, line_len,
+                                     tmp + i * line_len);
+
+        result = pass->fn(tmp, pass->n_pixels, pass->pixel_stride, n_lines, line_len,
+                          (float *)pass->outptr + line * pass->outptr_stride, pass->outptr_stride, pass->kernel,
+                          pass->borders.left_border, pass->borders.right_border,
+                          fir_pass_border_ptr(pass->borders.left, line * pass->borders.stride),
+                          fir_pass_border_ptr(pass->borders.right, line * pass->borders.stride), pass->borders.stride);
+    }
+
+    fastfilters_memory_align_free(tmp);
+    return result;
+}
+
+static bool fir_pass_inner_worker(void *ctx, size_t begin, size_t end)
+{
+    const fir_pass_t *pass = ctx;
+
+    if (pass->in_type != FASTFILTERS_TYPE_FLOAT32)
+        return fir_pass_inner_convert(pass, begin, end);
+
+    return pass->fn((const float *)pass->inptr + begin * pass->outer_stride, pass->n_pixels, pass->pixel_stride,
+                    end - begin, pass->outer_stride, (float *)pass->outptr + begin * pass->outptr_stride,
+                    pass->outptr_stride, pass->kernel, pass->borders.left_border, pass->borders.right_border,
+                    fir_pass_border_ptr(pass->borders.left, begin * pass->borders.stride),
+                    fir_pass_border_ptr(pass->borders.right, begin * pass->borders.stride), pass->borders.stride);
+}
+
+// rows that an optimistic border reads beyond the pass, converted input tiles have to hold them as well
+static size_t fir_pass_halo(const fir_pass_t *pass, fastfilters_border_treatment_t border)
+{
+    return border == FASTFILTERS_BORDER_OPTIMISTIC ? pass->kernel->len : 0;
+}
+
+// runs the pass on column tiles that fit into FF_CONVERT_BLOCK_BYTES, converting input tiles from in_type to float
+// and/or storing output tiles as out_type; tmp holds one tile including its halo rows, the outer pass can run in place
+// on it
+static bool fir_pass_outer_tiled(const fir_pass_t *pass, size_t offset, size_t n_outer, size_t out_offset,
+                                 size_t border_offset, float *tmp, size_t tile_size)
+{
+    const bool convert_in = pass->in_type != FASTFILTERS_TYPE_FLOAT32;
+    const bool convert_out = pass->out_type != FASTFILTERS_TYPE_FLOAT32;
+    const size_t halo_left = fir_pass_halo(pass, pass->borders.left_border);
+    const size_t n_rows = halo_left + pass->n_pixels + fir_pass_halo(pass, pass->borders.right_border);
+
+    for (size_t tile_start = 0; tile_start < n_outer; tile_start += tile_size) {
+        const size_t tile_len = n_outer - tile_start < tile_size ? n_outer - tile_start : tile_size;
+        const float *tile_in = tmp + halo_left * tile_size;
+        size_t pixel_stride = tile_size;
+        size_t outer_stride = 1;
+        float *tile_out = tmp + halo_left * tile_size;
+        size_t outptr_stride = tile_size;
+
+        if (convert_in) {
+            const size_t row_offset = offset - halo_left * pass->pixel_stride + tile_start;
+
+            for (size_t i = 0; i < n_rows; ++i)
+                fastfilters_type_convert(pass->inptr, pass->in_type, row_offset + i * pass->pixel_stride, tile_len,
+                                         tmp + i * tile_size);
+        } else {
+            tile_in = (const float *)pass->inptr + offset + tile_start * pass->outer_stride;
+            pixel_stride = pass->pixel_stride;
+            outer_stride = pass->outer_stride;
+        }
+
+        if (!convert_out) {
+            tile_out = (float *)pass->outptr + out_offset + tile_start;
+            outptr_stride = pass->outptr_stride;
+        }
+
+        if (!pass->fn(tile_in, pass->n_pixels, pixel_stride, tile_len, outer_stride, tile_out, outptr_stride,
+                      pass->kernel, pass->borders.left_border, pass->borders.right_border,
+                      fir_pass_border_ptr(pass->borders.left, border_offset + tile_start),
+                      fir_pass_border_ptr(pass->borders.right, border_offset + tile_start), pass->borders.stride))
+            return false;
+
+        if (convert_out)
+            for (size_t i = 0; i < pass->n_pixels; ++i)
+                fastfilters_type_store(tile_out + i * tile_size, tile_len, pass->outptr, pass->out_type,
+                                       out_offset + i * pass->outptr_stride + tile_start);
+    }
+
+    return true;
+}
+
+static bool fir_pass_outer_worker(void *ctx, size_t begin, size_t end)
+{
+    const fir_pass_t *pass = ctx;
+    float *tmp = NULL;
+    size_t tile_size = 0;
+    bool result = false;
+
+    if (pass->in_type != FASTFILTERS_TYPE_FLOAT32 || pass->out_type != FASTFILTERS_TYPE_FLOAT32) {
+        const size_t n_rows = fir_pass_halo(pass, pass->borders.left_border) + pass->n_pixels +
+                              fir_pass_halo(pass, pass->borders.right_border);
+
+        tile_size = FF_CONVERT_BLOCK_BYTES / (n_rows * sizeof(float));
+        tile_size -= tile_size % OUTER_BLOCK_ALIGNMENT;
+        if (tile_size < OUTER_BLOCK_ALIGNMENT)
+            tile_size = OUTER_BLOCK_ALIGNMENT;
+        if (tile_size > pass->block_size)
+            tile_size = pass->block_size;
+
+        tmp = fastfilters_memory_align(32, n_rows * tile_size * sizeof(float));
+        if (!tmp)
+            return false;
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        const size_t plane = i / pass->n_blocks;
+        const size_t block_start = (i % pass->n_blocks) * pass->block_size;
+        size_t block_len = pass->n_outer - block_start;
+        if (block_len > pass->block_size)
+            block_len = pass->block_size;
+
+        const size_t offset = plane * pass->plane_stride + block_start * pass->outer_stride;
+        const size_t out_offset = plane * pass->outptr_plane_stride + block_start;
+        const size_t border_offset = plane * pass->borders.plane_stride + block_start;
+
+        if (tmp) {
+            if (!fir_pass_outer_tiled(pass, offset, block_len, out_offset, border_offset, tmp, tile_size))
+                goto out;
+        } else if (!pass->fn((const float *)pass->inptr + offset, pass->n_pixels, pass->pixel_stride, block_len,
+                             pass->outer_stride, (float *)pass->outptr + out_offset, pass->outptr_stride,
+                             pass->kernel, pass->borders.left_border, pass->borders.right_border,
+                             fir_pass_border_ptr(pass->borders.left, border_offset),
+                             fir_pass_border_ptr(pass->borders.right, border_offset), pass->borders.stride)) {
+            goto out;
+        }
+    }
+
+    result = true;
+
+out:
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    return result;
+}
+
+static bool fir_convolve_inner_border(const void *inptr, fastfilters_type_t in_type, size_t n_pixels,
+                                      size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr,
+                                      size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                      const fastfilters_fir_borders_t *borders)
+{
+    fir_pass_t pass = {.fn = fir_run_inner,
+                       .inptr = inptr,
+                       .in_type = in_type,
+                       .outptr = outptr,
+                       .out_type = FASTFILTERS_TYPE_FLOAT32,
+                       .n_pixels = n_pixels,
+                       .pixel_stride = pixel_stride,
+                       .n_outer = n_outer,
+                       .outer_stride = outer_stride,
+                       .outptr_stride = outptr_stride,
+                       .kernel = kernel,
+                       .borders = *borders};
+
+    if (n_outer == 0 || n_pixels == 0)
+        return true;
+
+    return fastfilters_parallel_for(n_outer, fastfilters_parallel_chunk_size(n_outer, 1, 1), fir_pass_inner_worker,
+                                    &pass);
+}
+
+static bool fir_convolve_inner(const void *inptr, fastfilters_type_t in_type, size_t n_pixels, size_t pixel_stride,
+                               size_t n_outer, size_t outer_stride, float *outptr, size_t outptr_stride,
+                               fastfilters_kernel_fir_t kernel)
+{
+    return fir_convolve_inner_border(inptr, in_type, n_pixels, pixel_stride, n_outer, outer_stride, outptr,
+                                     outptr_stride, kernel, &g_mirror_borders);
+}
+
+// runs the outer pass on n_planes independent planes, each split into column blocks
+static bool fir_convolve_outer_border(const void *inptr, fastfilters_type_t in_type, size_t n_pixels,
+                                      size_t pixel_stride, size_t n_outer, size_t outer_stride, void *outptr,
+                                      fastfilters_type_t out_type, size_t outptr_stride,
+                                      fastfilters_kernel_fir_t kernel, size_t n_planes, size_t plane_stride,
+                                      size_t outptr_plane_stride, const fastfilters_fir_borders_t *borders)
+{
+    fir_pass_t pass = {.fn = fir_run_outer,
+                       .inptr = inptr,
+                       .in_type = in_type,
+                       .outptr = outptr,
+                       .out_type = out_type,
+                       .n_pixels = n_pixels,
+                       .pixel_stride = pixel_stride,
+                       .n_outer = n_outer,
+                       .outer_stride = outer_stride,
+                       .outptr_stride = outptr_stride,
+                       .plane_stride = plane_stride,
+                       .outptr_plane_stride = outptr_plane_stride,
+                       .kernel = kernel,
+                       .borders = *borders};
+
+    if (n_outer == 0)
+        return true;
+
+    pass.block_size = fastfilters_parallel_chunk_size(n_outer, n_planes, OUTER_BLOCK_ALIGNMENT);
+    pass.n_blocks = (n_outer + pass.block_size - 1) / pass.block_size;
+
+    return fastfilters_parallel_for(n_planes * pass.n_blocks,
+                                    fastfilters_parallel_chunk_size(n_planes * pass.n_blocks, 1, 1),
+                                    fir_pass_outer_worker, &pass);
+}
+
+static bool fir_convolve_outer(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                               size_t outer_stride, void *outptr, fastfilters_type_t out_type, size_t outptr_stride,
+                               fastfilters_kernel_fir_t kernel, size_t n_planes, size_t plane_stride,
+                               size_t outptr_plane_stride)
+{
+    return fir_convolve_outer_border(inptr, FASTFILTERS_TYPE_FLOAT32, n_pixels, pixel_stride, n_outer, outer_stride,
+                                     outptr, out_type, outptr_stride, kernel, n_planes, plane_stride,
+                                     outptr_plane_stride, &g_mirror_borders);
+}
+
+bool fastfilters_fir_pass_inner(const void *inptr, fastfilters_type_t in_type, size_t n_pixels, size_t pixel_stride,
+                                size_t n_outer, size_t outer_stride, float *outptr, size_t outptr_stride,
+                                fastfilters_kernel_fir_t kernel)
+{
+    return fir_convolve_inner(inptr, in_type, n_pixels, pixel_stride, n_outer, outer_stride, outptr, outptr_stride,
+                              kernel);
+}
+
+bool fastfilters_fir_pass_outer(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                                float *outptr, size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                size_t n_planes, size_t plane_stride, fastfilters_border_treatment_t border)
+{
+    const fastfilters_fir_borders_t borders = {.left_border = border, .right_border = border};
+
+    return fir_convolve_outer_border(inptr, FASTFILTERS_TYPE_FLOAT32, n_pixels, pixel_stride, n_outer, 1, outptr,
+                                     FASTFILTERS_TYPE_FLOAT32, outptr_stride, kernel, n_planes, plane_stride,
+                                     plane_stride, &borders);
+}
+
+bool fastfilters_fir_pass_inner_borders(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                                        size_t outer_stride, float *outptr, size_t outptr_stride,
+                                        fastfilters_kernel_fir_t kernel, const fastfilters_fir_borders_t *borders)
+{
+    return fir_convolve_inner_border(inptr, FASTFILTERS_TYPE_FLOAT32, n_pixels, pixel_stride, n_outer, outer_stride,
+                                     outptr, outptr_stride, kernel, borders);
+}
+
+bool fastfilters_fir_pass_outer_borders(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
+                                        void *outptr, fastfilters_type_t out_type, size_t outptr_stride,
+                                        fastfilters_kernel_fir_t kernel, size_t n_planes, size_t plane_stride,
+                                        size_t outptr_plane_stride, const fastfilters_fir_borders_t *borders)
+{
+    return fir_convolve_outer_border(inptr, FASTFILTERS_TYPE_FLOAT32, n_pixels, pixel_stride, n_outer, 1, outptr,
+                                     out_type, outptr_stride, kernel, n_planes, plane_stride, outptr_plane_stride,
+                                     borders);
+}
+
 bool DLL_PUBLIC fastfilters_fir_convolve2d(const fastfilters_array2d_t *inarray, const fastfilters_kernel_fir_t kernelx,
                                            const fastfilters_kernel_fir_t kernely,
                                            const fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
 {
     (void)options;
-    if (!g_convolve_inner(inarray->ptr, inarray->n_x, inarray->stride_x, inarray->n_y, inarray->stride_y, outarray->ptr,
-                          outarray->stride_y, kernelx, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL,
-                          0))
+    bool result = false;
+    float *tmp = NULL;
+    float *work = outarray->ptr;
+
+    if (!fastfilters_type_size(inarray->type) || !fastfilters_type_is_output(outarray->type))
         return false;
 
-    return g_convolve_outer(outarray->ptr, inarray->n_y, outarray->stride_y, inarray->n_x * inarray->n_channels,
-                            inarray->stride_x / inarray->n_channels, outarray->ptr, outarray->stride_y, kernely,
-                            FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0);
+    // outputs that are not float cannot hold the intermediate, only the last pass stores to them
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32) {
+        tmp = fastfilters_memory_align(32, outarray->n_y * outarray->stride_y * sizeof(float));
+        if (!tmp)
+            goto out;
+        work = tmp;
+    }
+
+    if (!fir_convolve_inner(inarray->ptr, inarray->type, inarray->n_x, inarray->stride_x, inarray->n_y,
+                            inarray->stride_y, work, outarray->stride_y, kernelx))
+        goto out;
+
+    result = fir_convolve_outer(work, inarray->n_y, outarray->stride_y, inarray->n_x * inarray->n_channels,
+                                inarray->stride_x / inarray->n_channels, outarray->ptr, outarray->type,
+                                outarray->stride_y, kernely, 1, 0, 0);
+
+out:
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    return result;
 }
 
 bool DLL_PUBLIC fastfilters_fir_convolve3d(const fastfilters_array3d_t *inarray, const fastfilters_kernel_fir_t kernelx,
@@ -70,22 +511,623 @@ bool DLL_PUBLIC fastfilters_fir_convolve3d(const fastfilters_array3d_t *inarray,
                                            const fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
 {
     (void)options;
+    bool result = false;
+    float *tmp = NULL;
+    float *work = outarray->ptr;
 
-    if (!g_convolve_inner(inarray->ptr, inarray->n_x, inarray->stride_x, inarray->n_y * inarray->n_z, inarray->stride_y,
-                          outarray->ptr, outarray->stride_y, kernelx, FASTFILTERS_BORDER_MIRROR,
-                          FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0))
+    if (!fastfilters_type_size(inarray->type) || !fastfilters_type_is_output(outarray->type))
         return false;
 
-    for (size_t z = 0; z < inarray->n_z; ++z) {
-        float *planeptr_out = outarray->ptr + z * outarray->stride_z;
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32) {
+        tmp = fastfilters_memory_align(32, outarray->n_z * outarray->stride_z * sizeof(float));
+        if (!tmp)
+            goto out;
+        work = tmp;
+    }
+
+    if (!fir_convolve_inner(inarray->ptr, inarray->type, inarray->n_x, inarray->stride_x,
+                            inarray->n_y * inarray->n_z, inarray->stride_y, work, outarray->stride_y, kernelx))
+        goto out;
 
-        if (!g_convolve_outer(planeptr_out, inarray->n_y, outarray->stride_y, inarray->n_x * inarray->n_channels,
-                              inarray->stride_x / inarray->n_channels, planeptr_out, outarray->stride_y, kernely,
-                              FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0))
+    if (!fir_convolve_outer(work, inarray->n_y, outarray->stride_y, inarray->n_x * inarray->n_channels,
+                            inarray->stride_x / inarray->n_channels, work, FASTFILTERS_TYPE_FLOAT32,
+                            outarray->stride_y, kernely, inarray->n_z, outarray->stride_z, outarray->stride_z))
+        goto out;
+
+    result = fir_convolve_outer(work, outarray->n_z, outarray->stride_z,
+                                inarray->n_y * inarray->n_x * inarray->n_channels, 1, outarray->ptr, outarray->type,
+                                outarray->stride_z, kernelz, 1, 0, 0);
+
+out:
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    return result;
+}
+
+// Fused 2D convolution of several targets that share inputs and 1D kernels.
+//
+// Targets are grouped by (input, kx) and each group runs its x pass only once, into a carrier that is one of the
+// group's float outputs whenever that output is not read as an input. The y passes of the group then all read from the
+// carrier, the target owning it goes last. Groups without a suitable output share a single scratch carrier.
+static bool multi2d_is_dense(const fastfilters_array2d_t *a)
+{
+    return a->stride_x == a->n_channels && a->stride_y == a->n_x * a->n_channels;
+}
+
+bool fastfilters_fir_convolve2d_multi(const fastfilters_fir_target2d_t *targets, size_t n_targets,
+                                      const fastfilters_options_t *options)
+{
+    (void)options;
+    bool result = false;
+    bool *done = NULL;
+    fastfilters_array2d_t *scratch = NULL;
+
+    if (n_targets == 0)
+        return true;
+
+    const fastfilters_array2d_t *shape = targets[0].in;
+
+    for (size_t i = 0; i < n_targets; ++i) {
+        const fastfilters_array2d_t *in = targets[i].in;
+        const fastfilters_array2d_t *out = targets[i].out;
+
+        if (in->n_x != shape->n_x || in->n_y != shape->n_y || in->n_channels != shape->n_channels)
+            return false;
+        if (out->n_x != shape->n_x || out->n_y != shape->n_y || out->n_channels != shape->n_channels)
+            return false;
+        if (!multi2d_is_dense(out))
             return false;
+        if (!fastfilters_type_size(in->type) || !fastfilters_type_is_output(out->type))
+            return false;
+
+        // groups run one after another, an output may only overwrite the input of its own group
+        for (size_t j = 0; j < n_targets; ++j)
+            if (targets[j].in->ptr == out->ptr &&
+                (in->ptr != out->ptr || !fastfilters_kernel_fir_equal(targets[j].kx, targets[i].kx)))
+                return false;
+    }
+
+    done = fastfilters_memory_alloc(n_targets * sizeof(*done));
+    if (!done)
+        goto out;
+    for (size_t i = 0; i < n_targets; ++i)
+        done[i] = false;
+
+    for (size_t first = 0; first < n_targets; ++first) {
+        if (done[first])
+            continue;
+
+        const fastfilters_array2d_t *in = targets[first].in;
+        const fastfilters_kernel_fir_t kx = targets[first].kx;
+        size_t owner = n_targets;
+
+        for (size_t i = first; i < n_targets && owner == n_targets; ++i) {
+            bool is_input = false;
+
+            if (done[i] || targets[i].in->ptr != in->ptr || !fastfilters_kernel_fir_equal(targets[i].kx, kx))
+                continue;
+            if (targets[i].out->type != FASTFILTERS_TYPE_FLOAT32)
+                continue;
+
+            for (size_t j = 0; j < n_targets; ++j)
+                if (targets[j].in->ptr == targets[i].out->ptr ||
+                    (j != i && targets[j].out->ptr == targets[i].out->ptr))
+                    is_input = true;
+
+            if (!is_input)
+                owner = i;
+        }
+
+        const fastfilters_array2d_t *carrier;
+        if (owner != n_targets) {
+            carrier = targets[owner].out;
+        } else {
+            if (!scratch) {
+                scratch = fastfilters_array2d_alloc(shape->n_x, shape->n_y, shape->n_channels);
+                if (!scratch)
+                    goto out;
+            }
+            carrier = scratch;
+        }
+
+        if (!fir_convolve_inner(in->ptr, in->type, in->n_x, in->stride_x, in->n_y, in->stride_y, carrier->ptr,
+                                carrier->stride_y, kx))
+            goto out;
+
+        for (size_t i = first; i <= n_targets; ++i) {
+            // the owner's y pass overwrites the carrier and has to come last
+            const size_t t = i < n_targets ? i : owner;
+
+            if (t == n_targets || done[t] || targets[t].in->ptr != in->ptr ||
+                !fastfilters_kernel_fir_equal(targets[t].kx, kx))
+                continue;
+            if (t == owner && i != n_targets)
+                continue;
+
+            const fastfilters_array2d_t *out = targets[t].out;
+            if (!fir_convolve_outer(carrier->ptr, shape->n_y, carrier->stride_y, shape->n_x * shape->n_channels, 1,
+                                    out->ptr, out->type, out->stride_y, targets[t].ky, 1, 0, 0))
+                goto out;
+
+            done[t] = true;
+        }
+    }
+
+    result = true;
+
+out:
+    if (scratch)
+        fastfilters_array2d_free(scratch);
+    if (done)
+        fastfilters_memory_free(done);
+    return result;
+}
+
+// Fused 3D convolution of several targets that share inputs and 1D kernels.
+//
+// Targets are grouped by (input, kz) and each group runs its z pass only once, into a carrier volume that is one of
+// the group's float outputs whenever that output is not read as an input. Afterwards every z plane is finished on its
+// own while it is still in cache: x pass from the carrier plane into a plane sized scratch buffer (reused by
+// consecutive targets with the same kx) and y pass from there into the output plane, or into a second plane buffer
+// that is then stored to outputs of other types. The target owning the carrier is scheduled last in its group so that
+// its output plane only overwrites the carrier after all other targets have read it.
+//
+// Running z first reorders the float sums compared to fastfilters_fir_convolve3d (x, y, z), so results agree with the
+// unfused composition only up to rounding; tests/test_hog.c pins the tolerance.
+typedef struct {
+    const fastfilters_array3d_t *in;
+    fastfilters_kernel_fir_t kz;
+    size_t owner;
+    const fastfilters_array3d_t *carrier;
+    fastfilters_array3d_t *carrier_alloc;
+} multi3d_group_t;
+
+typedef struct {
+    const fastfilters_fir_target3d_t *target;
+    const multi3d_group_t *group;
+    bool reuse_x;
+} multi3d_step_t;
+
+typedef struct {
+    const fastfilters_array3d_t *shape;
+    const multi3d_step_t *steps;
+    size_t n_steps;
+    bool typed_out;
+} multi3d_t;
+
+static bool multi3d_plane_worker(void *ctx, size_t begin, size_t end)
+{
+    const multi3d_t *m = ctx;
+    const size_t n_x = m->shape->n_x;
+    const size_t n_y = m->shape->n_y;
+    const size_t row_stride = n_x * m->shape->n_channels;
+    bool result = false;
+
+    float *plane = NULL;
+    float *scratch = fastfilters_memory_align(32, n_y * row_stride * sizeof(float));
+    if (!scratch)
+        return false;
+
+    if (m->typed_out) {
+        plane = fastfilters_memory_align(32, n_y * row_stride * sizeof(float));
+        if (!plane)
+            goto out;
+    }
+
+    for (size_t z = begin; z < end; ++z) {
+        for (size_t i = 0; i < m->n_steps; ++i) {
+            const multi3d_step_t *step = &m->steps[i];
+            const fastfilters_array3d_t *carrier = step->group->carrier;
+            const fastfilters_array3d_t *out = step->target->out;
+
+            if (!step->reuse_x &&
+                !fir_run_inner(carrier->ptr + z * carrier->stride_z, n_x, carrier->stride_x, n_y, carrier->stride_y,
+                               scratch, row_stride, step->target->kx, FASTFILTERS_BORDER_MIRROR,
+                               FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0))
+                goto out;
+
+            if (out->type != FASTFILTERS_TYPE_FLOAT32) {
+                if (!fir_run_outer(scratch, n_y, row_stride, row_stride, 1, plane, row_stride, step->target->ky,
+                                   FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0))
+                    goto out;
+
+                fastfilters_type_store(plane, n_y * row_stride, out->ptr, out->type, z * out->stride_z);
+            } else if (!fir_run_outer(scratch, n_y, row_stride, row_stride, 1, out->ptr + z * out->stride_z,
+                                      out->stride_y, step->target->ky, FASTFILTERS_BORDER_MIRROR,
+                                      FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0)) {
+                goto out;
+            }
+        }
+    }
+
+    result = true;
+
+out:
+    if (plane)
+        fastfilters_memory_align_free(plane);
+    fastfilters_memory_align_free(scratch);
+    return result;
+}
+
+static bool multi3d_same_shape(const fastfilters_array3d_t *a, const fastfilters_array3d_t *b)
+{
+    return a->n_x == b->n_x && a->n_y == b->n_y && a->n_z == b->n_z && a->n_channels == b->n_channels;
+}
+
+static bool multi3d_is_dense(const fastfilters_array3d_t *a)
+{
+    return a->stride_x == a->n_channels && a->stride_y == a->n_x * a->n_channels && a->stride_z == a->n_y * a->stride_y;
+}
+
+bool fastfilters_fir_convolve3d_multi(const fastfilters_fir_target3d_t *targets, size_t n_targets,
+                                      const fastfilters_options_t *options)
+{
+    (void)options;
+    bool result = false;
+    size_t n_groups = 0;
+    size_t n_steps = 0;
+    multi3d_group_t *groups = NULL;
+    multi3d_step_t *steps = NULL;
+    size_t *target_group = NULL;
+    bool *placed = NULL;
+    bool typed_out = false;
+
+    if (n_targets == 0)
+        return true;
+
+    const fastfilters_array3d_t *shape = targets[0].in;
+
+    groups = fastfilters_memory_alloc(n_targets * sizeof(*groups));
+    steps = fastfilters_memory_alloc(n_targets * sizeof(*steps));
+    target_group = fastfilters_memory_alloc(n_targets * sizeof(*target_group));
+    placed = fastfilters_memory_alloc(n_targets * sizeof(*placed));
+    if (!groups || !steps || !target_group || !placed)
+        goto out;
+
+    for (size_t i = 0; i < n_targets; ++i) {
+        const fastfilters_fir_target3d_t *t = &targets[i];
+        size_t g;
+
+        if (!multi3d_same_shape(shape, t->in) || !multi3d_same_shape(shape, t->out))
+            goto out;
+        if (!multi3d_is_dense(t->in) || !multi3d_is_dense(t->out))
+            goto out;
+        if (!fastfilters_type_size(t->in->type) || !fastfilters_type_is_output(t->out->type))
+            goto out;
+        if (t->out->type != FASTFILTERS_TYPE_FLOAT32)
+            typed_out = true;
+
+        for (g = 0; g < n_groups; ++g)
+            if (groups[g].in->ptr == t->in->ptr && fastfilters_kernel_fir_equal(groups[g].kz, t->kz))
+                break;
+
+        if (g == n_groups) {
+            groups[g].in = t->in;
+            groups[g].kz = t->kz;
+            groups[g].owner = n_targets;
+            groups[g].carrier = NULL;
+            groups[g].carrier_alloc = NULL;
+            n_groups++;
+        }
+
+        target_group[i] = g;
+        placed[i] = false;
+    }
+
+    // pick carriers: a float output that nobody reads from, scratch volumes otherwise
+    for (size_t i = 0; i < n_targets; ++i) {
+        multi3d_group_t *group = &groups[target_group[i]];
+        bool is_input = false;
+
+        if (group->owner != n_targets || targets[i].out->type != FASTFILTERS_TYPE_FLOAT32)
+            continue;
+
+        for (size_t j = 0; j < n_targets; ++j)
+            if (targets[j].in->ptr == targets[i].out->ptr || (j != i && targets[j].out->ptr == targets[i].out->ptr))
+                is_input = true;
+
+        if (is_input)
+            continue;
+
+        group->owner = i;
+        group->carrier = targets[i].out;
+    }
+
+    for (size_t g = 0; g < n_groups; ++g) {
+        if (groups[g].carrier)
+            continue;
+
+        groups[g].carrier_alloc = fastfilters_array3d_alloc(shape->n_x, shape->n_y, shape->n_z, shape->n_channels);
+        if (!groups[g].carrier_alloc)
+            goto out;
+        groups[g].carrier = groups[g].carrier_alloc;
+    }
+
+    // per group: targets with equal kx next to each other, the carrier owner and its kx last
+    for (size_t g = 0; g < n_groups; ++g) {
+        const size_t owner = groups[g].owner;
+
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < n_targets; ++i) {
+                if (target_group[i] != g || placed[i] || i == owner)
+                    continue;
+
+                const bool owner_kx =
+                    owner != n_targets && fastfilters_kernel_fir_equal(targets[i].kx, targets[owner].kx);
+                if (owner_kx != (pass == 1))
+                    continue;
+
+                for (size_t j = i; j < n_targets; ++j) {
+                    if (target_group[j] != g || placed[j] || j == owner)
+                        continue;
+                    if (!fastfilters_kernel_fir_equal(targets[i].kx, targets[j].kx))
+                        continue;
+
+                    steps[n_steps].target = &targets[j];
+                    steps[n_steps].group = &groups[g];
+                    n_steps++;
+                    placed[j] = true;
+                }
+            }
+        }
+
+        if (owner != n_targets) {
+            steps[n_steps].target = &targets[owner];
+            steps[n_steps].group = &groups[g];
+            n_steps++;
+            placed[owner] = true;
+        }
+    }
+
+    for (size_t i = 0; i < n_steps; ++i)
+        steps[i].reuse_x = i > 0 && steps[i].group == steps[i - 1].group &&
+                           fastfilters_kernel_fir_equal(steps[i].target->kx, steps[i - 1].target->kx);
+
+    for (size_t g = 0; g < n_groups; ++g) {
+        const fastfilters_array3d_t *in = groups[g].in;
+        const fastfilters_array3d_t *carrier = groups[g].carrier;
+
+        if (!fir_convolve_outer_border(in->ptr, in->type, in->n_z, in->stride_z, in->n_y * in->n_x * in->n_channels, 1,
+                                       carrier->ptr, FASTFILTERS_TYPE_FLOAT32, carrier->stride_z, groups[g].kz, 1, 0,
+                                       0, &g_mirror_borders))
+            goto out;
+    }
+
+    multi3d_t m = {.shape = shape, .steps = steps, .n_steps = n_steps, .typed_out = typed_out};
+    result = fastfilters_parallel_for(shape->n_z, fastfilters_parallel_chunk_size(shape->n_z, 1, 1),
+                                      multi3d_plane_worker, &m);
+
+out:
+    if (groups)
+        for (size_t g = 0; g < n_groups; ++g)
+            if (groups[g].carrier_alloc)
+                fastfilters_array3d_free(groups[g].carrier_alloc);
+    if (groups)
+        fastfilters_memory_free(groups);
+    if (steps)
+        fastfilters_memory_free(steps);
+    if (target_group)
+        fastfilters_memory_free(target_group);
+    if (placed)
+        fastfilters_memory_free(placed);
+    return result;
+}
+
+// Fused sum of two or three convolutions of the same input, or the square root of the sum of their squares.
+//
+// The slowest axis (y in 2D, z in 3D) is split into blocks of about FF_SUM_BLOCK_BYTES. For every block, the pass along
+// that axis runs once per group of terms sharing its kernel and reads the input directly, with optimistic borders
+// between blocks, into the output block for the first group and into block sized carriers for the others. Afterwards
+// every block of rows (2D) or plane (3D) runs the remaining passes of all terms into small buffers and combines them
+// straight into the output, squaring and taking the square root on that store, while the carriers are still in cache.
+// No buffer is as large as the image, and a block of the output is only overwritten after all terms have read it.
+#define SUM_MAX_TERMS 3
+
+typedef struct {
+    fastfilters_kernel_fir_t kx;
+    fastfilters_kernel_fir_t ky;
+    const float *carrier;
+} sum_term_t;
+
+typedef struct {
+    sum_term_t terms[SUM_MAX_TERMS];
+    size_t n_terms;
+    bool sqrt_of_squares;
+    unsigned ndim;
+    size_t n_x;
+    size_t n_y;
+    size_t n_channels;
+    float *outptr;
+} sum_t;
+
+static bool sum_slice_worker(void *ctx, size_t begin, size_t end)
+{
+    const sum_t *s = ctx;
+    const size_t row_len = s->n_x * s->n_channels;
+    const size_t slice_len = s->ndim == 3 ? s->n_y * row_len : row_len;
+    bool result = false;
+
+    // 2D slices are single rows and are processed in blocks, 3D slices are whole planes
+    size_t block = 1;
+    if (s->ndim == 2) {
+        block = FF_CONVERT_BLOCK_BYTES / (row_len * sizeof(float));
+        if (block == 0)
+            block = 1;
     }
+    if (block > end - begin)
+        block = end - begin;
+
+    // one buffer per term, plus the x pass scratch plane in 3D
+    const size_t block_len = block * slice_len;
+    float *buf = fastfilters_memory_align(32, (s->n_terms + (s->ndim == 3)) * block_len * sizeof(float));
+    if (!buf)
+        return false;
+
+    float *scratch = buf + s->n_terms * block_len;
+    const float *terms[SUM_MAX_TERMS];
+    for (size_t t = 0; t < s->n_terms; ++t)
+        terms[t] = buf + t * block_len;
+
+    for (size_t slice = begin; slice < end; slice += block) {
+        const size_t n_slices = end - slice < block ? end - slice : block;
+
+        for (size_t t = 0; t < s->n_terms; ++t) {
+            const float *carrier = s->terms[t].carrier + slice * slice_len;
+            float *dst = buf + t * block_len;
+
+            if (s->ndim == 3) {
+                if (!fir_run_inner(carrier, s->n_x, s->n_channels, s->n_y, row_len, scratch, row_len, s->terms[t].kx,
+                                   FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0))
+                    goto out;
+                if (!fir_run_outer(scratch, s->n_y, row_len, row_len, 1, dst, row_len, s->terms[t].ky,
+                                   FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0))
+                    goto out;
+            } else if (!fir_run_inner(carrier, s->n_x, s->n_channels, n_slices, row_len, dst, row_len, s->terms[t].kx,
+                                      FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0)) {
+                goto out;
+            }
+        }
+
+        fastfilters_combine_sum(terms, s->n_terms, s->sqrt_of_squares, s->outptr + slice * slice_len,
+                                n_slices * slice_len);
+    }
+
+    result = true;
+
+out:
+    fastfilters_memory_align_free(buf);
+    return result;
+}
+
+// kernels holds ndim kernels per term, n_z is 1 in 2D; the input must be dense along x, the output dense
+static bool fir_convolve_sum(const void *inptr, fastfilters_type_t in_type, size_t in_stride_y, size_t in_stride_z,
+                             unsigned ndim, size_t n_x, size_t n_y, size_t n_z, size_t n_channels,
+                             const fastfilters_kernel_fir_t *kernels, size_t n_terms, bool sqrt_of_squares,
+                             float *outptr)
+{
+    bool result = false;
+    float *carriers[SUM_MAX_TERMS] = {NULL};
+    size_t group[SUM_MAX_TERMS];
+    size_t halo = 0;
+
+    const size_t row_len = n_x * n_channels;
+    const size_t n_slow = ndim == 3 ? n_z : n_y;
+    const size_t in_stride_slow = ndim == 3 ? in_stride_z : in_stride_y;
+    const size_t slice_len = ndim == 3 ? n_y * row_len : row_len;
 
-    return g_convolve_outer(outarray->ptr, outarray->n_z, outarray->stride_z,
-                            inarray->n_y * inarray->n_x * inarray->n_channels, 1, outarray->ptr, outarray->stride_z,
-                            kernelz, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, NULL, NULL, 0);
-}
\ No newline at end of file
+    if (n_terms < 2 || n_terms > SUM_MAX_TERMS || !fastfilters_type_size(in_type) || inptr == outptr)
+        return false;
+    if (n_slow == 0 || slice_len == 0)
+        return true;
+
+    // terms share the slow pass with the first term that has the same kernel along that axis
+    for (size_t t = 0; t < n_terms; ++t) {
+        const fastfilters_kernel_fir_t kslow = kernels[t * ndim + ndim - 1];
+
+        for (group[t] = 0; group[t] < t; ++group[t])
+            if (fastfilters_kernel_fir_equal(kernels[group[t] * ndim + ndim - 1], kslow))
+                break;
+
+        if (kslow->len > halo)
+            halo = kslow->len;
+    }
+
+    // blocks span at least 2 * halo slices, so that the mirrored first and last block never read past their own end
+    // and the optimistic borders of all others stay within the input; a short remainder is merged into the last block
+    size_t block = FF_SUM_BLOCK_BYTES / (slice_len * sizeof(float));
+    if (block < 2 * halo)
+        block = 2 * halo;
+    if (block == 0)
+        block = 1;
+
+    size_t max_block = block + 2 * halo;
+    if (max_block > n_slow)
+        max_block = n_slow;
+
+    for (size_t t = 1; t < n_terms; ++t) {
+        if (group[t] != t)
+            continue;
+
+        carriers[t] = fastfilters_memory_align(32, max_block * slice_len * sizeof(float));
+        if (!carriers[t])
+            goto out;
+    }
+
+    for (size_t begin = 0, end; begin < n_slow; begin = end) {
+        end = n_slow - begin <= block + 2 * halo ? n_slow : begin + block;
+
+        const fastfilters_fir_borders_t borders = {
+            .left_border = begin == 0 ? FASTFILTERS_BORDER_MIRROR : FASTFILTERS_BORDER_OPTIMISTIC,
+            .right_border = end == n_slow ? FASTFILTERS_BORDER_MIRROR : FASTFILTERS_BORDER_OPTIMISTIC};
+        const void *in = (const char *)inptr + begin * in_stride_slow * fastfilters_type_size(in_type);
+
+        sum_t s = {.n_terms = n_terms,
+                   .sqrt_of_squares = sqrt_of_squares,
+                   .ndim = ndim,
+                   .n_x = n_x,
+                   .n_y = n_y,
+                   .n_channels = n_channels,
+                   .outptr = outptr + begin * slice_len};
+
+        for (size_t t = 0; t < n_terms; ++t) {
+            const fastfilters_kernel_fir_t *k = kernels + t * ndim;
+
+            s.terms[t].kx = k[0];
+            s.terms[t].ky = k[1];
+
+            if (group[t] != t) {
+                s.terms[t].carrier = s.terms[group[t]].carrier;
+                continue;
+            }
+
+            float *carrier = t == 0 ? s.outptr : carriers[t];
+            s.terms[t].carrier = carrier;
+
+            // the z pass of a 3D volume runs on the n_y planes of rows that are in_stride_y apart
+            if (ndim == 3) {
+                if (!fir_convolve_outer_border(in, in_type, end - begin, in_stride_z, row_len, 1, carrier,
+                                               FASTFILTERS_TYPE_FLOAT32, slice_len, k[2], n_y, in_stride_y, row_len,
+                                               &borders))
+                    goto out;
+            } else if (!fir_convolve_outer_border(in, in_type, end - begin, in_stride_y, row_len, 1, carrier,
+                                                  FASTFILTERS_TYPE_FLOAT32, row_len, k[1], 1, 0, 0, &borders)) {
+                goto out;
+            }
+        }
+
+        if (!fastfilters_parallel_for(end - begin, fastfilters_parallel_chunk_size(end - begin, 1, 1),
+                                      sum_slice_worker, &s))
+            goto out;
+    }
+
+    result = true;
+
+out:
+    for (size_t t = 0; t < SUM_MAX_TERMS; ++t)
+        if (carriers[t])
+            fastfilters_memory_align_free(carriers[t]);
+    return result;
+}
+
+bool fastfilters_fir_convolve2d_sum(const fastfilters_array2d_t *inarray, const fastfilters_kernel_fir_t (*kernels)[2],
+                                    size_t n_terms, bool sqrt_of_squares, const fastfilters_array2d_t *outarray)
+{
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32 || !multi2d_is_dense(outarray) ||
+        inarray->stride_x != inarray->n_channels)
+        return false;
+
+    return fir_convolve_sum(inarray->ptr, inarray->type, inarray->stride_y, 0, 2, inarray->n_x, inarray->n_y, 1,
+                            inarray->n_channels, kernels[0], n_terms, sqrt_of_squares, outarray->ptr);
+}
+
+bool fastfilters_fir_convolve3d_sum(const fastfilters_array3d_t *inarray, const fastfilters_kernel_fir_t (*kernels)[3],
+                                    size_t n_terms, bool sqrt_of_squares, const fastfilters_array3d_t *outarray)
+{
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32 || !multi3d_is_dense(outarray) ||
+        inarray->stride_x != inarray->n_channels)
+        return false;
+
+    return fir_convolve_sum(inarray->ptr, inarray->type, inarray->stride_y, inarray->stride_z, 3, inarray->n_x,
+                            inarray->n_y, inarray->n_z, inarray->n_channels, kernels[0], n_terms, sqrt_of_squares,
+                            outarray->ptr);
+}
@@ -116,6 +116,26 @@ static impl_fn_t find_fn(fastfilters_kernel_fir_t kernel, fastfilters_border_tre
 }
 
 #define APPEND_AVXFMA(x) BOOST_PP_CAT3(x, _, fname_avxfma(param_avxfma))
+#define FF_FIR_IMPL BOOST_PP_IF(param_avxfma, FASTFILTERS_FIR_IMPL_AVXFMA, FASTFILTERS_FIR_IMPL_AVX)
+
+void APPEND_AVXFMA(fastfilters_fir_resolve_fir)(fastfilters_kernel_fir_t kernel)
+{
+    fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FF_FIR_IMPL];
+
+    dispatch->fn_inner_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, jmptbls_inner,
+                                        ARRAY_LENGTH(jmptbls_inner));
+    dispatch->fn_inner_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
+                                            jmptbls_inner, ARRAY_LENGTH(jmptbls_inner));
+    dispatch->fn_inner_ptr =
+        find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, jmptbls_inner, ARRAY_LENGTH(jmptbls_inner));
+
+    dispatch->fn_outer_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, jmptbls_outer,
+                                        ARRAY_LENGTH(jmptbls_outer));
+    dispatch->fn_outer_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
+                                            jmptbls_outer, ARRAY_LENGTH(jmptbls_outer));
+    dispatch->fn_outer_ptr =
+        find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, jmptbls_outer, ARRAY_LENGTH(jmptbls_outer));
+}
 
 bool APPEND_AVXFMA(fastfilters_fir_convolve_fir_inner)(const float *inptr, size_t n_pixels, size_t pixel_stride,
                                                        size_t n_outer, size_t outer_stride, float *outptr,
@@ -141,25 +161,18 @@ bool APPEND_AVXFMA(fastfilters_fir_convolve_fir_inner)(const float *inptr, size_
         return true;
     }
 
-    if (unlikely(kernel->fn_inner_mirror == NULL)) {
-        kernel->fn_inner_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, jmptbls_inner,
-                                          ARRAY_LENGTH(jmptbls_inner));
-        kernel->fn_inner_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
-                                              jmptbls_inner, ARRAY_LENGTH(jmptbls_inner));
-        kernel->fn_inner_ptr =
-            find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, jmptbls_inner, ARRAY_LENGTH(jmptbls_inner));
-    }
+    const fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FF_FIR_IMPL];
 
     if (likely(left_border == right_border)) {
         switch (left_border) {
         case FASTFILTERS_BORDER_MIRROR:
-            fn = kernel->fn_inner_mirror;
+            fn = dispatch->fn_inner_mirror;
             break;
         case FASTFILTERS_BORDER_OPTIMISTIC:
-            fn = kernel->fn_inner_optimistic;
+            fn = dispatch->fn_inner_optimistic;
             break;
         case FASTFILTERS_BORDER_PTR:
-            fn = kernel->fn_inner_ptr;
+            fn = dispatch->fn_inner_ptr;
             break;
         default:
             return false;
@@ -192,29 +205,26 @@ bool APPEND_AVXFMA(fastfilters_fir_convolve_fir_outer)(const float *inptr, size_
         if (inptr == outptr)
             return true;
 
-        // FIXME: memcpy here
-        return false;
-    }
+        if (outer_stride != 1)
+            return false;
 
-    if (unlikely(kernel->fn_outer_mirror == NULL)) {
-        kernel->fn_outer_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, jmptbls_outer,
-                                          ARRAY_LENGTH(jmptbls_outer));
-        kernel->fn_outer_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
-                                              jmptbls_outer, ARRAY_LENGTH(jmptbls_outer));
-        kernel->fn_outer_ptr =
-            find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, jmptbls_outer, ARRAY_LENGTH(jmptbls_outer));
+        for (size_t i = 0; i < n_pixels; ++i)
+            memcpy(outptr + i * outptr_stride, inptr + i * pixel_stride, n_outer * sizeof(float));
+        return true;
     }
 
+    const fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FF_FIR_IMPL];
+
     if (likely(left_border == right_border)) {
         switch (left_border) {
         case FASTFILTERS_BORDER_MIRROR:
-            fn = kernel->fn_outer_mirror;
+            fn = dispatch->fn_outer_mirror;
             break;
         case FASTFILTERS_BORDER_OPTIMISTIC:
-            fn = kernel->fn_outer_optimistic;
+            fn = dispatch->fn_outer_optimistic;
             break;
         case FASTFILTERS_BORDER_PTR:
-            fn = kernel->fn_outer_ptr;
+            fn = dispatch->fn_outer_ptr;
             break;
         default:
             return false;
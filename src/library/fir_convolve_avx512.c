@@ -0,0 +1,215 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <immintrin.h>
+
+#if !defined(__AVX512F__) || !defined(__FMA__)
+#error "fir_convolve_avx512.c needs to be compiled with AVX512F and FMA support."
+#endif
+
+#include <boost/preprocessor/library.hpp>
+
+// unlike the avx kernels there is only one implementation per border combination, it reads the kernel length at runtime
+#define FASTFILTERS_FIR_CONVOLVE_AVX512_IMPL_H
+#include "fir_convolve_avx512_impl.h"
+
+#define N_BORDER_TYPES 3
+
+#define ENUM_BORDER(x) BOOST_PP_CAT(border_enum_, x)
+#define IMPL_NAME(prefix, x, y, symmetric)                                                                             \
+    BOOST_PP_CAT(BOOST_PP_CAT(prefix, BOOST_PP_CAT(BOOST_PP_CAT(border_, x), _)),                                      \
+                 BOOST_PP_CAT(BOOST_PP_CAT(border_, y),                                                                \
+                              BOOST_PP_IF(symmetric, _symmetric_avx512, _antisymmetric_avx512)))
+
+struct impl_fn_selection {
+    impl_fn_t fn_inner;
+    impl_fn_t fn_outer;
+    fastfilters_border_treatment_t left_border;
+    fastfilters_border_treatment_t right_border;
+    bool is_symmetric;
+};
+
+#define DEFINE_IMPL_STRUCT(x, y, symmetric)                                                                            \
+    {                                                                                                                  \
+        .fn_inner = &IMPL_NAME(fir_convolve_impl_, x, y, symmetric),                                                   \
+        .fn_outer = &IMPL_NAME(fir_convolve_outer_impl_, x, y, symmetric), .left_border = ENUM_BORDER(x),              \
+        .right_border = ENUM_BORDER(y), .is_symmetric = BOOST_PP_IF(symmetric, true, false)                            \
+    }
+
+#define DECL_DEFINE_IMPL_STRUCT_INNER(z, n1, n0) DEFINE_IMPL_STRUCT(n0, n1, 0), DEFINE_IMPL_STRUCT(n0, n1, 1),
+#define DECL_DEFINE_IMPL_STRUCT_OUTER(z, n0, text) BOOST_PP_REPEAT(N_BORDER_TYPES, DECL_DEFINE_IMPL_STRUCT_INNER, n0)
+
+static const struct impl_fn_selection impl_fns[] = {BOOST_PP_REPEAT(N_BORDER_TYPES, DECL_DEFINE_IMPL_STRUCT_OUTER, 0)};
+
+static const struct impl_fn_selection *find_fns(fastfilters_kernel_fir_t kernel,
+                                                fastfilters_border_treatment_t left_border,
+                                                fastfilters_border_treatment_t right_border)
+{
+    if (kernel->len == 0)
+        return NULL;
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(impl_fns); ++i) {
+        if (left_border != impl_fns[i].left_border)
+            continue;
+        if (right_border != impl_fns[i].right_border)
+            continue;
+        if (kernel->is_symmetric != impl_fns[i].is_symmetric)
+            continue;
+        return &impl_fns[i];
+    }
+
+    return NULL;
+}
+
+static impl_fn_t find_fn(fastfilters_kernel_fir_t kernel, fastfilters_border_treatment_t left_border,
+                         fastfilters_border_treatment_t right_border, bool outer)
+{
+    const struct impl_fn_selection *fns = find_fns(kernel, left_border, right_border);
+
+    if (fns == NULL)
+        return NULL;
+
+    return outer ? fns->fn_outer : fns->fn_inner;
+}
+
+void fastfilters_fir_resolve_fir_avx512(fastfilters_kernel_fir_t kernel)
+{
+    fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FASTFILTERS_FIR_IMPL_AVX512];
+
+    dispatch->fn_inner_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, false);
+    dispatch->fn_inner_optimistic =
+        find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC, false);
+    dispatch->fn_inner_ptr = find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, false);
+
+    dispatch->fn_outer_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR, true);
+    dispatch->fn_outer_optimistic =
+        find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC, true);
+    dispatch->fn_outer_ptr = find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, true);
+}
+
+bool fastfilters_fir_convolve_fir_inner_avx512(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                               size_t n_outer, size_t outer_stride, float *outptr,
+                                               size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                               fastfilters_border_treatment_t left_border,
+                                               fastfilters_border_treatment_t right_border,
+                                               const float *borderptr_left, const float *borderptr_right,
+                                               size_t border_outer_stride)
+{
+    impl_fn_t fn = NULL;
+
+    if (unlikely(kernel->len == 0)) {
+        if (fabs(kernel->coefs[0] - 1.0) > 1e-6)
+            return false;
+
+        if (inptr == outptr)
+            return true;
+
+        if (outer_stride != n_pixels * pixel_stride)
+            return false;
+
+        memcpy(outptr, inptr, outer_stride * n_outer * sizeof(float));
+        return true;
+    }
+
+    const fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FASTFILTERS_FIR_IMPL_AVX512];
+
+    if (likely(left_border == right_border)) {
+        switch (left_border) {
+        case FASTFILTERS_BORDER_MIRROR:
+            fn = dispatch->fn_inner_mirror;
+            break;
+        case FASTFILTERS_BORDER_OPTIMISTIC:
+            fn = dispatch->fn_inner_optimistic;
+            break;
+        case FASTFILTERS_BORDER_PTR:
+            fn = dispatch->fn_inner_ptr;
+            break;
+        default:
+            return false;
+        }
+    } else {
+        fn = find_fn(kernel, left_border, right_border, false);
+    }
+
+    if (unlikely(fn == NULL))
+        return false;
+
+    return fn(inptr, borderptr_left, borderptr_right, n_pixels, pixel_stride, n_outer, outer_stride, outptr,
+              outptr_stride, border_outer_stride, kernel);
+}
+
+bool fastfilters_fir_convolve_fir_outer_avx512(const float *inptr, size_t n_pixels, size_t pixel_stride,
+                                               size_t n_outer, size_t outer_stride, float *outptr,
+                                               size_t outptr_stride, fastfilters_kernel_fir_t kernel,
+                                               fastfilters_border_treatment_t left_border,
+                                               fastfilters_border_treatment_t right_border,
+                                               const float *borderptr_left, const float *borderptr_right,
+                                               size_t border_outer_stride)
+{
+    impl_fn_t fn = NULL;
+
+    if (unlikely(kernel->len == 0)) {
+        if (fabs(kernel->coefs[0] - 1.0) > 1e-6)
+            return false;
+
+        if (inptr == outptr)
+            return true;
+
+        if (outer_stride != 1)
+            return false;
+
+        for (size_t i = 0; i < n_pixels; ++i)
+            memcpy(outptr + i * outptr_stride, inptr + i * pixel_stride, n_outer * sizeof(float));
+        return true;
+    }
+
+    const fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FASTFILTERS_FIR_IMPL_AVX512];
+
+    if (likely(left_border == right_border)) {
+        switch (left_border) {
+        case FASTFILTERS_BORDER_MIRROR:
+            fn = dispatch->fn_outer_mirror;
+            break;
+        case FASTFILTERS_BORDER_OPTIMISTIC:
+            fn = dispatch->fn_outer_optimistic;
+            break;
+        case FASTFILTERS_BORDER_PTR:
+            fn = dispatch->fn_outer_ptr;
+            break;
+        default:
+            return false;
+        }
+    } else {
+        fn = find_fn(kernel, left_border, right_border, true);
+    }
+
+    if (unlikely(fn == NULL))
+        return false;
+
+    return fn(inptr, borderptr_left, borderptr_right, n_pixels, pixel_stride, n_outer, outer_stride, outptr,
+              outptr_stride, border_outer_stride, kernel);
+}
@@ -182,10 +182,10 @@ static bool
             for (x = 0; x < FF_KERNEL_LEN; ++x) {
                 float sum = kernel->coefs[0] * cur_input[x * pixel_stride];
 
-                for (unsigned int k = 1; k < x; ++k) {
+                for (unsigned int k = 1; k <= FF_KERNEL_LEN; ++k) {
                     float left;
                     if (-(int)k + (int)x < 0)
-                        left = in_border_left[y * borderptr_outer_stride +
+                        left = in_border_left[y * borderptr_outer_stride + c +
                                               (FF_KERNEL_LEN - (int)k + (int)x) * pixel_stride];
                     else
                         left = cur_input[(x - k) * pixel_stride];
@@ -215,8 +215,9 @@ static bool
                     float sum = kernel->coefs[0] * cur_input[x * pixel_stride];
 
                     for (unsigned int k = 1; k <= FF_KERNEL_LEN; ++k) {
-                        sum += kernel->coefs[k] * kernel_addsub_ss(cur_input[(x + k) * pixel_stride],
-                                                                   *(cur_input + (x - k) * pixel_stride));
+                        // x - k is negative for optimistic left borders
+                        const float *left = cur_input + ((ptrdiff_t)x - (ptrdiff_t)k) * (ptrdiff_t)pixel_stride;
+                        sum += kernel->coefs[k] * kernel_addsub_ss(cur_input[(x + k) * pixel_stride], *left);
                     }
 
                     cur_output[x * pixel_stride] = sum;
@@ -236,9 +237,9 @@ static bool
                     for (unsigned int k = 1; k <= kernel->len; ++k) {
                         kernel_val = _mm256_broadcast_ss(kernel->coefs + k);
 
-                        __m256 pixels =
-                            kernel_addsub_ps(_mm256_loadu_ps(cur_input + (x + k) * pixel_stride + subx * 8),
-                                             _mm256_loadu_ps(cur_input + (x - k) * pixel_stride + subx * 8));
+                        const float *left = cur_input + ((ptrdiff_t)x - (ptrdiff_t)k) * (ptrdiff_t)pixel_stride;
+                        __m256 pixels = kernel_addsub_ps(_mm256_loadu_ps(cur_input + (x + k) * pixel_stride + subx * 8),
+                                                         _mm256_loadu_ps(left + subx * 8));
                         sum = _mm256_fmadd_ps(pixels, kernel_val, sum);
                     }
 
@@ -262,9 +263,10 @@ static bool
             for (x = xstart_noavx; x < n_pixels_end; ++x) {
                 float sum = cur_input[x * pixel_stride] * kernel->coefs[0];
 
-                for (unsigned int k = 1; k <= FF_KERNEL_LEN; ++k)
-                    sum += kernel->coefs[k] *
-                           kernel_addsub_ss(cur_input[(x + k) * pixel_stride], *(cur_input + ((x - k) * pixel_stride)));
+                for (unsigned int k = 1; k <= FF_KERNEL_LEN; ++k) {
+                    const float *left = cur_input + ((ptrdiff_t)x - (ptrdiff_t)k) * (ptrdiff_t)pixel_stride;
+                    sum += kernel->coefs[k] * kernel_addsub_ss(cur_input[(x + k) * pixel_stride], *left);
+                }
 
                 cur_output[x * pixel_stride] = sum;
             }
@@ -370,7 +372,7 @@ bool DLL_LOCAL fname(0, param_boundary_left, param_boundary_right, param_symm, p
         for (x = 0; x < FF_KERNEL_LEN; ++x) {
             float sum = kernel->coefs[0] * cur_input[x];
 
-            for (unsigned int k = 1; k < x; ++k) {
+            for (unsigned int k = 1; k <= FF_KERNEL_LEN; ++k) {
                 float left;
                 if (-(int)k + (int)x < 0)
                     left = in_border_left[y * borderptr_outer_stride + (FF_KERNEL_LEN - (int)k + (int)x)];
@@ -441,14 +443,13 @@ bool DLL_LOCAL fname(0, param_boundary_left, param_boundary_right, param_symm, p
                     // since kernel[-j] = kernel[j] or kernel[-j] = -kernel[j]
                     __m256 pixels0, pixels1, pixels2, pixels3;
 
-                    pixels0 =
-                        kernel_addsub_ps(_mm256_loadu_ps(cur_input + x + j), _mm256_loadu_ps(cur_input + (x - j)));
+                    pixels0 = kernel_addsub_ps(_mm256_loadu_ps(cur_input + x + j), _mm256_loadu_ps(cur_input + x - j));
                     pixels1 = kernel_addsub_ps(_mm256_loadu_ps(cur_input + x + j + 8),
-                                               _mm256_loadu_ps(cur_input + (x - j) + 8));
+                                               _mm256_loadu_ps(cur_input + x - j + 8));
                     pixels2 = kernel_addsub_ps(_mm256_loadu_ps(cur_input + x + j + 16),
-                                               _mm256_loadu_ps(cur_input + (x - j) + 16));
+                                               _mm256_loadu_ps(cur_input + x - j + 16));
                     pixels3 = kernel_addsub_ps(_mm256_loadu_ps(cur_input + x + j + 24),
-                                               _mm256_loadu_ps(cur_input + (x - j) + 24));
+                                               _mm256_loadu_ps(cur_input + x - j + 24));
 
                     // multiply with kernel value and add to result
                     result0 = _mm256_fmadd_ps(pixels0, kernel_val, result0);
@@ -514,10 +515,12 @@ bool DLL_LOCAL fname(0, param_boundary_left, param_boundary_right, param_symm, p
                 else
                     right = cur_input[x + k];
 
-                // FIXME: ptr
                 if (unlikely(x < k))
-                    // if (unlikely(((int)x -(int)k) < 0))
+#ifdef FF_BOUNDARY_PTR_LEFT
+                    left = in_border_left[y * borderptr_outer_stride + (FF_KERNEL_LEN + x - k)];
+#else
                     left = *(cur_input + k - x);
+#endif
                 else
                     left = *(cur_input + x - k);
 
@@ -532,11 +535,12 @@ bool DLL_LOCAL fname(0, param_boundary_left, param_boundary_right, param_symm, p
     return true;
 }
 
-bool DLL_LOCAL fname(1, param_boundary_left, param_boundary_right, param_symm, param_avxfma,
-                     FF_KERNEL_LEN_FNAME)(const float *inptr, const float *in_border_left, const float *in_border_right,
-                                          size_t n_pixels, size_t pixel_stride, size_t n_outer, size_t outer_stride,
-                                          float *outptr, size_t outptr_outer_stride, size_t borderptr_outer_stride,
-                                          const fastfilters_kernel_fir_t kernel)
+static void BOOST_PP_CAT(fname(1, param_boundary_left, param_boundary_right, param_symm, param_avxfma,
+                               FF_KERNEL_LEN_FNAME),
+                         _tile)(const float *inptr, const float *in_border_left, const float *in_border_right,
+                                size_t n_pixels, size_t pixel_stride, size_t n_outer, float *outptr,
+                                size_t outptr_outer_stride, size_t borderptr_outer_stride,
+                                const fastfilters_kernel_fir_t kernel, float *tmp)
 {
 #ifndef FF_BOUNDARY_PTR_RIGHT
     (void)in_border_right;
@@ -548,9 +552,6 @@ bool DLL_LOCAL fname(1, param_boundary_left, param_boundary_right, param_symm, p
     (void)borderptr_outer_stride;
 #endif
 
-    if (unlikely(outer_stride != 1))
-        return false;
-
     const unsigned int avx_end = n_outer & ~7;
     const unsigned int noavx_left = n_outer - avx_end;
     const unsigned int n_outer_aligned = (n_outer + 8) & ~7;
@@ -560,11 +561,6 @@ bool DLL_LOCAL fname(1, param_boundary_left, param_boundary_right, param_symm, p
                          noavx_left >= 5 ? 0xffffffff : 0, noavx_left >= 4 ? 0xffffffff : 0,
                          noavx_left >= 3 ? 0xffffffff : 0, noavx_left >= 2 ? 0xffffffff : 0, 0xffffffff);
 
-    float *tmp = fastfilters_memory_align(32, (FF_KERNEL_LEN + 1) * n_outer_aligned * sizeof(float));
-
-    if (!tmp)
-        return false;
-
     size_t pixel = 0;
 
 // left border
@@ -688,6 +684,11 @@ bool DLL_LOCAL fname(1, param_boundary_left, param_boundary_right, param_symm, p
             _mm256_store_ps(tmpptr + dim, result);
         }
 
+#ifdef FF_BOUNDARY_OPTIMISTIC_LEFT
+        if (pixel < FF_KERNEL_LEN)
+            continue;
+#endif
+
         const unsigned writeidx = (pixel + 1) % (FF_KERNEL_LEN + 1);
         float *writeptr = tmp + writeidx * n_outer_aligned;
         memcpy(outptr + (pixel - FF_KERNEL_LEN) * outptr_outer_stride, writeptr, n_outer * sizeof(float));
@@ -791,10 +792,47 @@ bool DLL_LOCAL fname(1, param_boundary_left, param_boundary_right, param_symm, p
     // copy from scratch memory to real output
     for (unsigned i = 0; i < FF_KERNEL_LEN; ++i) {
         unsigned pixel = n_pixels + i;
+        // optimistic passes may be shorter than the kernel
+        if (pixel < FF_KERNEL_LEN)
+            continue;
         const unsigned writeidx = (pixel + 1) % (FF_KERNEL_LEN + 1);
         float *writeptr = tmp + writeidx * n_outer_aligned;
         memcpy(outptr + (pixel - FF_KERNEL_LEN) * outptr_outer_stride, writeptr, n_outer * sizeof(float));
     }
+}
+
+bool DLL_LOCAL fname(1, param_boundary_left, param_boundary_right, param_symm, param_avxfma,
+                     FF_KERNEL_LEN_FNAME)(const float *inptr, const float *in_border_left, const float *in_border_right,
+                                          size_t n_pixels, size_t pixel_stride, size_t n_outer, size_t outer_stride,
+                                          float *outptr, size_t outptr_outer_stride, size_t borderptr_outer_stride,
+                                          const fastfilters_kernel_fir_t kernel)
+{
+    if (unlikely(outer_stride != 1))
+        return false;
+
+    // the ring buffer and the 2 * FF_KERNEL_LEN + 1 input rows of one tile should stay in L2
+    size_t tile_size = (FF_OUTER_TILE_BYTES / ((3 * FF_KERNEL_LEN + 2) * sizeof(float))) & ~7;
+    if (tile_size < FF_OUTER_TILE_MIN)
+        tile_size = FF_OUTER_TILE_MIN;
+    if (tile_size > n_outer)
+        tile_size = n_outer;
+
+    const size_t tile_size_aligned = (tile_size + 8) & ~7;
+    float *tmp = fastfilters_memory_align(32, (FF_KERNEL_LEN + 1) * tile_size_aligned * sizeof(float));
+
+    if (!tmp)
+        return false;
+
+    for (size_t tile_start = 0; tile_start < n_outer; tile_start += tile_size) {
+        size_t tile_len = n_outer - tile_start;
+        if (tile_len > tile_size)
+            tile_len = tile_size;
+
+        BOOST_PP_CAT(fname(1, param_boundary_left, param_boundary_right, param_symm, param_avxfma, FF_KERNEL_LEN_FNAME),
+                     _tile)(inptr + tile_start, in_border_left ? in_border_left + tile_start : NULL,
+                            in_border_right ? in_border_right + tile_start : NULL, n_pixels, pixel_stride, tile_len,
+                            outptr + tile_start, outptr_outer_stride, borderptr_outer_stride, kernel, tmp);
+    }
 
     fastfilters_memory_align_free(tmp);
 
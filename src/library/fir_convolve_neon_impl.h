@@ -0,0 +1,426 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef FASTFILTERS_FIR_CONVOLVE_NEON_IMPL_H
+#error "Do not include/compile fir_convolve_neon_impl.h directly"
+#endif
+
+#if !defined(FF_BOUNDARY_OPTIMISTIC_LEFT) && !defined(FF_BOUNDARY_MIRROR_LEFT) && !defined(FF_BOUNDARY_PTR_LEFT)
+
+#define FF_BOUNDARY_OPTIMISTIC_LEFT
+#include "fir_convolve_neon_impl.h"
+#undef FF_BOUNDARY_OPTIMISTIC_LEFT
+
+#define FF_BOUNDARY_MIRROR_LEFT
+#include "fir_convolve_neon_impl.h"
+#undef FF_BOUNDARY_MIRROR_LEFT
+
+#define FF_BOUNDARY_PTR_LEFT
+#include "fir_convolve_neon_impl.h"
+#undef FF_BOUNDARY_PTR_LEFT
+
+#elif !defined(FF_BOUNDARY_OPTIMISTIC_RIGHT) && !defined(FF_BOUNDARY_MIRROR_RIGHT) && !defined(FF_BOUNDARY_PTR_RIGHT)
+
+#define FF_BOUNDARY_OPTIMISTIC_RIGHT
+#include "fir_convolve_neon_impl.h"
+#undef FF_BOUNDARY_OPTIMISTIC_RIGHT
+
+#define FF_BOUNDARY_MIRROR_RIGHT
+#include "fir_convolve_neon_impl.h"
+#undef FF_BOUNDARY_MIRROR_RIGHT
+
+#define FF_BOUNDARY_PTR_RIGHT
+#include "fir_convolve_neon_impl.h"
+#undef FF_BOUNDARY_PTR_RIGHT
+
+#elif !defined(FF_KERNEL_SYMMETRIC) && !defined(FF_KERNEL_ANTISYMMETRIC)
+
+#define FF_KERNEL_SYMMETRIC
+#include "fir_convolve_neon_impl.h"
+#undef FF_KERNEL_SYMMETRIC
+
+#define FF_KERNEL_ANTISYMMETRIC
+#include "fir_convolve_neon_impl.h"
+#undef FF_KERNEL_ANTISYMMETRIC
+
+#else
+
+#ifdef FF_BOUNDARY_OPTIMISTIC_LEFT
+#define boundary_name_left optimistic_
+#elif defined(FF_BOUNDARY_MIRROR_LEFT)
+#define boundary_name_left mirror_
+#elif defined(FF_BOUNDARY_PTR_LEFT)
+#define boundary_name_left ptr_
+#else
+#error "No boundary treatment mode defined."
+#endif
+
+#ifdef FF_BOUNDARY_OPTIMISTIC_RIGHT
+#define boundary_name_right optimistic_
+#elif defined(FF_BOUNDARY_MIRROR_RIGHT)
+#define boundary_name_right mirror_
+#elif defined(FF_BOUNDARY_PTR_RIGHT)
+#define boundary_name_right ptr_
+#else
+#error "No boundary treatment mode defined."
+#endif
+
+#ifdef FF_KERNEL_SYMMETRIC
+#define symmetry_name symmetric_neon
+#define kernel_addsub_ps(a, b) vaddq_f32((a), (b))
+#define kernel_addsub_ss(a, b) ((a) + (b))
+#elif defined(FF_KERNEL_ANTISYMMETRIC)
+#define symmetry_name antisymmetric_neon
+#define kernel_addsub_ps(a, b) vsubq_f32((a), (b))
+#define kernel_addsub_ss(a, b) ((a) - (b))
+#else
+#error "FF_KERNEL_SYMMETRIC and FF_KERNEL_ANTISYMMETRIC not defined"
+#endif
+
+#define boundary_name BOOST_PP_CAT(boundary_name_left, boundary_name_right)
+#define FNAME BOOST_PP_CAT(fir_convolve_impl_, BOOST_PP_CAT(boundary_name, symmetry_name))
+
+// one output pixel of a single channel close to a border, row and the border pointers already point to the channel
+static inline float BOOST_PP_CAT(FNAME, _pixel)(const float *row, const float *border_left, const float *border_right,
+                                                size_t x, size_t n_pixels, size_t pixel_stride,
+                                                const fastfilters_kernel_fir_t kernel)
+{
+#ifndef FF_BOUNDARY_PTR_LEFT
+    (void)border_left;
+#endif
+#ifndef FF_BOUNDARY_PTR_RIGHT
+    (void)border_right;
+#endif
+
+    float sum = kernel->coefs[0] * row[x * pixel_stride];
+
+    for (size_t k = 1; k <= kernel->len; ++k) {
+        float left, right;
+
+        if (k > x)
+#ifdef FF_BOUNDARY_MIRROR_LEFT
+            left = row[(k - x) * pixel_stride];
+#elif defined(FF_BOUNDARY_PTR_LEFT)
+            left = border_left[(kernel->len + x - k) * pixel_stride];
+#else
+            left = *(row - (ptrdiff_t)((k - x) * pixel_stride));
+#endif
+        else
+            left = row[(x - k) * pixel_stride];
+
+        if (x + k >= n_pixels)
+#ifdef FF_BOUNDARY_MIRROR_RIGHT
+            right = row[(n_pixels - ((k + x) % n_pixels) - 2) * pixel_stride];
+#elif defined(FF_BOUNDARY_PTR_RIGHT)
+            right = border_right[((k + x) % n_pixels) * pixel_stride];
+#else
+            right = row[(x + k) * pixel_stride];
+#endif
+        else
+            right = row[(x + k) * pixel_stride];
+
+        sum += kernel->coefs[k] * kernel_addsub_ss(right, left);
+    }
+
+    return sum;
+}
+
+static bool FNAME(const float *inptr, const float *in_border_left, const float *in_border_right, size_t n_pixels,
+                  size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr, size_t outptr_outer_stride,
+                  size_t borderptr_outer_stride, const fastfilters_kernel_fir_t kernel)
+{
+    const size_t kernel_len = kernel->len;
+
+#ifdef FF_BOUNDARY_OPTIMISTIC_LEFT
+    const size_t valid_begin = 0;
+#else
+    const size_t valid_begin = kernel_len < n_pixels ? kernel_len : n_pixels;
+#endif
+#ifdef FF_BOUNDARY_OPTIMISTIC_RIGHT
+    const size_t valid_end = n_pixels;
+#else
+    const size_t valid_end = n_pixels > valid_begin + kernel_len ? n_pixels - kernel_len : valid_begin;
+#endif
+
+    // all channels of a pixel are filtered independently, so the valid part of an interleaved row can be treated as
+    // one long line where the neighbours of an element are pixel_stride elements apart
+    const size_t flat_begin = valid_begin * pixel_stride;
+    const size_t flat_end = valid_end * pixel_stride;
+
+    for (size_t y = 0; y < n_outer; ++y) {
+        const float *row = inptr + y * outer_stride;
+        float *out = outptr + y * outptr_outer_stride;
+        const float *border_left = NULL;
+        const float *border_right = NULL;
+
+#ifdef FF_BOUNDARY_PTR_LEFT
+        border_left = in_border_left + y * borderptr_outer_stride;
+#else
+        (void)in_border_left;
+#endif
+#ifdef FF_BOUNDARY_PTR_RIGHT
+        border_right = in_border_right + y * borderptr_outer_stride;
+#else
+        (void)in_border_right;
+#endif
+#if !defined(FF_BOUNDARY_PTR_LEFT) && !defined(FF_BOUNDARY_PTR_RIGHT)
+        (void)borderptr_outer_stride;
+#endif
+
+        for (size_t x = 0; x < valid_begin; ++x)
+            for (size_t c = 0; c < pixel_stride; ++c)
+                out[x * pixel_stride + c] = BOOST_PP_CAT(FNAME, _pixel)(
+                    row + c, border_left ? border_left + c : NULL, border_right ? border_right + c : NULL, x, n_pixels,
+                    pixel_stride, kernel);
+
+        size_t i = flat_begin;
+
+        // main loop - 16 elements at once
+        for (; i + 16 <= flat_end; i += 16) {
+            float32x4_t kernel_val = vdupq_n_f32(kernel->coefs[0]);
+            float32x4_t result0 = vmulq_f32(vld1q_f32(row + i), kernel_val);
+            float32x4_t result1 = vmulq_f32(vld1q_f32(row + i + 4), kernel_val);
+            float32x4_t result2 = vmulq_f32(vld1q_f32(row + i + 8), kernel_val);
+            float32x4_t result3 = vmulq_f32(vld1q_f32(row + i + 12), kernel_val);
+
+            for (size_t k = 1; k <= kernel_len; ++k) {
+                const float *right = row + i + k * pixel_stride;
+                const float *left = row + i - k * pixel_stride;
+
+                kernel_val = vdupq_n_f32(kernel->coefs[k]);
+                result0 = vfmaq_f32(result0, kernel_addsub_ps(vld1q_f32(right), vld1q_f32(left)), kernel_val);
+                result1 = vfmaq_f32(result1, kernel_addsub_ps(vld1q_f32(right + 4), vld1q_f32(left + 4)), kernel_val);
+                result2 = vfmaq_f32(result2, kernel_addsub_ps(vld1q_f32(right + 8), vld1q_f32(left + 8)), kernel_val);
+                result3 =
+                    vfmaq_f32(result3, kernel_addsub_ps(vld1q_f32(right + 12), vld1q_f32(left + 12)), kernel_val);
+            }
+
+            vst1q_f32(out + i, result0);
+            vst1q_f32(out + i + 4, result1);
+            vst1q_f32(out + i + 8, result2);
+            vst1q_f32(out + i + 12, result3);
+        }
+
+        for (; i + 4 <= flat_end; i += 4) {
+            float32x4_t result = vmulq_f32(vld1q_f32(row + i), vdupq_n_f32(kernel->coefs[0]));
+
+            for (size_t k = 1; k <= kernel_len; ++k) {
+                float32x4_t pixels =
+                    kernel_addsub_ps(vld1q_f32(row + i + k * pixel_stride), vld1q_f32(row + i - k * pixel_stride));
+                result = vfmaq_f32(result, pixels, vdupq_n_f32(kernel->coefs[k]));
+            }
+
+            vst1q_f32(out + i, result);
+        }
+
+        for (; i < flat_end; ++i) {
+            float sum = kernel->coefs[0] * row[i];
+
+            for (size_t k = 1; k <= kernel_len; ++k)
+                sum += kernel->coefs[k] * kernel_addsub_ss(row[i + k * pixel_stride], row[i - k * pixel_stride]);
+
+            out[i] = sum;
+        }
+
+        for (size_t x = valid_end; x < n_pixels; ++x)
+            for (size_t c = 0; c < pixel_stride; ++c)
+                out[x * pixel_stride + c] = BOOST_PP_CAT(FNAME, _pixel)(
+                    row + c, border_left ? border_left + c : NULL, border_right ? border_right + c : NULL, x, n_pixels,
+                    pixel_stride, kernel);
+    }
+
+    return true;
+}
+
+#undef FNAME
+
+#define FNAME BOOST_PP_CAT(fir_convolve_outer_impl_, BOOST_PP_CAT(boundary_name, symmetry_name))
+
+// pointers to the lines pixel - k and pixel + k for k = 1..kernel->len, resolved once per output line
+static inline void BOOST_PP_CAT(FNAME, _lines)(const float *inptr, const float *in_border_left,
+                                               const float *in_border_right, size_t pixel, size_t n_pixels,
+                                               size_t pixel_stride, size_t borderptr_outer_stride,
+                                               const fastfilters_kernel_fir_t kernel, const float **lines_left,
+                                               const float **lines_right)
+{
+#ifndef FF_BOUNDARY_PTR_LEFT
+    (void)in_border_left;
+#endif
+#ifndef FF_BOUNDARY_PTR_RIGHT
+    (void)in_border_right;
+#endif
+#if !defined(FF_BOUNDARY_PTR_LEFT) && !defined(FF_BOUNDARY_PTR_RIGHT)
+    (void)borderptr_outer_stride;
+#endif
+
+    for (size_t k = 1; k <= kernel->len; ++k) {
+        if (k > pixel)
+#ifdef FF_BOUNDARY_MIRROR_LEFT
+            lines_left[k] = inptr + (k - pixel) * pixel_stride;
+#elif defined(FF_BOUNDARY_PTR_LEFT)
+            lines_left[k] = in_border_left + (kernel->len + pixel - k) * borderptr_outer_stride;
+#else
+            lines_left[k] = inptr - (ptrdiff_t)((k - pixel) * pixel_stride);
+#endif
+        else
+            lines_left[k] = inptr + (pixel - k) * pixel_stride;
+
+        if (pixel + k >= n_pixels)
+#ifdef FF_BOUNDARY_MIRROR_RIGHT
+            lines_right[k] = inptr + (n_pixels - ((pixel + k) % n_pixels) - 2) * pixel_stride;
+#elif defined(FF_BOUNDARY_PTR_RIGHT)
+            lines_right[k] = in_border_right + ((pixel + k) % n_pixels) * borderptr_outer_stride;
+#else
+            lines_right[k] = inptr + (pixel + k) * pixel_stride;
+#endif
+        else
+            lines_right[k] = inptr + (pixel + k) * pixel_stride;
+    }
+}
+
+static void BOOST_PP_CAT(FNAME, _tile)(const float *inptr, const float *in_border_left, const float *in_border_right,
+                                       size_t n_pixels, size_t pixel_stride, size_t n_outer, float *outptr,
+                                       size_t outptr_outer_stride, size_t borderptr_outer_stride,
+                                       const fastfilters_kernel_fir_t kernel, float *tmp, const float **lines_left,
+                                       const float **lines_right)
+{
+    const size_t kernel_len = kernel->len;
+    const size_t n_outer_aligned = (n_outer + 3) & ~3;
+    const size_t neon_end = n_outer & ~15;
+
+    // lines are computed into a ring buffer of kernel_len + 1 lines and written back kernel_len lines later, which
+    // keeps the pass safe to run in place
+    for (size_t pixel = 0; pixel < n_pixels; ++pixel) {
+        const float *cur_inptr = inptr + pixel * pixel_stride;
+        float *tmpptr = tmp + (pixel % (kernel_len + 1)) * n_outer_aligned;
+
+        BOOST_PP_CAT(FNAME, _lines)(inptr, in_border_left, in_border_right, pixel, n_pixels, pixel_stride,
+                                    borderptr_outer_stride, kernel, lines_left, lines_right);
+
+        size_t dim = 0;
+        for (; dim < neon_end; dim += 16) {
+            float32x4_t kernel_val = vdupq_n_f32(kernel->coefs[0]);
+            float32x4_t result0 = vmulq_f32(vld1q_f32(cur_inptr + dim), kernel_val);
+            float32x4_t result1 = vmulq_f32(vld1q_f32(cur_inptr + dim + 4), kernel_val);
+            float32x4_t result2 = vmulq_f32(vld1q_f32(cur_inptr + dim + 8), kernel_val);
+            float32x4_t result3 = vmulq_f32(vld1q_f32(cur_inptr + dim + 12), kernel_val);
+
+            for (size_t k = 1; k <= kernel_len; ++k) {
+                const float *right = lines_right[k] + dim;
+                const float *left = lines_left[k] + dim;
+
+                kernel_val = vdupq_n_f32(kernel->coefs[k]);
+                result0 = vfmaq_f32(result0, kernel_addsub_ps(vld1q_f32(right), vld1q_f32(left)), kernel_val);
+                result1 = vfmaq_f32(result1, kernel_addsub_ps(vld1q_f32(right + 4), vld1q_f32(left + 4)), kernel_val);
+                result2 = vfmaq_f32(result2, kernel_addsub_ps(vld1q_f32(right + 8), vld1q_f32(left + 8)), kernel_val);
+                result3 =
+                    vfmaq_f32(result3, kernel_addsub_ps(vld1q_f32(right + 12), vld1q_f32(left + 12)), kernel_val);
+            }
+
+            vst1q_f32(tmpptr + dim, result0);
+            vst1q_f32(tmpptr + dim + 4, result1);
+            vst1q_f32(tmpptr + dim + 8, result2);
+            vst1q_f32(tmpptr + dim + 12, result3);
+        }
+
+        for (; dim + 4 <= n_outer; dim += 4) {
+            float32x4_t result = vmulq_f32(vld1q_f32(cur_inptr + dim), vdupq_n_f32(kernel->coefs[0]));
+
+            for (size_t k = 1; k <= kernel_len; ++k) {
+                float32x4_t pixels = kernel_addsub_ps(vld1q_f32(lines_right[k] + dim), vld1q_f32(lines_left[k] + dim));
+                result = vfmaq_f32(result, pixels, vdupq_n_f32(kernel->coefs[k]));
+            }
+
+            vst1q_f32(tmpptr + dim, result);
+        }
+
+        for (; dim < n_outer; ++dim) {
+            float sum = kernel->coefs[0] * cur_inptr[dim];
+
+            for (size_t k = 1; k <= kernel_len; ++k)
+                sum += kernel->coefs[k] * kernel_addsub_ss(lines_right[k][dim], lines_left[k][dim]);
+
+            tmpptr[dim] = sum;
+        }
+
+        if (pixel >= kernel_len)
+            memcpy(outptr + (pixel - kernel_len) * outptr_outer_stride,
+                   tmp + ((pixel + 1) % (kernel_len + 1)) * n_outer_aligned, n_outer * sizeof(float));
+    }
+
+    // copy the last lines from scratch memory to the real output
+    for (size_t pixel = n_pixels; pixel < n_pixels + kernel_len; ++pixel)
+        if (pixel >= kernel_len)
+            memcpy(outptr + (pixel - kernel_len) * outptr_outer_stride,
+                   tmp + ((pixel + 1) % (kernel_len + 1)) * n_outer_aligned, n_outer * sizeof(float));
+}
+
+static bool FNAME(const float *inptr, const float *in_border_left, const float *in_border_right, size_t n_pixels,
+                  size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr, size_t outptr_outer_stride,
+                  size_t borderptr_outer_stride, const fastfilters_kernel_fir_t kernel)
+{
+    bool ret = false;
+    const size_t kernel_len = kernel->len;
+
+    if (unlikely(outer_stride != 1))
+        return false;
+
+    // the ring buffer and the 2 * kernel_len + 1 input lines of one tile should stay in L2
+    size_t tile_size = (FF_OUTER_TILE_BYTES / ((3 * kernel_len + 2) * sizeof(float))) & ~15;
+    if (tile_size < FF_OUTER_TILE_MIN)
+        tile_size = FF_OUTER_TILE_MIN;
+    if (tile_size > n_outer)
+        tile_size = n_outer;
+
+    const size_t tile_size_aligned = (tile_size + 3) & ~3;
+    float *tmp = fastfilters_memory_align(16, (kernel_len + 1) * tile_size_aligned * sizeof(float));
+    const float **lines = fastfilters_memory_alloc(2 * (kernel_len + 1) * sizeof(const float *));
+
+    if (!tmp || !lines)
+        goto out;
+
+    for (size_t tile_start = 0; tile_start < n_outer; tile_start += tile_size) {
+        size_t tile_len = n_outer - tile_start;
+        if (tile_len > tile_size)
+            tile_len = tile_size;
+
+        BOOST_PP_CAT(FNAME, _tile)(inptr + tile_start, in_border_left ? in_border_left + tile_start : NULL,
+                                   in_border_right ? in_border_right + tile_start : NULL, n_pixels, pixel_stride,
+                                   tile_len, outptr + tile_start, outptr_outer_stride, borderptr_outer_stride, kernel,
+                                   tmp, lines, lines + kernel_len + 1);
+    }
+
+    ret = true;
+
+out:
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    if (lines)
+        fastfilters_memory_free(lines);
+    return ret;
+}
+
+#undef FNAME
+#undef boundary_name
+#undef boundary_name_left
+#undef boundary_name_right
+#undef symmetry_name
+#undef kernel_addsub_ps
+#undef kernel_addsub_ss
+
+#endif
@@ -144,6 +144,25 @@ static impl_fn_t find_fn(fastfilters_kernel_fir_t kernel, fastfilters_border_tre
         return jmptbl[kernel->len - 1];
 }
 
+void fastfilters_fir_resolve_fir(fastfilters_kernel_fir_t kernel)
+{
+    fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FASTFILTERS_FIR_IMPL_NOSIMD];
+
+    dispatch->fn_inner_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR,
+                                        impl_fn_tbls_inner, ARRAY_LENGTH(impl_fn_tbls_inner));
+    dispatch->fn_inner_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
+                                            impl_fn_tbls_inner, ARRAY_LENGTH(impl_fn_tbls_inner));
+    dispatch->fn_inner_ptr = find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, impl_fn_tbls_inner,
+                                     ARRAY_LENGTH(impl_fn_tbls_inner));
+
+    dispatch->fn_outer_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR,
+                                        impl_fn_tbls_outer, ARRAY_LENGTH(impl_fn_tbls_outer));
+    dispatch->fn_outer_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
+                                            impl_fn_tbls_outer, ARRAY_LENGTH(impl_fn_tbls_outer));
+    dispatch->fn_outer_ptr = find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, impl_fn_tbls_outer,
+                                     ARRAY_LENGTH(impl_fn_tbls_outer));
+}
+
 bool fastfilters_fir_convolve_fir_inner(const float *inptr, size_t n_pixels, size_t pixel_stride, size_t n_outer,
                                         size_t outer_stride, float *outptr, size_t outptr_stride,
                                         fastfilters_kernel_fir_t kernel, fastfilters_border_treatment_t left_border,
@@ -166,25 +185,18 @@ bool fastfilters_fir_convolve_fir_inner(const float *inptr, size_t n_pixels, siz
         return true;
     }
 
-    if (unlikely(kernel->fn_inner_mirror == NULL)) {
-        kernel->fn_inner_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR,
-                                          impl_fn_tbls_inner, ARRAY_LENGTH(impl_fn_tbls_inner));
-        kernel->fn_inner_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
-                                              impl_fn_tbls_inner, ARRAY_LENGTH(impl_fn_tbls_inner));
-        kernel->fn_inner_ptr = find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, impl_fn_tbls_inner,
-                                       ARRAY_LENGTH(impl_fn_tbls_inner));
-    }
+    const fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FASTFILTERS_FIR_IMPL_NOSIMD];
 
     if (likely(left_border == right_border)) {
         switch (left_border) {
         case FASTFILTERS_BORDER_MIRROR:
-            fn = kernel->fn_inner_mirror;
+            fn = dispatch->fn_inner_mirror;
             break;
         case FASTFILTERS_BORDER_OPTIMISTIC:
-            fn = kernel->fn_inner_optimistic;
+            fn = dispatch->fn_inner_optimistic;
             break;
         case FASTFILTERS_BORDER_PTR:
-            fn = kernel->fn_inner_ptr;
+            fn = dispatch->fn_inner_ptr;
             break;
         default:
             fn = NULL;
@@ -217,29 +229,26 @@ bool fastfilters_fir_convolve_fir_outer(const float *inptr, size_t n_pixels, siz
         if (inptr == outptr)
             return true;
 
-        // FIXME: memcpy here
-        return false;
-    }
+        if (outer_stride != 1)
+            return false;
 
-    if (unlikely(kernel->fn_outer_mirror == NULL)) {
-        kernel->fn_outer_mirror = find_fn(kernel, FASTFILTERS_BORDER_MIRROR, FASTFILTERS_BORDER_MIRROR,
-                                          impl_fn_tbls_outer, ARRAY_LENGTH(impl_fn_tbls_outer));
-        kernel->fn_outer_optimistic = find_fn(kernel, FASTFILTERS_BORDER_OPTIMISTIC, FASTFILTERS_BORDER_OPTIMISTIC,
-                                              impl_fn_tbls_outer, ARRAY_LENGTH(impl_fn_tbls_outer));
-        kernel->fn_outer_ptr = find_fn(kernel, FASTFILTERS_BORDER_PTR, FASTFILTERS_BORDER_PTR, impl_fn_tbls_outer,
-                                       ARRAY_LENGTH(impl_fn_tbls_outer));
+        for (size_t i = 0; i < n_pixels; ++i)
+            memcpy(outptr + i * outptr_stride, inptr + i * pixel_stride, n_outer * sizeof(float));
+        return true;
     }
 
+    const fastfilters_fir_dispatch_t *dispatch = &kernel->dispatch[FASTFILTERS_FIR_IMPL_NOSIMD];
+
     if (likely(left_border == right_border)) {
         switch (left_border) {
         case FASTFILTERS_BORDER_MIRROR:
-            fn = kernel->fn_outer_mirror;
+            fn = dispatch->fn_outer_mirror;
             break;
         case FASTFILTERS_BORDER_OPTIMISTIC:
-            fn = kernel->fn_outer_optimistic;
+            fn = dispatch->fn_outer_optimistic;
             break;
         case FASTFILTERS_BORDER_PTR:
-            fn = kernel->fn_outer_ptr;
+            fn = dispatch->fn_outer_ptr;
             break;
         default:
             fn = NULL;
@@ -245,7 +245,7 @@ static bool BOOST_PP_CAT(FNAME, _impl)(const float *inptr, const float *in_borde
                 float right;
 
                 if (k + i_inner >= n_pixels)
-                    right = in_border_right[i_outer * borderptr_outer_stride + ((k + i_inner) % n_pixels)];
+                    right = in_border_right[i_outer * borderptr_outer_stride + ((k + i_inner) % n_pixels) * pixel_stride];
                 else
                     right = cur_inptr[(i_inner + k) * pixel_stride];
 #ifdef FF_KERNEL_SYMMETRIC
@@ -287,9 +287,10 @@ static bool FNAME(const float *inptr, const float *in_border_left, const float *
                  BOOST_PP_ITERATION())
 #endif
 
-static bool FNAME(const float *inptr, const float *in_border_left, const float *in_border_right, size_t n_pixels,
-                  size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr, size_t outptr_outer_stride,
-                  size_t borderptr_outer_stride, const fastfilters_kernel_fir_t kernel)
+static void BOOST_PP_CAT(FNAME, _tile)(const float *inptr, const float *in_border_left, const float *in_border_right,
+                                       size_t n_pixels, size_t pixel_stride, size_t n_outer, size_t outer_stride,
+                                       float *outptr, size_t outptr_outer_stride, size_t borderptr_outer_stride,
+                                       const fastfilters_kernel_fir_t kernel, float *tmp)
 {
 #ifndef FF_BOUNDARY_PTR_RIGHT
     (void)in_border_right;
@@ -301,14 +302,6 @@ static bool FNAME(const float *inptr, const float *in_border_left, const float *
     (void)borderptr_outer_stride;
 #endif
 
-    if (n_outer != outptr_outer_stride)
-        return false;
-
-    float *tmp = fastfilters_memory_alloc((KERNEL_LEN + 1) * n_outer * sizeof(float));
-
-    if (!tmp)
-        return false;
-
     unsigned int i_pixel = 0;
 
 // left border
@@ -408,8 +401,7 @@ static bool FNAME(const float *inptr, const float *in_border_left, const float *
 
         const unsigned writeidx = (i_pixel + 1) % (KERNEL_LEN + 1);
         float *writeptr = tmp + writeidx * n_outer;
-        // FIXME: outer_stride
-        memcpy(outptr + (i_pixel - KERNEL_LEN) * pixel_stride, writeptr, n_outer * sizeof(float));
+        memcpy(outptr + (i_pixel - KERNEL_LEN) * outptr_outer_stride, writeptr, n_outer * sizeof(float));
     }
 
 // right border
@@ -449,8 +441,7 @@ static bool FNAME(const float *inptr, const float *in_border_left, const float *
 
         const unsigned writeidx = (i_pixel + 1) % (KERNEL_LEN + 1);
         float *writeptr = tmp + writeidx * n_outer;
-        // FIXME: outer_stride
-        memcpy(outptr + (i_pixel - KERNEL_LEN) * pixel_stride, writeptr, n_outer * sizeof(float));
+        memcpy(outptr + (i_pixel - KERNEL_LEN) * outptr_outer_stride, writeptr, n_outer * sizeof(float));
     }
 #endif
 
@@ -484,17 +475,47 @@ static bool FNAME(const float *inptr, const float *in_border_left, const float *
 
         const unsigned writeidx = (i_pixel + 1) % (KERNEL_LEN + 1);
         float *writeptr = tmp + writeidx * n_outer;
-        // FIXME: outer_stride
-        memcpy(outptr + (i_pixel - KERNEL_LEN) * pixel_stride, writeptr, n_outer * sizeof(float));
+        memcpy(outptr + (i_pixel - KERNEL_LEN) * outptr_outer_stride, writeptr, n_outer * sizeof(float));
     }
 #endif
 
     for (unsigned i = 0; i < KERNEL_LEN; ++i) {
         unsigned pixel = n_pixels + i;
+        // optimistic passes may be shorter than the kernel
+        if (pixel < KERNEL_LEN)
+            continue;
         const unsigned writeidx = (pixel + 1) % (KERNEL_LEN + 1);
         float *writeptr = tmp + writeidx * n_outer;
-        // FIXME: outer_stride
-        memcpy(outptr + (pixel - KERNEL_LEN) * pixel_stride, writeptr, n_outer * sizeof(float));
+        memcpy(outptr + (pixel - KERNEL_LEN) * outptr_outer_stride, writeptr, n_outer * sizeof(float));
+    }
+}
+
+static bool FNAME(const float *inptr, const float *in_border_left, const float *in_border_right, size_t n_pixels,
+                  size_t pixel_stride, size_t n_outer, size_t outer_stride, float *outptr, size_t outptr_outer_stride,
+                  size_t borderptr_outer_stride, const fastfilters_kernel_fir_t kernel)
+{
+    // see fir_convolve_avx_impl.c: keep ring buffer and input window of one column tile in L2
+    size_t tile_size = FF_OUTER_TILE_BYTES / ((3 * KERNEL_LEN + 2) * sizeof(float));
+    if (tile_size < FF_OUTER_TILE_MIN)
+        tile_size = FF_OUTER_TILE_MIN;
+    if (tile_size > n_outer)
+        tile_size = n_outer;
+
+    float *tmp = fastfilters_memory_alloc((KERNEL_LEN + 1) * tile_size * sizeof(float));
+
+    if (!tmp)
+        return false;
+
+    for (size_t tile_start = 0; tile_start < n_outer; tile_start += tile_size) {
+        size_t tile_len = n_outer - tile_start;
+        if (tile_len > tile_size)
+            tile_len = tile_size;
+
+        BOOST_PP_CAT(FNAME, _tile)(inptr + tile_start * outer_stride,
+                                   in_border_left ? in_border_left + tile_start * outer_stride : NULL,
+                                   in_border_right ? in_border_right + tile_start * outer_stride : NULL, n_pixels,
+                                   pixel_stride, tile_len, outer_stride, outptr + tile_start, outptr_outer_stride,
+                                   borderptr_outer_stride, kernel, tmp);
     }
 
     fastfilters_memory_free(tmp);
@@ -0,0 +1,506 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "fastfilters.h"
+#include "common.h"
+
+// A filter bank expands all features at the same scale into the gaussian derivative components they are made of,
+// computes those with one fused multi-target convolution (so every 1D pass is shared across features) and then
+// combines the features from the components. Scratch space is allocated once for the busiest scale.
+
+#define BANK_MAX_COMPONENTS 10
+
+// derivative orders along x, y and z of each component
+static const unsigned int g_components2d[][3] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {2, 0, 0}, {0, 2, 0}, {1, 1, 0}};
+static const unsigned int g_components3d[][3] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {2, 0, 0},
+                                                 {0, 2, 0}, {0, 0, 2}, {1, 1, 0}, {1, 0, 1}, {0, 1, 1}};
+
+enum { C2_S, C2_X, C2_Y, C2_XX, C2_YY, C2_XY };
+enum { C3_S, C3_X, C3_Y, C3_Z, C3_XX, C3_YY, C3_ZZ, C3_XY, C3_XZ, C3_YZ };
+
+typedef struct {
+    unsigned int ndim;
+    const fastfilters_array2d_t *in2d;
+    const fastfilters_array3d_t *in3d;
+    size_t n_pixels;
+    fastfilters_type_t out_type;
+    const fastfilters_options_t *options;
+} bank_t;
+
+static unsigned int bank_components(const bank_t *bank, fastfilters_feature_type_t type)
+{
+    if (bank->ndim == 2) {
+        switch (type) {
+        case FASTFILTERS_FEATURE_GAUSSIAN:
+            return 1u << C2_S;
+        case FASTFILTERS_FEATURE_GRADMAG:
+        case FASTFILTERS_FEATURE_ST_EV:
+            return (1u << C2_X) | (1u << C2_Y);
+        case FASTFILTERS_FEATURE_LAPLACIAN:
+            return (1u << C2_XX) | (1u << C2_YY);
+        case FASTFILTERS_FEATURE_HOG_EV:
+            return (1u << C2_XX) | (1u << C2_YY) | (1u << C2_XY);
+        }
+    } else {
+        switch (type) {
+        case FASTFILTERS_FEATURE_GAUSSIAN:
+            return 1u << C3_S;
+        case FASTFILTERS_FEATURE_GRADMAG:
+        case FASTFILTERS_FEATURE_ST_EV:
+            return (1u << C3_X) | (1u << C3_Y) | (1u << C3_Z);
+        case FASTFILTERS_FEATURE_LAPLACIAN:
+            return (1u << C3_XX) | (1u << C3_YY) | (1u << C3_ZZ);
+        case FASTFILTERS_FEATURE_HOG_EV:
+            return (1u << C3_XX) | (1u << C3_YY) | (1u << C3_ZZ) | (1u << C3_XY) | (1u << C3_XZ) | (1u << C3_YZ);
+        }
+    }
+
+    return 0;
+}
+
+static const unsigned int (*bank_orders(const bank_t *bank, unsigned int *n_components))[3]
+{
+    if (bank->ndim == 2) {
+        *n_components = ARRAY_LENGTH(g_components2d);
+        return g_components2d;
+    }
+
+    *n_components = ARRAY_LENGTH(g_components3d);
+    return g_components3d;
+}
+
+static fastfilters_array2d_t bank_array2d(const bank_t *bank, float *ptr)
+{
+    const fastfilters_array2d_t *in = bank->in2d;
+    fastfilters_array2d_t a = {.ptr = ptr,
+                               .n_x = in->n_x,
+                               .n_y = in->n_y,
+                               .stride_x = in->n_channels,
+                               .stride_y = in->n_x * in->n_channels,
+                               .n_channels = in->n_channels};
+    return a;
+}
+
+static fastfilters_array3d_t bank_array3d(const bank_t *bank, float *ptr)
+{
+    const fastfilters_array3d_t *in = bank->in3d;
+    fastfilters_array3d_t a = {.ptr = ptr,
+                               .n_x = in->n_x,
+                               .n_y = in->n_y,
+                               .n_z = in->n_z,
+                               .stride_x = in->n_channels,
+                               .stride_y = in->n_x * in->n_channels,
+                               .stride_z = in->n_y * in->n_x * in->n_channels,
+                               .n_channels = in->n_channels};
+    return a;
+}
+
+// output index (counted in arrays shaped like the input) of the typed output buffer
+static void *bank_output(const bank_t *bank, void *outptr, size_t index)
+{
+    return (char *)outptr + index * bank->n_pixels * fastfilters_type_size(bank->out_type);
+}
+
+// kernels[o] is the gaussian kernel of derivative order o, components[c] receives component c for all c in mask.
+// Component 0 (smoothing) is only requested by gaussian features and always goes straight into their output.
+static bool bank_convolve(const bank_t *bank, unsigned int mask, const fastfilters_kernel_fir_t *kernels,
+                          float *const *components)
+{
+    unsigned int n_components;
+    const unsigned int(*orders)[3] = bank_orders(bank, &n_components);
+    size_t n_targets = 0;
+
+    if (bank->ndim == 2) {
+        fastfilters_array2d_t outs[BANK_MAX_COMPONENTS];
+        fastfilters_fir_target2d_t targets[BANK_MAX_COMPONENTS];
+
+        for (unsigned int c = 0; c < n_components; ++c) {
+            if (!(mask & (1u << c)))
+                continue;
+
+            outs[n_targets] = bank_array2d(bank, components[c]);
+            if (c == C2_S)
+                outs[n_targets].type = bank->out_type;
+            targets[n_targets].in = bank->in2d;
+            targets[n_targets].kx = kernels[orders[c][0]];
+            targets[n_targets].ky = kernels[orders[c][1]];
+            targets[n_targets].out = &outs[n_targets];
+            n_targets++;
+        }
+
+        return fastfilters_fir_convolve2d_multi(targets, n_targets, bank->options);
+    } else {
+        fastfilters_array3d_t outs[BANK_MAX_COMPONENTS];
+        fastfilters_fir_target3d_t targets[BANK_MAX_COMPONENTS];
+
+        for (unsigned int c = 0; c < n_components; ++c) {
+            if (!(mask & (1u << c)))
+                continue;
+
+            outs[n_targets] = bank_array3d(bank, components[c]);
+            if (c == C3_S)
+                outs[n_targets].type = bank->out_type;
+            targets[n_targets].in = bank->in3d;
+            targets[n_targets].kx = kernels[orders[c][0]];
+            targets[n_targets].ky = kernels[orders[c][1]];
+            targets[n_targets].kz = kernels[orders[c][2]];
+            targets[n_targets].out = &outs[n_targets];
+            n_targets++;
+        }
+
+        return fastfilters_fir_convolve3d_multi(targets, n_targets, bank->options);
+    }
+}
+
+// gaussian smoothing of one scratch plane into another one. Source and destination must differ: the fused
+// convolution would otherwise have to allocate a volume to carry the first pass.
+static bool bank_smooth(const bank_t *bank, float *src, float *dst, fastfilters_kernel_fir_t kernel)
+{
+    if (bank->ndim == 2) {
+        fastfilters_array2d_t in = bank_array2d(bank, src), out = bank_array2d(bank, dst);
+        fastfilters_fir_target2d_t target = {.in = &in, .kx = kernel, .ky = kernel, .out = &out};
+
+        return fastfilters_fir_convolve2d_multi(&target, 1, bank->options);
+    } else {
+        fastfilters_array3d_t in = bank_array3d(bank, src), out = bank_array3d(bank, dst);
+        fastfilters_fir_target3d_t target = {.in = &in, .kx = kernel, .ky = kernel, .kz = kernel, .out = &out};
+
+        return fastfilters_fir_convolve3d_multi(&target, 1, bank->options);
+    }
+}
+
+// derivative components whose product is each structure tensor entry, in the order the entries are stored
+static const unsigned int g_tensor2d[][2] = {{C2_X, C2_X}, {C2_X, C2_Y}, {C2_Y, C2_Y}};
+static const unsigned int g_tensor3d[][2] = {{C3_X, C3_X}, {C3_Y, C3_Y}, {C3_Z, C3_Z},
+                                             {C3_X, C3_Y}, {C3_X, C3_Z}, {C3_Y, C3_Z}};
+
+// tensor holds the n_tensor smoothed entries followed by one plane for the product that is being smoothed
+static bool bank_structure_tensor(const bank_t *bank, const fastfilters_feature_t *feature, float *const *c,
+                                  float *tensor, void *outptr)
+{
+    const size_t n = bank->n_pixels;
+    const unsigned int n_tensor = bank->ndim == 2 ? ARRAY_LENGTH(g_tensor2d) : ARRAY_LENGTH(g_tensor3d);
+    float *product = tensor + n_tensor * n;
+    bool result = false;
+    fastfilters_kernel_fir_t k_smooth = NULL;
+
+    k_smooth = fastfilters_kernel_fir_gaussian(0, feature->sigma_outer, opt_window_ratio(bank->options));
+    if (!k_smooth)
+        goto out;
+
+    for (unsigned int i = 0; i < n_tensor; ++i) {
+        if (bank->ndim == 2) {
+            fastfilters_array2d_t a = bank_array2d(bank, c[g_tensor2d[i][0]]);
+            fastfilters_array2d_t b = bank_array2d(bank, c[g_tensor2d[i][1]]);
+            fastfilters_array2d_t ab = bank_array2d(bank, product);
+
+            fastfilters_combine_mul2d(&a, &b, &ab);
+        } else {
+            fastfilters_array3d_t a = bank_array3d(bank, c[g_tensor3d[i][0]]);
+            fastfilters_array3d_t b = bank_array3d(bank, c[g_tensor3d[i][1]]);
+            fastfilters_array3d_t ab = bank_array3d(bank, product);
+
+            fastfilters_combine_mul3d(&a, &b, &ab);
+        }
+
+        if (!bank_smooth(bank, product, tensor + i * n, k_smooth))
+            goto out;
+    }
+
+    if (bank->ndim == 2)
+        fastfilters_linalg_ev2d_ex(tensor, tensor + n, tensor + 2 * n, outptr, bank_output(bank, outptr, 1), n,
+                                   bank->out_type);
+    else
+        fastfilters_linalg_ev3d_ex(tensor + 2 * n, tensor + 5 * n, tensor + 4 * n, tensor + n, tensor + 3 * n, tensor,
+                                   outptr, bank_output(bank, outptr, 1), bank_output(bank, outptr, 2), n,
+                                   bank->out_type);
+
+    result = true;
+
+out:
+    if (k_smooth)
+        fastfilters_kernel_fir_free(k_smooth);
+    return result;
+}
+
+static bool bank_combine(const bank_t *bank, const fastfilters_feature_t *feature, float *const *c, float *tensor,
+                         void *outptr)
+{
+    const size_t n = bank->n_pixels;
+
+    switch (feature->type) {
+    case FASTFILTERS_FEATURE_GAUSSIAN:
+        if (outptr != (void *)c[0])
+            memcpy(outptr, c[0], n * fastfilters_type_size(bank->out_type));
+        return true;
+
+    case FASTFILTERS_FEATURE_GRADMAG:
+    case FASTFILTERS_FEATURE_LAPLACIAN:
+        if (bank->ndim == 2) {
+            const bool gradmag = feature->type == FASTFILTERS_FEATURE_GRADMAG;
+            fastfilters_array2d_t a = bank_array2d(bank, c[gradmag ? C2_X : C2_XX]);
+            fastfilters_array2d_t b = bank_array2d(bank, c[gradmag ? C2_Y : C2_YY]);
+            fastfilters_array2d_t out = bank_array2d(bank, outptr);
+            out.type = bank->out_type;
+
+            if (gradmag)
+                fastfilters_combine_addsqrt2d(&a, &b, &out);
+            else
+                fastfilters_combine_add2d(&a, &b, &out);
+        } else {
+            const bool gradmag = feature->type == FASTFILTERS_FEATURE_GRADMAG;
+            fastfilters_array3d_t a = bank_array3d(bank, c[gradmag ? C3_X : C3_XX]);
+            fastfilters_array3d_t b = bank_array3d(bank, c[gradmag ? C3_Y : C3_YY]);
+            fastfilters_array3d_t d = bank_array3d(bank, c[gradmag ? C3_Z : C3_ZZ]);
+            fastfilters_array3d_t out = bank_array3d(bank, outptr);
+            out.type = bank->out_type;
+
+            if (gradmag)
+                fastfilters_combine_addsqrt3d(&a, &b, &d, &out);
+            else
+                fastfilters_combine_add3d(&a, &b, &d, &out);
+        }
+        return true;
+
+    case FASTFILTERS_FEATURE_HOG_EV:
+        // same argument order as the python bindings of hog2d/hog3d
+        if (bank->ndim == 2)
+            fastfilters_linalg_ev2d_ex(c[C2_XX], c[C2_XY], c[C2_YY], outptr, bank_output(bank, outptr, 1), n,
+                                       bank->out_type);
+        else
+            fastfilters_linalg_ev3d_ex(c[C3_ZZ], c[C3_YZ], c[C3_XZ], c[C3_YY], c[C3_XY], c[C3_XX], outptr,
+                                       bank_output(bank, outptr, 1), bank_output(bank, outptr, 2), n,
+                                       bank->out_type);
+        return true;
+
+    case FASTFILTERS_FEATURE_ST_EV:
+        return bank_structure_tensor(bank, feature, c, tensor, outptr);
+    }
+
+    return false;
+}
+
+static size_t bank_popcount(unsigned int mask)
+{
+    size_t n = 0;
+    for (; mask; mask &= mask - 1)
+        n++;
+    return n;
+}
+
+static bool bank_run(const bank_t *bank, const fastfilters_feature_t *features, size_t n_features, void *outptr)
+{
+    bool result = false;
+    size_t *offsets = NULL;
+    bool *done = NULL;
+    float *scratch = NULL;
+    fastfilters_kernel_fir_t kernels[3] = {NULL, NULL, NULL};
+    const size_t n_pixels = bank->n_pixels;
+    const size_t n_tensor = bank->ndim == 2 ? 3 : 6;
+    unsigned int n_components;
+    const unsigned int(*orders)[3] = bank_orders(bank, &n_components);
+    size_t n_scratch = 0;
+
+    if (n_features == 0)
+        return true;
+
+    offsets = fastfilters_memory_alloc(n_features * sizeof(*offsets));
+    done = fastfilters_memory_alloc(n_features * sizeof(*done));
+    if (!offsets || !done)
+        goto out;
+
+    size_t n_outputs = 0;
+    for (size_t i = 0; i < n_features; ++i) {
+        const unsigned int n = fastfilters_feature_get_n_outputs(features[i].type, bank->ndim);
+        if (n == 0)
+            goto out;
+
+        offsets[i] = n_outputs;
+        n_outputs += n;
+        done[i] = false;
+    }
+
+    // gaussian smoothing goes straight into its output, every other component and the structure tensor into scratch
+    for (size_t i = 0; i < n_features; ++i) {
+        unsigned int mask = 0;
+        bool has_st = false;
+
+        for (size_t j = i; j < n_features; ++j) {
+            if (features[j].sigma != features[i].sigma)
+                continue;
+            if (features[j].type != FASTFILTERS_FEATURE_GAUSSIAN)
+                mask |= bank_components(bank, features[j].type);
+            if (features[j].type == FASTFILTERS_FEATURE_ST_EV)
+                has_st = true;
+        }
+
+        const size_t n = bank_popcount(mask) + (has_st ? n_tensor + 1 : 0);
+        if (n > n_scratch)
+            n_scratch = n;
+    }
+
+    if (n_scratch > 0) {
+        scratch = fastfilters_memory_align(32, n_scratch * n_pixels * sizeof(float));
+        if (!scratch)
+            goto out;
+    }
+
+    for (size_t i = 0; i < n_features; ++i) {
+        if (done[i])
+            continue;
+
+        const double sigma = features[i].sigma;
+        float *components[BANK_MAX_COMPONENTS] = {NULL};
+        unsigned int mask = 0;
+
+        for (size_t j = i; j < n_features; ++j) {
+            if (features[j].sigma != sigma)
+                continue;
+
+            mask |= bank_components(bank, features[j].type);
+            if (features[j].type == FASTFILTERS_FEATURE_GAUSSIAN && !components[0])
+                components[0] = bank_output(bank, outptr, offsets[j]);
+        }
+
+        size_t n_used = 0;
+        for (unsigned int c = 0; c < n_components; ++c)
+            if ((mask & (1u << c)) && !components[c])
+                components[c] = scratch + n_pixels * n_used++;
+        float *tensor = scratch + n_pixels * n_used;
+
+        for (unsigned int c = 0; c < n_components; ++c) {
+            if (!(mask & (1u << c)))
+                continue;
+
+            for (unsigned int d = 0; d < bank->ndim; ++d) {
+                const unsigned int order = orders[c][d];
+                if (kernels[order])
+                    continue;
+
+                kernels[order] = fastfilters_kernel_fir_gaussian(order, sigma, opt_window_ratio(bank->options));
+                if (!kernels[order])
+                    goto out;
+            }
+        }
+
+        if (!bank_convolve(bank, mask, kernels, components))
+            goto out;
+
+        for (size_t j = i; j < n_features; ++j) {
+            if (features[j].sigma != sigma)
+                continue;
+
+            if (!bank_combine(bank, &features[j], components, tensor, bank_output(bank, outptr, offsets[j])))
+                goto out;
+            done[j] = true;
+        }
+
+        for (unsigned int o = 0; o < ARRAY_LENGTH(kernels); ++o) {
+            if (kernels[o])
+                fastfilters_kernel_fir_free(kernels[o]);
+            kernels[o] = NULL;
+        }
+    }
+
+    result = true;
+
+out:
+    for (unsigned int o = 0; o < ARRAY_LENGTH(kernels); ++o)
+        if (kernels[o])
+            fastfilters_kernel_fir_free(kernels[o]);
+    if (scratch)
+        fastfilters_memory_align_free(scratch);
+    if (offsets)
+        fastfilters_memory_free(offsets);
+    if (done)
+        fastfilters_memory_free(done);
+    return result;
+}
+
+unsigned int DLL_PUBLIC fastfilters_feature_get_n_outputs(fastfilters_feature_type_t type, unsigned int ndim)
+{
+    if (ndim != 2 && ndim != 3)
+        return 0;
+
+    switch (type) {
+    case FASTFILTERS_FEATURE_GAUSSIAN:
+    case FASTFILTERS_FEATURE_GRADMAG:
+    case FASTFILTERS_FEATURE_LAPLACIAN:
+        return 1;
+    case FASTFILTERS_FEATURE_HOG_EV:
+    case FASTFILTERS_FEATURE_ST_EV:
+        return ndim;
+    }
+
+    return 0;
+}
+
+bool DLL_PUBLIC fastfilters_fir_filter_bank2d_ex(const fastfilters_array2d_t *inarray,
+                                                 const fastfilters_feature_t *features, size_t n_features,
+                                                 void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options)
+{
+    bank_t bank = {.ndim = 2,
+                   .in2d = inarray,
+                   .in3d = NULL,
+                   .n_pixels = inarray->n_x * inarray->n_y * inarray->n_channels,
+                   .out_type = out_type,
+                   .options = options};
+
+    if (!fastfilters_type_is_output(out_type))
+        return false;
+
+    return bank_run(&bank, features, n_features, outptr);
+}
+
+bool DLL_PUBLIC fastfilters_fir_filter_bank3d_ex(const fastfilters_array3d_t *inarray,
+                                                 const fastfilters_feature_t *features, size_t n_features,
+                                                 void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options)
+{
+    bank_t bank = {.ndim = 3,
+                   .in2d = NULL,
+                   .in3d = inarray,
+                   .n_pixels = inarray->n_x * inarray->n_y * inarray->n_z * inarray->n_channels,
+                   .out_type = out_type,
+                   .options = options};
+
+    if (!fastfilters_type_is_output(out_type))
+        return false;
+
+    return bank_run(&bank, features, n_features, outptr);
+}
+
+bool DLL_PUBLIC fastfilters_fir_filter_bank2d(const fastfilters_array2d_t *inarray,
+                                              const fastfilters_feature_t *features, size_t n_features, float *outptr,
+                                              const fastfilters_options_t *options)
+{
+    return fastfilters_fir_filter_bank2d_ex(inarray, features, n_features, outptr, FASTFILTERS_TYPE_FLOAT32, options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_filter_bank3d(const fastfilters_array3d_t *inarray,
+                                              const fastfilters_feature_t *features, size_t n_features, float *outptr,
+                                              const fastfilters_options_t *options)
+{
+    return fastfilters_fir_filter_bank3d_ex(inarray, features, n_features, outptr, FASTFILTERS_TYPE_FLOAT32, options);
+}
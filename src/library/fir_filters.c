@@ -19,114 +19,177 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "fastfilters.h"
 #include "common.h"
 
-bool DLL_PUBLIC fastfilters_fir_gaussian2d(const fastfilters_array2d_t *inarray, unsigned order, double sigma,
-                                           fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
-{
-    bool result = false;
-    fastfilters_kernel_fir_t kx = NULL;
+// gaussian kernels per axis and derivative order, orders is a bitmask of the orders to create. Large sigmas use
+// recursive kernels instead, see fastfilters_iir_select.
+typedef struct {
+    fastfilters_kernel_fir_t k[3][3];
+    fastfilters_kernel_iir_t iir[3][3];
+    bool use_iir;
+} axis_kernels_t;
 
-    kx = fastfilters_kernel_fir_gaussian(order, sigma, opt_window_ratio(options));
-    if (!kx)
-        goto out;
+static void axis_kernels_free(axis_kernels_t *ak)
+{
+    for (unsigned int i = 0; i < 3; ++i) {
+        for (unsigned int order = 0; order < 3; ++order) {
+            if (ak->k[i][order])
+                fastfilters_kernel_fir_free(ak->k[i][order]);
+            if (ak->iir[i][order])
+                fastfilters_kernel_iir_free(ak->iir[i][order]);
+        }
+    }
+}
 
-    result = fastfilters_fir_convolve2d(inarray, kx, kx, outarray, options);
+static bool axis_kernels_init(axis_kernels_t *ak, unsigned int ndim, unsigned int orders, const double *sigmas,
+                              const float *window_ratios, const fastfilters_options_t *options)
+{
+    memset(ak, 0, sizeof(*ak));
+    ak->use_iir = fastfilters_iir_select(sigmas, ndim, window_ratios, options);
+
+    for (unsigned int i = 0; i < ndim; ++i) {
+        for (unsigned int order = 0; order < 3; ++order) {
+            if (!(orders & (1u << order)))
+                continue;
+
+            bool ok;
+            if (ak->use_iir) {
+                ak->iir[i][order] = fastfilters_kernel_iir_gaussian(order, sigmas[i]);
+                ok = ak->iir[i][order] != NULL;
+            } else {
+                ak->k[i][order] =
+                    fastfilters_kernel_fir_gaussian(order, sigmas[i], axis_window_ratio(window_ratios, i, options));
+                ok = ak->k[i][order] != NULL;
+            }
+
+            if (!ok) {
+                axis_kernels_free(ak);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
 
-out:
-    if (kx)
-        fastfilters_kernel_fir_free(kx);
-    return result;
+static bool axis_convolve2d(const axis_kernels_t *ak, const fastfilters_array2d_t *inarray, unsigned order_x,
+                            unsigned order_y, fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
+{
+    if (ak->use_iir)
+        return fastfilters_iir_convolve2d(inarray, ak->iir[0][order_x], ak->iir[1][order_y], outarray, options);
+    return fastfilters_fir_convolve2d(inarray, ak->k[0][order_x], ak->k[1][order_y], outarray, options);
 }
 
-bool DLL_PUBLIC fastfilters_fir_hog2d(const fastfilters_array2d_t *inarray, double sigma, fastfilters_array2d_t *out_xx,
-                                      fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
-                                      const fastfilters_options_t *options)
+static bool axis_convolve3d(const axis_kernels_t *ak, const fastfilters_array3d_t *inarray, unsigned order_x,
+                            unsigned order_y, unsigned order_z, fastfilters_array3d_t *outarray,
+                            const fastfilters_options_t *options)
 {
-    bool result = false;
-    fastfilters_kernel_fir_t k_smooth = NULL;
-    fastfilters_kernel_fir_t k_first = NULL;
-    fastfilters_kernel_fir_t k_second = NULL;
+    if (ak->use_iir)
+        return fastfilters_iir_convolve3d(inarray, ak->iir[0][order_x], ak->iir[1][order_y], ak->iir[2][order_z],
+                                          outarray, options);
+    return fastfilters_fir_convolve3d(inarray, ak->k[0][order_x], ak->k[1][order_y], ak->k[2][order_z], outarray,
+                                      options);
+}
 
-    k_smooth = fastfilters_kernel_fir_gaussian(0, sigma, opt_window_ratio(options));
-    if (!k_smooth)
-        goto out;
+bool DLL_PUBLIC fastfilters_fir_gaussian2d_aniso(const fastfilters_array2d_t *inarray, unsigned order,
+                                                 const double *sigmas, const float *window_ratios,
+                                                 fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
+{
+    bool result;
+    axis_kernels_t ak;
 
-    k_first = fastfilters_kernel_fir_gaussian(1, sigma, opt_window_ratio(options));
-    if (!k_first)
-        goto out;
+    if (order > 2)
+        return false;
+    if (!axis_kernels_init(&ak, 2, 1u << order, sigmas, window_ratios, options))
+        return false;
 
-    k_second = fastfilters_kernel_fir_gaussian(2, sigma, opt_window_ratio(options));
-    if (!k_second)
-        goto out;
+    result = axis_convolve2d(&ak, inarray, order, order, outarray, options);
 
-    result = fastfilters_fir_convolve2d(inarray, k_second, k_smooth, out_xx, options);
-    if (!result)
-        goto out;
-
-    result = fastfilters_fir_convolve2d(inarray, k_smooth, k_second, out_yy, options);
-    if (!result)
-        goto out;
+    axis_kernels_free(&ak);
+    return result;
+}
 
-    result = fastfilters_fir_convolve2d(inarray, k_first, k_first, out_xy, options);
-    if (!result)
-        goto out;
+bool DLL_PUBLIC fastfilters_fir_gaussian2d(const fastfilters_array2d_t *inarray, unsigned order, double sigma,
+                                           fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
+{
+    const double sigmas[] = {sigma, sigma};
 
-out:
-    if (k_smooth)
-        fastfilters_kernel_fir_free(k_smooth);
-    if (k_first)
-        fastfilters_kernel_fir_free(k_first);
-    if (k_second)
-        fastfilters_kernel_fir_free(k_second);
-    return result;
+    return fastfilters_fir_gaussian2d_aniso(inarray, order, sigmas, NULL, outarray, options);
 }
 
-static bool fastfilters_fir_deriv2d_inner(const fastfilters_array2d_t *inarray, double sigma, unsigned order,
-                                          fastfilters_array2d_t *out0, fastfilters_array2d_t *out1,
-                                          const fastfilters_options_t *options)
+bool DLL_PUBLIC fastfilters_fir_hog2d_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                            const float *window_ratios, fastfilters_array2d_t *out_xx,
+                                            fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
+                                            const fastfilters_options_t *options)
 {
     bool result = false;
-    fastfilters_kernel_fir_t k_smooth = NULL;
-    fastfilters_kernel_fir_t k_deriv = NULL;
+    axis_kernels_t ak;
 
-    k_smooth = fastfilters_kernel_fir_gaussian(0, sigma, opt_window_ratio(options));
-    if (!k_smooth)
-        goto out;
+    if (!axis_kernels_init(&ak, 2, 7, sigmas, window_ratios, options))
+        return false;
 
-    k_deriv = fastfilters_kernel_fir_gaussian(order, sigma, opt_window_ratio(options));
-    if (!k_deriv)
+    result = axis_convolve2d(&ak, inarray, 2, 0, out_xx, options);
+    if (!result)
         goto out;
 
-    result = fastfilters_fir_convolve2d(inarray, k_deriv, k_smooth, out0, options);
+    result = axis_convolve2d(&ak, inarray, 0, 2, out_yy, options);
     if (!result)
         goto out;
 
-    result = fastfilters_fir_convolve2d(inarray, k_smooth, k_deriv, out1, options);
+    result = axis_convolve2d(&ak, inarray, 1, 1, out_xy, options);
     if (!result)
         goto out;
 
 out:
-    if (k_smooth)
-        fastfilters_kernel_fir_free(k_smooth);
-    if (k_deriv)
-        fastfilters_kernel_fir_free(k_deriv);
+    axis_kernels_free(&ak);
     return result;
 }
 
-static bool fastfilters_fir_deriv2d(const fastfilters_array2d_t *inarray, double sigma, unsigned order,
-                                    fastfilters_array2d_t *outarray, bool do_sqrt, const fastfilters_options_t *options)
+bool DLL_PUBLIC fastfilters_fir_hog2d(const fastfilters_array2d_t *inarray, double sigma, fastfilters_array2d_t *out_xx,
+                                      fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
+                                      const fastfilters_options_t *options)
+{
+    const double sigmas[] = {sigma, sigma};
+
+    return fastfilters_fir_hog2d_aniso(inarray, sigmas, NULL, out_xx, out_xy, out_yy, options);
+}
+
+static bool fastfilters_fir_deriv2d(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                    const float *window_ratios, unsigned order, fastfilters_array2d_t *outarray,
+                                    bool do_sqrt, const fastfilters_options_t *options)
 {
     bool result = false;
     fastfilters_array2d_t *tmparray = NULL;
+    axis_kernels_t ak;
+
+    // the output doubles as float intermediate
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32)
+        return false;
+
+    if (!axis_kernels_init(&ak, 2, 1u | (1u << order), sigmas, window_ratios, options))
+        return false;
+
+    // dense arrays combine the derivatives while they are in cache, see fastfilters_fir_convolve2d_sum
+    if (!ak.use_iir && inarray->ptr != outarray->ptr && inarray->stride_x == inarray->n_channels &&
+        outarray->stride_x == outarray->n_channels && outarray->stride_y == outarray->n_x * outarray->n_channels) {
+        const fastfilters_kernel_fir_t kernels[2][2] = {{ak.k[0][order], ak.k[1][0]}, {ak.k[0][0], ak.k[1][order]}};
+
+        result = fastfilters_fir_convolve2d_sum(inarray, kernels, 2, do_sqrt, outarray);
+        goto out;
+    }
 
     tmparray = fastfilters_array2d_alloc(inarray->n_x, inarray->n_y, inarray->n_channels);
     if (!tmparray)
         goto out;
 
-    result = fastfilters_fir_deriv2d_inner(inarray, sigma, order, tmparray, outarray, options);
+    result = axis_convolve2d(&ak, inarray, order, 0, tmparray, options);
+    if (!result)
+        goto out;
+
+    result = axis_convolve2d(&ak, inarray, 0, order, outarray, options);
     if (!result)
         goto out;
 
@@ -138,76 +201,75 @@ static bool fastfilters_fir_deriv2d(const fastfilters_array2d_t *inarray, double
 out:
     if (tmparray)
         fastfilters_array2d_free(tmparray);
+    axis_kernels_free(&ak);
     return result;
 }
 
+bool DLL_PUBLIC fastfilters_fir_gradmag2d_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                const float *window_ratios, fastfilters_array2d_t *outarray,
+                                                const fastfilters_options_t *options)
+{
+    return fastfilters_fir_deriv2d(inarray, sigmas, window_ratios, 1, outarray, true, options);
+}
+
 bool DLL_PUBLIC fastfilters_fir_gradmag2d(const fastfilters_array2d_t *inarray, double sigma,
                                           fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
 {
-    return fastfilters_fir_deriv2d(inarray, sigma, 1, outarray, true, options);
+    const double sigmas[] = {sigma, sigma};
+
+    return fastfilters_fir_deriv2d(inarray, sigmas, NULL, 1, outarray, true, options);
 }
 
-bool DLL_PUBLIC fastfilters_fir_laplacian2d(const fastfilters_array2d_t *inarray, double sigma,
-                                            fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
+bool DLL_PUBLIC fastfilters_fir_laplacian2d_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                  const float *window_ratios, fastfilters_array2d_t *outarray,
+                                                  const fastfilters_options_t *options)
 {
-    return fastfilters_fir_deriv2d(inarray, sigma, 2, outarray, false, options);
+    return fastfilters_fir_deriv2d(inarray, sigmas, window_ratios, 2, outarray, false, options);
 }
 
-bool DLL_PUBLIC fastfilters_fir_structure_tensor2d(const fastfilters_array2d_t *inarray, double sigma_outer,
-                                                   double sigma_inner, fastfilters_array2d_t *out_xx,
-                                                   fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
-                                                   const fastfilters_options_t *options)
+bool DLL_PUBLIC fastfilters_fir_laplacian2d(const fastfilters_array2d_t *inarray, double sigma,
+                                            fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
 {
-    bool result = false;
-    fastfilters_kernel_fir_t k_smooth = NULL;
-    fastfilters_array2d_t *tmp = NULL;
-    fastfilters_array2d_t *tmpx = NULL;
-    fastfilters_array2d_t *tmpy = NULL;
+    const double sigmas[] = {sigma, sigma};
 
-    k_smooth = fastfilters_kernel_fir_gaussian(0, sigma_outer, opt_window_ratio(options));
-    if (!k_smooth)
-        goto out;
+    return fastfilters_fir_deriv2d(inarray, sigmas, NULL, 2, outarray, false, options);
+}
 
-    tmp = fastfilters_array2d_alloc(inarray->n_x, inarray->n_y, inarray->n_channels);
-    if (!tmp)
-        goto out;
+DLL_PUBLIC bool fastfilters_fir_hog3d_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                            const float *window_ratios, fastfilters_array3d_t *out_xx,
+                                            fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
+                                            fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
+                                            fastfilters_array3d_t *out_yz, const fastfilters_options_t *options)
+{
+    bool result;
+    axis_kernels_t ak;
 
-    tmpx = fastfilters_array2d_alloc(inarray->n_x, inarray->n_y, inarray->n_channels);
-    if (!tmpx)
-        goto out;
+    if (!axis_kernels_init(&ak, 3, 7, sigmas, window_ratios, options))
+        return false;
 
-    tmpy = fastfilters_array2d_alloc(inarray->n_x, inarray->n_y, inarray->n_channels);
-    if (!tmpy)
-        goto out;
+    if (ak.use_iir) {
+        const unsigned orders[6][3] = {{2, 0, 0}, {0, 2, 0}, {0, 0, 2}, {1, 1, 0}, {1, 0, 1}, {0, 1, 1}};
+        fastfilters_array3d_t *outs[6] = {out_xx, out_yy, out_zz, out_xy, out_xz, out_yz};
 
-    result = fastfilters_fir_deriv2d_inner(inarray, sigma_inner, 1, tmpx, tmpy, options);
-    if (!result)
+        result = true;
+        for (unsigned int i = 0; i < 6 && result; ++i)
+            result = axis_convolve3d(&ak, inarray, orders[i][0], orders[i][1], orders[i][2], outs[i], options);
         goto out;
+    }
 
-    fastfilters_combine_mul2d(tmpx, tmpx, tmp);
-    result = fastfilters_fir_convolve2d(tmp, k_smooth, k_smooth, out_xx, options);
-    if (!result)
-        goto out;
+    fastfilters_kernel_fir_t(*k)[3] = ak.k;
 
-    fastfilters_combine_mul2d(tmpy, tmpy, tmp);
-    result = fastfilters_fir_convolve2d(tmp, k_smooth, k_smooth, out_yy, options);
-    if (!result)
-        goto out;
+    // three z passes shared by all six components, the outputs double as z pass intermediates
+    const fastfilters_fir_target3d_t targets[] = {
+        {inarray, k[0][2], k[1][0], k[2][0], out_xx}, {inarray, k[0][0], k[1][2], k[2][0], out_yy},
+        {inarray, k[0][0], k[1][0], k[2][2], out_zz}, {inarray, k[0][1], k[1][1], k[2][0], out_xy},
+        {inarray, k[0][1], k[1][0], k[2][1], out_xz}, {inarray, k[0][0], k[1][1], k[2][1], out_yz},
+    };
 
-    fastfilters_combine_mul2d(tmpx, tmpy, tmp);
-    result = fastfilters_fir_convolve2d(tmp, k_smooth, k_smooth, out_xy, options);
-    if (!result)
-        goto out;
+    result = fastfilters_fir_convolve3d_multi(targets, ARRAY_LENGTH(targets), options);
 
 out:
-    if (k_smooth)
-        fastfilters_kernel_fir_free(k_smooth);
-    if (tmp)
-        fastfilters_array2d_free(tmp);
-    if (tmpx)
-        fastfilters_array2d_free(tmpx);
-    if (tmpy)
-        fastfilters_array2d_free(tmpy);
+    axis_kernels_free(&ak);
     return result;
 }
 
@@ -216,117 +278,64 @@ DLL_PUBLIC bool fastfilters_fir_hog3d(const fastfilters_array3d_t *inarray, doub
                                       fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
                                       fastfilters_array3d_t *out_yz, const fastfilters_options_t *options)
 {
-    bool result = false;
-    fastfilters_kernel_fir_t k_smooth = NULL;
-    fastfilters_kernel_fir_t k_first = NULL;
-    fastfilters_kernel_fir_t k_second = NULL;
-
-    k_smooth = fastfilters_kernel_fir_gaussian(0, sigma, opt_window_ratio(options));
-    if (!k_smooth)
-        goto out;
-
-    k_first = fastfilters_kernel_fir_gaussian(1, sigma, opt_window_ratio(options));
-    if (!k_first)
-        goto out;
-
-    k_second = fastfilters_kernel_fir_gaussian(2, sigma, opt_window_ratio(options));
-    if (!k_second)
-        goto out;
-
-    result = fastfilters_fir_convolve3d(inarray, k_second, k_smooth, k_smooth, out_xx, options);
-    if (!result)
-        goto out;
-
-    result = fastfilters_fir_convolve3d(inarray, k_smooth, k_second, k_smooth, out_yy, options);
-    if (!result)
-        goto out;
+    const double sigmas[] = {sigma, sigma, sigma};
 
-    result = fastfilters_fir_convolve3d(inarray, k_smooth, k_smooth, k_second, out_zz, options);
-    if (!result)
-        goto out;
+    return fastfilters_fir_hog3d_aniso(inarray, sigmas, NULL, out_xx, out_yy, out_zz, out_xy, out_xz, out_yz, options);
+}
 
-    result = fastfilters_fir_convolve3d(inarray, k_first, k_first, k_smooth, out_xy, options);
-    if (!result)
-        goto out;
+bool DLL_PUBLIC fastfilters_fir_gaussian3d_aniso(const fastfilters_array3d_t *inarray, unsigned order,
+                                                 const double *sigmas, const float *window_ratios,
+                                                 fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
+{
+    bool result;
+    axis_kernels_t ak;
 
-    result = fastfilters_fir_convolve3d(inarray, k_first, k_smooth, k_first, out_xz, options);
-    if (!result)
-        goto out;
+    if (order > 2)
+        return false;
+    if (!axis_kernels_init(&ak, 3, 1u << order, sigmas, window_ratios, options))
+        return false;
 
-    result = fastfilters_fir_convolve3d(inarray, k_smooth, k_first, k_first, out_yz, options);
-    if (!result)
-        goto out;
+    result = axis_convolve3d(&ak, inarray, order, order, order, outarray, options);
 
-out:
-    if (k_smooth)
-        fastfilters_kernel_fir_free(k_smooth);
-    if (k_first)
-        fastfilters_kernel_fir_free(k_first);
-    if (k_second)
-        fastfilters_kernel_fir_free(k_second);
+    axis_kernels_free(&ak);
     return result;
 }
 
 bool DLL_PUBLIC fastfilters_fir_gaussian3d(const fastfilters_array3d_t *inarray, unsigned order, double sigma,
                                            fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
 {
-    bool result = false;
-    fastfilters_kernel_fir_t kx = NULL;
-
-    kx = fastfilters_kernel_fir_gaussian(order, sigma, opt_window_ratio(options));
-    if (!kx)
-        goto out;
-
-    result = fastfilters_fir_convolve3d(inarray, kx, kx, kx, outarray, options);
+    const double sigmas[] = {sigma, sigma, sigma};
 
-out:
-    if (kx)
-        fastfilters_kernel_fir_free(kx);
-    return result;
+    return fastfilters_fir_gaussian3d_aniso(inarray, order, sigmas, NULL, outarray, options);
 }
 
-static bool fastfilters_fir_deriv3d_inner(const fastfilters_array3d_t *inarray, double sigma, unsigned order,
-                                          fastfilters_array3d_t *out0, fastfilters_array3d_t *out1,
-                                          fastfilters_array3d_t *out2, const fastfilters_options_t *options)
+static bool fastfilters_fir_deriv3d(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                    const float *window_ratios, unsigned order, fastfilters_array3d_t *outarray,
+                                    bool do_sqrt, const fastfilters_options_t *options)
 {
     bool result = false;
-    fastfilters_kernel_fir_t k_smooth = NULL;
-    fastfilters_kernel_fir_t k_deriv = NULL;
-
-    k_smooth = fastfilters_kernel_fir_gaussian(0, sigma, opt_window_ratio(options));
-    if (!k_smooth)
-        goto out;
+    fastfilters_array3d_t *tmparray0 = NULL;
+    fastfilters_array3d_t *tmparray1 = NULL;
+    axis_kernels_t ak;
 
-    k_deriv = fastfilters_kernel_fir_gaussian(order, sigma, opt_window_ratio(options));
-    if (!k_deriv)
-        goto out;
+    // the output doubles as float intermediate
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32)
+        return false;
 
-    result = fastfilters_fir_convolve3d(inarray, k_deriv, k_smooth, k_smooth, out0, options);
-    if (!result)
-        goto out;
+    if (!axis_kernels_init(&ak, 3, 1u | (1u << order), sigmas, window_ratios, options))
+        return false;
 
-    result = fastfilters_fir_convolve3d(inarray, k_smooth, k_deriv, k_smooth, out1, options);
-    if (!result)
-        goto out;
+    // dense arrays combine the derivatives while they are in cache, see fastfilters_fir_convolve3d_sum
+    if (!ak.use_iir && inarray->ptr != outarray->ptr && inarray->stride_x == inarray->n_channels &&
+        outarray->stride_x == outarray->n_channels && outarray->stride_y == outarray->n_x * outarray->n_channels &&
+        outarray->stride_z == outarray->n_y * outarray->stride_y) {
+        const fastfilters_kernel_fir_t kernels[3][3] = {{ak.k[0][order], ak.k[1][0], ak.k[2][0]},
+                                                        {ak.k[0][0], ak.k[1][order], ak.k[2][0]},
+                                                        {ak.k[0][0], ak.k[1][0], ak.k[2][order]}};
 
-    result = fastfilters_fir_convolve3d(inarray, k_smooth, k_smooth, k_deriv, out2, options);
-    if (!result)
+        result = fastfilters_fir_convolve3d_sum(inarray, kernels, 3, do_sqrt, outarray);
         goto out;
-
-out:
-    if (k_smooth)
-        fastfilters_kernel_fir_free(k_smooth);
-    if (k_deriv)
-        fastfilters_kernel_fir_free(k_deriv);
-    return result;
-}
-
-static bool fastfilters_fir_deriv3d(const fastfilters_array3d_t *inarray, double sigma, unsigned order,
-                                    fastfilters_array3d_t *outarray, bool do_sqrt, const fastfilters_options_t *options)
-{
-    bool result = false;
-    fastfilters_array3d_t *tmparray0 = NULL;
-    fastfilters_array3d_t *tmparray1 = NULL;
+    }
 
     tmparray0 = fastfilters_array3d_alloc(inarray->n_x, inarray->n_y, inarray->n_z, inarray->n_channels);
     if (!tmparray0)
@@ -336,7 +345,15 @@ static bool fastfilters_fir_deriv3d(const fastfilters_array3d_t *inarray, double
     if (!tmparray1)
         goto out;
 
-    result = fastfilters_fir_deriv3d_inner(inarray, sigma, order, outarray, tmparray0, tmparray1, options);
+    result = axis_convolve3d(&ak, inarray, order, 0, 0, outarray, options);
+    if (!result)
+        goto out;
+
+    result = axis_convolve3d(&ak, inarray, 0, order, 0, tmparray0, options);
+    if (!result)
+        goto out;
+
+    result = axis_convolve3d(&ak, inarray, 0, 0, order, tmparray1, options);
     if (!result)
         goto out;
 
@@ -350,91 +367,36 @@ out:
         fastfilters_array3d_free(tmparray0);
     if (tmparray1)
         fastfilters_array3d_free(tmparray1);
+    axis_kernels_free(&ak);
     return result;
 }
 
+bool DLL_PUBLIC fastfilters_fir_gradmag3d_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                const float *window_ratios, fastfilters_array3d_t *outarray,
+                                                const fastfilters_options_t *options)
+{
+    return fastfilters_fir_deriv3d(inarray, sigmas, window_ratios, 1, outarray, true, options);
+}
+
 bool DLL_PUBLIC fastfilters_fir_gradmag3d(const fastfilters_array3d_t *inarray, double sigma,
                                           fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
 {
-    return fastfilters_fir_deriv3d(inarray, sigma, 1, outarray, true, options);
+    const double sigmas[] = {sigma, sigma, sigma};
+
+    return fastfilters_fir_deriv3d(inarray, sigmas, NULL, 1, outarray, true, options);
 }
 
-bool DLL_PUBLIC fastfilters_fir_laplacian3d(const fastfilters_array3d_t *inarray, double sigma,
-                                            fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
+bool DLL_PUBLIC fastfilters_fir_laplacian3d_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                  const float *window_ratios, fastfilters_array3d_t *outarray,
+                                                  const fastfilters_options_t *options)
 {
-    return fastfilters_fir_deriv3d(inarray, sigma, 2, outarray, false, options);
+    return fastfilters_fir_deriv3d(inarray, sigmas, window_ratios, 2, outarray, false, options);
 }
 
-bool DLL_PUBLIC fastfilters_fir_structure_tensor3d(const fastfilters_array3d_t *inarray, double sigma_outer,
-                                                   double sigma_inner, fastfilters_array3d_t *out_xx,
-                                                   fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
-                                                   fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
-                                                   fastfilters_array3d_t *out_yz, const fastfilters_options_t *options)
+bool DLL_PUBLIC fastfilters_fir_laplacian3d(const fastfilters_array3d_t *inarray, double sigma,
+                                            fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
 {
-    bool result = false;
-    fastfilters_array3d_t *tmpx = NULL;
-    fastfilters_array3d_t *tmpy = NULL;
-    fastfilters_array3d_t *tmpz = NULL;
-    fastfilters_array3d_t *tmp = NULL;
-
-    tmp = fastfilters_array3d_alloc(inarray->n_x, inarray->n_y, inarray->n_z, inarray->n_channels);
-    if (!tmp)
-        goto out;
-
-    tmpx = fastfilters_array3d_alloc(inarray->n_x, inarray->n_y, inarray->n_z, inarray->n_channels);
-    if (!tmpx)
-        goto out;
-
-    tmpy = fastfilters_array3d_alloc(inarray->n_x, inarray->n_y, inarray->n_z, inarray->n_channels);
-    if (!tmpy)
-        goto out;
-
-    tmpz = fastfilters_array3d_alloc(inarray->n_x, inarray->n_y, inarray->n_z, inarray->n_channels);
-    if (!tmpz)
-        goto out;
-
-    result = fastfilters_fir_deriv3d_inner(inarray, sigma_inner, 1, tmpx, tmpy, tmpz, options);
-    if (!result)
-        goto out;
+    const double sigmas[] = {sigma, sigma, sigma};
 
-    fastfilters_combine_mul3d(tmpx, tmpx, tmp);
-    result = fastfilters_fir_gaussian3d(tmp, 0, sigma_outer, out_xx, options);
-    if (!result)
-        goto out;
-
-    fastfilters_combine_mul3d(tmpy, tmpy, tmp);
-    result = fastfilters_fir_gaussian3d(tmp, 0, sigma_outer, out_yy, options);
-    if (!result)
-        goto out;
-
-    fastfilters_combine_mul3d(tmpz, tmpz, tmp);
-    result = fastfilters_fir_gaussian3d(tmp, 0, sigma_outer, out_zz, options);
-    if (!result)
-        goto out;
-
-    fastfilters_combine_mul3d(tmpx, tmpy, tmp);
-    result = fastfilters_fir_gaussian3d(tmp, 0, sigma_outer, out_xy, options);
-    if (!result)
-        goto out;
-
-    fastfilters_combine_mul3d(tmpx, tmpz, tmp);
-    result = fastfilters_fir_gaussian3d(tmp, 0, sigma_outer, out_xz, options);
-    if (!result)
-        goto out;
-
-    fastfilters_combine_mul3d(tmpy, tmpz, tmp);
-    result = fastfilters_fir_gaussian3d(tmp, 0, sigma_outer, out_yz, options);
-    if (!result)
-        goto out;
-
-out:
-    if (tmp)
-        fastfilters_array3d_free(tmp);
-    if (tmpx)
-        fastfilters_array3d_free(tmpx);
-    if (tmpy)
-        fastfilters_array3d_free(tmpy);
-    if (tmpz)
-        fastfilters_array3d_free(tmpz);
-    return result;
-}
\ No newline at end of file
+    return fastfilters_fir_deriv3d(inarray, sigmas, NULL, 2, outarray, false, options);
+}
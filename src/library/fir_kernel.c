@@ -55,8 +55,57 @@
 #include "fastfilters.h"
 #include "common.h"
 
-fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_gaussian(unsigned int order, double sigma,
-                                                                    float window_ratio)
+#include <string.h>
+
+#include "parallel.h"
+
+typedef struct {
+    unsigned int order;
+    double sigma;
+    float window_ratio;
+    unsigned long last_use;
+    fastfilters_kernel_fir_t kernel;
+} kernel_cache_entry_t;
+
+static mutex_t g_cache_lock = MUTEX_INITIALIZER;
+static kernel_cache_entry_t g_cache[FF_KERNEL_CACHE_SIZE];
+static unsigned long g_cache_clock = 0;
+
+static void kernel_fir_destroy(fastfilters_kernel_fir_t kernel)
+{
+    if (kernel->odd)
+        kernel_fir_destroy(kernel->odd);
+    fastfilters_memory_free(kernel->coefs);
+    fastfilters_memory_free(kernel);
+}
+
+// called with g_cache_lock held, returns true if the kernel has no owners left and has to be destroyed
+static bool kernel_fir_unref(fastfilters_kernel_fir_t kernel)
+{
+    return --kernel->refcount == 0;
+}
+
+static fastfilters_kernel_fir_t kernel_fir_alloc(size_t len, bool is_symmetric)
+{
+    fastfilters_kernel_fir_t kernel = fastfilters_memory_alloc(sizeof(struct _fastfilters_kernel_fir_t));
+    if (!kernel)
+        return NULL;
+
+    kernel->coefs = fastfilters_memory_alloc(sizeof(float) * (len + 1));
+    if (!kernel->coefs) {
+        fastfilters_memory_free(kernel);
+        return NULL;
+    }
+
+    kernel->len = len;
+    kernel->is_symmetric = is_symmetric;
+    kernel->odd = NULL;
+    kernel->refcount = 1;
+
+    return kernel;
+}
+
+static fastfilters_kernel_fir_t kernel_fir_gaussian_create(unsigned int order, double sigma, float window_ratio)
 {
     double norm;
     double sigma2 = -0.5 / sigma / sigma;
@@ -67,28 +116,18 @@ fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_gaussian(unsigned int
     if (sigma < 0)
         return NULL;
 
-    fastfilters_kernel_fir_t kernel = fastfilters_memory_alloc(sizeof(struct _fastfilters_kernel_fir_t));
-    if (!kernel)
-        return NULL;
-
+    size_t len;
     if (window_ratio > 0)
-        kernel->len = floor(window_ratio * sigma + 0.5);
+        len = floor(window_ratio * sigma + 0.5);
     else
-        kernel->len = ceil((3.0 + 0.5 * (double)order) * sigma);
+        len = ceil((3.0 + 0.5 * (double)order) * sigma);
 
     if (fabs(sigma) < 1e-6)
-        kernel->len = 0;
+        len = 0;
 
-    kernel->coefs = fastfilters_memory_alloc(sizeof(float) * (kernel->len + 1));
-    if (!kernel->coefs) {
-        fastfilters_memory_free(kernel);
+    fastfilters_kernel_fir_t kernel = kernel_fir_alloc(len, order != 1);
+    if (!kernel)
         return NULL;
-    }
-
-    if (order == 1)
-        kernel->is_symmetric = false;
-    else
-        kernel->is_symmetric = true;
 
     switch (order) {
     case 1:
@@ -159,20 +198,197 @@ fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_gaussian(unsigned int
         for (unsigned int x = 0; x <= kernel->len; ++x)
             kernel->coefs[x] *= -1;
 
-    kernel->fn_inner_mirror = NULL;
-    kernel->fn_inner_ptr = NULL;
-    kernel->fn_inner_optimistic = NULL;
-    kernel->fn_outer_mirror = NULL;
-    kernel->fn_outer_ptr = NULL;
-    kernel->fn_outer_optimistic = NULL;
+    fastfilters_fir_resolve(kernel);
+
+    return kernel;
+}
+
+// called with g_cache_lock held
+static kernel_cache_entry_t *kernel_cache_find(unsigned int order, double sigma, float window_ratio)
+{
+    for (unsigned int i = 0; i < FF_KERNEL_CACHE_SIZE; ++i) {
+        kernel_cache_entry_t *entry = &g_cache[i];
+
+        if (entry->kernel && entry->order == order && entry->sigma == sigma && entry->window_ratio == window_ratio)
+            return entry;
+    }
+
+    return NULL;
+}
+
+fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_gaussian(unsigned int order, double sigma,
+                                                                    float window_ratio)
+{
+    fastfilters_kernel_fir_t kernel = NULL;
+    fastfilters_kernel_fir_t evicted = NULL;
+
+    mutex_lock(&g_cache_lock);
+    kernel_cache_entry_t *entry = kernel_cache_find(order, sigma, window_ratio);
+    if (entry) {
+        entry->last_use = ++g_cache_clock;
+        entry->kernel->refcount++;
+        kernel = entry->kernel;
+    }
+    mutex_unlock(&g_cache_lock);
+
+    if (kernel)
+        return kernel;
+
+    kernel = kernel_fir_gaussian_create(order, sigma, window_ratio);
+    if (!kernel)
+        return NULL;
+
+    mutex_lock(&g_cache_lock);
+    entry = kernel_cache_find(order, sigma, window_ratio);
+    if (entry) {
+        // another thread was faster
+        evicted = kernel;
+        kernel = entry->kernel;
+        kernel->refcount++;
+    } else {
+        entry = &g_cache[0];
+        for (unsigned int i = 1; i < FF_KERNEL_CACHE_SIZE && entry->kernel; ++i)
+            if (!g_cache[i].kernel || g_cache[i].last_use < entry->last_use)
+                entry = &g_cache[i];
+
+        if (entry->kernel && kernel_fir_unref(entry->kernel))
+            evicted = entry->kernel;
+
+        entry->order = order;
+        entry->sigma = sigma;
+        entry->window_ratio = window_ratio;
+        entry->kernel = kernel;
+        kernel->refcount++;
+    }
+    entry->last_use = ++g_cache_clock;
+    mutex_unlock(&g_cache_lock);
+
+    if (evicted)
+        kernel_fir_destroy(evicted);
+
+    return kernel;
+}
+
+void DLL_PUBLIC fastfilters_kernel_cache_invalidate(unsigned int order, double sigma, float window_ratio)
+{
+    fastfilters_kernel_fir_t evicted = NULL;
+
+    mutex_lock(&g_cache_lock);
+    kernel_cache_entry_t *entry = kernel_cache_find(order, sigma, window_ratio);
+    if (entry) {
+        if (kernel_fir_unref(entry->kernel))
+            evicted = entry->kernel;
+        entry->kernel = NULL;
+    }
+    mutex_unlock(&g_cache_lock);
+
+    if (evicted)
+        kernel_fir_destroy(evicted);
+}
+
+void DLL_PUBLIC fastfilters_kernel_cache_clear(void)
+{
+    fastfilters_kernel_fir_t evicted[FF_KERNEL_CACHE_SIZE];
+    unsigned int n_evicted = 0;
+
+    mutex_lock(&g_cache_lock);
+    for (unsigned int i = 0; i < FF_KERNEL_CACHE_SIZE; ++i) {
+        if (g_cache[i].kernel && kernel_fir_unref(g_cache[i].kernel))
+            evicted[n_evicted++] = g_cache[i].kernel;
+        g_cache[i].kernel = NULL;
+    }
+    mutex_unlock(&g_cache_lock);
+
+    for (unsigned int i = 0; i < n_evicted; ++i)
+        kernel_fir_destroy(evicted[i]);
+}
+
+bool fastfilters_kernel_fir_equal(const fastfilters_kernel_fir_t a, const fastfilters_kernel_fir_t b)
+{
+    if (a == b)
+        return true;
+
+    if (a->len != b->len || a->is_symmetric != b->is_symmetric)
+        return false;
+
+    if ((a->odd == NULL) != (b->odd == NULL) || (a->odd && !fastfilters_kernel_fir_equal(a->odd, b->odd)))
+        return false;
+
+    return memcmp(a->coefs, b->coefs, (a->len + 1) * sizeof(float)) == 0;
+}
+
+fastfilters_kernel_fir_t DLL_PUBLIC fastfilters_kernel_fir_create(const float *coefs, unsigned int len,
+                                                                  fastfilters_kernel_symmetry_t symmetry)
+{
+    fastfilters_kernel_fir_t kernel = NULL;
+
+    if (len == 0 || !coefs)
+        return NULL;
+
+    switch (symmetry) {
+    case FASTFILTERS_KERNEL_SYMMETRIC:
+    case FASTFILTERS_KERNEL_ANTISYMMETRIC:
+        kernel = kernel_fir_alloc(len, symmetry == FASTFILTERS_KERNEL_SYMMETRIC);
+        if (!kernel)
+            return NULL;
+
+        memcpy(kernel->coefs, coefs, (len + 1) * sizeof(float));
+        break;
+
+    case FASTFILTERS_KERNEL_GENERAL: {
+        const float *center = coefs + len;
+        bool is_even = true;
+        bool is_odd = true;
+
+        for (unsigned int k = 1; k <= len; ++k) {
+            is_even = is_even && center[k] == center[-(ptrdiff_t)k];
+            is_odd = is_odd && center[k] == -center[-(ptrdiff_t)k];
+        }
+
+        // kernels that turn out to be (anti)symmetric don't need the second pass
+        if (is_even)
+            return fastfilters_kernel_fir_create(center, len, FASTFILTERS_KERNEL_SYMMETRIC);
+        if (is_odd)
+            return fastfilters_kernel_fir_create(center, len, FASTFILTERS_KERNEL_ANTISYMMETRIC);
+
+        kernel = kernel_fir_alloc(len, true);
+        if (!kernel)
+            return NULL;
+
+        kernel->odd = kernel_fir_alloc(len, false);
+        if (!kernel->odd) {
+            kernel_fir_destroy(kernel);
+            return NULL;
+        }
+
+        kernel->coefs[0] = center[0];
+        kernel->odd->coefs[0] = 0.0;
+        for (unsigned int k = 1; k <= len; ++k) {
+            kernel->coefs[k] = 0.5f * (center[k] + center[-(ptrdiff_t)k]);
+            kernel->odd->coefs[k] = 0.5f * (center[k] - center[-(ptrdiff_t)k]);
+        }
+
+        fastfilters_fir_resolve(kernel->odd);
+        break;
+    }
+
+    default:
+        return NULL;
+    }
+
+    fastfilters_fir_resolve(kernel);
 
     return kernel;
 }
 
 void DLL_PUBLIC fastfilters_kernel_fir_free(fastfilters_kernel_fir_t kernel)
 {
-    fastfilters_memory_free(kernel->coefs);
-    fastfilters_memory_free(kernel);
+    mutex_lock(&g_cache_lock);
+    const bool destroy = kernel_fir_unref(kernel);
+    mutex_unlock(&g_cache_lock);
+
+    if (destroy)
+        kernel_fir_destroy(kernel);
 }
 
 unsigned int DLL_PUBLIC fastfilters_kernel_fir_get_length(fastfilters_kernel_fir_t kernel)
@@ -0,0 +1,242 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fastfilters.h"
+#include "common.h"
+
+// A scale space is built incrementally: gaussians form a semigroup, so level k is level k - 1 smoothed with sigma
+// sqrt(sigmas[k]^2 - sigmas[k - 1]^2). That kernel is much shorter than the one of sigmas[k], but sampled gaussians
+// are poor approximations for tiny sigmas, so levels whose step falls below FF_SCALE_SPACE_MIN_STEP are smoothed
+// from the input instead. Float32 stacks are built in their output, everything else keeps the last level in scratch.
+
+typedef struct {
+    unsigned int ndim;
+    const fastfilters_array2d_t *in2d;
+    const fastfilters_array3d_t *in3d;
+    size_t n_pixels;
+    fastfilters_type_t out_type;
+    const fastfilters_options_t *options;
+} ss_t;
+
+static fastfilters_array2d_t ss_array2d(const ss_t *ss, void *ptr, fastfilters_type_t type)
+{
+    const fastfilters_array2d_t *in = ss->in2d;
+    fastfilters_array2d_t a = {.ptr = ptr,
+                               .n_x = in->n_x,
+                               .n_y = in->n_y,
+                               .stride_x = in->n_channels,
+                               .stride_y = in->n_x * in->n_channels,
+                               .n_channels = in->n_channels,
+                               .type = type};
+    return a;
+}
+
+static fastfilters_array3d_t ss_array3d(const ss_t *ss, void *ptr, fastfilters_type_t type)
+{
+    const fastfilters_array3d_t *in = ss->in3d;
+    fastfilters_array3d_t a = {.ptr = ptr,
+                               .n_x = in->n_x,
+                               .n_y = in->n_y,
+                               .n_z = in->n_z,
+                               .stride_x = in->n_channels,
+                               .stride_y = in->n_x * in->n_channels,
+                               .stride_z = in->n_y * in->n_x * in->n_channels,
+                               .n_channels = in->n_channels,
+                               .type = type};
+    return a;
+}
+
+static void *ss_output(const ss_t *ss, void *outptr, size_t index)
+{
+    return (char *)outptr + index * ss->n_pixels * fastfilters_type_size(ss->out_type);
+}
+
+// smooths src (the input if NULL) into the float array out and, if typed is not NULL, into that output as well; both
+// targets share all 1D passes
+static bool ss_smooth(const ss_t *ss, float *src, double sigma, float *out, void *typed)
+{
+    bool result = false;
+    fastfilters_kernel_fir_t kernel = fastfilters_kernel_fir_gaussian(0, sigma, opt_window_ratio(ss->options));
+    if (!kernel)
+        return false;
+
+    const size_t n_targets = typed ? 2 : 1;
+
+    if (ss->ndim == 2) {
+        fastfilters_array2d_t in = src ? ss_array2d(ss, src, FASTFILTERS_TYPE_FLOAT32) : *ss->in2d;
+        fastfilters_array2d_t outs[2] = {ss_array2d(ss, out, FASTFILTERS_TYPE_FLOAT32),
+                                         ss_array2d(ss, typed, ss->out_type)};
+        fastfilters_fir_target2d_t targets[2] = {{.in = &in, .kx = kernel, .ky = kernel, .out = &outs[0]},
+                                                 {.in = &in, .kx = kernel, .ky = kernel, .out = &outs[1]}};
+
+        result = fastfilters_fir_convolve2d_multi(targets, n_targets, ss->options);
+    } else {
+        fastfilters_array3d_t in = src ? ss_array3d(ss, src, FASTFILTERS_TYPE_FLOAT32) : *ss->in3d;
+        fastfilters_array3d_t outs[2] = {ss_array3d(ss, out, FASTFILTERS_TYPE_FLOAT32),
+                                         ss_array3d(ss, typed, ss->out_type)};
+        fastfilters_fir_target3d_t targets[2] = {
+            {.in = &in, .kx = kernel, .ky = kernel, .kz = kernel, .out = &outs[0]},
+            {.in = &in, .kx = kernel, .ky = kernel, .kz = kernel, .out = &outs[1]}};
+
+        result = fastfilters_fir_convolve3d_multi(targets, n_targets, ss->options);
+    }
+
+    fastfilters_kernel_fir_free(kernel);
+    return result;
+}
+
+// stores next - level as output index and then moves next into level; next may be that output itself
+static void ss_difference(const ss_t *ss, float *level, const float *next, void *outptr, size_t index)
+{
+    float diff[FF_STORE_BLOCK];
+
+    for (size_t i = 0; i < ss->n_pixels; i += FF_STORE_BLOCK) {
+        size_t n = ss->n_pixels - i;
+        if (n > FF_STORE_BLOCK)
+            n = FF_STORE_BLOCK;
+
+        for (size_t j = 0; j < n; ++j) {
+            const float v = next[i + j];
+            diff[j] = v - level[i + j];
+            level[i + j] = v;
+        }
+
+        fastfilters_type_store(diff, n, outptr, ss->out_type, index * ss->n_pixels + i);
+    }
+}
+
+static bool ss_run(const ss_t *ss, const double *sigmas, size_t n_scales, bool dog, void *outptr)
+{
+    bool result = false;
+    float *level = NULL, *next = NULL;
+    const bool direct = ss->out_type == FASTFILTERS_TYPE_FLOAT32;
+
+    if (!fastfilters_type_is_output(ss->out_type))
+        return false;
+    for (size_t k = 0; k < n_scales; ++k)
+        if (!(sigmas[k] > 0.0) || (k > 0 && !(sigmas[k] > sigmas[k - 1])))
+            return false;
+    if (n_scales < (dog ? 2u : 1u))
+        return true;
+
+    // level holds the last smoothing; differences of typed outputs need a second scratch array for the next one
+    if (dog || !direct) {
+        level = fastfilters_memory_align(32, ss->n_pixels * sizeof(float));
+        if (!level)
+            goto out;
+    }
+    if (dog && !direct) {
+        next = fastfilters_memory_align(32, ss->n_pixels * sizeof(float));
+        if (!next)
+            goto out;
+    }
+
+    float *prev = NULL;
+    for (size_t k = 0; k < n_scales; ++k) {
+        float *src = prev;
+        double sigma = sigmas[k];
+
+        if (k > 0) {
+            const double step = sqrt(sigmas[k] * sigmas[k] - sigmas[k - 1] * sigmas[k - 1]);
+            if (step >= FF_SCALE_SPACE_MIN_STEP)
+                sigma = step;
+            else
+                src = NULL;
+        }
+
+        if (!dog) {
+            // float32 stacks keep the last level in the output, typed ones in scratch (smoothed in place)
+            if (direct) {
+                prev = ss_output(ss, outptr, k);
+                if (!ss_smooth(ss, src, sigma, prev, NULL))
+                    goto out;
+            } else {
+                prev = level;
+                if (!ss_smooth(ss, src, sigma, level, ss_output(ss, outptr, k)))
+                    goto out;
+            }
+        } else if (k == 0) {
+            prev = level;
+            if (!ss_smooth(ss, NULL, sigma, level, NULL))
+                goto out;
+        } else {
+            float *dst = direct ? ss_output(ss, outptr, k - 1) : next;
+            if (!ss_smooth(ss, src, sigma, dst, NULL))
+                goto out;
+            ss_difference(ss, level, dst, outptr, k - 1);
+        }
+    }
+
+    result = true;
+
+out:
+    if (level)
+        fastfilters_memory_align_free(level);
+    if (next)
+        fastfilters_memory_align_free(next);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_scale_space2d_ex(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                 size_t n_scales, bool dog, void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options)
+{
+    ss_t ss = {.ndim = 2,
+               .in2d = inarray,
+               .in3d = NULL,
+               .n_pixels = inarray->n_x * inarray->n_y * inarray->n_channels,
+               .out_type = out_type,
+               .options = options};
+
+    return ss_run(&ss, sigmas, n_scales, dog, outptr);
+}
+
+bool DLL_PUBLIC fastfilters_fir_scale_space3d_ex(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                 size_t n_scales, bool dog, void *outptr, fastfilters_type_t out_type,
+                                                 const fastfilters_options_t *options)
+{
+    ss_t ss = {.ndim = 3,
+               .in2d = NULL,
+               .in3d = inarray,
+               .n_pixels = inarray->n_x * inarray->n_y * inarray->n_z * inarray->n_channels,
+               .out_type = out_type,
+               .options = options};
+
+    return ss_run(&ss, sigmas, n_scales, dog, outptr);
+}
+
+bool DLL_PUBLIC fastfilters_fir_scale_space2d(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                              size_t n_scales, bool dog, float *outptr,
+                                              const fastfilters_options_t *options)
+{
+    return fastfilters_fir_scale_space2d_ex(inarray, sigmas, n_scales, dog, outptr, FASTFILTERS_TYPE_FLOAT32,
+                                            options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_scale_space3d(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                              size_t n_scales, bool dog, float *outptr,
+                                              const fastfilters_options_t *options)
+{
+    return fastfilters_fir_scale_space3d_ex(inarray, sigmas, n_scales, dog, outptr, FASTFILTERS_TYPE_FLOAT32,
+                                            options);
+}
@@ -0,0 +1,1117 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "fastfilters.h"
+#include "common.h"
+
+// Streaming structure tensor and Hessian.
+//
+// The image is processed in batches of output slices along its last axis (rows in 2D, planes in 3D). Two slabs of
+// slices slide along that axis: the first holds the input filtered within each slice (derivative along one axis,
+// smoothing along the others), the second the gradient products, already smoothed within each slice by the outer
+// kernel. The last axis pass of the gradients writes straight into the product slab and the last axis pass of the
+// outer smoothing straight into the outputs. Both use the optimistic border because slices outside of the image
+// are mirrored copies inside the slabs, so scratch memory only depends on the slice size and the kernel radii.
+//
+// The Hessian fills the tensor slab straight from the input with the second derivatives taken within each slice and
+// only needs the last axis pass. Eigenvalue outputs replace the tensor outputs: the last axis pass then runs on tiles
+// of a few slices and columns that are turned into eigenvalues while they are in cache, so the tensor never exists
+// at full size. Hessian measures go one step further and reduce the eigenvalues of each tile to a single value that is
+// kept as running maximum over the scales.
+
+// output slices per batch, at least twice the combined kernel radii so that shifting the slabs stays cheap
+#define ST_MIN_BATCH 8
+
+typedef struct {
+    float *ptr;
+    size_t capacity;
+    size_t n_components;
+    // slab index of the first slice (negative in front of the image) and number of slices present
+    ptrdiff_t base;
+    size_t count;
+} st_slab_t;
+
+typedef struct {
+    unsigned int ndim;
+    size_t n_slices;
+    size_t n_x;
+    size_t n_rows;
+    size_t row_len;
+    size_t slice_len;
+
+    const void *inptr;
+    fastfilters_type_t in_type;
+    size_t in_stride_x;
+    size_t in_stride_row;
+    size_t in_stride_slice;
+
+    size_t n_tensor;
+    float *outptr[6];
+    size_t out_stride_slice[6];
+
+    // eigenvalue outputs instead of the tensor outputs
+    bool eigenvalues;
+    void *evptr[3];
+    size_t ev_stride_slice[3];
+    fastfilters_type_t ev_type;
+    // optional eigenvectors along with the eigenvalues, component j of vector k at k * ndim + j in matrix row order
+    bool vectors;
+    void *vecptr[9];
+    size_t vec_stride_slice[9];
+    // Hessian measure of the eigenvalues written to outptr[0] instead, combined by maximum with its contents unless
+    // this is the first scale
+    const fastfilters_hessian_measure_t *measure;
+    float measure_norm;
+    bool measure_max;
+
+    // per axis kernels, x first
+    bool hessian;
+    fastfilters_kernel_fir_t k_smooth[3];
+    fastfilters_kernel_fir_t k_deriv[3];
+    fastfilters_kernel_fir_t k_outer[3];
+    fastfilters_kernel_fir_t k_hessian[3][3];
+    // last axis pass of each tensor component
+    fastfilters_kernel_fir_t k_last[6];
+
+    st_slab_t grad;
+    st_slab_t tensor;
+    float *scratch;
+} st_t;
+
+// gradient products as (a, b, tensor component); cross products first because the squares overwrite the gradients
+static const unsigned int g_products2d[][3] = {{0, 1, 2}, {0, 0, 0}, {1, 1, 1}};
+static const unsigned int g_products3d[][3] = {{0, 1, 3}, {0, 2, 4}, {1, 2, 5}, {0, 0, 0}, {1, 1, 1}, {2, 2, 2}};
+
+static size_t st_mirror(ptrdiff_t i, size_t n)
+{
+    if (n == 1)
+        return 0;
+
+    const ptrdiff_t period = 2 * (ptrdiff_t)(n - 1);
+    i %= period;
+    if (i < 0)
+        i += period;
+
+    return i < (ptrdiff_t)n ? (size_t)i : (size_t)(period - i);
+}
+
+static float *st_slice(const st_t *st, const st_slab_t *slab, size_t component, ptrdiff_t i)
+{
+    return slab->ptr + (component * slab->capacity + (size_t)(i - slab->base)) * st->slice_len;
+}
+
+static bool st_slab_alloc(const st_t *st, st_slab_t *slab, size_t n_components, size_t capacity)
+{
+    slab->n_components = n_components;
+    slab->capacity = capacity;
+    slab->base = 0;
+    slab->count = 0;
+    slab->ptr = fastfilters_memory_align(32, n_components * capacity * st->slice_len * sizeof(float));
+
+    return slab->ptr != NULL;
+}
+
+// drops all slices in front of base
+static void st_slab_shift(const st_t *st, st_slab_t *slab, ptrdiff_t base)
+{
+    const ptrdiff_t end = slab->base + (ptrdiff_t)slab->count;
+
+    if (base >= end) {
+        slab->count = 0;
+    } else if (base > slab->base) {
+        const size_t shift = (size_t)(base - slab->base);
+
+        for (size_t c = 0; c < slab->n_components; ++c)
+            memmove(slab->ptr + c * slab->capacity * st->slice_len,
+                    slab->ptr + (c * slab->capacity + shift) * st->slice_len,
+                    (slab->count - shift) * st->slice_len * sizeof(float));
+        slab->count -= shift;
+    }
+
+    slab->base = base;
+}
+
+// slices [begin, end) outside of the image become copies of the slices they mirror, which are in the slab already
+static void st_slab_mirror(const st_t *st, st_slab_t *slab, ptrdiff_t begin, ptrdiff_t end)
+{
+    for (ptrdiff_t i = begin; i < end; ++i) {
+        if (i >= 0 && i < (ptrdiff_t)st->n_slices)
+            continue;
+
+        const ptrdiff_t src = (ptrdiff_t)st_mirror(i, st->n_slices);
+        for (size_t c = 0; c < slab->n_components; ++c)
+            memcpy(st_slice(st, slab, c, i), st_slice(st, slab, c, src), st->slice_len * sizeof(float));
+    }
+
+    slab->count = (size_t)(end - slab->base);
+}
+
+// x pass of n slices of elements of type into dense slices
+static bool st_pass_x(const st_t *st, const void *in, fastfilters_type_t type, size_t stride_x, size_t stride_row,
+                      size_t stride_slice, size_t n, float *out, fastfilters_kernel_fir_t kernel)
+{
+    if (stride_slice == st->n_rows * stride_row)
+        return fastfilters_fir_pass_inner(in, type, st->n_x, stride_x, n * st->n_rows, stride_row, out, st->row_len,
+                                          kernel);
+
+    for (size_t i = 0; i < n; ++i)
+        if (!fastfilters_fir_pass_inner((const char *)in + i * stride_slice * fastfilters_type_size(type), type,
+                                        st->n_x, stride_x, st->n_rows, stride_row, out + i * st->slice_len,
+                                        st->row_len, kernel))
+            return false;
+
+    return true;
+}
+
+// y pass of n dense 3D slices, may run in place
+static bool st_pass_y(const st_t *st, const float *in, size_t n, float *out, fastfilters_kernel_fir_t kernel)
+{
+    return fastfilters_fir_pass_outer(in, st->n_rows, st->row_len, st->row_len, out, st->row_len, kernel, n,
+                                      st->slice_len, FASTFILTERS_BORDER_MIRROR);
+}
+
+// input slices [begin, end) filtered within the slice: component i is derived along axis i and smoothed along the
+// other in-slice axes, the last component is only smoothed
+static bool st_fill_grad(st_t *st, ptrdiff_t begin, ptrdiff_t end)
+{
+    const st_slab_t *grad = &st->grad;
+    const void *in = (const char *)st->inptr + (size_t)begin * st->in_stride_slice * fastfilters_type_size(st->in_type);
+    const size_t n = (size_t)(end - begin);
+    float *g0 = st_slice(st, grad, 0, begin);
+    float *g1 = st_slice(st, grad, 1, begin);
+
+    if (!st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, g0, st->k_deriv[0]))
+        return false;
+
+    if (st->ndim == 2)
+        return st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, g1,
+                         st->k_smooth[0]);
+
+    float *g2 = st_slice(st, grad, 2, begin);
+
+    if (!st_pass_y(st, g0, n, g0, st->k_smooth[1]))
+        return false;
+    if (!st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, g2,
+                   st->k_smooth[0]))
+        return false;
+    if (!st_pass_y(st, g2, n, g1, st->k_deriv[1]))
+        return false;
+    return st_pass_y(st, g2, n, g2, st->k_smooth[1]);
+}
+
+static fastfilters_array2d_t st_line(const float *ptr, size_t len)
+{
+    fastfilters_array2d_t a = {
+        .ptr = (float *)ptr, .n_x = len, .n_y = 1, .stride_x = 1, .stride_y = len, .n_channels = 1};
+    return a;
+}
+
+static void st_mul(const float *a, const float *b, float *out, size_t len)
+{
+    fastfilters_array2d_t va = st_line(a, len), vb = st_line(b, len), vout = st_line(out, len);
+
+    fastfilters_combine_mul2d(&va, &vb, &vout);
+}
+
+// tensor slices [begin, end) inside of the image: gradients, their products and the in-slice outer smoothing
+static bool st_fill_tensor(st_t *st, ptrdiff_t begin, ptrdiff_t end)
+{
+    const fastfilters_kernel_fir_t k_smooth = st->k_smooth[st->ndim - 1];
+    const fastfilters_kernel_fir_t k_deriv = st->k_deriv[st->ndim - 1];
+    const ptrdiff_t radius = (ptrdiff_t)(k_smooth->len > k_deriv->len ? k_smooth->len : k_deriv->len);
+    const ptrdiff_t grad_end = end + radius;
+    const size_t n = (size_t)(end - begin);
+
+    st_slab_shift(st, &st->grad, begin - radius);
+
+    const ptrdiff_t grad_filled = st->grad.base + (ptrdiff_t)st->grad.count;
+    const ptrdiff_t real_begin = grad_filled > 0 ? grad_filled : 0;
+    const ptrdiff_t real_end = grad_end < (ptrdiff_t)st->n_slices ? grad_end : (ptrdiff_t)st->n_slices;
+
+    if (real_begin < real_end && !st_fill_grad(st, real_begin, real_end))
+        return false;
+    st_slab_mirror(st, &st->grad, grad_filled, grad_end);
+
+    for (unsigned int i = 0; i < st->ndim; ++i) {
+        fastfilters_kernel_fir_t kernel = i == st->ndim - 1 ? k_deriv : k_smooth;
+
+        if (!fastfilters_fir_pass_outer(st_slice(st, &st->grad, i, begin), n, st->slice_len, st->slice_len,
+                                        st_slice(st, &st->tensor, i, begin), st->slice_len, kernel, 1, 0,
+                                        FASTFILTERS_BORDER_OPTIMISTIC))
+            return false;
+    }
+
+    const unsigned int(*products)[3] = st->ndim == 2 ? g_products2d : g_products3d;
+
+    for (unsigned int i = 0; i < st->n_tensor; ++i) {
+        float *out = st_slice(st, &st->tensor, products[i][2], begin);
+
+        st_mul(st_slice(st, &st->tensor, products[i][0], begin), st_slice(st, &st->tensor, products[i][1], begin),
+               st->scratch, n * st->slice_len);
+
+        if (!st_pass_x(st, st->scratch, FASTFILTERS_TYPE_FLOAT32, st->row_len / st->n_x, st->row_len, st->slice_len,
+                       n, out, st->k_outer[0]))
+            return false;
+        if (st->ndim == 3 && !st_pass_y(st, out, n, out, st->k_outer[1]))
+            return false;
+    }
+
+    return true;
+}
+
+// Hessian slices [begin, end) filtered within the slice; in 3D one x pass per derivative order feeds the y passes
+static bool st_fill_hessian(st_t *st, ptrdiff_t begin, ptrdiff_t end)
+{
+    const void *in = (const char *)st->inptr + (size_t)begin * st->in_stride_slice * fastfilters_type_size(st->in_type);
+    const size_t n = (size_t)(end - begin);
+    const fastfilters_kernel_fir_t(*k)[3] = st->k_hessian;
+    float *t[6];
+
+    for (size_t i = 0; i < st->n_tensor; ++i)
+        t[i] = st_slice(st, &st->tensor, i, begin);
+
+    // xx, yy, xy
+    if (st->ndim == 2)
+        return st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, t[0],
+                         k[0][2]) &&
+               st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, t[1],
+                         k[0][0]) &&
+               st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, t[2],
+                         k[0][1]);
+
+    // xx, yy, zz, xy, xz, yz
+    if (!st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, t[0], k[0][2]) ||
+        !st_pass_y(st, t[0], n, t[0], k[1][0]))
+        return false;
+
+    if (!st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, t[4], k[0][1]) ||
+        !st_pass_y(st, t[4], n, t[3], k[1][1]) || !st_pass_y(st, t[4], n, t[4], k[1][0]))
+        return false;
+
+    return st_pass_x(st, in, st->in_type, st->in_stride_x, st->in_stride_row, st->in_stride_slice, n, t[2],
+                     k[0][0]) &&
+           st_pass_y(st, t[2], n, t[1], k[1][2]) && st_pass_y(st, t[2], n, t[5], k[1][1]) &&
+           st_pass_y(st, t[2], n, t[2], k[1][0]);
+}
+
+static void st_store_measure(const st_t *st, const float *const *t, size_t z, size_t x, size_t len)
+{
+    float block[3][FF_STORE_BLOCK];
+    float *const ev[3] = {block[0], block[1], block[2]};
+    float *out = st->outptr[0] + z * st->out_stride_slice[0] + x;
+
+    for (size_t i = 0; i < len; i += FF_STORE_BLOCK) {
+        const size_t n = len - i < FF_STORE_BLOCK ? len - i : FF_STORE_BLOCK;
+
+        if (st->ndim == 2)
+            fastfilters_linalg_ev2d(t[0] + i, t[2] + i, t[1] + i, ev[0], ev[1], n);
+        else
+            fastfilters_linalg_ev3d(t[2] + i, t[5] + i, t[4] + i, t[1] + i, t[3] + i, t[0] + i, ev[0], ev[1], ev[2],
+                                    n);
+        fastfilters_hessian_measure_apply(st->measure, st->ndim, ev, st->measure_norm, n, out + i, st->measure_max);
+    }
+}
+
+// eigenvalues and eigenvectors of len tensor elements t (in slab component order) at column x of slice z
+static void st_store_eigen(const st_t *st, const float *const *t, size_t z, size_t x, size_t len)
+{
+    const size_t type_size = fastfilters_type_size(st->ev_type);
+    void *ev[3];
+    void *vec[9];
+
+    if (st->measure) {
+        st_store_measure(st, t, z, x, len);
+        return;
+    }
+
+    for (size_t i = 0; i < st->ndim; ++i)
+        ev[i] = (char *)st->evptr[i] + (z * st->ev_stride_slice[i] + x) * type_size;
+    if (st->vectors)
+        for (size_t i = 0; i < st->ndim * st->ndim; ++i)
+            vec[i] = (char *)st->vecptr[i] + (z * st->vec_stride_slice[i] + x) * type_size;
+
+    // same argument order as the python bindings used on the full tensor
+    if (st->ndim == 2 && st->vectors)
+        fastfilters_linalg_eigen2d_ex(t[0], t[2], t[1], ev[0], ev[1], vec, len, st->ev_type);
+    else if (st->ndim == 2)
+        fastfilters_linalg_ev2d_ex(t[0], t[2], t[1], ev[0], ev[1], len, st->ev_type);
+    else if (st->vectors)
+        fastfilters_linalg_eigen3d_ex(t[2], t[5], t[4], t[1], t[3], t[0], ev[0], ev[1], ev[2], vec, len,
+                                      st->ev_type);
+    else
+        fastfilters_linalg_ev3d_ex(t[2], t[5], t[4], t[1], t[3], t[0], ev[0], ev[1], ev[2], len, st->ev_type);
+}
+
+typedef struct {
+    const st_t *st;
+    ptrdiff_t z0;
+    size_t n;
+} st_ev_t;
+
+// last axis pass of the tensor slices [z0, z0 + n) in tiles of columns [begin, end), eigenvalues of each tile
+static bool st_ev_worker(void *ctx, size_t begin, size_t end)
+{
+    const st_ev_t *e = ctx;
+    const st_t *st = e->st;
+    bool result = false;
+
+    size_t tile = FF_OUTER_TILE_BYTES / (st->n_tensor * e->n * sizeof(float));
+    if (tile < FF_OUTER_TILE_MIN)
+        tile = FF_OUTER_TILE_MIN;
+    if (tile > end - begin)
+        tile = end - begin;
+
+    float *buf = fastfilters_memory_align(32, st->n_tensor * e->n * tile * sizeof(float));
+    if (!buf)
+        return false;
+
+    for (size_t x = begin; x < end; x += tile) {
+        const size_t len = end - x < tile ? end - x : tile;
+        const float *t[6];
+
+        for (size_t i = 0; i < st->n_tensor; ++i)
+            if (!fastfilters_fir_pass_outer(st_slice(st, &st->tensor, i, e->z0) + x, e->n, st->slice_len, len,
+                                            buf + i * e->n * tile, tile, st->k_last[i], 1, 0,
+                                            FASTFILTERS_BORDER_OPTIMISTIC))
+                goto out;
+
+        for (size_t s = 0; s < e->n; ++s) {
+            for (size_t i = 0; i < st->n_tensor; ++i)
+                t[i] = buf + (i * e->n + s) * tile;
+
+            st_store_eigen(st, t, (size_t)e->z0 + s, x, len);
+        }
+    }
+
+    result = true;
+
+out:
+    fastfilters_memory_align_free(buf);
+    return result;
+}
+
+static bool st_run(st_t *st)
+{
+    bool result = false;
+    const ptrdiff_t n_slices = (ptrdiff_t)st->n_slices;
+    size_t radius_inner = 0;
+    size_t radius_outer = 0;
+
+    if (st->n_slices == 0 || st->slice_len == 0)
+        return true;
+
+    if (!st->hessian) {
+        const fastfilters_kernel_fir_t k_smooth = st->k_smooth[st->ndim - 1];
+        const fastfilters_kernel_fir_t k_deriv = st->k_deriv[st->ndim - 1];
+
+        radius_inner = k_smooth->len > k_deriv->len ? k_smooth->len : k_deriv->len;
+    }
+    for (size_t i = 0; i < st->n_tensor; ++i)
+        if (st->k_last[i]->len > radius_outer)
+            radius_outer = st->k_last[i]->len;
+
+    size_t batch = 2 * (radius_inner + radius_outer);
+    if (batch < ST_MIN_BATCH)
+        batch = ST_MIN_BATCH;
+    if (batch > st->n_slices)
+        batch = st->n_slices;
+
+    st->grad.ptr = NULL;
+    st->tensor.ptr = NULL;
+    st->scratch = NULL;
+    if (!st->hessian) {
+        st->scratch = fastfilters_memory_align(32, (batch + radius_outer) * st->slice_len * sizeof(float));
+        if (!st->scratch)
+            goto out;
+        if (!st_slab_alloc(st, &st->grad, st->ndim, batch + radius_outer + 2 * radius_inner))
+            goto out;
+    }
+    if (!st_slab_alloc(st, &st->tensor, st->n_tensor, batch + 2 * radius_outer))
+        goto out;
+
+    for (ptrdiff_t z0 = 0; z0 < n_slices;) {
+        const ptrdiff_t z1 = z0 + (ptrdiff_t)batch < n_slices ? z0 + (ptrdiff_t)batch : n_slices;
+        const ptrdiff_t tensor_end = z1 + (ptrdiff_t)radius_outer;
+
+        st_slab_shift(st, &st->tensor, z0 - (ptrdiff_t)radius_outer);
+
+        const ptrdiff_t tensor_filled = st->tensor.base + (ptrdiff_t)st->tensor.count;
+        const ptrdiff_t real_begin = tensor_filled > 0 ? tensor_filled : 0;
+        const ptrdiff_t real_end = tensor_end < n_slices ? tensor_end : n_slices;
+
+        if (real_begin < real_end &&
+            !(st->hessian ? st_fill_hessian : st_fill_tensor)(st, real_begin, real_end))
+            goto out;
+        st_slab_mirror(st, &st->tensor, tensor_filled, tensor_end);
+
+        if (st->eigenvalues) {
+            st_ev_t e = {.st = st, .z0 = z0, .n = (size_t)(z1 - z0)};
+
+            if (!fastfilters_parallel_for(st->slice_len, fastfilters_parallel_chunk_size(st->slice_len, 1, 16),
+                                          st_ev_worker, &e))
+                goto out;
+        } else {
+            for (unsigned int i = 0; i < st->n_tensor; ++i)
+                if (!fastfilters_fir_pass_outer(st_slice(st, &st->tensor, i, z0), (size_t)(z1 - z0), st->slice_len,
+                                                st->slice_len, st->outptr[i] + (size_t)z0 * st->out_stride_slice[i],
+                                                st->out_stride_slice[i], st->k_last[i], 1, 0,
+                                                FASTFILTERS_BORDER_OPTIMISTIC))
+                    goto out;
+        }
+
+        z0 = z1;
+    }
+
+    result = true;
+
+out:
+    if (st->scratch)
+        fastfilters_memory_align_free(st->scratch);
+    if (st->grad.ptr)
+        fastfilters_memory_align_free(st->grad.ptr);
+    if (st->tensor.ptr)
+        fastfilters_memory_align_free(st->tensor.ptr);
+    return result;
+}
+
+static bool st_kernels(st_t *st, const double *sigma_outer, const double *sigma_inner, const float *window_ratios,
+                       const fastfilters_options_t *options)
+{
+    for (unsigned int i = 0; i < st->ndim; ++i) {
+        const float window_ratio = axis_window_ratio(window_ratios, i, options);
+
+        st->k_smooth[i] = fastfilters_kernel_fir_gaussian(0, sigma_inner[i], window_ratio);
+        st->k_deriv[i] = fastfilters_kernel_fir_gaussian(1, sigma_inner[i], window_ratio);
+        st->k_outer[i] = fastfilters_kernel_fir_gaussian(0, sigma_outer[i], window_ratio);
+
+        if (!st->k_smooth[i] || !st->k_deriv[i] || !st->k_outer[i])
+            return false;
+    }
+
+    for (unsigned int i = 0; i < st->n_tensor; ++i)
+        st->k_last[i] = st->k_outer[st->ndim - 1];
+
+    return true;
+}
+
+static bool st_hessian_kernels(st_t *st, const double *sigmas, const float *window_ratios,
+                               const fastfilters_options_t *options)
+{
+    // derivative order along the last axis of xx, yy, xy (2D) or xx, yy, zz, xy, xz, yz (3D)
+    static const unsigned int last_order2d[] = {0, 2, 1};
+    static const unsigned int last_order3d[] = {0, 0, 2, 0, 1, 1};
+
+    st->hessian = true;
+
+    for (unsigned int i = 0; i < st->ndim; ++i) {
+        const float window_ratio = axis_window_ratio(window_ratios, i, options);
+
+        for (unsigned int order = 0; order < 3; ++order) {
+            st->k_hessian[i][order] = fastfilters_kernel_fir_gaussian(order, sigmas[i], window_ratio);
+            if (!st->k_hessian[i][order])
+                return false;
+        }
+    }
+
+    for (unsigned int i = 0; i < st->n_tensor; ++i)
+        st->k_last[i] = st->k_hessian[st->ndim - 1][st->ndim == 2 ? last_order2d[i] : last_order3d[i]];
+
+    return true;
+}
+
+static void st_free_kernels(st_t *st)
+{
+    for (unsigned int i = 0; i < st->ndim; ++i) {
+        if (st->k_smooth[i])
+            fastfilters_kernel_fir_free(st->k_smooth[i]);
+        if (st->k_deriv[i])
+            fastfilters_kernel_fir_free(st->k_deriv[i]);
+        if (st->k_outer[i])
+            fastfilters_kernel_fir_free(st->k_outer[i]);
+        for (unsigned int order = 0; order < 3; ++order)
+            if (st->k_hessian[i][order])
+                fastfilters_kernel_fir_free(st->k_hessian[i][order]);
+    }
+}
+
+static st_t st_init2d(const fastfilters_array2d_t *inarray)
+{
+    const st_t st = {.ndim = 2,
+                     .n_slices = inarray->n_y,
+                     .n_x = inarray->n_x,
+                     .n_rows = 1,
+                     .row_len = inarray->n_x * inarray->n_channels,
+                     .slice_len = inarray->n_x * inarray->n_channels,
+                     .inptr = inarray->ptr,
+                     .in_type = inarray->type,
+                     .in_stride_x = inarray->stride_x,
+                     .in_stride_row = inarray->stride_y,
+                     .in_stride_slice = inarray->stride_y,
+                     .n_tensor = 3};
+    return st;
+}
+
+static st_t st_init3d(const fastfilters_array3d_t *inarray)
+{
+    const st_t st = {.ndim = 3,
+                     .n_slices = inarray->n_z,
+                     .n_x = inarray->n_x,
+                     .n_rows = inarray->n_y,
+                     .row_len = inarray->n_x * inarray->n_channels,
+                     .slice_len = inarray->n_y * inarray->n_x * inarray->n_channels,
+                     .inptr = inarray->ptr,
+                     .in_type = inarray->type,
+                     .in_stride_x = inarray->stride_x,
+                     .in_stride_row = inarray->stride_y,
+                     .in_stride_slice = inarray->stride_z,
+                     .n_tensor = 6};
+    return st;
+}
+
+// outputs are shaped like the input and dense within each slice
+static bool st_check2d(const fastfilters_array2d_t *inarray, const fastfilters_array2d_t *out)
+{
+    return out->n_x == inarray->n_x && out->n_y == inarray->n_y && out->n_channels == inarray->n_channels &&
+           out->stride_x == inarray->n_channels;
+}
+
+static bool st_check3d(const fastfilters_array3d_t *inarray, const fastfilters_array3d_t *out)
+{
+    return out->n_x == inarray->n_x && out->n_y == inarray->n_y && out->n_z == inarray->n_z &&
+           out->n_channels == inarray->n_channels && out->stride_x == inarray->n_channels &&
+           out->stride_y == inarray->n_x * inarray->n_channels;
+}
+
+static bool st_set_outputs2d(st_t *st, const fastfilters_array2d_t *inarray, fastfilters_array2d_t *const *outs)
+{
+    for (unsigned int i = 0; i < st->n_tensor; ++i) {
+        if (!st_check2d(inarray, outs[i]) || outs[i]->type != FASTFILTERS_TYPE_FLOAT32)
+            return false;
+
+        st->outptr[i] = outs[i]->ptr;
+        st->out_stride_slice[i] = outs[i]->stride_y;
+    }
+
+    return true;
+}
+
+static bool st_set_outputs3d(st_t *st, const fastfilters_array3d_t *inarray, fastfilters_array3d_t *const *outs)
+{
+    for (unsigned int i = 0; i < st->n_tensor; ++i) {
+        if (!st_check3d(inarray, outs[i]) || outs[i]->type != FASTFILTERS_TYPE_FLOAT32)
+            return false;
+
+        st->outptr[i] = outs[i]->ptr;
+        st->out_stride_slice[i] = outs[i]->stride_z;
+    }
+
+    return true;
+}
+
+// all eigenvalue outputs share one output type
+static bool st_set_ev2d(st_t *st, const fastfilters_array2d_t *inarray, fastfilters_array2d_t *const *evs)
+{
+    st->eigenvalues = true;
+    st->ev_type = evs[0]->type;
+    if (!fastfilters_type_is_output(st->ev_type))
+        return false;
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        if (!st_check2d(inarray, evs[i]) || evs[i]->type != st->ev_type)
+            return false;
+
+        st->evptr[i] = evs[i]->ptr;
+        st->ev_stride_slice[i] = evs[i]->stride_y;
+    }
+
+    return true;
+}
+
+static bool st_set_ev3d(st_t *st, const fastfilters_array3d_t *inarray, fastfilters_array3d_t *const *evs)
+{
+    st->eigenvalues = true;
+    st->ev_type = evs[0]->type;
+    if (!fastfilters_type_is_output(st->ev_type))
+        return false;
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        if (!st_check3d(inarray, evs[i]) || evs[i]->type != st->ev_type)
+            return false;
+
+        st->evptr[i] = evs[i]->ptr;
+        st->ev_stride_slice[i] = evs[i]->stride_z;
+    }
+
+    return true;
+}
+
+// vecs[k * 2 + j] is component j (x first) of the k-th eigenvector, the matrix rows follow x, y
+static bool st_set_vec2d(st_t *st, const fastfilters_array2d_t *inarray, fastfilters_array2d_t *const *vecs)
+{
+    st->vectors = true;
+
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (!st_check2d(inarray, vecs[i]) || vecs[i]->type != st->ev_type)
+            return false;
+
+        st->vecptr[i] = vecs[i]->ptr;
+        st->vec_stride_slice[i] = vecs[i]->stride_y;
+    }
+
+    return true;
+}
+
+// the matrix rows follow z, y, x
+static bool st_set_vec3d(st_t *st, const fastfilters_array3d_t *inarray, fastfilters_array3d_t *const *vecs)
+{
+    st->vectors = true;
+
+    for (unsigned int k = 0; k < 3; ++k)
+        for (unsigned int j = 0; j < 3; ++j) {
+            const fastfilters_array3d_t *vec = vecs[k * 3 + 2 - j];
+
+            if (!st_check3d(inarray, vec) || vec->type != st->ev_type)
+                return false;
+
+            st->vecptr[k * 3 + j] = vec->ptr;
+            st->vec_stride_slice[k * 3 + j] = vec->stride_z;
+        }
+
+    return true;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_aniso(const fastfilters_array2d_t *inarray,
+                                                         const double *sigma_outer, const double *sigma_inner,
+                                                         const float *window_ratios, fastfilters_array2d_t *out_xx,
+                                                         fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
+                                                         const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array2d_t *outs[] = {out_xx, out_yy, out_xy};
+    st_t st = st_init2d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_outputs2d(&st, inarray, outs))
+        return false;
+
+    if (st_kernels(&st, sigma_outer, sigma_inner, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_aniso(const fastfilters_array3d_t *inarray,
+                                                         const double *sigma_outer, const double *sigma_inner,
+                                                         const float *window_ratios, fastfilters_array3d_t *out_xx,
+                                                         fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
+                                                         fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
+                                                         fastfilters_array3d_t *out_yz,
+                                                         const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array3d_t *outs[] = {out_xx, out_yy, out_zz, out_xy, out_xz, out_yz};
+    st_t st = st_init3d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_outputs3d(&st, inarray, outs))
+        return false;
+
+    if (st_kernels(&st, sigma_outer, sigma_inner, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d(const fastfilters_array2d_t *inarray, double sigma_outer,
+                                                   double sigma_inner, fastfilters_array2d_t *out_xx,
+                                                   fastfilters_array2d_t *out_xy, fastfilters_array2d_t *out_yy,
+                                                   const fastfilters_options_t *options)
+{
+    const double sigmas_outer[] = {sigma_outer, sigma_outer};
+    const double sigmas_inner[] = {sigma_inner, sigma_inner};
+
+    return fastfilters_fir_structure_tensor2d_aniso(inarray, sigmas_outer, sigmas_inner, NULL, out_xx, out_xy, out_yy,
+                                                    options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d(const fastfilters_array3d_t *inarray, double sigma_outer,
+                                                   double sigma_inner, fastfilters_array3d_t *out_xx,
+                                                   fastfilters_array3d_t *out_yy, fastfilters_array3d_t *out_zz,
+                                                   fastfilters_array3d_t *out_xy, fastfilters_array3d_t *out_xz,
+                                                   fastfilters_array3d_t *out_yz, const fastfilters_options_t *options)
+{
+    const double sigmas_outer[] = {sigma_outer, sigma_outer, sigma_outer};
+    const double sigmas_inner[] = {sigma_inner, sigma_inner, sigma_inner};
+
+    return fastfilters_fir_structure_tensor3d_aniso(inarray, sigmas_outer, sigmas_inner, NULL, out_xx, out_yy, out_zz,
+                                                    out_xy, out_xz, out_yz, options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_eigenvalues_aniso(
+    const fastfilters_array2d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array2d_t *ev_small, fastfilters_array2d_t *ev_big,
+    const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array2d_t *evs[] = {ev_small, ev_big};
+    st_t st = st_init2d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev2d(&st, inarray, evs))
+        return false;
+
+    if (st_kernels(&st, sigma_outer, sigma_inner, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_eigenvalues_aniso(
+    const fastfilters_array3d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array3d_t *ev0, fastfilters_array3d_t *ev1, fastfilters_array3d_t *ev2,
+    const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array3d_t *evs[] = {ev0, ev1, ev2};
+    st_t st = st_init3d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev3d(&st, inarray, evs))
+        return false;
+
+    if (st_kernels(&st, sigma_outer, sigma_inner, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_eigenvalues(const fastfilters_array2d_t *inarray,
+                                                               double sigma_outer, double sigma_inner,
+                                                               fastfilters_array2d_t *ev_small,
+                                                               fastfilters_array2d_t *ev_big,
+                                                               const fastfilters_options_t *options)
+{
+    const double sigmas_outer[] = {sigma_outer, sigma_outer};
+    const double sigmas_inner[] = {sigma_inner, sigma_inner};
+
+    return fastfilters_fir_structure_tensor2d_eigenvalues_aniso(inarray, sigmas_outer, sigmas_inner, NULL, ev_small,
+                                                                ev_big, options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_eigenvalues(const fastfilters_array3d_t *inarray,
+                                                               double sigma_outer, double sigma_inner,
+                                                               fastfilters_array3d_t *ev0, fastfilters_array3d_t *ev1,
+                                                               fastfilters_array3d_t *ev2,
+                                                               const fastfilters_options_t *options)
+{
+    const double sigmas_outer[] = {sigma_outer, sigma_outer, sigma_outer};
+    const double sigmas_inner[] = {sigma_inner, sigma_inner, sigma_inner};
+
+    return fastfilters_fir_structure_tensor3d_eigenvalues_aniso(inarray, sigmas_outer, sigmas_inner, NULL, ev0, ev1,
+                                                                ev2, options);
+}
+
+// iir kernels run on the whole image, so they go through a full-size tensor
+static bool hog_ev_iir2d(const st_t *st, const fastfilters_array2d_t *inarray, const double *sigmas,
+                         const float *window_ratios, const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array2d_t *t[3] = {NULL, NULL, NULL};
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        t[i] = fastfilters_array2d_alloc(inarray->n_x, inarray->n_y, inarray->n_channels);
+        if (!t[i])
+            goto out;
+    }
+
+    // xx, yy, xy like the tensor slab
+    if (!fastfilters_fir_hog2d_aniso(inarray, sigmas, window_ratios, t[0], t[2], t[1], options))
+        goto out;
+
+    for (size_t y = 0; y < inarray->n_y; ++y) {
+        const size_t offset = y * t[0]->stride_y;
+        const float *row[6] = {t[0]->ptr + offset, t[1]->ptr + offset, t[2]->ptr + offset};
+
+        st_store_eigen(st, row, y, 0, t[0]->stride_y);
+    }
+
+    result = true;
+
+out:
+    for (unsigned int i = 0; i < 3; ++i)
+        if (t[i])
+            fastfilters_array2d_free(t[i]);
+    return result;
+}
+
+static bool hog_ev_iir3d(const st_t *st, const fastfilters_array3d_t *inarray, const double *sigmas,
+                         const float *window_ratios, const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array3d_t *t[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+
+    for (unsigned int i = 0; i < 6; ++i) {
+        t[i] = fastfilters_array3d_alloc(inarray->n_x, inarray->n_y, inarray->n_z, inarray->n_channels);
+        if (!t[i])
+            goto out;
+    }
+
+    // xx, yy, zz, xy, xz, yz
+    if (!fastfilters_fir_hog3d_aniso(inarray, sigmas, window_ratios, t[0], t[1], t[2], t[3], t[4], t[5], options))
+        goto out;
+
+    for (size_t z = 0; z < inarray->n_z; ++z) {
+        const size_t offset = z * t[0]->stride_z;
+        const float *slice[6];
+
+        for (unsigned int i = 0; i < 6; ++i)
+            slice[i] = t[i]->ptr + offset;
+
+        st_store_eigen(st, slice, z, 0, t[0]->stride_z);
+    }
+
+    result = true;
+
+out:
+    for (unsigned int i = 0; i < 6; ++i)
+        if (t[i])
+            fastfilters_array3d_free(t[i]);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_hog2d_eigenvalues_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                        const float *window_ratios, fastfilters_array2d_t *ev_small,
+                                                        fastfilters_array2d_t *ev_big,
+                                                        const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array2d_t *evs[] = {ev_small, ev_big};
+    st_t st = st_init2d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev2d(&st, inarray, evs))
+        return false;
+
+    if (fastfilters_iir_select(sigmas, 2, window_ratios, options))
+        return hog_ev_iir2d(&st, inarray, sigmas, window_ratios, options);
+
+    if (st_hessian_kernels(&st, sigmas, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_hog3d_eigenvalues_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                        const float *window_ratios, fastfilters_array3d_t *ev0,
+                                                        fastfilters_array3d_t *ev1, fastfilters_array3d_t *ev2,
+                                                        const fastfilters_options_t *options)
+{
+    bool result = false;
+    fastfilters_array3d_t *evs[] = {ev0, ev1, ev2};
+    st_t st = st_init3d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev3d(&st, inarray, evs))
+        return false;
+
+    if (fastfilters_iir_select(sigmas, 3, window_ratios, options))
+        return hog_ev_iir3d(&st, inarray, sigmas, window_ratios, options);
+
+    if (st_hessian_kernels(&st, sigmas, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_hog2d_eigenvalues(const fastfilters_array2d_t *inarray, double sigma,
+                                                  fastfilters_array2d_t *ev_small, fastfilters_array2d_t *ev_big,
+                                                  const fastfilters_options_t *options)
+{
+    const double sigmas[] = {sigma, sigma};
+
+    return fastfilters_fir_hog2d_eigenvalues_aniso(inarray, sigmas, NULL, ev_small, ev_big, options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_hog3d_eigenvalues(const fastfilters_array3d_t *inarray, double sigma,
+                                                  fastfilters_array3d_t *ev0, fastfilters_array3d_t *ev1,
+                                                  fastfilters_array3d_t *ev2, const fastfilters_options_t *options)
+{
+    const double sigmas[] = {sigma, sigma, sigma};
+
+    return fastfilters_fir_hog3d_eigenvalues_aniso(inarray, sigmas, NULL, ev0, ev1, ev2, options);
+}
+
+bool DLL_PUBLIC fastfilters_fir_hog2d_eigenvectors_aniso(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                         const float *window_ratios, fastfilters_array2d_t *const *evs,
+                                                         fastfilters_array2d_t *const *vecs,
+                                                         const fastfilters_options_t *options)
+{
+    bool result = false;
+    st_t st = st_init2d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev2d(&st, inarray, evs) ||
+        !st_set_vec2d(&st, inarray, vecs))
+        return false;
+
+    if (fastfilters_iir_select(sigmas, 2, window_ratios, options))
+        return hog_ev_iir2d(&st, inarray, sigmas, window_ratios, options);
+
+    if (st_hessian_kernels(&st, sigmas, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_hog3d_eigenvectors_aniso(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                         const float *window_ratios, fastfilters_array3d_t *const *evs,
+                                                         fastfilters_array3d_t *const *vecs,
+                                                         const fastfilters_options_t *options)
+{
+    bool result = false;
+    st_t st = st_init3d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev3d(&st, inarray, evs) ||
+        !st_set_vec3d(&st, inarray, vecs))
+        return false;
+
+    if (fastfilters_iir_select(sigmas, 3, window_ratios, options))
+        return hog_ev_iir3d(&st, inarray, sigmas, window_ratios, options);
+
+    if (st_hessian_kernels(&st, sigmas, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor2d_eigenvectors_aniso(
+    const fastfilters_array2d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array2d_t *const *evs, fastfilters_array2d_t *const *vecs,
+    const fastfilters_options_t *options)
+{
+    bool result = false;
+    st_t st = st_init2d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev2d(&st, inarray, evs) ||
+        !st_set_vec2d(&st, inarray, vecs))
+        return false;
+
+    if (st_kernels(&st, sigma_outer, sigma_inner, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_structure_tensor3d_eigenvectors_aniso(
+    const fastfilters_array3d_t *inarray, const double *sigma_outer, const double *sigma_inner,
+    const float *window_ratios, fastfilters_array3d_t *const *evs, fastfilters_array3d_t *const *vecs,
+    const fastfilters_options_t *options)
+{
+    bool result = false;
+    st_t st = st_init3d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || !st_set_ev3d(&st, inarray, evs) ||
+        !st_set_vec3d(&st, inarray, vecs))
+        return false;
+
+    if (st_kernels(&st, sigma_outer, sigma_inner, window_ratios, options))
+        result = st_run(&st);
+
+    st_free_kernels(&st);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_fir_hessian_measure2d(const fastfilters_array2d_t *inarray, const double *sigmas,
+                                                  size_t n_scales, const fastfilters_hessian_measure_t *measure,
+                                                  fastfilters_array2d_t *out, const fastfilters_options_t *options)
+{
+    st_t base = st_init2d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || n_scales == 0 || !st_check2d(inarray, out) ||
+        out->type != FASTFILTERS_TYPE_FLOAT32)
+        return false;
+
+    base.eigenvalues = true;
+    base.measure = measure;
+    base.outptr[0] = out->ptr;
+    base.out_stride_slice[0] = out->stride_y;
+
+    for (size_t i = 0; i < n_scales; ++i) {
+        const double sigma_axes[] = {sigmas[i], sigmas[i]};
+        st_t st = base;
+        bool ok;
+
+        st.measure_norm = sigmas[i] * sigmas[i];
+        st.measure_max = i > 0;
+
+        if (fastfilters_iir_select(sigma_axes, 2, NULL, options)) {
+            ok = hog_ev_iir2d(&st, inarray, sigma_axes, NULL, options);
+        } else {
+            ok = st_hessian_kernels(&st, sigma_axes, NULL, options) && st_run(&st);
+            st_free_kernels(&st);
+        }
+
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+bool DLL_PUBLIC fastfilters_fir_hessian_measure3d(const fastfilters_array3d_t *inarray, const double *sigmas,
+                                                  size_t n_scales, const fastfilters_hessian_measure_t *measure,
+                                                  fastfilters_array3d_t *out, const fastfilters_options_t *options)
+{
+    st_t base = st_init3d(inarray);
+
+    if (!fastfilters_type_size(inarray->type) || n_scales == 0 || !st_check3d(inarray, out) ||
+        out->type != FASTFILTERS_TYPE_FLOAT32)
+        return false;
+
+    base.eigenvalues = true;
+    base.measure = measure;
+    base.outptr[0] = out->ptr;
+    base.out_stride_slice[0] = out->stride_z;
+
+    for (size_t i = 0; i < n_scales; ++i) {
+        const double sigma_axes[] = {sigmas[i], sigmas[i], sigmas[i]};
+        st_t st = base;
+        bool ok;
+
+        st.measure_norm = sigmas[i] * sigmas[i];
+        st.measure_max = i > 0;
+
+        if (fastfilters_iir_select(sigma_axes, 3, NULL, options)) {
+            ok = hog_ev_iir3d(&st, inarray, sigma_axes, NULL, options);
+        } else {
+            ok = st_hessian_kernels(&st, sigma_axes, NULL, options) && st_run(&st);
+            st_free_kernels(&st);
+        }
+
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
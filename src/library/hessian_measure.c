@@ -0,0 +1,132 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <math.h>
+
+// Measures see bright structures on a dark background as negative eigenvalues, dark ones are mirrored into that case.
+// l0 >= l1 (>= l2) are the eigenvalues, the loops stay free of branches so that they vectorize: invalid pixels get
+// harmless denominators and are masked at the end.
+
+static inline float combine(float out, float v, bool combine_max)
+{
+    return combine_max && out > v ? out : v;
+}
+
+// Frangi et al., 1998: all but the first eigenvalue negative with the first one of the smallest magnitude
+static void vesselness2d(const fastfilters_hessian_measure_t *m, const float *l0, const float *l1, size_t n,
+                         float *out, bool combine_max)
+{
+    const float kb = 1 / (2 * m->beta * m->beta);
+    const bool structure = m->c > 0;
+    const float kc = structure ? 1 / (2 * m->c * m->c) : 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        const float a0 = fabsf(l0[i]);
+        const float a1 = fabsf(l1[i]);
+        const bool valid = l1[i] < 0 && a0 <= a1;
+        const float rb = a0 / (valid ? a1 : 1);
+        const float s = structure ? 1 - expf(-(a0 * a0 + a1 * a1) * kc) : 1;
+
+        out[i] = combine(out[i], valid ? expf(-rb * rb * kb) * s : 0, combine_max);
+    }
+}
+
+static void vesselness3d(const fastfilters_hessian_measure_t *m, const float *l0, const float *l1, const float *l2,
+                         size_t n, float *out, bool combine_max)
+{
+    const float ka = 1 / (2 * m->alpha * m->alpha);
+    const float kb = 1 / (2 * m->beta * m->beta);
+    const bool structure = m->c > 0;
+    const float kc = structure ? 1 / (2 * m->c * m->c) : 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        const float a0 = fabsf(l0[i]);
+        const float a1 = fabsf(l1[i]);
+        const float a2 = fabsf(l2[i]);
+        const bool valid = l1[i] < 0 && a0 <= a1;
+        const float ra = a1 / (valid ? a2 : 1);
+        const float rb2 = a0 * a0 / (valid ? a1 * a2 : 1);
+        const float s = structure ? 1 - expf(-(a0 * a0 + a1 * a1 + a2 * a2) * kc) : 1;
+
+        out[i] = combine(out[i], valid ? (1 - expf(-ra * ra * ka)) * expf(-rb2 * kb) * s : 0, combine_max);
+    }
+}
+
+// Li et al., 2003: all eigenvalues negative, the smallest magnitude squared over the largest
+static void blobness(const float *l0, const float *l_last, size_t n, float *out, bool combine_max)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const bool valid = l0[i] < 0;
+
+        out[i] = combine(out[i], valid ? l0[i] * l0[i] / (valid ? -l_last[i] : 1) : 0, combine_max);
+    }
+}
+
+// Sato et al., 1998: the second eigenvalue (the larger of the two negative ones in 3D) weighted by the first
+static void ridgeness(const fastfilters_hessian_measure_t *m, const float *l0, const float *l1, size_t n, float *out,
+                      bool combine_max)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const float lc = -l1[i];
+        const bool valid = lc > 0;
+        const float w = (l0[i] <= 0 ? m->alpha : m->beta) * (valid ? lc : 1);
+
+        out[i] = combine(out[i], valid ? lc * expf(-l0[i] * l0[i] / (2 * w * w)) : 0, combine_max);
+    }
+}
+
+void DLL_LOCAL fastfilters_hessian_measure_apply(const fastfilters_hessian_measure_t *measure, unsigned int ndim,
+                                                 float *const *ev, float norm, size_t n, float *out, bool combine_max)
+{
+    float *const l_last = ev[ndim - 1];
+
+    // eigenvalues in place, scaled and mirrored for dark structures
+    if (measure->dark) {
+        for (size_t i = 0; i < n; ++i) {
+            const float l0 = ev[0][i];
+
+            ev[0][i] = -norm * l_last[i];
+            l_last[i] = -norm * l0;
+        }
+        if (ndim == 3)
+            for (size_t i = 0; i < n; ++i)
+                ev[1][i] *= -norm;
+    } else {
+        for (unsigned int j = 0; j < ndim; ++j)
+            for (size_t i = 0; i < n; ++i)
+                ev[j][i] *= norm;
+    }
+
+    switch (measure->type) {
+    case FASTFILTERS_HESSIAN_VESSELNESS:
+        if (ndim == 2)
+            vesselness2d(measure, ev[0], ev[1], n, out, combine_max);
+        else
+            vesselness3d(measure, ev[0], ev[1], ev[2], n, out, combine_max);
+        break;
+    case FASTFILTERS_HESSIAN_BLOBNESS:
+        blobness(ev[0], l_last, n, out, combine_max);
+        break;
+    default:
+        ridgeness(measure, ev[0], ev[1], n, out, combine_max);
+        break;
+    }
+}
@@ -0,0 +1,70 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <immintrin.h>
+
+#if !defined(__AVX__) || !defined(__FMA__)
+#error "iir_avx.c needs to be compiled with AVX and FMA support."
+#endif
+
+static void iir_sweep(const fastfilters_kernel_iir_t kernel, float *buf, ptrdiff_t first, ptrdiff_t step, size_t len)
+{
+    __m256 y1[FF_IIR_SECTIONS][2], y2[FF_IIR_SECTIONS][2];
+    __m256 g[FF_IIR_SECTIONS], c1[FF_IIR_SECTIONS], c2[FF_IIR_SECTIONS];
+
+    for (unsigned int s = 0; s < FF_IIR_SECTIONS; ++s) {
+        g[s] = _mm256_set1_ps(kernel->g[s]);
+        c1[s] = _mm256_set1_ps(kernel->c1[s]);
+        c2[s] = _mm256_set1_ps(kernel->c2[s]);
+
+        for (unsigned int h = 0; h < 2; ++h)
+            y1[s][h] = y2[s][h] = _mm256_load_ps(buf + first * FF_IIR_LANES_AVX + 8 * h);
+    }
+
+    float *row = buf + first * FF_IIR_LANES_AVX;
+    for (size_t i = 0; i < len; ++i, row += step * FF_IIR_LANES_AVX) {
+        __m256 x0 = _mm256_load_ps(row);
+        __m256 x1 = _mm256_load_ps(row + 8);
+
+        for (unsigned int s = 0; s < FF_IIR_SECTIONS; ++s) {
+            __m256 r0 = _mm256_fmadd_ps(c2[s], y2[s][0], _mm256_fmadd_ps(c1[s], y1[s][0], _mm256_mul_ps(g[s], x0)));
+            __m256 r1 = _mm256_fmadd_ps(c2[s], y2[s][1], _mm256_fmadd_ps(c1[s], y1[s][1], _mm256_mul_ps(g[s], x1)));
+            y2[s][0] = y1[s][0];
+            y2[s][1] = y1[s][1];
+            y1[s][0] = x0 = r0;
+            y1[s][1] = x1 = r1;
+        }
+
+        _mm256_store_ps(row, x0);
+        _mm256_store_ps(row + 8, x1);
+    }
+}
+
+void fastfilters_iir_run_avxfma(const fastfilters_kernel_iir_t kernel, float *buf, size_t len)
+{
+    iir_sweep(kernel, buf, 0, 1, len);
+    iir_sweep(kernel, buf, (ptrdiff_t)len - 1, -1, len);
+}
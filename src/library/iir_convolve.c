@@ -0,0 +1,372 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+static void (*g_iir_fn)(const fastfilters_kernel_iir_t, float *, size_t) = fastfilters_iir_run;
+static size_t g_iir_lanes = FF_IIR_LANES_NOSIMD;
+
+void fastfilters_iir_init(void)
+{
+#ifdef HAVE_AVX512F
+    if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX512F)) {
+        g_iir_fn = fastfilters_iir_run_avx512;
+        g_iir_lanes = FF_IIR_LANES_AVX512;
+        return;
+    }
+#endif
+#ifndef _USE_SIMDE_ON_ARM_
+    if (fastfilters_cpu_check(FASTFILTERS_CPU_FMA)) {
+        g_iir_fn = fastfilters_iir_run_avxfma;
+        g_iir_lanes = FF_IIR_LANES_AVX;
+        return;
+    }
+#endif
+
+    g_iir_fn = fastfilters_iir_run;
+    g_iir_lanes = FF_IIR_LANES_NOSIMD;
+}
+
+void fastfilters_iir_run(const fastfilters_kernel_iir_t kernel, float *buf, size_t len)
+{
+    float y1[FF_IIR_SECTIONS][FF_IIR_LANES_NOSIMD], y2[FF_IIR_SECTIONS][FF_IIR_LANES_NOSIMD];
+
+    // both recursions start in the steady state of a constant line
+    for (unsigned int s = 0; s < FF_IIR_SECTIONS; ++s)
+        for (unsigned int l = 0; l < FF_IIR_LANES_NOSIMD; ++l)
+            y1[s][l] = y2[s][l] = buf[l];
+
+    for (size_t i = 0; i < len; ++i) {
+        float *row = buf + i * FF_IIR_LANES_NOSIMD;
+
+        for (unsigned int s = 0; s < FF_IIR_SECTIONS; ++s) {
+            for (unsigned int l = 0; l < FF_IIR_LANES_NOSIMD; ++l) {
+                const float y = kernel->g[s] * row[l] + kernel->c1[s] * y1[s][l] + kernel->c2[s] * y2[s][l];
+                y2[s][l] = y1[s][l];
+                y1[s][l] = y;
+                row[l] = y;
+            }
+        }
+    }
+
+    for (unsigned int s = 0; s < FF_IIR_SECTIONS; ++s)
+        for (unsigned int l = 0; l < FF_IIR_LANES_NOSIMD; ++l)
+            y1[s][l] = y2[s][l] = buf[(len - 1) * FF_IIR_LANES_NOSIMD + l];
+
+    for (size_t i = len; i-- > 0;) {
+        float *row = buf + i * FF_IIR_LANES_NOSIMD;
+
+        for (unsigned int s = 0; s < FF_IIR_SECTIONS; ++s) {
+            for (unsigned int l = 0; l < FF_IIR_LANES_NOSIMD; ++l) {
+                const float y = kernel->g[s] * row[l] + kernel->c1[s] * y1[s][l] + kernel->c2[s] * y2[s][l];
+                y2[s][l] = y1[s][l];
+                y1[s][l] = y;
+                row[l] = y;
+            }
+        }
+    }
+}
+
+// One pass filters n samples along an axis (step apart) of lines that are indexed by up to three dimensions, the
+// first one varying fastest. Consecutive lines are gathered into groups of g_iir_lanes lines.
+typedef struct {
+    const void *inptr;
+    fastfilters_type_t in_type;
+    void *outptr;
+    fastfilters_type_t out_type;
+    size_t n;
+    size_t in_step;
+    size_t out_step;
+    size_t n_lines[3];
+    size_t in_stride[3];
+    size_t out_stride[3];
+    size_t n_total;
+    fastfilters_kernel_iir_t kernel;
+} iir_pass_t;
+
+static size_t iir_mirror(ptrdiff_t i, size_t n)
+{
+    const ptrdiff_t period = 2 * ((ptrdiff_t)n - 1);
+
+    if (n == 1)
+        return 0;
+
+    i %= period;
+    if (i < 0)
+        i += period;
+    if (i >= (ptrdiff_t)n)
+        i = period - i;
+
+    return (size_t)i;
+}
+
+static void iir_line_offsets(const iir_pass_t *pass, size_t line, size_t *in_off, size_t *out_off)
+{
+    const size_t i0 = line % pass->n_lines[0];
+    const size_t i1 = line / pass->n_lines[0] % pass->n_lines[1];
+    const size_t i2 = line / pass->n_lines[0] / pass->n_lines[1];
+
+    *in_off = i0 * pass->in_stride[0] + i1 * pass->in_stride[1] + i2 * pass->in_stride[2];
+    *out_off = i0 * pass->out_stride[0] + i1 * pass->out_stride[1] + i2 * pass->out_stride[2];
+}
+
+static bool iir_is_contiguous(const size_t *off, size_t count)
+{
+    for (size_t l = 1; l < count; ++l)
+        if (off[l] != off[0] + l)
+            return false;
+    return true;
+}
+
+static void iir_gather(const iir_pass_t *pass, const size_t *in_off, size_t count, float *buf, size_t lanes)
+{
+    const size_t margin = pass->kernel->margin;
+    const bool contiguous = iir_is_contiguous(in_off, count);
+    const float *in = pass->inptr;
+
+    for (size_t j = 0; j < pass->n + 2 * margin; ++j) {
+        const size_t offset = iir_mirror((ptrdiff_t)j - (ptrdiff_t)margin, pass->n) * pass->in_step;
+        float *row = buf + j * lanes;
+
+        if (contiguous && pass->in_type == FASTFILTERS_TYPE_FLOAT32)
+            memcpy(row, in + in_off[0] + offset, count * sizeof(float));
+        else if (contiguous)
+            fastfilters_type_convert(pass->inptr, pass->in_type, in_off[0] + offset, count, row);
+        else if (pass->in_type == FASTFILTERS_TYPE_FLOAT32)
+            for (size_t l = 0; l < count; ++l)
+                row[l] = in[in_off[l] + offset];
+        else
+            for (size_t l = 0; l < count; ++l)
+                fastfilters_type_convert(pass->inptr, pass->in_type, in_off[l] + offset, 1, row + l);
+
+        for (size_t l = count; l < lanes; ++l)
+            row[l] = 0.0f;
+    }
+}
+
+static void iir_scatter(const iir_pass_t *pass, const size_t *out_off, size_t count, const float *buf, size_t lanes)
+{
+    const size_t margin = pass->kernel->margin;
+    const bool contiguous = iir_is_contiguous(out_off, count);
+    float *out = pass->outptr;
+    float diff[FF_IIR_MAX_LANES];
+
+    for (size_t i = 0; i < pass->n; ++i) {
+        const float *row = buf + (i + margin) * lanes;
+        const float *src = row;
+        const size_t offset = i * pass->out_step;
+
+        if (pass->kernel->order == 1) {
+            for (size_t l = 0; l < count; ++l)
+                diff[l] = 0.5f * (row[l + lanes] - row[l - lanes]);
+            src = diff;
+        } else if (pass->kernel->order == 2) {
+            for (size_t l = 0; l < count; ++l)
+                diff[l] = row[l + lanes] - 2.0f * row[l] + row[l - lanes];
+            src = diff;
+        }
+
+        if (contiguous && pass->out_type == FASTFILTERS_TYPE_FLOAT32)
+            memcpy(out + out_off[0] + offset, src, count * sizeof(float));
+        else if (contiguous)
+            fastfilters_type_store(src, count, pass->outptr, pass->out_type, out_off[0] + offset);
+        else if (pass->out_type == FASTFILTERS_TYPE_FLOAT32)
+            for (size_t l = 0; l < count; ++l)
+                out[out_off[l] + offset] = src[l];
+        else
+            for (size_t l = 0; l < count; ++l)
+                fastfilters_type_store(src + l, 1, pass->outptr, pass->out_type, out_off[l] + offset);
+    }
+}
+
+static bool iir_pass_worker(void *ctx, size_t begin, size_t end)
+{
+    const iir_pass_t *pass = ctx;
+    const size_t lanes = g_iir_lanes;
+    const size_t len = pass->n + 2 * pass->kernel->margin;
+    size_t in_off[FF_IIR_MAX_LANES], out_off[FF_IIR_MAX_LANES];
+
+    float *buf = fastfilters_memory_align(64, len * lanes * sizeof(float));
+    if (!buf)
+        return false;
+
+    for (size_t group = begin; group < end; ++group) {
+        const size_t first = group * lanes;
+        const size_t count = pass->n_total - first < lanes ? pass->n_total - first : lanes;
+
+        for (size_t l = 0; l < count; ++l)
+            iir_line_offsets(pass, first + l, &in_off[l], &out_off[l]);
+
+        iir_gather(pass, in_off, count, buf, lanes);
+        g_iir_fn(pass->kernel, buf, len);
+        iir_scatter(pass, out_off, count, buf, lanes);
+    }
+
+    fastfilters_memory_align_free(buf);
+    return true;
+}
+
+// lines are gathered completely before they are written back, so a pass may run in place
+static bool iir_pass(iir_pass_t *pass)
+{
+    pass->n_total = pass->n_lines[0] * pass->n_lines[1] * pass->n_lines[2];
+    if (pass->n == 0 || pass->n_total == 0)
+        return true;
+
+    const size_t n_groups = (pass->n_total + g_iir_lanes - 1) / g_iir_lanes;
+
+    return fastfilters_parallel_for(n_groups, fastfilters_parallel_chunk_size(n_groups, 1, 1), iir_pass_worker, pass);
+}
+
+bool DLL_PUBLIC fastfilters_iir_convolve2d(const fastfilters_array2d_t *inarray, const fastfilters_kernel_iir_t kernelx,
+                                           const fastfilters_kernel_iir_t kernely,
+                                           const fastfilters_array2d_t *outarray, const fastfilters_options_t *options)
+{
+    (void)options;
+    bool result = false;
+    float *tmp = NULL;
+    float *work = outarray->ptr;
+    size_t work_stride_x = outarray->stride_x, work_stride_y = outarray->stride_y;
+
+    if (!kernelx || !kernely)
+        return false;
+    if (!fastfilters_type_size(inarray->type) || !fastfilters_type_is_output(outarray->type))
+        return false;
+
+    // outputs that are not float cannot hold the intermediate, only the last pass stores to them
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32) {
+        work_stride_x = inarray->n_channels;
+        work_stride_y = inarray->n_x * inarray->n_channels;
+        tmp = fastfilters_memory_align(32, inarray->n_y * work_stride_y * sizeof(float));
+        if (!tmp)
+            goto out;
+        work = tmp;
+    }
+
+    iir_pass_t pass_x = {.inptr = inarray->ptr,
+                         .in_type = inarray->type,
+                         .outptr = work,
+                         .out_type = FASTFILTERS_TYPE_FLOAT32,
+                         .n = inarray->n_x,
+                         .in_step = inarray->stride_x,
+                         .out_step = work_stride_x,
+                         .n_lines = {inarray->n_channels, inarray->n_y, 1},
+                         .in_stride = {1, inarray->stride_y, 0},
+                         .out_stride = {1, work_stride_y, 0},
+                         .kernel = kernelx};
+    if (!iir_pass(&pass_x))
+        goto out;
+
+    iir_pass_t pass_y = {.inptr = work,
+                         .in_type = FASTFILTERS_TYPE_FLOAT32,
+                         .outptr = outarray->ptr,
+                         .out_type = outarray->type,
+                         .n = inarray->n_y,
+                         .in_step = work_stride_y,
+                         .out_step = outarray->stride_y,
+                         .n_lines = {inarray->n_channels, inarray->n_x, 1},
+                         .in_stride = {1, work_stride_x, 0},
+                         .out_stride = {1, outarray->stride_x, 0},
+                         .kernel = kernely};
+    result = iir_pass(&pass_y);
+
+out:
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_iir_convolve3d(const fastfilters_array3d_t *inarray, const fastfilters_kernel_iir_t kernelx,
+                                           const fastfilters_kernel_iir_t kernely,
+                                           const fastfilters_kernel_iir_t kernelz,
+                                           const fastfilters_array3d_t *outarray, const fastfilters_options_t *options)
+{
+    (void)options;
+    bool result = false;
+    float *tmp = NULL;
+    float *work = outarray->ptr;
+    size_t work_stride_x = outarray->stride_x, work_stride_y = outarray->stride_y, work_stride_z = outarray->stride_z;
+
+    if (!kernelx || !kernely || !kernelz)
+        return false;
+    if (!fastfilters_type_size(inarray->type) || !fastfilters_type_is_output(outarray->type))
+        return false;
+
+    if (outarray->type != FASTFILTERS_TYPE_FLOAT32) {
+        work_stride_x = inarray->n_channels;
+        work_stride_y = inarray->n_x * inarray->n_channels;
+        work_stride_z = inarray->n_y * work_stride_y;
+        tmp = fastfilters_memory_align(32, inarray->n_z * work_stride_z * sizeof(float));
+        if (!tmp)
+            goto out;
+        work = tmp;
+    }
+
+    iir_pass_t pass_x = {.inptr = inarray->ptr,
+                         .in_type = inarray->type,
+                         .outptr = work,
+                         .out_type = FASTFILTERS_TYPE_FLOAT32,
+                         .n = inarray->n_x,
+                         .in_step = inarray->stride_x,
+                         .out_step = work_stride_x,
+                         .n_lines = {inarray->n_channels, inarray->n_y, inarray->n_z},
+                         .in_stride = {1, inarray->stride_y, inarray->stride_z},
+                         .out_stride = {1, work_stride_y, work_stride_z},
+                         .kernel = kernelx};
+    if (!iir_pass(&pass_x))
+        goto out;
+
+    iir_pass_t pass_y = {.inptr = work,
+                         .in_type = FASTFILTERS_TYPE_FLOAT32,
+                         .outptr = work,
+                         .out_type = FASTFILTERS_TYPE_FLOAT32,
+                         .n = inarray->n_y,
+                         .in_step = work_stride_y,
+                         .out_step = work_stride_y,
+                         .n_lines = {inarray->n_channels, inarray->n_x, inarray->n_z},
+                         .in_stride = {1, work_stride_x, work_stride_z},
+                         .out_stride = {1, work_stride_x, work_stride_z},
+                         .kernel = kernely};
+    if (!iir_pass(&pass_y))
+        goto out;
+
+    iir_pass_t pass_z = {.inptr = work,
+                         .in_type = FASTFILTERS_TYPE_FLOAT32,
+                         .outptr = outarray->ptr,
+                         .out_type = outarray->type,
+                         .n = inarray->n_z,
+                         .in_step = work_stride_z,
+                         .out_step = outarray->stride_z,
+                         .n_lines = {inarray->n_channels, inarray->n_x, inarray->n_y},
+                         .in_stride = {1, work_stride_x, work_stride_y},
+                         .out_stride = {1, outarray->stride_x, outarray->stride_y},
+                         .kernel = kernelz};
+    result = iir_pass(&pass_z);
+
+out:
+    if (tmp)
+        fastfilters_memory_align_free(tmp);
+    return result;
+}
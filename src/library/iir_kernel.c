@@ -0,0 +1,169 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "fastfilters.h"
+#include "common.h"
+
+// Young - van Vliet recursive gaussian with five poles (van Vliet, Young, Verbeek: "Recursive Gaussian derivative
+// filters", ICPR 1998). The poles are given for sigma = 2 in the upper half plane and moved to p = d^(-1/q) for other
+// sigmas, q is chosen so that the variance of the filter matches sigma^2 exactly.
+static const double g_base_poles[FF_IIR_SECTIONS][2] = {{1.87504, 0.0}, {1.61433, 0.83134}, {0.86430, 1.45389}};
+
+// impulse responses below this fraction of their peak are ignored at the borders
+#define IIR_MARGIN_EPS 1e-5
+
+// below this the pole model does not describe a gaussian anymore
+#define IIR_MIN_SIGMA 0.5
+
+// single threaded iir kernels overtake fir kernels at sigma 3 to 5 for 3D and 5 to 8 for 2D gaussians with avx2 and
+// fma, the default lies between both, compare the fir and iir kernel results of the filter section of fastfilters_bench
+static double g_iir_crossover = FF_IIR_CROSSOVER;
+
+typedef struct {
+    double re, im;
+} iir_complex_t;
+
+static void iir_pole(unsigned int i, double q, iir_complex_t *p)
+{
+    const double r = pow(hypot(g_base_poles[i][0], g_base_poles[i][1]), -1.0 / q);
+    const double phi = atan2(g_base_poles[i][1], g_base_poles[i][0]) / q;
+
+    p->re = r * cos(phi);
+    p->im = r * sin(phi);
+}
+
+// variance of the causal and the anticausal pass together, each pole contributes p / (1 - p)^2 twice
+static double iir_variance(double q)
+{
+    double var = 0.0;
+
+    for (unsigned int i = 0; i < FF_IIR_SECTIONS; ++i) {
+        iir_complex_t p;
+        iir_pole(i, q, &p);
+
+        const double u = 1.0 - p.re, v = -p.im;
+        const double w_re = u * u - v * v, w_im = 2.0 * u * v;
+        const double w_abs2 = w_re * w_re + w_im * w_im;
+        const double re = (p.re * w_re + p.im * w_im) / w_abs2;
+
+        // complex poles come with their conjugate
+        var += (g_base_poles[i][1] != 0.0 ? 4.0 : 2.0) * re;
+    }
+
+    return var;
+}
+
+static double iir_solve_q(double sigma)
+{
+    double lo = 0.01, hi = 2.0 * sigma + 1.0;
+
+    for (unsigned int i = 0; i < 100; ++i) {
+        const double q = 0.5 * (lo + hi);
+
+        if (iir_variance(q) < sigma * sigma)
+            lo = q;
+        else
+            hi = q;
+    }
+
+    return 0.5 * (lo + hi);
+}
+
+fastfilters_kernel_iir_t DLL_PUBLIC fastfilters_kernel_iir_gaussian(unsigned int order, double sigma)
+{
+    double sigma2 = sigma * sigma;
+
+    if (order > 2)
+        return NULL;
+
+    // the central differences of the derivatives act like a gaussian of variance 1/3 (first) or 1/6 (second order)
+    // on the low frequencies, the smoothing makes up for the rest
+    if (order == 1)
+        sigma2 -= 1.0 / 3.0;
+    else if (order == 2)
+        sigma2 -= 1.0 / 6.0;
+
+    if (!(sigma2 >= IIR_MIN_SIGMA * IIR_MIN_SIGMA))
+        return NULL;
+
+    fastfilters_kernel_iir_t kernel = fastfilters_memory_alloc(sizeof(struct _fastfilters_kernel_iir_t));
+    if (!kernel)
+        return NULL;
+
+    const double q = iir_solve_q(sqrt(sigma2));
+    double r_max = 0.0;
+
+    kernel->order = order;
+    kernel->sigma = sigma;
+
+    for (unsigned int i = 0; i < FF_IIR_SECTIONS; ++i) {
+        iir_complex_t p;
+        iir_pole(i, q, &p);
+
+        // the unit dc gain is computed from the rounded coefficients so that it holds for the float recursion
+        if (g_base_poles[i][1] != 0.0) {
+            kernel->c1[i] = (float)(2.0 * p.re);
+            kernel->c2[i] = (float)-(p.re * p.re + p.im * p.im);
+        } else {
+            kernel->c1[i] = (float)p.re;
+            kernel->c2[i] = 0.0f;
+        }
+        kernel->g[i] = (float)(1.0 - (double)kernel->c1[i] - (double)kernel->c2[i]);
+
+        if (hypot(p.re, p.im) > r_max)
+            r_max = hypot(p.re, p.im);
+    }
+
+    // the cascade settles a little slower than its slowest pole alone
+    kernel->margin = (size_t)ceil(log(IIR_MARGIN_EPS) / log(r_max)) + 2 * FF_IIR_SECTIONS;
+
+    return kernel;
+}
+
+void DLL_PUBLIC fastfilters_kernel_iir_free(fastfilters_kernel_iir_t kernel)
+{
+    fastfilters_memory_free(kernel);
+}
+
+void DLL_PUBLIC fastfilters_iir_set_crossover(double sigma)
+{
+    g_iir_crossover = sigma;
+}
+
+double DLL_PUBLIC fastfilters_iir_get_crossover(void)
+{
+    return g_iir_crossover;
+}
+
+bool fastfilters_iir_select(const double *sigmas, unsigned int ndim, const float *window_ratios,
+                            const fastfilters_options_t *options)
+{
+    // an explicit window ratio asks for a truncated fir kernel
+    if (g_iir_crossover <= 0.0 || window_ratios || opt_window_ratio(options) > 0.0 || opt_exact_fir(options))
+        return false;
+
+    for (unsigned int i = 0; i < ndim; ++i)
+        if (!(sigmas[i] >= g_iir_crossover))
+            return false;
+
+    return true;
+}
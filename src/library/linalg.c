@@ -23,6 +23,11 @@ typedef void (*ev2d_fn_t)(const float *, const float *, const float *, float *,
 typedef void (*ev3d_fn_t)(const float *, const float *, const float *, const float *, const float *, const float *,
                           float *, float *, float *, const size_t);
 
+typedef void (*eigen2d_fn_t)(const float *, const float *, const float *, float *, float *, float *const *,
+                             const size_t);
+typedef void (*eigen3d_fn_t)(const float *, const float *, const float *, const float *, const float *, const float *,
+                             float *, float *, float *, float *const *, const size_t);
+
 typedef void (*combine_add_fn_t)(const float *, const float *, float *, size_t);
 typedef void (*combine_add3_fn_t)(const float *, const float *, const float *, float *, size_t);
 
@@ -41,6 +46,45 @@ DLL_LOCAL void _ev3d_avx(const float *a00, const float *a01, const float *a02, c
 DLL_LOCAL void _ev3d_avx2(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
                           const float *a22, float *ev0, float *ev1, float *ev2, const size_t len);
 
+DLL_LOCAL void _eigen2d_avx(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
+                            float *const *vec, const size_t len);
+DLL_LOCAL void _eigen2d_avx2(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
+                             float *const *vec, const size_t len);
+DLL_LOCAL void _eigen3d_avx(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                            const float *a22, float *ev0, float *ev1, float *ev2, float *const *vec, const size_t len);
+DLL_LOCAL void _eigen3d_avx2(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                             const float *a22, float *ev0, float *ev1, float *ev2, float *const *vec, const size_t len);
+
+#ifdef HAVE_AVX512F
+void DLL_LOCAL _ev2d_avx512(const float *xx, const float *xy, const float *yy, float *ev_small, float *ev_big,
+                            const size_t len);
+
+void DLL_LOCAL _combine_add_avx512(const float *a, const float *b, float *c, size_t len);
+void DLL_LOCAL _combine_addsqrt_avx512(const float *a, const float *b, float *c, size_t len);
+void DLL_LOCAL _combine_mul_avx512(const float *a, const float *b, float *c, size_t len);
+
+void DLL_LOCAL _combine_add3_avx512(const float *a, const float *b, const float *c, float *res, size_t len);
+void DLL_LOCAL _combine_addsqrt3_avx512(const float *a, const float *b, const float *c, float *res, size_t len);
+
+DLL_LOCAL void _ev3d_avx512(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                            const float *a22, float *ev0, float *ev1, float *ev2, const size_t len);
+#endif
+
+#ifdef HAVE_NEON
+void DLL_LOCAL _ev2d_neon(const float *xx, const float *xy, const float *yy, float *ev_small, float *ev_big,
+                          const size_t len);
+
+void DLL_LOCAL _combine_add_neon(const float *a, const float *b, float *c, size_t len);
+void DLL_LOCAL _combine_addsqrt_neon(const float *a, const float *b, float *c, size_t len);
+void DLL_LOCAL _combine_mul_neon(const float *a, const float *b, float *c, size_t len);
+
+void DLL_LOCAL _combine_add3_neon(const float *a, const float *b, const float *c, float *res, size_t len);
+void DLL_LOCAL _combine_addsqrt3_neon(const float *a, const float *b, const float *c, float *res, size_t len);
+
+DLL_LOCAL void _ev3d_neon(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                          const float *a22, float *ev0, float *ev1, float *ev2, const size_t len);
+#endif
+
 static void _ev2d_default(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
                           const size_t len)
 {
@@ -132,76 +176,237 @@ static inline float max(float a, float b)
         return b;
 }
 
-static void _ev3d_default(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
-                          const float *a22, float *ev0, float *ev1, float *ev2, const size_t len)
+// eigenvalues of the matrix m = a00 .. a22 in descending order; m is scaled in place by the returned maximum element
+// and so are the eigenvalues in r
+static float ev3d_scaled(float *m, float *r)
 {
     const float inv3 = 1.0 / 3.0;
     const float root3 = sqrt(3.0);
 
+    // guard against float overflows
+    float max0 = max(fabs(m[0]), fabs(m[1]));
+    float max1 = max(fabs(m[2]), fabs(m[3]));
+    float max2 = max(fabs(m[4]), fabs(m[5]));
+    float maxElement = max(max(max0, max1), max2);
+
+    if (maxElement == 0) {
+        r[0] = 0;
+        r[1] = 0;
+        r[2] = 0;
+        return 0;
+    }
+
+    float invMaxElement = 1/maxElement;
+    for (unsigned int i = 0; i < 6; ++i)
+        m[i] *= invMaxElement;
+
+    const float i_a00 = m[0], i_a01 = m[1], i_a02 = m[2], i_a11 = m[3], i_a12 = m[4], i_a22 = m[5];
+
+    float c0 = i_a00 * i_a11 * i_a22 + 2.0 * i_a01 * i_a02 * i_a12 - i_a00 * i_a12 * i_a12 -
+               i_a11 * i_a02 * i_a02 - i_a22 * i_a01 * i_a01;
+    float c1 =
+        i_a00 * i_a11 - i_a01 * i_a01 + i_a00 * i_a22 - i_a02 * i_a02 + i_a11 * i_a22 - i_a12 * i_a12;
+    float c2 = i_a00 + i_a11 + i_a22;
+    float c2Div3 = c2 * inv3;
+    float aDiv3 = (c1 - c2 * c2Div3) * inv3;
+
+    if (aDiv3 > 0.0)
+        aDiv3 = 0.0;
+
+    float mbDiv2 = 0.5 * (c0 + c2Div3 * (2.0 * c2Div3 * c2Div3 - c1));
+    float q = mbDiv2 * mbDiv2 + aDiv3 * aDiv3 * aDiv3;
+
+    if (q > 0.0)
+        q = 0.0;
+
+    float magnitude = sqrt(-aDiv3);
+    float angle = atan2(sqrt(-q), mbDiv2) * inv3;
+    float cs = cos(angle);
+    float sn = sin(angle);
+    float r0 = (c2Div3 + 2.0 * magnitude * cs);
+    float r1 = (c2Div3 - magnitude * (cs + root3 * sn));
+    float r2 = (c2Div3 - magnitude * (cs - root3 * sn));
+
+    if (r0 < r1)
+        swap(&r0, &r1);
+    if (r0 < r2)
+        swap(&r0, &r2);
+    if (r1 < r2)
+        swap(&r1, &r2);
+
+    r[0] = r0;
+    r[1] = r1;
+    r[2] = r2;
+    return maxElement;
+}
+
+static void _ev3d_default(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                          const float *a22, float *ev0, float *ev1, float *ev2, const size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        float m[6] = {a00[i], a01[i], a02[i], a11[i], a12[i], a22[i]};
+        float r[3];
+
+        const float maxElement = ev3d_scaled(m, r);
+
+        ev0[i] = r[0] * maxElement;
+        ev1[i] = r[1] * maxElement;
+        ev2[i] = r[2] * maxElement;
+    }
+}
+
+static float dot3(const float *a, const float *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void cross3(const float *a, const float *b, float *c)
+{
+    c[0] = a[1] * b[2] - a[2] * b[1];
+    c[1] = a[2] * b[0] - a[0] * b[2];
+    c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// unit eigenvector of the single eigenvalue l: the largest cross product of two rows of m - l
+static void evec3d_first(const float *m, float l, float *w)
+{
+    const float rows[3][3] = {{m[0] - l, m[1], m[2]}, {m[1], m[3] - l, m[4]}, {m[2], m[4], m[5] - l}};
+    float c[3][3], d[3];
+
+    cross3(rows[0], rows[1], c[0]);
+    cross3(rows[0], rows[2], c[1]);
+    cross3(rows[1], rows[2], c[2]);
+
+    unsigned int best = 0;
+    for (unsigned int i = 0; i < 3; ++i) {
+        d[i] = dot3(c[i], c[i]);
+        if (d[i] > d[best])
+            best = i;
+    }
+
+    // a multiple of the identity has any vector as eigenvector
+    if (d[best] == 0) {
+        w[0] = 1;
+        w[1] = 0;
+        w[2] = 0;
+        return;
+    }
+
+    const float inv_len = 1 / sqrt(d[best]);
+    for (unsigned int i = 0; i < 3; ++i)
+        w[i] = c[best][i] * inv_len;
+}
+
+// unit eigenvector of the eigenvalue l orthogonal to the unit eigenvector w, solved in the plane orthogonal to w
+static void evec3d_second(const float *m, float l, const float *w, float *out)
+{
+    float u[3], v[3], au[3], av[3];
+
+    // orthonormal u, v with w = u x v
+    if (fabs(w[0]) > fabs(w[1])) {
+        const float inv_len = 1 / sqrt(w[0] * w[0] + w[2] * w[2]);
+        u[0] = -w[2] * inv_len;
+        u[1] = 0;
+        u[2] = w[0] * inv_len;
+    } else {
+        const float inv_len = 1 / sqrt(w[1] * w[1] + w[2] * w[2]);
+        u[0] = 0;
+        u[1] = w[2] * inv_len;
+        u[2] = -w[1] * inv_len;
+    }
+    cross3(w, u, v);
+
+    const float rows[3][3] = {{m[0], m[1], m[2]}, {m[1], m[3], m[4]}, {m[2], m[4], m[5]}};
+    for (unsigned int i = 0; i < 3; ++i) {
+        au[i] = dot3(rows[i], u);
+        av[i] = dot3(rows[i], v);
+    }
+
+    // m - l restricted to span(u, v), the null vector of its row with the larger entries gives the eigenvector
+    const float m00 = dot3(u, au) - l, m01 = dot3(u, av), m11 = dot3(v, av) - l;
+    float p, q;
+
+    if (max(fabs(m00), fabs(m01)) >= fabs(m11)) {
+        p = m01;
+        q = -m00;
+    } else {
+        p = m11;
+        q = -m01;
+    }
+
+    const float p_max = max(fabs(p), fabs(q));
+
+    // two equal eigenvalues, every vector of the plane qualifies
+    if (p_max == 0) {
+        p = 1;
+        q = 0;
+    } else {
+        p /= p_max;
+        q /= p_max;
+    }
+
+    const float inv_len = 1 / sqrt(p * p + q * q);
+    for (unsigned int i = 0; i < 3; ++i)
+        out[i] = (p * u[i] + q * v[i]) * inv_len;
+}
+
+// see eigen3d_ps in linalg_avx2.c
+static void _eigen3d_default(const float *a00, const float *a01, const float *a02, const float *a11,
+                             const float *a12, const float *a22, float *ev0, float *ev1, float *ev2,
+                             float *const *vec, const size_t len)
+{
     for (size_t i = 0; i < len; ++i) {
-        float i_a00 = a00[i];
-        float i_a01 = a01[i];
-        float i_a02 = a02[i];
-        float i_a11 = a11[i];
-        float i_a12 = a12[i];
-        float i_a22 = a22[i];
-
-        // guard against float overflows
-        float max0 = max(fabs(i_a00), fabs(i_a01));
-        float max1 = max(fabs(i_a02), fabs(i_a11));
-        float max2 = max(fabs(i_a12), fabs(i_a22));
-        float maxElement = max(max(max0, max1), max2);
-
-        if (maxElement == 0) {
-            ev0[i] = 0;
-            ev1[i] = 0;
-            ev2[i] = 0;
-            continue;
+        float m[6] = {a00[i], a01[i], a02[i], a11[i], a12[i], a22[i]};
+        float r[3], w[3][3];
+
+        const float maxElement = ev3d_scaled(m, r);
+
+        // the eigenvalue farthest from the middle one first
+        const unsigned int first = r[0] - r[1] >= r[1] - r[2] ? 0 : 2;
+        evec3d_first(m, r[first], w[first]);
+        evec3d_second(m, r[1], w[first], w[1]);
+        cross3(w[first], w[1], w[2 - first]);
+
+        ev0[i] = r[0] * maxElement;
+        ev1[i] = r[1] * maxElement;
+        ev2[i] = r[2] * maxElement;
+        for (unsigned int k = 0; k < 3; ++k)
+            for (unsigned int j = 0; j < 3; ++j)
+                vec[k * 3 + j][i] = w[k][j];
+    }
+}
+
+// see eigen2d_fname in linalg_avx2.c
+static void _eigen2d_default(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
+                             float *const *vec, const size_t len)
+{
+    _ev2d_default(xx, xy, yy, ev_big, ev_small, len);
+
+    for (size_t i = 0; i < len; ++i) {
+        float s = max(max(fabs(xx[i]), fabs(yy[i])), fabs(xy[i]));
+        if (s == 0)
+            s = 1;
+
+        const float d = (xx[i] - yy[i]) / 2.0 / s;
+        const float b = xy[i] / s;
+        const float r = sqrt(d * d + b * b);
+        const float len_sq = 2 * r * (r + fabs(d));
+        float x = d >= 0 ? d + r : b;
+        float y = d >= 0 ? b : r - d;
+
+        if (len_sq == 0) {
+            x = 1;
+            y = 0;
+        } else {
+            const float inv_len = 1 / sqrt(len_sq);
+            x *= inv_len;
+            y *= inv_len;
         }
 
-        float invMaxElement = 1/maxElement;
-        i_a00 *= invMaxElement;
-        i_a01 *= invMaxElement;
-        i_a02 *= invMaxElement;
-        i_a11 *= invMaxElement;
-        i_a12 *= invMaxElement;
-        i_a22 *= invMaxElement;
-
-        float c0 = i_a00 * i_a11 * i_a22 + 2.0 * i_a01 * i_a02 * i_a12 - i_a00 * i_a12 * i_a12 -
-                   i_a11 * i_a02 * i_a02 - i_a22 * i_a01 * i_a01;
-        float c1 =
-            i_a00 * i_a11 - i_a01 * i_a01 + i_a00 * i_a22 - i_a02 * i_a02 + i_a11 * i_a22 - i_a12 * i_a12;
-        float c2 = i_a00 + i_a11 + i_a22;
-        float c2Div3 = c2 * inv3;
-        float aDiv3 = (c1 - c2 * c2Div3) * inv3;
-
-        if (aDiv3 > 0.0)
-            aDiv3 = 0.0;
-
-        float mbDiv2 = 0.5 * (c0 + c2Div3 * (2.0 * c2Div3 * c2Div3 - c1));
-        float q = mbDiv2 * mbDiv2 + aDiv3 * aDiv3 * aDiv3;
-
-        if (q > 0.0)
-            q = 0.0;
-
-        float magnitude = sqrt(-aDiv3);
-        float angle = atan2(sqrt(-q), mbDiv2) * inv3;
-        float cs = cos(angle);
-        float sn = sin(angle);
-        float r0 = (c2Div3 + 2.0 * magnitude * cs);
-        float r1 = (c2Div3 - magnitude * (cs + root3 * sn));
-        float r2 = (c2Div3 - magnitude * (cs - root3 * sn));
-
-        if (r0 < r1)
-            swap(&r0, &r1);
-        if (r0 < r2)
-            swap(&r0, &r2);
-        if (r1 < r2)
-            swap(&r1, &r2);
-
-        ev0[i] = r0 * maxElement;
-        ev1[i] = r1 * maxElement;
-        ev2[i] = r2 * maxElement;
+        vec[0][i] = x;
+        vec[1][i] = y;
+        vec[2][i] = -y;
+        vec[3][i] = x;
     }
 }
 
@@ -237,6 +442,8 @@ static void _combine_addsqrt3_default(const float *a, const float *b, const floa
 
 static ev2d_fn_t g_ev2d_fn = NULL;
 static ev3d_fn_t g_ev3d_fn = NULL;
+static eigen2d_fn_t g_eigen2d_fn = NULL;
+static eigen3d_fn_t g_eigen3d_fn = NULL;
 static combine_add_fn_t g_combine_add = NULL;
 static combine_add_fn_t g_combine_mul = NULL;
 static combine_add_fn_t g_combine_addsqrt = NULL;
@@ -264,11 +471,29 @@ void fastfilters_linalg_init()
 
     if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX2)) {
         g_ev3d_fn = _ev3d_avx2;
+        g_eigen2d_fn = _eigen2d_avx2;
+        g_eigen3d_fn = _eigen3d_avx2;
     } else if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX)) {
         g_ev3d_fn = _ev3d_avx;
+        g_eigen2d_fn = _eigen2d_avx;
+        g_eigen3d_fn = _eigen3d_avx;
     } else {
         g_ev3d_fn = _ev3d_default;
+        g_eigen2d_fn = _eigen2d_default;
+        g_eigen3d_fn = _eigen3d_default;
     }
+
+    #ifdef HAVE_AVX512F
+    if (fastfilters_cpu_check(FASTFILTERS_CPU_AVX512F)) {
+        g_combine_add = _combine_add_avx512;
+        g_combine_add3 = _combine_add3_avx512;
+        g_combine_mul = _combine_mul_avx512;
+        g_combine_addsqrt = _combine_addsqrt_avx512;
+        g_combine_addsqrt3 = _combine_addsqrt3_avx512;
+        g_ev2d_fn = _ev2d_avx512;
+        g_ev3d_fn = _ev3d_avx512;
+    }
+    #endif
     #else
         g_combine_add = _combine_add_avx;
         g_combine_add3 = _combine_add3_avx;
@@ -277,9 +502,60 @@ void fastfilters_linalg_init()
         g_combine_addsqrt3 = _combine_addsqrt3_avx;
         g_ev2d_fn = _ev2d_avx;
         g_ev3d_fn = _ev3d_avx2;
+        g_eigen2d_fn = _eigen2d_avx2;
+        g_eigen3d_fn = _eigen3d_avx2;
+
+    #ifdef HAVE_NEON
+    if (fastfilters_cpu_check(FASTFILTERS_CPU_NEON)) {
+        g_combine_add = _combine_add_neon;
+        g_combine_add3 = _combine_add3_neon;
+        g_combine_mul = _combine_mul_neon;
+        g_combine_addsqrt = _combine_addsqrt_neon;
+        g_combine_addsqrt3 = _combine_addsqrt3_neon;
+        g_ev2d_fn = _ev2d_neon;
+        g_ev3d_fn = _ev3d_neon;
+    }
+    #endif
     #endif
 }
 
+// results that are not stored as float are computed block by block into a buffer that stays in L1
+static void combine_store(combine_add_fn_t fn, const float *a, const float *b, void *out, fastfilters_type_t type,
+                          size_t n)
+{
+    float block[FF_STORE_BLOCK];
+
+    if (type == FASTFILTERS_TYPE_FLOAT32) {
+        fn(a, b, out, n);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i += FF_STORE_BLOCK) {
+        const size_t len = n - i < FF_STORE_BLOCK ? n - i : FF_STORE_BLOCK;
+
+        fn(a + i, b + i, block, len);
+        fastfilters_type_store(block, len, out, type, i);
+    }
+}
+
+static void combine3_store(combine_add3_fn_t fn, const float *a, const float *b, const float *c, void *out,
+                           fastfilters_type_t type, size_t n)
+{
+    float block[FF_STORE_BLOCK];
+
+    if (type == FASTFILTERS_TYPE_FLOAT32) {
+        fn(a, b, c, out, n);
+        return;
+    }
+
+    for (size_t i = 0; i < n; i += FF_STORE_BLOCK) {
+        const size_t len = n - i < FF_STORE_BLOCK ? n - i : FF_STORE_BLOCK;
+
+        fn(a + i, b + i, c + i, block, len);
+        fastfilters_type_store(block, len, out, type, i);
+    }
+}
+
 void DLL_PUBLIC fastfilters_linalg_ev3d(const float *a00, const float *a01, const float *a02, const float *a11,
                                         const float *a12, const float *a22, float *ev0, float *ev1, float *ev2,
                                         const size_t len)
@@ -293,38 +569,149 @@ void DLL_PUBLIC fastfilters_linalg_ev2d(const float *xx, const float *xy, const
     g_ev2d_fn(xx, xy, yy, ev_small, ev_big, len);
 }
 
+void DLL_PUBLIC fastfilters_linalg_ev2d_ex(const float *xx, const float *xy, const float *yy, void *ev_small,
+                                           void *ev_big, const size_t len, fastfilters_type_t out_type)
+{
+    float block[2][FF_STORE_BLOCK];
+
+    if (out_type == FASTFILTERS_TYPE_FLOAT32) {
+        g_ev2d_fn(xx, xy, yy, ev_small, ev_big, len);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += FF_STORE_BLOCK) {
+        const size_t n = len - i < FF_STORE_BLOCK ? len - i : FF_STORE_BLOCK;
+
+        g_ev2d_fn(xx + i, xy + i, yy + i, block[0], block[1], n);
+        fastfilters_type_store(block[0], n, ev_small, out_type, i);
+        fastfilters_type_store(block[1], n, ev_big, out_type, i);
+    }
+}
+
+void DLL_PUBLIC fastfilters_linalg_ev3d_ex(const float *a00, const float *a01, const float *a02, const float *a11,
+                                           const float *a12, const float *a22, void *ev0, void *ev1, void *ev2,
+                                           const size_t len, fastfilters_type_t out_type)
+{
+    float block[3][FF_STORE_BLOCK];
+
+    if (out_type == FASTFILTERS_TYPE_FLOAT32) {
+        g_ev3d_fn(a00, a01, a02, a11, a12, a22, ev0, ev1, ev2, len);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += FF_STORE_BLOCK) {
+        const size_t n = len - i < FF_STORE_BLOCK ? len - i : FF_STORE_BLOCK;
+
+        g_ev3d_fn(a00 + i, a01 + i, a02 + i, a11 + i, a12 + i, a22 + i, block[0], block[1], block[2], n);
+        fastfilters_type_store(block[0], n, ev0, out_type, i);
+        fastfilters_type_store(block[1], n, ev1, out_type, i);
+        fastfilters_type_store(block[2], n, ev2, out_type, i);
+    }
+}
+
+void DLL_PUBLIC fastfilters_linalg_eigen2d(const float *xx, const float *xy, const float *yy, float *ev0, float *ev1,
+                                           float *const *vec, const size_t len)
+{
+    g_eigen2d_fn(xx, xy, yy, ev0, ev1, vec, len);
+}
+
+void DLL_PUBLIC fastfilters_linalg_eigen3d(const float *a00, const float *a01, const float *a02, const float *a11,
+                                           const float *a12, const float *a22, float *ev0, float *ev1, float *ev2,
+                                           float *const *vec, const size_t len)
+{
+    g_eigen3d_fn(a00, a01, a02, a11, a12, a22, ev0, ev1, ev2, vec, len);
+}
+
+void DLL_PUBLIC fastfilters_linalg_eigen2d_ex(const float *xx, const float *xy, const float *yy, void *ev0, void *ev1,
+                                              void *const *vec, const size_t len, fastfilters_type_t out_type)
+{
+    float block[6][FF_STORE_BLOCK];
+    float *const block_vec[4] = {block[2], block[3], block[4], block[5]};
+
+    if (out_type == FASTFILTERS_TYPE_FLOAT32) {
+        g_eigen2d_fn(xx, xy, yy, ev0, ev1, (float *const *)vec, len);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i += FF_STORE_BLOCK) {
+        const size_t n = len - i < FF_STORE_BLOCK ? len - i : FF_STORE_BLOCK;
+
+        g_eigen2d_fn(xx + i, xy + i, yy + i, block[0], block[1], block_vec, n);
+        fastfilters_type_store(block[0], n, ev0, out_type, i);
+        fastfilters_type_store(block[1], n, ev1, out_type, i);
+        for (unsigned int c = 0; c < 4; ++c)
+            fastfilters_type_store(block_vec[c], n, vec[c], out_type, i);
+    }
+}
+
+void DLL_PUBLIC fastfilters_linalg_eigen3d_ex(const float *a00, const float *a01, const float *a02, const float *a11,
+                                              const float *a12, const float *a22, void *ev0, void *ev1, void *ev2,
+                                              void *const *vec, const size_t len, fastfilters_type_t out_type)
+{
+    float block[12][FF_STORE_BLOCK];
+    float *block_vec[9];
+
+    if (out_type == FASTFILTERS_TYPE_FLOAT32) {
+        g_eigen3d_fn(a00, a01, a02, a11, a12, a22, ev0, ev1, ev2, (float *const *)vec, len);
+        return;
+    }
+
+    for (unsigned int c = 0; c < 9; ++c)
+        block_vec[c] = block[3 + c];
+
+    for (size_t i = 0; i < len; i += FF_STORE_BLOCK) {
+        const size_t n = len - i < FF_STORE_BLOCK ? len - i : FF_STORE_BLOCK;
+
+        g_eigen3d_fn(a00 + i, a01 + i, a02 + i, a11 + i, a12 + i, a22 + i, block[0], block[1], block[2], block_vec, n);
+        fastfilters_type_store(block[0], n, ev0, out_type, i);
+        fastfilters_type_store(block[1], n, ev1, out_type, i);
+        fastfilters_type_store(block[2], n, ev2, out_type, i);
+        for (unsigned int c = 0; c < 9; ++c)
+            fastfilters_type_store(block_vec[c], n, vec[c], out_type, i);
+    }
+}
+
 void DLL_PUBLIC fastfilters_combine_add2d(const fastfilters_array2d_t *a, const fastfilters_array2d_t *b,
                                           fastfilters_array2d_t *out)
 {
-    g_combine_add(a->ptr, b->ptr, out->ptr, a->n_y * a->stride_y);
+    combine_store(g_combine_add, a->ptr, b->ptr, out->ptr, out->type, a->n_y * a->stride_y);
 }
 
 void DLL_PUBLIC fastfilters_combine_addsqrt2d(const fastfilters_array2d_t *a, const fastfilters_array2d_t *b,
                                               fastfilters_array2d_t *out)
 {
-    g_combine_addsqrt(a->ptr, b->ptr, out->ptr, a->n_y * a->stride_y);
+    combine_store(g_combine_addsqrt, a->ptr, b->ptr, out->ptr, out->type, a->n_y * a->stride_y);
 }
 
 void DLL_PUBLIC fastfilters_combine_mul2d(const fastfilters_array2d_t *a, const fastfilters_array2d_t *b,
                                           fastfilters_array2d_t *out)
 {
-    g_combine_mul(a->ptr, b->ptr, out->ptr, a->n_y * a->stride_y);
+    combine_store(g_combine_mul, a->ptr, b->ptr, out->ptr, out->type, a->n_y * a->stride_y);
 }
 
 void DLL_PUBLIC fastfilters_combine_mul3d(const fastfilters_array3d_t *a, const fastfilters_array3d_t *b,
                                           fastfilters_array3d_t *out)
 {
-    g_combine_mul(a->ptr, b->ptr, out->ptr, a->n_z * a->stride_z);
+    combine_store(g_combine_mul, a->ptr, b->ptr, out->ptr, out->type, a->n_z * a->stride_z);
 }
 
 void DLL_PUBLIC fastfilters_combine_add3d(const fastfilters_array3d_t *a, const fastfilters_array3d_t *b,
                                           const fastfilters_array3d_t *c, fastfilters_array3d_t *out)
 {
-    g_combine_add3(a->ptr, b->ptr, c->ptr, out->ptr, a->n_z * a->stride_z);
+    combine3_store(g_combine_add3, a->ptr, b->ptr, c->ptr, out->ptr, out->type, a->n_z * a->stride_z);
 }
 
 void DLL_PUBLIC fastfilters_combine_addsqrt3d(const fastfilters_array3d_t *a, const fastfilters_array3d_t *b,
                                               const fastfilters_array3d_t *c, fastfilters_array3d_t *out)
 {
-    g_combine_addsqrt3(a->ptr, b->ptr, c->ptr, out->ptr, a->n_z * a->stride_z);
+    combine3_store(g_combine_addsqrt3, a->ptr, b->ptr, c->ptr, out->ptr, out->type,
+                   a->n_z * a->stride_z);
+}
+
+void fastfilters_combine_sum(const float *const *terms, size_t n_terms, bool sqrt_of_squares, float *out, size_t n)
+{
+    if (n_terms == 2)
+        (sqrt_of_squares ? g_combine_addsqrt : g_combine_add)(terms[0], terms[1], out, n);
+    else
+        (sqrt_of_squares ? g_combine_addsqrt3 : g_combine_add3)(terms[0], terms[1], terms[2], out, n);
 }
@@ -43,11 +43,17 @@ static inline float max(float a, float b)
 
 #ifdef _USE_SIMDE_ON_ARM_
 #define fname _ev3d_avx2
+#define eigen2d_fname _eigen2d_avx2
+#define eigen3d_fname _eigen3d_avx2
 #else
 #ifdef __AVX2__
 #define fname _ev3d_avx2
+#define eigen2d_fname _eigen2d_avx2
+#define eigen3d_fname _eigen3d_avx2
 #elif defined(__AVX__)
 #define fname _ev3d_avx
+#define eigen2d_fname _eigen2d_avx
+#define eigen3d_fname _eigen3d_avx
 #else
 #error "linalg_avx2.c needs to be compiled with avx or avx2 support"
 #endif
@@ -60,89 +66,90 @@ static inline __m256 _mm256_abs_ps(__m256 x)
 }
 
 
+// eigenvalues of the matrices a00 .. a22 in descending order; a is scaled in place by the returned maximum element
+// and so are the eigenvalues in r
+static inline __m256 ev3d_scaled_ps(__m256 *a, __m256 *r)
+{
+    const __m256 v_inv3 = _mm256_set1_ps(1.0 / 3.0);
+    const __m256 v_root3 = _mm256_sqrt_ps(_mm256_set1_ps(3.0));
+    const __m256 two = _mm256_set1_ps(2.0);
+    const __m256 one = _mm256_set1_ps(1.0);
+    const __m256 half = _mm256_set1_ps(0.5);
+    const __m256 zero = _mm256_setzero_ps();
+
+    // guard against float overflows
+    __m256 v_max0 = _mm256_max_ps(_mm256_abs_ps(a[0]), _mm256_abs_ps(a[1]));
+    __m256 v_max1 = _mm256_max_ps(_mm256_abs_ps(a[2]), _mm256_abs_ps(a[3]));
+    __m256 v_max2 = _mm256_max_ps(_mm256_abs_ps(a[4]), _mm256_abs_ps(a[5]));
+    __m256 v_max_element = _mm256_max_ps(_mm256_max_ps(v_max0, v_max1), v_max2);
+
+    // replace zeros with ones to avoid NaNs
+    v_max_element = _mm256_or_ps(v_max_element, _mm256_and_ps(one, _mm256_cmp_ps(v_max_element, zero, _CMP_EQ_UQ)));
+
+    for (unsigned int i = 0; i < 6; ++i)
+        a[i] = _mm256_div_ps(a[i], v_max_element);
+
+    const __m256 v_a00 = a[0], v_a01 = a[1], v_a02 = a[2], v_a11 = a[3], v_a12 = a[4], v_a22 = a[5];
+
+    __m256 c0 = _avx_sub(_avx_sub(_avx_sub(_avx_add(_avx_mul(_avx_mul(v_a00, v_a11), v_a22),
+        _avx_mul(_avx_mul(_avx_mul(two, v_a01), v_a02), v_a12)),
+        _avx_mul(_avx_mul(v_a00, v_a12), v_a12)),
+        _avx_mul(_avx_mul(v_a11, v_a02), v_a02)),
+        _avx_mul(_avx_mul(v_a22, v_a01), v_a01));
+    __m256 c1 = _avx_sub(_avx_add(_avx_sub(_avx_add(_avx_sub(_avx_mul(v_a00, v_a11),
+        _avx_mul(v_a01, v_a01)),
+        _avx_mul(v_a00, v_a22)),
+        _avx_mul(v_a02, v_a02)),
+        _avx_mul(v_a11, v_a22)),
+        _avx_mul(v_a12, v_a12));
+    __m256 c2 = _avx_add(_avx_add(v_a00, v_a11), v_a22);
+    __m256 c2Div3 = _avx_mul(c2, v_inv3);
+    __m256 aDiv3 = _avx_mul(_avx_sub(c1, _avx_mul(c2, c2Div3)), v_inv3);
+
+    aDiv3 = _mm256_min_ps(aDiv3, zero);
+
+    __m256 mbDiv2 = _avx_mul(half, _avx_add(c0, _avx_mul(c2Div3, _avx_sub(_avx_mul(_avx_mul(two, c2Div3), c2Div3), c1))));
+    __m256 q = _avx_add(_avx_mul(mbDiv2, mbDiv2), _avx_mul(_avx_mul(aDiv3, aDiv3), aDiv3));
+
+    q = _mm256_min_ps(q, zero);
+
+    __m256 magnitude = _mm256_sqrt_ps(_avx_neg(aDiv3));
+    __m256 angle = _avx_mul(atan2_256_ps(_mm256_sqrt_ps(_avx_neg(q)), mbDiv2), v_inv3);
+    __m256 cs, sn;
+
+    sincos256_ps(angle, &sn, &cs);
+
+    __m256 r0 = _avx_add(c2Div3, _avx_mul(_avx_mul(two, magnitude), cs));
+    __m256 r1 = _avx_sub(c2Div3, _avx_mul(magnitude, _avx_add(cs, _avx_mul(v_root3, sn))));
+    __m256 r2 = _avx_sub(c2Div3, _avx_mul(magnitude, _avx_sub(cs, _avx_mul(v_root3, sn))));
+
+    __m256 v_r0_tmp = _mm256_min_ps(r0, r1);
+    __m256 v_r1_tmp = _mm256_max_ps(r0, r1);
+
+    r[2] = _mm256_min_ps(v_r0_tmp, r2);
+    __m256 v_r2_tmp = _mm256_max_ps(v_r0_tmp, r2);
+
+    r[1] = _mm256_min_ps(v_r1_tmp, v_r2_tmp);
+    r[0] = _mm256_max_ps(v_r1_tmp, v_r2_tmp);
+
+    return v_max_element;
+}
+
 DLL_LOCAL void fname(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
                      const float *a22, float *ev0, float *ev1, float *ev2, const size_t len)
 {
     const size_t avx_end = len & ~7;
-    __m256 v_inv3 = _mm256_set1_ps(1.0 / 3.0);
-    __m256 v_root3 = _mm256_sqrt_ps(_mm256_set1_ps(3.0));
-    __m256 two = _mm256_set1_ps(2.0);
-    __m256 one = _mm256_set1_ps(1.0);
-    __m256 half = _mm256_set1_ps(0.5);
-    __m256 zero = _mm256_setzero_ps();
 
     for (size_t i = 0; i < avx_end; i += 8) {
-        __m256 v_a00 = _mm256_loadu_ps(a00 + i);
-        __m256 v_a01 = _mm256_loadu_ps(a01 + i);
-        __m256 v_a02 = _mm256_loadu_ps(a02 + i);
-        __m256 v_a11 = _mm256_loadu_ps(a11 + i);
-        __m256 v_a12 = _mm256_loadu_ps(a12 + i);
-        __m256 v_a22 = _mm256_loadu_ps(a22 + i);
+        __m256 a[6] = {_mm256_loadu_ps(a00 + i), _mm256_loadu_ps(a01 + i), _mm256_loadu_ps(a02 + i),
+                       _mm256_loadu_ps(a11 + i), _mm256_loadu_ps(a12 + i), _mm256_loadu_ps(a22 + i)};
+        __m256 r[3];
 
-        // guard against float overflows
-        __m256 v_max0 = _mm256_max_ps(_mm256_abs_ps(v_a00), _mm256_abs_ps(v_a01));
-        __m256 v_max1 = _mm256_max_ps(_mm256_abs_ps(v_a02), _mm256_abs_ps(v_a11));
-        __m256 v_max2 = _mm256_max_ps(_mm256_abs_ps(v_a12), _mm256_abs_ps(v_a22));
-        __m256 v_max_element = _mm256_max_ps(_mm256_max_ps(v_max0, v_max1), v_max2);
-
-        // replace zeros with ones to avoid NaNs
-        v_max_element = _mm256_or_ps(v_max_element, _mm256_and_ps(one, _mm256_cmp_ps(v_max_element, zero, _CMP_EQ_UQ)));
-
-        v_a00 = _mm256_div_ps(v_a00, v_max_element);
-        v_a01 = _mm256_div_ps(v_a01, v_max_element);
-        v_a02 = _mm256_div_ps(v_a02, v_max_element);
-        v_a11 = _mm256_div_ps(v_a11, v_max_element);
-        v_a12 = _mm256_div_ps(v_a12, v_max_element);
-        v_a22 = _mm256_div_ps(v_a22, v_max_element);
-
-        __m256 c0 = _avx_sub(_avx_sub(_avx_sub(_avx_add(_avx_mul(_avx_mul(v_a00, v_a11), v_a22),
-            _avx_mul(_avx_mul(_avx_mul(two, v_a01), v_a02), v_a12)),
-            _avx_mul(_avx_mul(v_a00, v_a12), v_a12)),
-            _avx_mul(_avx_mul(v_a11, v_a02), v_a02)),
-            _avx_mul(_avx_mul(v_a22, v_a01), v_a01));
-        __m256 c1 = _avx_sub(_avx_add(_avx_sub(_avx_add(_avx_sub(_avx_mul(v_a00, v_a11),
-            _avx_mul(v_a01, v_a01)),
-            _avx_mul(v_a00, v_a22)),
-            _avx_mul(v_a02, v_a02)),
-            _avx_mul(v_a11, v_a22)),
-            _avx_mul(v_a12, v_a12));
-        __m256 c2 = _avx_add(_avx_add(v_a00, v_a11), v_a22);
-        __m256 c2Div3 = _avx_mul(c2, v_inv3);
-        __m256 aDiv3 = _avx_mul(_avx_sub(c1, _avx_mul(c2, c2Div3)), v_inv3);
-
-        aDiv3 = _mm256_min_ps(aDiv3, zero);
-
-        __m256 mbDiv2 = _avx_mul(half, _avx_add(c0, _avx_mul(c2Div3, _avx_sub(_avx_mul(_avx_mul(two, c2Div3), c2Div3), c1))));
-        __m256 q = _avx_add(_avx_mul(mbDiv2, mbDiv2), _avx_mul(_avx_mul(aDiv3, aDiv3), aDiv3));
-
-        q = _mm256_min_ps(q, zero);
-
-        __m256 magnitude = _mm256_sqrt_ps(_avx_neg(aDiv3));
-        __m256 angle = _avx_mul(atan2_256_ps(_mm256_sqrt_ps(_avx_neg(q)), mbDiv2), v_inv3);
-        __m256 cs, sn;
-
-        sincos256_ps(angle, &sn, &cs);
-
-        __m256 r0 = _avx_add(c2Div3, _avx_mul(_avx_mul(two, magnitude), cs));
-        __m256 r1 = _avx_sub(c2Div3, _avx_mul(magnitude, _avx_add(cs, _avx_mul(v_root3, sn))));
-        __m256 r2 = _avx_sub(c2Div3, _avx_mul(magnitude, _avx_sub(cs, _avx_mul(v_root3, sn))));
-
-        __m256 v_r0_tmp = _mm256_min_ps(r0, r1);
-        __m256 v_r1_tmp = _mm256_max_ps(r0, r1);
-
-        __m256 v_r0 = _mm256_min_ps(v_r0_tmp, r2);
-        __m256 v_r2_tmp = _mm256_max_ps(v_r0_tmp, r2);
-
-        __m256 v_r1 = _mm256_min_ps(v_r1_tmp, v_r2_tmp);
-        __m256 v_r2 = _mm256_max_ps(v_r1_tmp, v_r2_tmp);
-
-        v_r0 = _mm256_mul_ps(v_r0, v_max_element);
-        v_r1 = _mm256_mul_ps(v_r1, v_max_element);
-        v_r2 = _mm256_mul_ps(v_r2, v_max_element);
-
-        _mm256_storeu_ps(ev2 + i, v_r0);
-        _mm256_storeu_ps(ev1 + i, v_r1);
-        _mm256_storeu_ps(ev0 + i, v_r2);
+        const __m256 v_max_element = ev3d_scaled_ps(a, r);
+
+        _mm256_storeu_ps(ev2 + i, _mm256_mul_ps(r[2], v_max_element));
+        _mm256_storeu_ps(ev1 + i, _mm256_mul_ps(r[1], v_max_element));
+        _mm256_storeu_ps(ev0 + i, _mm256_mul_ps(r[0], v_max_element));
     }
 
     const float inv3 = 1.0 / 3.0;
@@ -212,4 +219,261 @@ DLL_LOCAL void fname(const float *a00, const float *a01, const float *a02, const
         ev1[i] = r1 * maxElement;
         ev2[i] = r2 * maxElement;
     }
-}
\ No newline at end of file
+}
+
+typedef struct {
+    __m256 x, y, z;
+} vec3_ps;
+
+static inline __m256 dot3_ps(vec3_ps a, vec3_ps b)
+{
+    return _avx_add(_avx_add(_avx_mul(a.x, b.x), _avx_mul(a.y, b.y)), _avx_mul(a.z, b.z));
+}
+
+static inline vec3_ps cross3_ps(vec3_ps a, vec3_ps b)
+{
+    const vec3_ps c = {_avx_sub(_avx_mul(a.y, b.z), _avx_mul(a.z, b.y)),
+                       _avx_sub(_avx_mul(a.z, b.x), _avx_mul(a.x, b.z)),
+                       _avx_sub(_avx_mul(a.x, b.y), _avx_mul(a.y, b.x))};
+    return c;
+}
+
+static inline vec3_ps scale3_ps(vec3_ps a, __m256 s)
+{
+    const vec3_ps c = {_avx_mul(a.x, s), _avx_mul(a.y, s), _avx_mul(a.z, s)};
+    return c;
+}
+
+// lanes of b where mask is set, of a elsewhere
+static inline vec3_ps blend3_ps(vec3_ps a, vec3_ps b, __m256 mask)
+{
+    const vec3_ps c = {_mm256_blendv_ps(a.x, b.x, mask), _mm256_blendv_ps(a.y, b.y, mask),
+                       _mm256_blendv_ps(a.z, b.z, mask)};
+    return c;
+}
+
+// symmetric matrix a00 .. a22 times v
+static inline vec3_ps matvec3_ps(const __m256 *a, vec3_ps v)
+{
+    const vec3_ps c = {dot3_ps((vec3_ps){a[0], a[1], a[2]}, v), dot3_ps((vec3_ps){a[1], a[3], a[4]}, v),
+                       dot3_ps((vec3_ps){a[2], a[4], a[5]}, v)};
+    return c;
+}
+
+// unit eigenvector of the single eigenvalue l: the largest cross product of two rows of a - l
+static inline vec3_ps evec3d_first_ps(const __m256 *a, __m256 l)
+{
+    const __m256 one = _mm256_set1_ps(1.0);
+    const __m256 zero = _mm256_setzero_ps();
+    const vec3_ps r0 = {_avx_sub(a[0], l), a[1], a[2]};
+    const vec3_ps r1 = {a[1], _avx_sub(a[3], l), a[4]};
+    const vec3_ps r2 = {a[2], a[4], _avx_sub(a[5], l)};
+
+    const vec3_ps c01 = cross3_ps(r0, r1), c02 = cross3_ps(r0, r2), c12 = cross3_ps(r1, r2);
+    const __m256 d01 = dot3_ps(c01, c01), d02 = dot3_ps(c02, c02), d12 = dot3_ps(c12, c12);
+
+    __m256 mask = _mm256_cmp_ps(d02, d01, _CMP_GT_OQ);
+    vec3_ps best = blend3_ps(c01, c02, mask);
+    __m256 d = _mm256_max_ps(d01, d02);
+
+    mask = _mm256_cmp_ps(d12, d, _CMP_GT_OQ);
+    best = blend3_ps(best, c12, mask);
+    d = _mm256_max_ps(d, d12);
+
+    // a multiple of the identity has any vector as eigenvector
+    const vec3_ps e0 = {one, zero, zero};
+    mask = _mm256_cmp_ps(d, zero, _CMP_EQ_OQ);
+    best = blend3_ps(best, e0, mask);
+    d = _mm256_blendv_ps(d, one, mask);
+
+    return scale3_ps(best, _mm256_div_ps(one, _mm256_sqrt_ps(d)));
+}
+
+// unit eigenvector of the eigenvalue l orthogonal to the unit eigenvector w, solved in the plane orthogonal to w
+static inline vec3_ps evec3d_second_ps(const __m256 *a, __m256 l, vec3_ps w)
+{
+    const __m256 one = _mm256_set1_ps(1.0);
+    const __m256 zero = _mm256_setzero_ps();
+
+    // orthonormal u, v with w = u x v
+    __m256 mask = _mm256_cmp_ps(_mm256_abs_ps(w.x), _mm256_abs_ps(w.y), _CMP_GT_OQ);
+    const __m256 len_sq = _mm256_blendv_ps(_avx_add(_avx_mul(w.y, w.y), _avx_mul(w.z, w.z)),
+                                           _avx_add(_avx_mul(w.x, w.x), _avx_mul(w.z, w.z)), mask);
+    const vec3_ps ua = {_avx_neg(w.z), zero, w.x}, ub = {zero, w.z, _avx_neg(w.y)};
+    const vec3_ps u = scale3_ps(blend3_ps(ub, ua, mask), _mm256_div_ps(one, _mm256_sqrt_ps(len_sq)));
+    const vec3_ps v = cross3_ps(w, u);
+
+    // a - l restricted to span(u, v) is the 2x2 matrix m, its null vector gives the eigenvector
+    const vec3_ps au = matvec3_ps(a, u), av = matvec3_ps(a, v);
+    const __m256 m00 = _avx_sub(dot3_ps(u, au), l);
+    const __m256 m01 = dot3_ps(u, av);
+    const __m256 m11 = _avx_sub(dot3_ps(v, av), l);
+    const __m256 abs00 = _mm256_abs_ps(m00), abs01 = _mm256_abs_ps(m01), abs11 = _mm256_abs_ps(m11);
+
+    // null vector of the row with the larger entries
+    mask = _mm256_cmp_ps(_mm256_max_ps(abs00, abs01), abs11, _CMP_GE_OQ);
+    __m256 p = _mm256_blendv_ps(m11, m01, mask);
+    __m256 q = _mm256_blendv_ps(_avx_neg(m01), _avx_neg(m00), mask);
+    const __m256 p_max = _mm256_max_ps(_mm256_abs_ps(p), _mm256_abs_ps(q));
+
+    mask = _mm256_cmp_ps(p_max, zero, _CMP_EQ_OQ);
+    const __m256 inv_max = _mm256_div_ps(one, _mm256_blendv_ps(p_max, one, mask));
+    p = _avx_mul(p, inv_max);
+    q = _avx_mul(q, inv_max);
+
+    // two equal eigenvalues, every vector of the plane qualifies
+    p = _mm256_blendv_ps(p, one, mask);
+    q = _mm256_blendv_ps(q, zero, mask);
+
+    const __m256 inv_len = _mm256_div_ps(one, _mm256_sqrt_ps(_avx_add(_avx_mul(p, p), _avx_mul(q, q))));
+    const vec3_ps c = {_avx_add(_avx_mul(p, u.x), _avx_mul(q, v.x)), _avx_add(_avx_mul(p, u.y), _avx_mul(q, v.y)),
+                       _avx_add(_avx_mul(p, u.z), _avx_mul(q, v.z))};
+    return scale3_ps(c, inv_len);
+}
+
+// Eigenvectors after David Eberly, "A Robust Eigensolver for 3x3 Symmetric Matrices": the eigenvector of the
+// eigenvalue farthest from the middle one comes from cross products, the middle one from the 2x2 problem in the plane
+// orthogonal to it and the last one is their cross product. All three are orthonormal even for repeated eigenvalues.
+static inline void eigen3d_ps(__m256 *a, __m256 *ev, vec3_ps *vec)
+{
+    __m256 r[3];
+    const __m256 v_max_element = ev3d_scaled_ps(a, r);
+
+    const __m256 first_big = _mm256_cmp_ps(_avx_sub(r[0], r[1]), _avx_sub(r[1], r[2]), _CMP_GE_OQ);
+    const vec3_ps w0 = evec3d_first_ps(a, _mm256_blendv_ps(r[2], r[0], first_big));
+    const vec3_ps w1 = evec3d_second_ps(a, r[1], w0);
+    const vec3_ps w2 = cross3_ps(w0, w1);
+
+    vec[0] = blend3_ps(w2, w0, first_big);
+    vec[1] = w1;
+    vec[2] = blend3_ps(w0, w2, first_big);
+
+    for (unsigned int i = 0; i < 3; ++i)
+        ev[i] = _mm256_mul_ps(r[i], v_max_element);
+}
+
+DLL_LOCAL void eigen3d_fname(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                             const float *a22, float *ev0, float *ev1, float *ev2, float *const *vec, const size_t len)
+{
+    float *ev_out[3] = {ev0, ev1, ev2};
+
+    for (size_t i = 0; i < len; i += 8) {
+        const size_t n = len - i < 8 ? len - i : 8;
+        __m256 a[6], ev[3];
+        vec3_ps v[3];
+
+        // the tail runs through zero padded buffers
+        if (n == 8) {
+            a[0] = _mm256_loadu_ps(a00 + i);
+            a[1] = _mm256_loadu_ps(a01 + i);
+            a[2] = _mm256_loadu_ps(a02 + i);
+            a[3] = _mm256_loadu_ps(a11 + i);
+            a[4] = _mm256_loadu_ps(a12 + i);
+            a[5] = _mm256_loadu_ps(a22 + i);
+        } else {
+            const float *in[6] = {a00, a01, a02, a11, a12, a22};
+            float buf[8];
+
+            for (unsigned int c = 0; c < 6; ++c) {
+                for (size_t j = 0; j < 8; ++j)
+                    buf[j] = j < n ? in[c][i + j] : 0.0f;
+                a[c] = _mm256_loadu_ps(buf);
+            }
+        }
+
+        eigen3d_ps(a, ev, v);
+
+        __m256 out[12] = {ev[0], ev[1], ev[2], v[0].x, v[0].y, v[0].z, v[1].x, v[1].y, v[1].z, v[2].x, v[2].y, v[2].z};
+        for (unsigned int c = 0; c < 12; ++c) {
+            float *dst = c < 3 ? ev_out[c] + i : vec[c - 3] + i;
+
+            if (n == 8) {
+                _mm256_storeu_ps(dst, out[c]);
+            } else {
+                float buf[8];
+
+                _mm256_storeu_ps(buf, out[c]);
+                for (size_t j = 0; j < n; ++j)
+                    dst[j] = buf[j];
+            }
+        }
+    }
+}
+
+// Closed form: with d = (xx - yy) / 2 and r = sqrt(d^2 + xy^2) the eigenvector of the larger eigenvalue is
+// (d + r, xy) for d >= 0 and (xy, r - d) otherwise, both of squared length 2 r (r + |d|) and free of cancellation.
+DLL_LOCAL void eigen2d_fname(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
+                             float *const *vec, const size_t len)
+{
+    const __m256 half = _mm256_set1_ps(0.5);
+    const __m256 two = _mm256_set1_ps(2.0);
+    const __m256 one = _mm256_set1_ps(1.0);
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (size_t i = 0; i < len; i += 8) {
+        const size_t n = len - i < 8 ? len - i : 8;
+        __m256 v_xx, v_xy, v_yy;
+
+        if (n == 8) {
+            v_xx = _mm256_loadu_ps(xx + i);
+            v_xy = _mm256_loadu_ps(xy + i);
+            v_yy = _mm256_loadu_ps(yy + i);
+        } else {
+            float buf[3][8];
+
+            for (size_t j = 0; j < 8; ++j) {
+                buf[0][j] = j < n ? xx[i + j] : 0.0f;
+                buf[1][j] = j < n ? xy[i + j] : 0.0f;
+                buf[2][j] = j < n ? yy[i + j] : 0.0f;
+            }
+            v_xx = _mm256_loadu_ps(buf[0]);
+            v_xy = _mm256_loadu_ps(buf[1]);
+            v_yy = _mm256_loadu_ps(buf[2]);
+        }
+
+        // eigenvalues exactly as in _ev2d_avx
+        __m256 tmp0 = _mm256_mul_ps(_mm256_add_ps(v_xx, v_yy), half);
+        __m256 tmp1 = _mm256_mul_ps(_mm256_sub_ps(v_xx, v_yy), half);
+        __m256 det = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(tmp1, tmp1), _mm256_mul_ps(v_xy, v_xy)));
+        __m256 v_ev_big = _mm256_max_ps(_mm256_add_ps(tmp0, det), _mm256_sub_ps(tmp0, det));
+        __m256 v_ev_small = _mm256_min_ps(_mm256_add_ps(tmp0, det), _mm256_sub_ps(tmp0, det));
+
+        // eigenvector from the matrix scaled to a maximum element of one
+        __m256 s = _mm256_max_ps(_mm256_max_ps(_mm256_abs_ps(v_xx), _mm256_abs_ps(v_yy)), _mm256_abs_ps(v_xy));
+        s = _mm256_div_ps(one, _mm256_blendv_ps(s, one, _mm256_cmp_ps(s, zero, _CMP_EQ_OQ)));
+
+        const __m256 d = _avx_mul(_avx_mul(_mm256_sub_ps(v_xx, v_yy), half), s);
+        const __m256 b = _avx_mul(v_xy, s);
+        const __m256 r = _mm256_sqrt_ps(_avx_add(_avx_mul(d, d), _avx_mul(b, b)));
+        const __m256 d_pos = _mm256_cmp_ps(d, zero, _CMP_GE_OQ);
+
+        __m256 x = _mm256_blendv_ps(b, _avx_add(d, r), d_pos);
+        __m256 y = _mm256_blendv_ps(_avx_sub(r, d), b, d_pos);
+        __m256 len_sq = _avx_mul(_avx_mul(two, r), _avx_add(r, _mm256_abs_ps(d)));
+
+        // a multiple of the identity has any vector as eigenvector
+        const __m256 isotropic = _mm256_cmp_ps(len_sq, zero, _CMP_EQ_OQ);
+        x = _mm256_blendv_ps(x, one, isotropic);
+        y = _mm256_blendv_ps(y, zero, isotropic);
+        len_sq = _mm256_blendv_ps(len_sq, one, isotropic);
+
+        const __m256 inv_len = _mm256_div_ps(one, _mm256_sqrt_ps(len_sq));
+        x = _avx_mul(x, inv_len);
+        y = _avx_mul(y, inv_len);
+
+        __m256 out[6] = {v_ev_big, v_ev_small, x, y, _avx_neg(y), x};
+        for (unsigned int c = 0; c < 6; ++c) {
+            float *dst = c == 0 ? ev_big + i : c == 1 ? ev_small + i : vec[c - 2] + i;
+
+            if (n == 8) {
+                _mm256_storeu_ps(dst, out[c]);
+            } else {
+                float buf[8];
+
+                _mm256_storeu_ps(buf, out[c]);
+                for (size_t j = 0; j < n; ++j)
+                    dst[j] = buf[j];
+            }
+        }
+    }
+}
@@ -0,0 +1,236 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "fastfilters.h"
+#include "common.h"
+#include "avx_mathfun.h"
+
+#include <immintrin.h>
+
+#if !defined(__AVX512F__) || !defined(__AVX2__)
+#error "linalg_avx512.c needs to be compiled with AVX512F and AVX2 support."
+#endif
+
+// all loops handle the last len % 16 elements with masked loads and stores instead of a scalar loop
+static inline __mmask16 tail_mask(size_t remaining)
+{
+    if (remaining >= 16)
+        return 0xffff;
+    return (__mmask16)((1u << remaining) - 1);
+}
+
+void DLL_LOCAL _ev2d_avx512(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
+                            const size_t len)
+{
+    const __m512 half = _mm512_set1_ps(0.5);
+
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 v_xx = _mm512_maskz_loadu_ps(mask, xx + i);
+        __m512 v_xy = _mm512_maskz_loadu_ps(mask, xy + i);
+        __m512 v_yy = _mm512_maskz_loadu_ps(mask, yy + i);
+
+        __m512 tmp0 = _mm512_mul_ps(_mm512_add_ps(v_xx, v_yy), half);
+        __m512 tmp1 = _mm512_mul_ps(_mm512_sub_ps(v_xx, v_yy), half);
+        tmp1 = _mm512_mul_ps(tmp1, tmp1);
+
+        __m512 det = _mm512_sqrt_ps(_mm512_fmadd_ps(v_xy, v_xy, tmp1));
+
+        __m512 ev0 = _mm512_add_ps(tmp0, det);
+        __m512 ev1 = _mm512_sub_ps(tmp0, det);
+
+        _mm512_mask_storeu_ps(ev_small + i, mask, _mm512_min_ps(ev0, ev1));
+        _mm512_mask_storeu_ps(ev_big + i, mask, _mm512_max_ps(ev0, ev1));
+    }
+}
+
+void DLL_LOCAL _combine_add_avx512(const float *a, const float *b, float *c, size_t len)
+{
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+
+        _mm512_mask_storeu_ps(c + i, mask, _mm512_add_ps(va, vb));
+    }
+}
+
+void DLL_LOCAL _combine_add3_avx512(const float *a, const float *b, const float *c, float *res, size_t len)
+{
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+        __m512 vc = _mm512_maskz_loadu_ps(mask, c + i);
+
+        _mm512_mask_storeu_ps(res + i, mask, _mm512_add_ps(_mm512_add_ps(va, vb), vc));
+    }
+}
+
+void DLL_LOCAL _combine_addsqrt_avx512(const float *a, const float *b, float *c, size_t len)
+{
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+
+        __m512 sum = _mm512_fmadd_ps(va, va, _mm512_mul_ps(vb, vb));
+
+        _mm512_mask_storeu_ps(c + i, mask, _mm512_sqrt_ps(sum));
+    }
+}
+
+void DLL_LOCAL _combine_addsqrt3_avx512(const float *a, const float *b, const float *c, float *res, size_t len)
+{
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+        __m512 vc = _mm512_maskz_loadu_ps(mask, c + i);
+
+        __m512 sum = _mm512_fmadd_ps(va, va, _mm512_fmadd_ps(vb, vb, _mm512_mul_ps(vc, vc)));
+
+        _mm512_mask_storeu_ps(res + i, mask, _mm512_sqrt_ps(sum));
+    }
+}
+
+void DLL_LOCAL _combine_mul_avx512(const float *a, const float *b, float *c, size_t len)
+{
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 va = _mm512_maskz_loadu_ps(mask, a + i);
+        __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+
+        _mm512_mask_storeu_ps(c + i, mask, _mm512_mul_ps(va, vb));
+    }
+}
+
+static inline __m256 _mm512_lower_ps(__m512 x)
+{
+    return _mm512_castps512_ps256(x);
+}
+
+static inline __m256 _mm512_upper_ps(__m512 x)
+{
+    return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1));
+}
+
+static inline __m512 _mm512_combine_ps(__m256 lower, __m256 upper)
+{
+    return _mm512_castpd_ps(
+        _mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(lower)), _mm256_castps_pd(upper), 1));
+}
+
+static inline __m512 _mm512_abs_ps(__m512 x)
+{
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32(0x7fffffff)));
+}
+
+// same algorithm as _ev3d_avx2, the transcendental functions are evaluated on both halves with the 8-wide versions
+DLL_LOCAL void _ev3d_avx512(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                            const float *a22, float *ev0, float *ev1, float *ev2, const size_t len)
+{
+    const __m512 v_inv3 = _mm512_set1_ps(1.0 / 3.0);
+    const __m512 v_root3 = _mm512_sqrt_ps(_mm512_set1_ps(3.0));
+    const __m512 two = _mm512_set1_ps(2.0);
+    const __m512 one = _mm512_set1_ps(1.0);
+    const __m512 half = _mm512_set1_ps(0.5);
+    const __m512 zero = _mm512_setzero_ps();
+
+    for (size_t i = 0; i < len; i += 16) {
+        const __mmask16 mask = tail_mask(len - i);
+        __m512 v_a00 = _mm512_maskz_loadu_ps(mask, a00 + i);
+        __m512 v_a01 = _mm512_maskz_loadu_ps(mask, a01 + i);
+        __m512 v_a02 = _mm512_maskz_loadu_ps(mask, a02 + i);
+        __m512 v_a11 = _mm512_maskz_loadu_ps(mask, a11 + i);
+        __m512 v_a12 = _mm512_maskz_loadu_ps(mask, a12 + i);
+        __m512 v_a22 = _mm512_maskz_loadu_ps(mask, a22 + i);
+
+        // guard against float overflows
+        __m512 v_max0 = _mm512_max_ps(_mm512_abs_ps(v_a00), _mm512_abs_ps(v_a01));
+        __m512 v_max1 = _mm512_max_ps(_mm512_abs_ps(v_a02), _mm512_abs_ps(v_a11));
+        __m512 v_max2 = _mm512_max_ps(_mm512_abs_ps(v_a12), _mm512_abs_ps(v_a22));
+        __m512 v_max_element = _mm512_max_ps(_mm512_max_ps(v_max0, v_max1), v_max2);
+
+        // replace zeros with ones to avoid NaNs
+        v_max_element = _mm512_mask_mov_ps(v_max_element, _mm512_cmp_ps_mask(v_max_element, zero, _CMP_EQ_UQ), one);
+
+        v_a00 = _mm512_div_ps(v_a00, v_max_element);
+        v_a01 = _mm512_div_ps(v_a01, v_max_element);
+        v_a02 = _mm512_div_ps(v_a02, v_max_element);
+        v_a11 = _mm512_div_ps(v_a11, v_max_element);
+        v_a12 = _mm512_div_ps(v_a12, v_max_element);
+        v_a22 = _mm512_div_ps(v_a22, v_max_element);
+
+        __m512 c0 = _mm512_mul_ps(_mm512_mul_ps(v_a00, v_a11), v_a22);
+        c0 = _mm512_fmadd_ps(_mm512_mul_ps(_mm512_mul_ps(two, v_a01), v_a02), v_a12, c0);
+        c0 = _mm512_fnmadd_ps(_mm512_mul_ps(v_a00, v_a12), v_a12, c0);
+        c0 = _mm512_fnmadd_ps(_mm512_mul_ps(v_a11, v_a02), v_a02, c0);
+        c0 = _mm512_fnmadd_ps(_mm512_mul_ps(v_a22, v_a01), v_a01, c0);
+
+        __m512 c1 = _mm512_mul_ps(v_a00, v_a11);
+        c1 = _mm512_fnmadd_ps(v_a01, v_a01, c1);
+        c1 = _mm512_fmadd_ps(v_a00, v_a22, c1);
+        c1 = _mm512_fnmadd_ps(v_a02, v_a02, c1);
+        c1 = _mm512_fmadd_ps(v_a11, v_a22, c1);
+        c1 = _mm512_fnmadd_ps(v_a12, v_a12, c1);
+
+        __m512 c2 = _mm512_add_ps(_mm512_add_ps(v_a00, v_a11), v_a22);
+        __m512 c2Div3 = _mm512_mul_ps(c2, v_inv3);
+        __m512 aDiv3 = _mm512_mul_ps(_mm512_fnmadd_ps(c2, c2Div3, c1), v_inv3);
+
+        aDiv3 = _mm512_min_ps(aDiv3, zero);
+
+        __m512 mbDiv2 =
+            _mm512_mul_ps(half, _mm512_fmadd_ps(c2Div3, _mm512_fmsub_ps(_mm512_mul_ps(two, c2Div3), c2Div3, c1), c0));
+        __m512 q = _mm512_fmadd_ps(_mm512_mul_ps(aDiv3, aDiv3), aDiv3, _mm512_mul_ps(mbDiv2, mbDiv2));
+
+        q = _mm512_min_ps(q, zero);
+
+        __m512 magnitude = _mm512_sqrt_ps(_mm512_sub_ps(zero, aDiv3));
+        __m512 sqrt_q = _mm512_sqrt_ps(_mm512_sub_ps(zero, q));
+        __m512 angle =
+            _mm512_mul_ps(_mm512_combine_ps(atan2_256_ps(_mm512_lower_ps(sqrt_q), _mm512_lower_ps(mbDiv2)),
+                                            atan2_256_ps(_mm512_upper_ps(sqrt_q), _mm512_upper_ps(mbDiv2))),
+                          v_inv3);
+        __m256 cs_lower, sn_lower, cs_upper, sn_upper;
+
+        sincos256_ps(_mm512_lower_ps(angle), &sn_lower, &cs_lower);
+        sincos256_ps(_mm512_upper_ps(angle), &sn_upper, &cs_upper);
+
+        __m512 cs = _mm512_combine_ps(cs_lower, cs_upper);
+        __m512 sn = _mm512_combine_ps(sn_lower, sn_upper);
+
+        __m512 r0 = _mm512_fmadd_ps(_mm512_mul_ps(two, magnitude), cs, c2Div3);
+        __m512 r1 = _mm512_fnmadd_ps(magnitude, _mm512_fmadd_ps(v_root3, sn, cs), c2Div3);
+        __m512 r2 = _mm512_fnmadd_ps(magnitude, _mm512_fnmadd_ps(v_root3, sn, cs), c2Div3);
+
+        __m512 v_r0_tmp = _mm512_min_ps(r0, r1);
+        __m512 v_r1_tmp = _mm512_max_ps(r0, r1);
+
+        __m512 v_r0 = _mm512_min_ps(v_r0_tmp, r2);
+        __m512 v_r2_tmp = _mm512_max_ps(v_r0_tmp, r2);
+
+        __m512 v_r1 = _mm512_min_ps(v_r1_tmp, v_r2_tmp);
+        __m512 v_r2 = _mm512_max_ps(v_r1_tmp, v_r2_tmp);
+
+        _mm512_mask_storeu_ps(ev2 + i, mask, _mm512_mul_ps(v_r0, v_max_element));
+        _mm512_mask_storeu_ps(ev1 + i, mask, _mm512_mul_ps(v_r1, v_max_element));
+        _mm512_mask_storeu_ps(ev0 + i, mask, _mm512_mul_ps(v_r2, v_max_element));
+    }
+}
@@ -0,0 +1,222 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+#include "fastfilters.h"
+#include "common.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+#error "linalg_neon.c needs to be compiled for aarch64."
+#endif
+
+// loads and stores the last len % 4 elements through a zero padded buffer so that the vector code handles them, too
+static inline float32x4_t load_tail(const float *p, size_t remaining)
+{
+    float buf[4] = {0.0, 0.0, 0.0, 0.0};
+
+    for (size_t i = 0; i < remaining; ++i)
+        buf[i] = p[i];
+    return vld1q_f32(buf);
+}
+
+static inline void store_tail(float *p, float32x4_t v, size_t remaining)
+{
+    float buf[4];
+
+    vst1q_f32(buf, v);
+    for (size_t i = 0; i < remaining; ++i)
+        p[i] = buf[i];
+}
+
+static inline float32x4_t load(const float *p, size_t remaining)
+{
+    if (likely(remaining >= 4))
+        return vld1q_f32(p);
+    return load_tail(p, remaining);
+}
+
+static inline void store(float *p, float32x4_t v, size_t remaining)
+{
+    if (likely(remaining >= 4))
+        vst1q_f32(p, v);
+    else
+        store_tail(p, v, remaining);
+}
+
+void DLL_LOCAL _ev2d_neon(const float *xx, const float *xy, const float *yy, float *ev_big, float *ev_small,
+                          const size_t len)
+{
+    const float32x4_t half = vdupq_n_f32(0.5);
+
+    for (size_t i = 0; i < len; i += 4) {
+        float32x4_t v_xx = load(xx + i, len - i);
+        float32x4_t v_xy = load(xy + i, len - i);
+        float32x4_t v_yy = load(yy + i, len - i);
+
+        float32x4_t tmp0 = vmulq_f32(vaddq_f32(v_xx, v_yy), half);
+        float32x4_t tmp1 = vmulq_f32(vsubq_f32(v_xx, v_yy), half);
+        tmp1 = vmulq_f32(tmp1, tmp1);
+
+        float32x4_t det = vsqrtq_f32(vfmaq_f32(tmp1, v_xy, v_xy));
+
+        float32x4_t ev0 = vaddq_f32(tmp0, det);
+        float32x4_t ev1 = vsubq_f32(tmp0, det);
+
+        store(ev_small + i, vminq_f32(ev0, ev1), len - i);
+        store(ev_big + i, vmaxq_f32(ev0, ev1), len - i);
+    }
+}
+
+void DLL_LOCAL _combine_add_neon(const float *a, const float *b, float *c, size_t len)
+{
+    for (size_t i = 0; i < len; i += 4)
+        store(c + i, vaddq_f32(load(a + i, len - i), load(b + i, len - i)), len - i);
+}
+
+void DLL_LOCAL _combine_add3_neon(const float *a, const float *b, const float *c, float *res, size_t len)
+{
+    for (size_t i = 0; i < len; i += 4) {
+        float32x4_t va = load(a + i, len - i);
+        float32x4_t vb = load(b + i, len - i);
+        float32x4_t vc = load(c + i, len - i);
+
+        store(res + i, vaddq_f32(vaddq_f32(va, vb), vc), len - i);
+    }
+}
+
+void DLL_LOCAL _combine_addsqrt_neon(const float *a, const float *b, float *c, size_t len)
+{
+    for (size_t i = 0; i < len; i += 4) {
+        float32x4_t va = load(a + i, len - i);
+        float32x4_t vb = load(b + i, len - i);
+
+        store(c + i, vsqrtq_f32(vfmaq_f32(vmulq_f32(vb, vb), va, va)), len - i);
+    }
+}
+
+void DLL_LOCAL _combine_addsqrt3_neon(const float *a, const float *b, const float *c, float *res, size_t len)
+{
+    for (size_t i = 0; i < len; i += 4) {
+        float32x4_t va = load(a + i, len - i);
+        float32x4_t vb = load(b + i, len - i);
+        float32x4_t vc = load(c + i, len - i);
+
+        float32x4_t sum = vfmaq_f32(vfmaq_f32(vmulq_f32(vc, vc), vb, vb), va, va);
+
+        store(res + i, vsqrtq_f32(sum), len - i);
+    }
+}
+
+void DLL_LOCAL _combine_mul_neon(const float *a, const float *b, float *c, size_t len)
+{
+    for (size_t i = 0; i < len; i += 4)
+        store(c + i, vmulq_f32(load(a + i, len - i), load(b + i, len - i)), len - i);
+}
+
+// same algorithm as _ev3d_avx2; there is no vectorized atan2/sincos for NEON, so only those are evaluated per lane
+DLL_LOCAL void _ev3d_neon(const float *a00, const float *a01, const float *a02, const float *a11, const float *a12,
+                          const float *a22, float *ev0, float *ev1, float *ev2, const size_t len)
+{
+    const float32x4_t v_inv3 = vdupq_n_f32(1.0 / 3.0);
+    const float32x4_t v_root3 = vsqrtq_f32(vdupq_n_f32(3.0));
+    const float32x4_t two = vdupq_n_f32(2.0);
+    const float32x4_t one = vdupq_n_f32(1.0);
+    const float32x4_t half = vdupq_n_f32(0.5);
+    const float32x4_t zero = vdupq_n_f32(0.0);
+
+    for (size_t i = 0; i < len; i += 4) {
+        float32x4_t v_a00 = load(a00 + i, len - i);
+        float32x4_t v_a01 = load(a01 + i, len - i);
+        float32x4_t v_a02 = load(a02 + i, len - i);
+        float32x4_t v_a11 = load(a11 + i, len - i);
+        float32x4_t v_a12 = load(a12 + i, len - i);
+        float32x4_t v_a22 = load(a22 + i, len - i);
+
+        // guard against float overflows
+        float32x4_t v_max0 = vmaxq_f32(vabsq_f32(v_a00), vabsq_f32(v_a01));
+        float32x4_t v_max1 = vmaxq_f32(vabsq_f32(v_a02), vabsq_f32(v_a11));
+        float32x4_t v_max2 = vmaxq_f32(vabsq_f32(v_a12), vabsq_f32(v_a22));
+        float32x4_t v_max_element = vmaxq_f32(vmaxq_f32(v_max0, v_max1), v_max2);
+
+        // replace zeros with ones to avoid NaNs
+        v_max_element = vbslq_f32(vceqq_f32(v_max_element, zero), one, v_max_element);
+
+        v_a00 = vdivq_f32(v_a00, v_max_element);
+        v_a01 = vdivq_f32(v_a01, v_max_element);
+        v_a02 = vdivq_f32(v_a02, v_max_element);
+        v_a11 = vdivq_f32(v_a11, v_max_element);
+        v_a12 = vdivq_f32(v_a12, v_max_element);
+        v_a22 = vdivq_f32(v_a22, v_max_element);
+
+        float32x4_t c0 = vmulq_f32(vmulq_f32(v_a00, v_a11), v_a22);
+        c0 = vfmaq_f32(c0, vmulq_f32(vmulq_f32(two, v_a01), v_a02), v_a12);
+        c0 = vfmsq_f32(c0, vmulq_f32(v_a00, v_a12), v_a12);
+        c0 = vfmsq_f32(c0, vmulq_f32(v_a11, v_a02), v_a02);
+        c0 = vfmsq_f32(c0, vmulq_f32(v_a22, v_a01), v_a01);
+
+        float32x4_t c1 = vmulq_f32(v_a00, v_a11);
+        c1 = vfmsq_f32(c1, v_a01, v_a01);
+        c1 = vfmaq_f32(c1, v_a00, v_a22);
+        c1 = vfmsq_f32(c1, v_a02, v_a02);
+        c1 = vfmaq_f32(c1, v_a11, v_a22);
+        c1 = vfmsq_f32(c1, v_a12, v_a12);
+
+        float32x4_t c2 = vaddq_f32(vaddq_f32(v_a00, v_a11), v_a22);
+        float32x4_t c2Div3 = vmulq_f32(c2, v_inv3);
+        float32x4_t aDiv3 = vmulq_f32(vfmsq_f32(c1, c2, c2Div3), v_inv3);
+
+        aDiv3 = vminq_f32(aDiv3, zero);
+
+        float32x4_t mbDiv2 =
+            vmulq_f32(half, vfmaq_f32(c0, c2Div3, vsubq_f32(vmulq_f32(vmulq_f32(two, c2Div3), c2Div3), c1)));
+        float32x4_t q = vfmaq_f32(vmulq_f32(mbDiv2, mbDiv2), vmulq_f32(aDiv3, aDiv3), aDiv3);
+
+        q = vminq_f32(q, zero);
+
+        float32x4_t magnitude = vsqrtq_f32(vnegq_f32(aDiv3));
+
+        float lane_y[4], lane_x[4], lane_cs[4], lane_sn[4];
+        vst1q_f32(lane_y, vsqrtq_f32(vnegq_f32(q)));
+        vst1q_f32(lane_x, mbDiv2);
+        for (unsigned int j = 0; j < 4; ++j) {
+            float angle = atan2f(lane_y[j], lane_x[j]) * (float)(1.0 / 3.0);
+            lane_cs[j] = cosf(angle);
+            lane_sn[j] = sinf(angle);
+        }
+
+        float32x4_t cs = vld1q_f32(lane_cs);
+        float32x4_t sn = vld1q_f32(lane_sn);
+
+        float32x4_t r0 = vfmaq_f32(c2Div3, vmulq_f32(two, magnitude), cs);
+        float32x4_t r1 = vfmsq_f32(c2Div3, magnitude, vfmaq_f32(cs, v_root3, sn));
+        float32x4_t r2 = vfmsq_f32(c2Div3, magnitude, vfmsq_f32(cs, v_root3, sn));
+
+        float32x4_t v_r0_tmp = vminq_f32(r0, r1);
+        float32x4_t v_r1_tmp = vmaxq_f32(r0, r1);
+
+        float32x4_t v_r0 = vminq_f32(v_r0_tmp, r2);
+        float32x4_t v_r2_tmp = vmaxq_f32(v_r0_tmp, r2);
+
+        float32x4_t v_r1 = vminq_f32(v_r1_tmp, v_r2_tmp);
+        float32x4_t v_r2 = vmaxq_f32(v_r1_tmp, v_r2_tmp);
+
+        store(ev2 + i, vmulq_f32(v_r0, v_max_element), len - i);
+        store(ev1 + i, vmulq_f32(v_r1, v_max_element), len - i);
+        store(ev0 + i, vmulq_f32(v_r2, v_max_element), len - i);
+    }
+}
@@ -16,19 +16,170 @@
 // OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
 #include "fastfilters.h"
 #include "common.h"
 
 #include <stdlib.h>
 #include <assert.h>
 
+#include "parallel.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#ifdef _MSC_VER
+#define FF_THREAD_LOCAL __declspec(thread)
+#else
+#define FF_THREAD_LOCAL __thread
+#endif
+
 #define ALIGN_MAGIC 0xd2ac461d9c25ee00
 
+// Aligned blocks are served from size classes of four steps per power of two from 4 KB up to 1 << FF_POOL_MAX_SHIFT
+// bytes. Freed blocks go back to the cache shard of the freeing thread, so worker threads reuse their own tiles (and the
+// pages they first touched, which keeps them on their NUMA node) without contending for a lock. Larger blocks, blocks
+// with an alignment above POOL_ALIGNMENT and everything while the pool is disabled go straight to the allocator.
+#define POOL_MIN_SHIFT 12
+#define POOL_ALIGNMENT 64
+#define POOL_NO_CLASS ((unsigned)-1)
+#define HUGE_PAGE_BYTES (2 * 1024 * 1024)
+
+typedef struct _block_header_t {
+    void *base;
+    size_t capacity;
+    struct _block_header_t *next;
+    unsigned size_class;
+    unsigned shard;
+    uint64_t magic;
+} block_header_t;
+
+typedef struct {
+    mutex_t lock;
+    block_header_t *free_list[1 + 4 * (FF_POOL_MAX_SHIFT - POOL_MIN_SHIFT)];
+    fastfilters_memory_stats_t stats;
+} pool_shard_t;
+
 static fastfilters_alloc_fn_t g_alloc_fn = NULL;
 static fastfilters_free_fn_t g_free_fn = NULL;
 
+static pool_shard_t g_shards[FF_POOL_SHARDS];
+static mutex_t g_shard_lock = MUTEX_INITIALIZER;
+static bool g_shards_initialized = false;
+static unsigned g_next_shard = 0;
+static FF_THREAD_LOCAL unsigned g_thread_shard = 0;
+
+// off by default: cached blocks stay allocated after the filters return, see fastfilters_memory_pool_configure
+static flag_t g_pool_enabled = false;
+static flag_t g_huge_pages = false;
+
+static void shards_init(void)
+{
+    mutex_lock(&g_shard_lock);
+    if (!g_shards_initialized) {
+        for (unsigned i = 0; i < FF_POOL_SHARDS; ++i)
+            g_shards[i].lock = (mutex_t)MUTEX_INITIALIZER;
+        g_shards_initialized = true;
+    }
+    mutex_unlock(&g_shard_lock);
+}
+
+static pool_shard_t *thread_shard(void)
+{
+    // 0 means the thread has not been assigned a shard yet
+    if (!g_thread_shard) {
+        mutex_lock(&g_shard_lock);
+        g_thread_shard = 1 + g_next_shard++ % FF_POOL_SHARDS;
+        mutex_unlock(&g_shard_lock);
+    }
+
+    return &g_shards[g_thread_shard - 1];
+}
+
+// size class and capacity of an allocation of size bytes, POOL_NO_CLASS if it is too large to be pooled
+static unsigned size_class(size_t size, size_t *capacity)
+{
+    if (size <= ((size_t)1 << POOL_MIN_SHIFT)) {
+        *capacity = (size_t)1 << POOL_MIN_SHIFT;
+        return 0;
+    }
+
+    if (size > ((size_t)1 << FF_POOL_MAX_SHIFT)) {
+        *capacity = size;
+        return POOL_NO_CLASS;
+    }
+
+    unsigned e = 0;
+    while (((size - 1) >> e) > 1)
+        ++e;
+
+    // (size - 1) >> (e - 2) is in [4, 8)
+    const size_t quarters = ((size - 1) >> (e - 2)) + 1;
+    *capacity = quarters << (e - 2);
+    return 1 + 4 * (e - POOL_MIN_SHIFT) + (unsigned)(quarters - 5);
+}
+
+static block_header_t *header_of(void *ptr)
+{
+    block_header_t *header = (block_header_t *)ptr - 1;
+    assert(header->magic == ALIGN_MAGIC);
+    return header;
+}
+
+static void *block_alloc(size_t alignment, size_t capacity, unsigned cls, unsigned shard)
+{
+    const bool huge = flag_load(&g_huge_pages) && capacity >= HUGE_PAGE_BYTES;
+    if (huge && alignment < HUGE_PAGE_BYTES)
+        alignment = HUGE_PAGE_BYTES;
+
+    void *base = fastfilters_memory_alloc(capacity + alignment + sizeof(block_header_t));
+    if (!base)
+        return NULL;
+
+    uintptr_t ptr_i = (uintptr_t)base + sizeof(block_header_t) + alignment - 1;
+    ptr_i &= ~(uintptr_t)(alignment - 1);
+
+    block_header_t *header = (block_header_t *)ptr_i - 1;
+    header->base = base;
+    header->capacity = capacity;
+    header->next = NULL;
+    header->size_class = cls;
+    header->shard = shard;
+    header->magic = ALIGN_MAGIC;
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (huge)
+        madvise((void *)ptr_i, capacity & ~(size_t)(HUGE_PAGE_BYTES - 1), MADV_HUGEPAGE);
+#endif
+
+    return (void *)ptr_i;
+}
+
+// frees all cached blocks of shard, called with its lock held
+static void shard_trim(pool_shard_t *shard)
+{
+    for (unsigned cls = 0; cls < ARRAY_LENGTH(shard->free_list); ++cls) {
+        while (shard->free_list[cls]) {
+            block_header_t *header = shard->free_list[cls];
+            shard->free_list[cls] = header->next;
+            shard->stats.bytes_cached -= header->capacity;
+            fastfilters_memory_free(header->base);
+        }
+    }
+}
+
 void fastfilters_memory_init(fastfilters_alloc_fn_t alloc_fn, fastfilters_free_fn_t free_fn)
 {
+    shards_init();
+
+    // cached blocks belong to the previous allocator
+    if (g_free_fn)
+        fastfilters_memory_trim();
+
     if (alloc_fn)
         g_alloc_fn = alloc_fn;
     else
@@ -52,33 +203,111 @@ void fastfilters_memory_free(void *ptr)
 
 void *fastfilters_memory_align(size_t alignment, size_t size)
 {
-    assert(alignment < 0xff);
-    void *ptr = fastfilters_memory_alloc(size + alignment + 8);
+    assert(alignment && !(alignment & (alignment - 1)));
+
+    pool_shard_t *shard = thread_shard();
+    const unsigned shard_idx = (unsigned)(shard - g_shards);
+    size_t capacity;
+    unsigned cls = size_class(size, &capacity);
+    if (!flag_load(&g_pool_enabled) || alignment > POOL_ALIGNMENT)
+        cls = POOL_NO_CLASS;
+
+    mutex_lock(&shard->lock);
+    shard->stats.allocations++;
+
+    if (cls != POOL_NO_CLASS && shard->free_list[cls]) {
+        block_header_t *header = shard->free_list[cls];
+        shard->free_list[cls] = header->next;
+        header->shard = shard_idx;
+
+        shard->stats.pool_hits++;
+        shard->stats.bytes_cached -= capacity;
+        shard->stats.bytes_in_use += capacity;
+        mutex_unlock(&shard->lock);
+        return header + 1;
+    }
+    mutex_unlock(&shard->lock);
+
+    if (cls == POOL_NO_CLASS)
+        capacity = size;
+    else
+        alignment = POOL_ALIGNMENT;
 
+    void *ptr = block_alloc(alignment, capacity, cls, shard_idx);
     if (!ptr)
         return NULL;
 
-    uintptr_t ptr_i = (uintptr_t)ptr;
-    ptr_i += 8 + alignment - 1;
-    ptr_i &= ~(alignment - 1);
+    mutex_lock(&shard->lock);
+    shard->stats.bytes_in_use += capacity;
+    mutex_unlock(&shard->lock);
 
-    uintptr_t ptr_diff = ptr_i - (uintptr_t)ptr;
+    return ptr;
+}
+
+void fastfilters_memory_align_free(void *ptr)
+{
+    block_header_t *header = header_of(ptr);
+    pool_shard_t *shard = thread_shard();
 
-    void *ptr_aligned = (void *)ptr_i;
-    uint64_t *ptr_magic = (uint64_t *)(ptr_i - 8);
+    // usage is accounted to the shard that allocated the block, so that the sum over all shards stays exact
+    pool_shard_t *owner = &g_shards[header->shard];
+    mutex_lock(&owner->lock);
+    owner->stats.bytes_in_use -= header->capacity;
+    mutex_unlock(&owner->lock);
 
-    *ptr_magic = ALIGN_MAGIC | (ptr_diff & 0xff);
+    if (header->size_class != POOL_NO_CLASS && flag_load(&g_pool_enabled)) {
+        mutex_lock(&shard->lock);
+        // disabling the pool trims every shard under its lock afterwards, a block cached after that trim would leak
+        if (flag_load(&g_pool_enabled) && shard->stats.bytes_cached + header->capacity <= FF_POOL_SHARD_BYTES) {
+            header->next = shard->free_list[header->size_class];
+            shard->free_list[header->size_class] = header;
+            shard->stats.bytes_cached += header->capacity;
+            mutex_unlock(&shard->lock);
+            return;
+        }
+        mutex_unlock(&shard->lock);
+    }
 
-    return ptr_aligned;
+    fastfilters_memory_free(header->base);
 }
 
-void fastfilters_memory_align_free(void *ptr)
+void DLL_PUBLIC fastfilters_memory_pool_configure(bool enable, bool huge_pages)
 {
-    char *ptr_cast = (char *)ptr;
-    uint64_t magic = *(uint64_t *)(ptr_cast - 8);
+    shards_init();
+
+    flag_store(&g_huge_pages, huge_pages);
+    flag_store(&g_pool_enabled, enable);
 
-    assert((magic & ~0xff) == ALIGN_MAGIC);
+    if (!enable)
+        fastfilters_memory_trim();
+}
 
-    ptr_cast -= magic & 0xff;
-    fastfilters_memory_free(ptr_cast);
-}
\ No newline at end of file
+void DLL_PUBLIC fastfilters_memory_trim(void)
+{
+    shards_init();
+
+    for (unsigned i = 0; i < FF_POOL_SHARDS; ++i) {
+        mutex_lock(&g_shards[i].lock);
+        shard_trim(&g_shards[i]);
+        mutex_unlock(&g_shards[i].lock);
+    }
+}
+
+void DLL_PUBLIC fastfilters_memory_stats(fastfilters_memory_stats_t *stats)
+{
+    shards_init();
+
+    stats->allocations = 0;
+    stats->pool_hits = 0;
+    stats->bytes_in_use = 0;
+    stats->bytes_cached = 0;
+
+    for (unsigned i = 0; i < FF_POOL_SHARDS; ++i) {
+        mutex_lock(&g_shards[i].lock);
+        stats->allocations += g_shards[i].stats.allocations;
+        stats->pool_hits += g_shards[i].stats.pool_hits;
+        stats->bytes_in_use += g_shards[i].stats.bytes_in_use;
+        stats->bytes_cached += g_shards[i].stats.bytes_cached;
+        mutex_unlock(&g_shards[i].lock);
+    }
+}
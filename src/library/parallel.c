@@ -0,0 +1,394 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "parallel.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// number of chunks each thread gets on average, more chunks help balancing uneven borders
+#define CHUNKS_PER_THREAD 4
+
+typedef struct {
+    mutex_t lock;
+    cond_t cond_work;
+    cond_t cond_done;
+
+    thread_t *threads;
+    size_t n_workers;
+    bool shutdown;
+    bool busy;
+    unsigned long generation;
+
+    fastfilters_parallel_fn_t fn;
+    void *ctx;
+    size_t n;
+    size_t chunk_size;
+    size_t n_chunks;
+    size_t next_chunk;
+    size_t done_chunks;
+    bool result;
+} parallel_pool_t;
+
+static parallel_pool_t g_pool = {
+    .lock = MUTEX_INITIALIZER, .cond_work = COND_INITIALIZER, .cond_done = COND_INITIALIZER};
+// serializes fastfilters_set_num_threads, g_pool.lock only protects n_workers and the work queue
+static mutex_t g_config_lock = MUTEX_INITIALIZER;
+static bool g_parallel_initialized = false;
+
+// called and returns with g_pool.lock held
+static void run_chunks(void)
+{
+    while (g_pool.next_chunk < g_pool.n_chunks) {
+        const size_t chunk = g_pool.next_chunk++;
+        const size_t begin = chunk * g_pool.chunk_size;
+        size_t end = begin + g_pool.chunk_size;
+        if (end > g_pool.n)
+            end = g_pool.n;
+
+        fastfilters_parallel_fn_t fn = g_pool.fn;
+        void *ctx = g_pool.ctx;
+
+        mutex_unlock(&g_pool.lock);
+        bool res = fn(ctx, begin, end);
+        mutex_lock(&g_pool.lock);
+
+        if (!res)
+            g_pool.result = false;
+
+        if (++g_pool.done_chunks == g_pool.n_chunks)
+            cond_broadcast(&g_pool.cond_done);
+    }
+}
+
+static void worker_main(void)
+{
+    mutex_lock(&g_pool.lock);
+    unsigned long seen = g_pool.generation;
+
+    for (;;) {
+        while (!g_pool.shutdown && g_pool.generation == seen)
+            cond_wait(&g_pool.cond_work, &g_pool.lock);
+
+        if (g_pool.shutdown)
+            break;
+
+        seen = g_pool.generation;
+        run_chunks();
+    }
+
+    mutex_unlock(&g_pool.lock);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_thread(LPVOID arg)
+{
+    (void)arg;
+    worker_main();
+    return 0;
+}
+
+static bool thread_start(thread_t *thread)
+{
+    *thread = CreateThread(NULL, 0, worker_thread, NULL, 0, NULL);
+    return *thread != NULL;
+}
+
+static void thread_join(thread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+static DWORD WINAPI task_thread(LPVOID arg)
+{
+    fastfilters_task_t *task = arg;
+    task->result = task->fn(task->ctx);
+    return 0;
+}
+
+static bool task_thread_start(fastfilters_task_t *task)
+{
+    task->thread = CreateThread(NULL, 0, task_thread, task, 0, NULL);
+    return task->thread != NULL;
+}
+
+static unsigned int hardware_threads(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+#else
+static void *worker_thread(void *arg)
+{
+    (void)arg;
+    worker_main();
+    return NULL;
+}
+
+static bool thread_start(thread_t *thread)
+{
+    return pthread_create(thread, NULL, worker_thread, NULL) == 0;
+}
+
+static void thread_join(thread_t thread)
+{
+    pthread_join(thread, NULL);
+}
+
+static void *task_thread(void *arg)
+{
+    fastfilters_task_t *task = arg;
+    task->result = task->fn(task->ctx);
+    return NULL;
+}
+
+static bool task_thread_start(fastfilters_task_t *task)
+{
+    return pthread_create(&task->thread, NULL, task_thread, task) == 0;
+}
+
+static unsigned int hardware_threads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned int)n : 1;
+}
+
+// worker threads do not survive fork(), the child has to start over with an empty pool
+static void atfork_child(void)
+{
+    parallel_pool_t empty = {.lock = MUTEX_INITIALIZER, .cond_work = COND_INITIALIZER, .cond_done = COND_INITIALIZER};
+    mutex_t config_lock = MUTEX_INITIALIZER;
+
+    free(g_pool.threads);
+    g_pool = empty;
+    g_config_lock = config_lock;
+}
+#endif
+
+static size_t pool_threads(void)
+{
+    mutex_lock(&g_pool.lock);
+    const size_t n_threads = g_pool.n_workers + 1;
+    mutex_unlock(&g_pool.lock);
+
+    return n_threads;
+}
+
+// called with g_config_lock held
+static void stop_workers(void)
+{
+    mutex_lock(&g_pool.lock);
+    while (g_pool.busy)
+        cond_wait(&g_pool.cond_done, &g_pool.lock);
+
+    // parallel_for stops handing out work as soon as the pool is empty
+    const size_t n_workers = g_pool.n_workers;
+    g_pool.n_workers = 0;
+    g_pool.shutdown = true;
+    cond_broadcast(&g_pool.cond_work);
+    mutex_unlock(&g_pool.lock);
+
+    for (size_t i = 0; i < n_workers; ++i)
+        thread_join(g_pool.threads[i]);
+
+    free(g_pool.threads);
+    g_pool.threads = NULL;
+
+    mutex_lock(&g_pool.lock);
+    g_pool.shutdown = false;
+    mutex_unlock(&g_pool.lock);
+}
+
+// called with g_config_lock held and an empty pool
+static bool start_workers(size_t n_workers)
+{
+    // thread handles are internal bookkeeping and must not go through the (possibly Python) user allocator
+    g_pool.threads = malloc(n_workers * sizeof(thread_t));
+    if (!g_pool.threads)
+        return false;
+
+    bool result = true;
+
+    mutex_lock(&g_pool.lock);
+    for (size_t i = 0; i < n_workers; ++i) {
+        if (!thread_start(&g_pool.threads[i])) {
+            result = false;
+            break;
+        }
+        g_pool.n_workers++;
+    }
+    mutex_unlock(&g_pool.lock);
+
+    // a partially started pool would not match the requested thread count, fall back to a single thread
+    if (!result)
+        stop_workers();
+
+    return result;
+}
+
+bool DLL_PUBLIC fastfilters_set_num_threads(unsigned int n_threads)
+{
+    bool result = true;
+
+    if (n_threads == 0)
+        n_threads = hardware_threads();
+
+    mutex_lock(&g_config_lock);
+    if (pool_threads() != n_threads) {
+        stop_workers();
+
+        if (n_threads > 1)
+            result = start_workers(n_threads - 1);
+    }
+    mutex_unlock(&g_config_lock);
+
+    return result;
+}
+
+unsigned int DLL_PUBLIC fastfilters_get_num_threads(void)
+{
+    return pool_threads();
+}
+
+void fastfilters_parallel_init(void)
+{
+    if (g_parallel_initialized)
+        return;
+    g_parallel_initialized = true;
+
+#ifndef _WIN32
+    pthread_atfork(NULL, NULL, atfork_child);
+#endif
+
+    const char *env = getenv("FASTFILTERS_NUM_THREADS");
+    if (env) {
+        char *end;
+        long n_threads = strtol(env, &end, 10);
+
+        if (end != env && n_threads >= 0)
+            fastfilters_set_num_threads((unsigned int)n_threads);
+    }
+}
+
+size_t fastfilters_parallel_chunk_size(size_t n, size_t n_outer, size_t alignment)
+{
+    const size_t n_threads = pool_threads();
+
+    if (n_threads == 1 || n == 0)
+        return n;
+
+    if (n_outer == 0)
+        n_outer = 1;
+
+    size_t n_chunks = (n_threads * CHUNKS_PER_THREAD + n_outer - 1) / n_outer;
+    size_t chunk_size = (n + n_chunks - 1) / n_chunks;
+
+    chunk_size = (chunk_size + alignment - 1) / alignment * alignment;
+    if (chunk_size > n)
+        chunk_size = n;
+
+    return chunk_size;
+}
+
+bool fastfilters_parallel_for(size_t n, size_t chunk_size, fastfilters_parallel_fn_t fn, void *ctx)
+{
+    if (n == 0)
+        return true;
+
+    if (chunk_size == 0 || chunk_size > n)
+        chunk_size = n;
+
+    const size_t n_chunks = (n + chunk_size - 1) / chunk_size;
+
+    if (n_chunks > 1) {
+        mutex_lock(&g_pool.lock);
+
+        // nested calls from inside a worker and concurrent callers run on their own thread
+        if (!g_pool.busy && g_pool.n_workers > 0) {
+            g_pool.busy = true;
+            g_pool.fn = fn;
+            g_pool.ctx = ctx;
+            g_pool.n = n;
+            g_pool.chunk_size = chunk_size;
+            g_pool.n_chunks = n_chunks;
+            g_pool.next_chunk = 0;
+            g_pool.done_chunks = 0;
+            g_pool.result = true;
+            g_pool.generation++;
+            cond_broadcast(&g_pool.cond_work);
+
+            run_chunks();
+            while (g_pool.done_chunks < g_pool.n_chunks)
+                cond_wait(&g_pool.cond_done, &g_pool.lock);
+
+            bool result = g_pool.result;
+            g_pool.busy = false;
+            cond_broadcast(&g_pool.cond_done);
+            mutex_unlock(&g_pool.lock);
+
+            return result;
+        }
+
+        mutex_unlock(&g_pool.lock);
+    }
+
+    for (size_t begin = 0; begin < n; begin += chunk_size) {
+        size_t end = begin + chunk_size;
+        if (end > n)
+            end = n;
+
+        if (!fn(ctx, begin, end))
+            return false;
+    }
+
+    return true;
+}
+
+void fastfilters_task_start(fastfilters_task_t *task, fastfilters_task_fn_t fn, void *ctx)
+{
+    task->fn = fn;
+    task->ctx = ctx;
+    task->running = task_thread_start(task);
+
+    if (!task->running)
+        task->result = fn(ctx);
+}
+
+bool fastfilters_task_join(fastfilters_task_t *task)
+{
+    if (task->running)
+        thread_join(task->thread);
+    task->running = false;
+
+    return task->result;
+}
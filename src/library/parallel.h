@@ -0,0 +1,124 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef FASTFILTERS_PARALLEL_H
+#define FASTFILTERS_PARALLEL_H
+
+// thin mutex/condition variable wrappers shared by the thread pool and the kernel cache, and flags that are read
+// without a lock
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef HANDLE thread_t;
+typedef SRWLOCK mutex_t;
+typedef CONDITION_VARIABLE cond_t;
+
+#define MUTEX_INITIALIZER SRWLOCK_INIT
+#define COND_INITIALIZER CONDITION_VARIABLE_INIT
+
+static inline void mutex_lock(mutex_t *m)
+{
+    AcquireSRWLockExclusive(m);
+}
+
+static inline void mutex_unlock(mutex_t *m)
+{
+    ReleaseSRWLockExclusive(m);
+}
+
+static inline void cond_wait(cond_t *c, mutex_t *m)
+{
+    SleepConditionVariableSRW(c, m, INFINITE, 0);
+}
+
+static inline void cond_broadcast(cond_t *c)
+{
+    WakeAllConditionVariable(c);
+}
+
+typedef volatile LONG flag_t;
+
+static inline bool flag_load(flag_t *f)
+{
+    return InterlockedCompareExchange(f, 0, 0) != 0;
+}
+
+static inline void flag_store(flag_t *f, bool value)
+{
+    InterlockedExchange(f, value);
+}
+#else
+#include <pthread.h>
+
+typedef pthread_t thread_t;
+typedef pthread_mutex_t mutex_t;
+typedef pthread_cond_t cond_t;
+
+#define MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define COND_INITIALIZER PTHREAD_COND_INITIALIZER
+
+static inline void mutex_lock(mutex_t *m)
+{
+    pthread_mutex_lock(m);
+}
+
+static inline void mutex_unlock(mutex_t *m)
+{
+    pthread_mutex_unlock(m);
+}
+
+static inline void cond_wait(cond_t *c, mutex_t *m)
+{
+    pthread_cond_wait(c, m);
+}
+
+static inline void cond_broadcast(cond_t *c)
+{
+    pthread_cond_broadcast(c);
+}
+
+typedef int flag_t;
+
+static inline bool flag_load(flag_t *f)
+{
+    return __atomic_load_n(f, __ATOMIC_ACQUIRE) != 0;
+}
+
+static inline void flag_store(flag_t *f, bool value)
+{
+    __atomic_store_n(f, value, __ATOMIC_RELEASE);
+}
+#endif
+
+// runs fn(ctx) on a helper thread, or right away if no thread can be started; fastfilters_task_join waits for it and
+// returns its result
+typedef bool (*fastfilters_task_fn_t)(void *ctx);
+
+typedef struct {
+    thread_t thread;
+    bool running;
+    fastfilters_task_fn_t fn;
+    void *ctx;
+    bool result;
+} fastfilters_task_t;
+
+void DLL_LOCAL fastfilters_task_start(fastfilters_task_t *task, fastfilters_task_fn_t fn, void *ctx);
+bool DLL_LOCAL fastfilters_task_join(fastfilters_task_t *task);
+
+#endif
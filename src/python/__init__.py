@@ -1,10 +1,21 @@
 from __future__ import absolute_import
 from . import core
+import functools
+import warnings
 import numpy as np
 
-__all__ = ["gaussianSmoothing", "gaussianGradientMagnitude", "hessianOfGaussianEigenvalues", "laplacianOfGaussian", "structureTensorEigenvalues", "gaussianDerivative"]
+__all__ = ["gaussianSmoothing", "gaussianGradientMagnitude", "hessianOfGaussianEigenvalues", "laplacianOfGaussian", "structureTensorEigenvalues", "hessianOfGaussianEigenvectors", "structureTensorEigenvectors", "gaussianDerivative", "set_num_threads", "get_num_threads", "clear_kernel_cache", "set_iir_crossover", "get_iir_crossover", "memory_pool_configure", "memory_trim", "memory_stats", "filterBank", "filterBankFeatures", "scaleSpace", "differenceOfGaussians", "vesselness", "blobness", "ridgeness"]
 __version__ = core.__version__
 
+set_num_threads = core.set_num_threads
+get_num_threads = core.get_num_threads
+clear_kernel_cache = core.clear_kernel_cache
+set_iir_crossover = core.set_iir_crossover
+get_iir_crossover = core.get_iir_crossover
+memory_pool_configure = core.memory_pool_configure
+memory_trim = core.memory_trim
+memory_stats = core.memory_stats
+
 try:
 	import vigra
 except ImportError:
@@ -19,6 +30,7 @@ def __p_fix_array(func):
 	Note: Singleton dimensions are only permitted if the input array has axistags.
 		  Otherwise, there is no way to know which singleton dimensions (if any) correspond to channel.
 	"""
+	@functools.wraps(func)
 	def func_wrapper(array, *args, **kwargs):
 		if hasattr(array, 'axistags'):
 			array = vigra.taggedView( np.ascontiguousarray(array), array.axistags )
@@ -37,6 +49,29 @@ def __p_fix_array(func):
 
 	return func_wrapper
 
+def __p_fix_array_tuple(func):
+	"""
+	Decorator.
+	Like __p_fix_array for functions that return a tuple of arrays with extra trailing axes, e.g. (values, vectors).
+	The singleton dimensions of a tagged input are removed from the input and from the arrays of an out= tuple, and
+	inserted again into every result.
+	"""
+	@functools.wraps(func)
+	def func_wrapper(array, *args, **kwargs):
+		if hasattr(array, 'axistags'):
+			singletons = tuple(i for i, n in enumerate(array.shape) if n == 1)
+			squeezed = vigra.taggedView( np.ascontiguousarray(array), array.axistags ).squeeze()
+			if kwargs.get('out') is not None:
+				kwargs['out'] = tuple(np.squeeze(o, axis=singletons) for o in kwargs['out'])
+			res = func(squeezed, *args, **kwargs)
+			return tuple(np.expand_dims(r.view(np.ndarray), singletons) for r in res)
+		else:
+			assert not any( np.array(array.shape) == 1 ), \
+				"Can't handle arrays with singleton dimensions (unless they are tagged VigraArrays)."
+			return func(array, *args, **kwargs)
+
+	return func_wrapper
+
 def __get_fn(array, fn_2d, fn_3d):
 	"""
 	Decide whether or not the given array is really 2D or 3D, and return the corresponding function.
@@ -62,32 +97,205 @@ def __get_fn(array, fn_2d, fn_3d):
 	else:
 		raise NotImplementedError("Invalid array dimensions: {}".format(  array.shape ))
 
+def __ev_out(out):
+	"""
+	Eigenvalue and filter bank results put their channel axis last, the core functions expect it first.
+	"""
+	if out is None:
+		return None
+	return np.rollaxis(out, len(out.shape) - 1, 0)
+
+def __axis_args(array, *values):
+	"""
+	Sigmas and window sizes are scalars or sequences with one entry per axis of array, in the order of its axes.
+	The core functions take per axis values x first.
+	"""
+	if all(np.ndim(v) == 0 for v in values):
+		return values
+	return tuple([float(x) for x in np.broadcast_to(v, (array.ndim,))[::-1]] for v in values)
+
 @__p_fix_array
-def gaussianSmoothing(array, sigma, window_size=0.0):
-	return __get_fn(array, core.gaussian2d, core.gaussian3d)(array, 0, sigma, window_size)
+def gaussianSmoothing(array, sigma, window_size=0.0, out=None, exact_fir=False):
+	"""
+	Gaussian smoothing. Sigmas of at least get_iir_crossover() on all axes use the recursive approximation unless
+	window_size is given or exact_fir is True, the same holds for the other gaussian based filters.
+	"""
+	sigma, window_size = __axis_args(array, sigma, window_size)
+	return __get_fn(array, core.gaussian2d, core.gaussian3d)(array, 0, sigma, window_size, out, exact_fir=exact_fir)
 
 @__p_fix_array
-def gaussianGradientMagnitude(array, sigma, window_size=0.0):
-	return __get_fn(array, core.gradmag2d, core.gradmag3d)(array, sigma, window_size)
+def gaussianGradientMagnitude(array, sigma, window_size=0.0, out=None, exact_fir=False):
+	sigma, window_size = __axis_args(array, sigma, window_size)
+	return __get_fn(array, core.gradmag2d, core.gradmag3d)(array, sigma, window_size, out, exact_fir=exact_fir)
+
+def __workspace_deprecated(workspace):
+	if workspace is not None:
+		# points past this function, the filter and the __p_fix_array wrapper at the caller
+		warnings.warn("workspace= is deprecated and ignored, the eigenvalues are computed without a full-size tensor",
+		              DeprecationWarning, stacklevel=4)
 
 @__p_fix_array
-def hessianOfGaussianEigenvalues(image, scale, window_size=0.0):
-	res = __get_fn(image, core.hog2d, core.hog3d)(image, scale, window_size)
+def hessianOfGaussianEigenvalues(image, scale, window_size=0.0, out=None, workspace=None, exact_fir=False):
+	"""
+	Eigenvalues of the Hessian of Gaussian in descending order along a new last axis.
+
+	workspace is deprecated: it is ignored and passing it emits a DeprecationWarning.
+	"""
+	__workspace_deprecated(workspace)
+	scale, window_size = __axis_args(image, scale, window_size)
+	res = __get_fn(image, core.hog2d, core.hog3d)(image, scale, window_size, __ev_out(out), exact_fir=exact_fir)
 	return np.rollaxis(res, 0, len(res.shape))
 
 @__p_fix_array
-def laplacianOfGaussian(array, scale=1.0, window_size=0.0):
-	return __get_fn(array, core.laplacian2d, core.laplacian3d)(array, scale, window_size)
+def laplacianOfGaussian(array, scale=1.0, window_size=0.0, out=None, exact_fir=False):
+	scale, window_size = __axis_args(array, scale, window_size)
+	return __get_fn(array, core.laplacian2d, core.laplacian3d)(array, scale, window_size, out, exact_fir=exact_fir)
 
 @__p_fix_array
-def structureTensorEigenvalues(image, innerScale, outerScale, window_size=0.0):
-	res = __get_fn(image, core.st2d, core.st3d)(image, innerScale, outerScale, window_size)
+def structureTensorEigenvalues(image, innerScale, outerScale, window_size=0.0, out=None, workspace=None):
+	"""
+	Eigenvalues of the structure tensor in descending order along a new last axis.
+
+	workspace is deprecated: it is ignored and passing it emits a DeprecationWarning.
+	"""
+	__workspace_deprecated(workspace)
+	innerScale, outerScale, window_size = __axis_args(image, innerScale, outerScale, window_size)
+	res = __get_fn(image, core.st2d, core.st3d)(image, innerScale, outerScale, window_size, __ev_out(out))
 	return np.rollaxis(res, 0, len(res.shape))
 
+def __eigenvectors(values, vectors):
+	"""
+	Move the eigenvalue and eigenvector axes of the core results to the end, where numpy.linalg.eigh puts them.
+	"""
+	return np.moveaxis(values, 0, -1), np.moveaxis(vectors, (0, 1), (-2, -1))
+
+def __eigenvectors_out(out):
+	"""
+	The inverse of __eigenvectors for an out=(values, vectors) tuple, the core functions expect the channels first.
+	"""
+	if out is None:
+		return None
+	values, vectors = out
+	return np.moveaxis(values, -1, 0), np.moveaxis(vectors, (-2, -1), (0, 1))
+
+@__p_fix_array_tuple
+def hessianOfGaussianEigenvectors(image, scale, window_size=0.0, out=None, exact_fir=False):
+	"""
+	Eigenvalues and unit eigenvectors of the Hessian of Gaussian, computed together without a full-size tensor.
+
+	Returns (values, vectors) laid out like numpy.linalg.eigh, but with the eigenvalues in descending order:
+	vectors[..., :, k] belongs to values[..., k] and its components follow the non-singleton image axes. The sign of
+	each eigenvector is arbitrary. out may be a (values, vectors) tuple of float32 arrays in that layout.
+	"""
+	scale, window_size = __axis_args(image, scale, window_size)
+	fn = __get_fn(image, core.hog2d_eigenvectors, core.hog3d_eigenvectors)
+	return __eigenvectors(*fn(image, scale, window_size, __eigenvectors_out(out), exact_fir=exact_fir))
+
+@__p_fix_array_tuple
+def structureTensorEigenvectors(image, innerScale, outerScale, window_size=0.0, out=None):
+	"""
+	Eigenvalues and unit eigenvectors of the structure tensor, laid out like hessianOfGaussianEigenvectors.
+	"""
+	innerScale, outerScale, window_size = __axis_args(image, innerScale, outerScale, window_size)
+	fn = __get_fn(image, core.st2d_eigenvectors, core.st3d_eigenvectors)
+	return __eigenvectors(*fn(image, innerScale, outerScale, window_size, __eigenvectors_out(out)))
+
 @__p_fix_array
-def gaussianDerivative(array, sigma, order, window_size=0.0):
+def gaussianDerivative(array, sigma, order, window_size=0.0, out=None, exact_fir=False):
     if isinstance(order, list):
         assert(len(order) == len(array.shape))
         assert(len(np.unique(order)) == 1)
         order = order[0]
-    return __get_fn(array, core.gaussian2d, core.gaussian3d)(array, order, sigma, window_size)
+    sigma, window_size = __axis_args(array, sigma, window_size)
+    return __get_fn(array, core.gaussian2d, core.gaussian3d)(array, order, sigma, window_size, out, exact_fir=exact_fir)
+
+filterBankFeatures = ("gaussianSmoothing", "laplacianOfGaussian", "gaussianGradientMagnitude", "hessianOfGaussianEigenvalues", "structureTensorEigenvalues")
+__filter_bank_types = (core.FeatureType.gaussian, core.FeatureType.laplacian, core.FeatureType.gradmag, core.FeatureType.hog_ev, core.FeatureType.st_ev)
+
+@__p_fix_array
+def filterBank(array, sigmas, matrix, window_size=0.0, out=None, dtype=None):
+	"""
+	Compute several features at several scales in one pass that shares the 1D convolutions between them.
+
+	matrix[i][j] selects feature filterBankFeatures[i] at scale sigmas[j]. Structure tensor eigenvalues use
+	sigmas[j] as inner and sigmas[j] / 2 as outer scale. The selected features are stacked along a new last
+	axis, ordered by feature and then by scale; eigenvalue features contribute one channel per dimension.
+
+	dtype may be float32 (the default, or the dtype of out) or float16; everything is computed in float32
+	and only rounded when the features are stored.
+	"""
+	if dtype is None:
+		dtype = np.float32 if out is None else out.dtype
+
+	types = []
+	scales = []
+	outer_scales = []
+	for i, feature_type in enumerate(__filter_bank_types):
+		for j, sigma in enumerate(sigmas):
+			if matrix[i][j]:
+				types.append(feature_type)
+				scales.append(sigma)
+				outer_scales.append(0.5 * sigma)
+
+	res = __get_fn(array, core.filter_bank2d, core.filter_bank3d)(array, types, scales, outer_scales, window_size, __ev_out(out), np.dtype(dtype).name)
+	return np.rollaxis(res, 0, len(res.shape))
+
+def __scale_space(array, sigmas, dog, window_size, out, dtype):
+	if dtype is None:
+		dtype = np.float32 if out is None else out.dtype
+
+	sigmas = [float(s) for s in np.atleast_1d(sigmas)]
+	res = __get_fn(array, core.scale_space2d, core.scale_space3d)(array, sigmas, dog, window_size, __ev_out(out), np.dtype(dtype).name)
+	return np.rollaxis(res, 0, len(res.shape))
+
+@__p_fix_array
+def scaleSpace(array, sigmas, window_size=0.0, out=None, dtype=None):
+	"""
+	Gaussian smoothings at increasing sigmas, stacked along a new last axis.
+
+	Every level is smoothed from the previous one with sigma sqrt(sigmas[k]^2 - sigmas[k-1]^2), which is much cheaper
+	than smoothing each level from the input. dtype may be float32 or float16 like in filterBank.
+	"""
+	return __scale_space(array, sigmas, False, window_size, out, dtype)
+
+@__p_fix_array
+def differenceOfGaussians(array, sigmas, window_size=0.0, out=None, dtype=None):
+	"""
+	Differences of consecutive levels of scaleSpace(array, sigmas), the coarser level minus the finer one, stacked
+	along a new last axis of len(sigmas) - 1 channels.
+	"""
+	return __scale_space(array, sigmas, True, window_size, out, dtype)
+
+def __hessian_measure(image, measure, scales, dark, alpha, beta, c, window_size, out, exact_fir):
+	scales = [float(s) for s in np.atleast_1d(scales)]
+	fn = __get_fn(image, core.hessian_measure2d, core.hessian_measure3d)
+	return fn(image, measure, scales, dark, alpha, beta, c, window_size, out, exact_fir=exact_fir)
+
+@__p_fix_array
+def vesselness(image, scales, alpha=0.5, beta=0.5, c=0.0, dark=False, window_size=0.0, out=None, exact_fir=False):
+	"""
+	Frangi vesselness of bright (or dark) lines in 2D and tubes in 3D, the maximum over the given scales.
+
+	The eigenvalues are those of the Hessian of Gaussian scaled by sigma^2, the per-scale eigenvalues are never stored.
+	alpha (3D only) and beta weight the plate and blob ratios, c the structure strength, which is left out for c <= 0.
+	"""
+	return __hessian_measure(image, core.HessianMeasure.vesselness, scales, dark, alpha, beta, c, window_size, out,
+	                         exact_fir)
+
+@__p_fix_array
+def blobness(image, scales, dark=False, window_size=0.0, out=None, exact_fir=False):
+	"""
+	Blob measure where all Hessian eigenvalues are negative (positive for dark blobs): the smallest magnitude squared
+	over the largest, the maximum over the given scales.
+	"""
+	return __hessian_measure(image, core.HessianMeasure.blobness, scales, dark, 0.0, 0.0, 0.0, window_size, out,
+	                         exact_fir)
+
+@__p_fix_array
+def ridgeness(image, scales, alpha1=0.5, alpha2=2.0, dark=False, window_size=0.0, out=None, exact_fir=False):
+	"""
+	Sato line measure, the maximum over the given scales. alpha1 and alpha2 weight a first (largest) eigenvalue of the
+	same or the opposite sign as the line eigenvalues.
+	"""
+	return __hessian_measure(image, core.HessianMeasure.ridge, scales, dark, alpha1, alpha2, 0.0, window_size, out,
+	                         exact_fir)
@@ -39,8 +39,9 @@ struct FIRKernel {
     fastfilters_kernel_fir_t kernel;
     const unsigned order;
     const double sigma;
+    const bool custom;
 
-    FIRKernel(unsigned order, double sigma) : order(order), sigma(sigma)
+    FIRKernel(unsigned order, double sigma) : order(order), sigma(sigma), custom(false)
     {
         kernel = fastfilters_kernel_fir_gaussian(order, sigma, 0.0);
 
@@ -48,6 +49,18 @@ struct FIRKernel {
             throw std::runtime_error("fastfilters_kernel_fir_gaussian returned NULL.");
     }
 
+    // taps for offsets -len .. len, applied as out[i] = sum(coefs[len + k] * in[i + k])
+    FIRKernel(std::vector<float> coefs) : order(0), sigma(0.0), custom(true)
+    {
+        if (coefs.size() < 3 || coefs.size() % 2 == 0)
+            throw std::invalid_argument("FIRKernel needs an odd number of at least three coefficients.");
+
+        kernel = fastfilters_kernel_fir_create(coefs.data(), coefs.size() / 2, FASTFILTERS_KERNEL_GENERAL);
+
+        if (!kernel)
+            throw std::runtime_error("fastfilters_kernel_fir_create returned NULL.");
+    }
+
     ~FIRKernel()
     {
         fastfilters_kernel_fir_free(kernel);
@@ -62,7 +75,10 @@ struct FIRKernel {
     std::string __repr__()
     {
         std::stringstream oss;
-        oss << "<fastfilters.FIRKernel with sigma = " << sigma << " and order = " << order << ">";
+        if (custom)
+            oss << "<fastfilters.FIRKernel with " << 2 * len() + 1 << " custom coefficients>";
+        else
+            oss << "<fastfilters.FIRKernel with sigma = " << sigma << " and order = " << order << ">";
 
         return oss.str();
     }
@@ -125,24 +141,27 @@ template <> struct ff_ndim_t<fastfilters_array3d_t> {
     }
 };
 
-template <typename fastfilters_array_t, int flags>
-void convert_py2ff(py::array_t<float, flags> &np, fastfilters_array_t &ff)
+template <typename fastfilters_array_t>
+void convert_py2ff(py::array &np, fastfilters_array_t &ff, fastfilters_type_t type = FASTFILTERS_TYPE_FLOAT32)
 {
     const unsigned int ff_ndim = ff_ndim_t<fastfilters_array_t>::ndim;
     py::buffer_info np_info = np.request();
+    const ssize_t itemsize = np_info.itemsize;
+
+    ff.type = type;
 
     if (np_info.ndim >= (int)ff_ndim) {
         ff.ptr = (float *)np_info.ptr;
 
         ff.n_x = np_info.shape[ff_ndim - 1];
-        ff.stride_x = np_info.strides[ff_ndim - 1] / sizeof(float);
+        ff.stride_x = np_info.strides[ff_ndim - 1] / itemsize;
 
         ff.n_y = np_info.shape[ff_ndim - 2];
-        ff.stride_y = np_info.strides[ff_ndim - 2] / sizeof(float);
+        ff.stride_y = np_info.strides[ff_ndim - 2] / itemsize;
 
         if (ff_ndim == 3) {
             ff_ndim_t<fastfilters_array_t>::set_z(np_info.shape[ff_ndim - 3], ff);
-            ff_ndim_t<fastfilters_array_t>::set_stride_z(np_info.strides[ff_ndim - 3] / sizeof(float), ff);
+            ff_ndim_t<fastfilters_array_t>::set_stride_z(np_info.strides[ff_ndim - 3] / itemsize, ff);
         }
     } else {
         throw std::logic_error("Too few dimensions.");
@@ -151,360 +170,727 @@ void convert_py2ff(py::array_t<float, flags> &np, fastfilters_array_t &ff)
     if (np_info.ndim == ff_ndim) {
         ff.n_channels = 1;
     } else if ((np_info.ndim == ff_ndim + 1) && np_info.shape[ff_ndim] < 8 &&
-               np_info.strides[ff_ndim] == sizeof(float)) {
+               np_info.strides[ff_ndim] == itemsize) {
         ff.n_channels = np_info.shape[ff_ndim];
     } else {
         throw std::logic_error("Invalid number of dimensions or too many channels or stride between channels.");
     }
 }
 
-py::array_t<float> array_like(py::array_t<float, py::array::c_style | py::array::forcecast> &base)
+// Input of a binding: C-contiguous in its own dtype if the library reads that type directly (the first pass converts
+// while loading), otherwise a C-contiguous float32 copy.
+struct InputArray {
+    py::array array;
+    fastfilters_type_t type;
+
+    InputArray(py::object input)
+    {
+        py::array a = py::array::ensure(input);
+        if (!a)
+            throw std::invalid_argument("input must be array-like.");
+
+        if (!as<float>(a, FASTFILTERS_TYPE_FLOAT32) && !as<uint8_t>(a, FASTFILTERS_TYPE_UINT8) &&
+            !as<uint16_t>(a, FASTFILTERS_TYPE_UINT16) && !as<int16_t>(a, FASTFILTERS_TYPE_INT16) &&
+            !as<double>(a, FASTFILTERS_TYPE_FLOAT64)) {
+            array = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(a);
+            type = FASTFILTERS_TYPE_FLOAT32;
+        }
+
+        if (!array)
+            throw std::invalid_argument("input can not be converted to float32.");
+    }
+
+    template <typename T> bool as(py::array &a, fastfilters_type_t t)
+    {
+        if (!py::isinstance<py::array_t<T>>(a))
+            return false;
+
+        array = py::array_t<T, py::array::c_style | py::array::forcecast>::ensure(a);
+        type = t;
+        return true;
+    }
+
+    std::vector<size_t> shape()
+    {
+        py::buffer_info info = array.request();
+        return std::vector<size_t>(info.shape.begin(), info.shape.end());
+    }
+
+    template <typename fastfilters_array_t> void convert(fastfilters_array_t &ff)
+    {
+        convert_py2ff(array, ff, type);
+    }
+};
+
+// out= arrays that are C-contiguous apart from the leading n_strided axes, which may have any positive stride. The
+// array structs of the library represent these by their strides.
+inline bool output_strides_supported(const py::array &o, size_t n_strided)
 {
-    py::buffer_info info = base.request();
-    auto result = py::array(py::buffer_info(nullptr, sizeof(float), py::format_descriptor<float>::value, info.ndim,
-                                            info.shape, info.strides));
+    const ssize_t itemsize = o.itemsize();
+    ssize_t stride = itemsize;
 
-    return result;
+    for (size_t i = o.ndim(); i > 0; --i) {
+        const ssize_t s = o.strides(i - 1);
+
+        if (i - 1 < n_strided) {
+            if (s <= 0 || s % itemsize)
+                return false;
+        } else if (s != stride) {
+            return false;
+        }
+
+        stride *= o.shape(i - 1);
+    }
+
+    return true;
 }
 
-py::array_t<float> convolve_2d_fir(py::array_t<float, py::array::c_style | py::array::forcecast> &input, FIRKernel *k0,
-                                   FIRKernel *k1)
+// Result of a binding: the caller's out= array if one was passed, otherwise a new array. Filters write straight into
+// out= arrays whose layout the C function can represent: C-contiguous ones, and those whose first n_strided axes are
+// strided (e.g. padded rows for n_strided = 1) if the function honours those strides. Any other layout gets a
+// temporary that is copied into out by finish(). Filter banks can also store float16 results, all other bindings
+// produce float32.
+struct OutputArray {
+    py::object out;
+    py::array array;
+
+    OutputArray(py::object out, const std::vector<size_t> &shape, fastfilters_type_t type = FASTFILTERS_TYPE_FLOAT32,
+                size_t n_strided = 0)
+        : out(out)
+    {
+        const bool half = type == FASTFILTERS_TYPE_FLOAT16;
+        const size_t itemsize = half ? 2 : sizeof(float);
+
+        if (!out.is_none()) {
+            if (!py::isinstance<py::array>(out))
+                throw std::invalid_argument(half ? "out must be a float16 numpy array."
+                                                 : "out must be a float32 numpy array.");
+
+            py::array o = py::reinterpret_borrow<py::array>(out);
+            if (o.dtype().kind() != 'f' || (size_t)o.itemsize() != itemsize)
+                throw std::invalid_argument(half ? "out must be a float16 numpy array."
+                                                 : "out must be a float32 numpy array.");
+            if (!o.writeable())
+                throw std::invalid_argument("out must be writeable.");
+            if ((size_t)o.ndim() != shape.size())
+                throw std::invalid_argument("out has the wrong number of dimensions.");
+            for (size_t i = 0; i < shape.size(); ++i)
+                if ((size_t)o.shape(i) != shape[i])
+                    throw std::invalid_argument("out has the wrong shape.");
+
+            if ((o.flags() & py::array::c_style) || output_strides_supported(o, n_strided)) {
+                array = o;
+                return;
+            }
+        }
+
+        std::vector<size_t> strides(shape.size());
+        size_t stride = itemsize;
+        for (size_t i = shape.size(); i > 0; --i) {
+            strides[i - 1] = stride;
+            stride *= shape[i - 1];
+        }
+
+        array = py::array(py::buffer_info(nullptr, itemsize, half ? "e" : py::format_descriptor<float>::value,
+                                          shape.size(), shape, strides));
+    }
+
+    float *ptr()
+    {
+        return (float *)array.request().ptr;
+    }
+
+    // stride of axis in elements
+    size_t stride(size_t axis)
+    {
+        return array.strides(axis) / array.itemsize();
+    }
+
+    py::array finish()
+    {
+        if (out.is_none())
+            return array;
+
+        if (!out.is(array))
+            py::module::import("numpy").attr("copyto")(out, array);
+
+        return py::reinterpret_borrow<py::array>(out);
+    }
+};
+
+py::array convolve_2d_fir(InputArray &input, FIRKernel *k0, FIRKernel *k1, py::object out)
 {
     fastfilters_array2d_t ff;
     fastfilters_array2d_t ff_out;
 
-    py::array_t<float> result;
+    // fastfilters_fir_convolve2d honours the row stride of its output
+    OutputArray result(out, input.shape(), FASTFILTERS_TYPE_FLOAT32, 1);
 
-    result = array_like(input);
+    input.convert(ff);
+    convert_py2ff(result.array, ff_out);
 
-    convert_py2ff(input, ff);
-    convert_py2ff(result, ff_out);
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = fastfilters_fir_convolve2d(&ff, k0->kernel, k1->kernel, &ff_out, NULL);
+    }
 
-    if (!fastfilters_fir_convolve2d(&ff, k0->kernel, k1->kernel, &ff_out, NULL))
+    if (!ok)
         throw std::logic_error("fastfilters_fir_convolve2d returned false.");
 
-    return result;
+    return result.finish();
 }
 
-py::array_t<float> convolve_3d_fir(py::array_t<float, py::array::c_style | py::array::forcecast> &input, FIRKernel *k0,
-                                   FIRKernel *k1, FIRKernel *k2)
+py::array convolve_3d_fir(InputArray &input, FIRKernel *k0, FIRKernel *k1, FIRKernel *k2, py::object out)
 {
     fastfilters_array3d_t ff;
     fastfilters_array3d_t ff_out;
 
-    py::array_t<float> result;
+    OutputArray result(out, input.shape());
 
-    result = array_like(input);
+    input.convert(ff);
+    convert_py2ff(result.array, ff_out);
 
-    convert_py2ff(input, ff);
-    convert_py2ff(result, ff_out);
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = fastfilters_fir_convolve3d(&ff, k0->kernel, k1->kernel, k2->kernel, &ff_out, NULL);
+    }
 
-    if (!fastfilters_fir_convolve3d(&ff, k0->kernel, k1->kernel, k2->kernel, &ff_out, NULL))
+    if (!ok)
         throw std::logic_error("fastfilters_fir_convolve3d returned false.");
 
-    return result;
+    return result.finish();
 }
 
-py::array_t<float> convolve_fir(py::array_t<float, py::array::c_style | py::array::forcecast> &input,
-                                std::vector<FIRKernel *> k)
+py::array convolve_fir(py::object array, std::vector<FIRKernel *> k, py::object out)
 {
+    InputArray input(array);
+
     if (k.size() == 2)
-        return convolve_2d_fir(input, k[0], k[1]);
+        return convolve_2d_fir(input, k[0], k[1], out);
     else if (k.size() == 3)
-        return convolve_3d_fir(input, k[0], k[1], k[2]);
+        return convolve_3d_fir(input, k[0], k[1], k[2], out);
     else
         throw std::logic_error("Invalid number of dimensions.");
 }
 
+// per axis parameter in x, y(, z) order, a single value applies to all axes
+struct AxisValues {
+    std::vector<double> values;
+
+    AxisValues(double value) : values(1, value)
+    {
+    }
+
+    AxisValues(const std::vector<double> &values) : values(values)
+    {
+    }
+
+    const double *get(size_t ndim)
+    {
+        if (values.size() == 1)
+            values.resize(ndim, values[0]);
+        if (values.size() != ndim)
+            throw std::logic_error("Per axis parameters need one value for each axis.");
+        return values.data();
+    }
+};
+
 struct ConvolveBase {
     fastfilters_options_t opt;
+    std::vector<float> window_ratios;
 
     ConvolveBase()
     {
         opt.window_ratio = 0.0;
+        opt.exact_fir = false;
     }
 
     void set_window_ratio(double ratio)
     {
         opt.window_ratio = (float)ratio;
     }
+
+    void set_exact_fir(bool exact_fir)
+    {
+        opt.exact_fir = exact_fir;
+    }
+
+    void set_window_ratio(const std::vector<float> &ratios)
+    {
+        window_ratios = ratios;
+    }
+
+    // leading axes of the output that may be strided, see OutputArray
+    size_t strided_axes(unsigned /*ndim*/)
+    {
+        return 0;
+    }
+
+    const float *axis_window_ratios(size_t ndim)
+    {
+        if (window_ratios.empty())
+            return nullptr;
+        if (window_ratios.size() == 1)
+            window_ratios.resize(ndim, window_ratios[0]);
+        if (window_ratios.size() != ndim)
+            throw std::logic_error("window_ratio needs one value for each axis.");
+        return window_ratios.data();
+    }
 };
 
 struct ConvolveGaussian : ConvolveBase {
     unsigned order;
-    double sigma;
+    AxisValues sigma;
 
-    ConvolveGaussian(unsigned order, double sigma) : order(order), sigma(sigma)
+    ConvolveGaussian(unsigned order, AxisValues sigma) : order(order), sigma(sigma)
     {
     }
 
+    // rows of 2D outputs may be padded
+    size_t strided_axes(unsigned ndim)
+    {
+        return ndim == 2 ? 1 : 0;
+    }
+
     bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &out)
     {
+        const double *sigmas = sigma.get(2);
+        const float *ratios = axis_window_ratios(2);
         py::gil_scoped_release release;
-        return fastfilters_fir_gaussian2d(&in, order, sigma, &out, &opt);
+        return fastfilters_fir_gaussian2d_aniso(&in, order, sigmas, ratios, &out, &opt);
     }
 
     bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &out)
     {
+        const double *sigmas = sigma.get(3);
+        const float *ratios = axis_window_ratios(3);
         py::gil_scoped_release release;
-        return fastfilters_fir_gaussian3d(&in, order, sigma, &out, &opt);
+        return fastfilters_fir_gaussian3d_aniso(&in, order, sigmas, ratios, &out, &opt);
     }
 };
 
 struct ConvolveGradMag : ConvolveBase {
-    double sigma;
+    AxisValues sigma;
 
-    ConvolveGradMag(double sigma) : sigma(sigma)
+    ConvolveGradMag(AxisValues sigma) : sigma(sigma)
     {
     }
 
     bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &out)
     {
+        const double *sigmas = sigma.get(2);
+        const float *ratios = axis_window_ratios(2);
         py::gil_scoped_release release;
-        return fastfilters_fir_gradmag2d(&in, sigma, &out, &opt);
+        return fastfilters_fir_gradmag2d_aniso(&in, sigmas, ratios, &out, &opt);
     }
 
     bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &out)
     {
+        const double *sigmas = sigma.get(3);
+        const float *ratios = axis_window_ratios(3);
         py::gil_scoped_release release;
-        return fastfilters_fir_gradmag3d(&in, sigma, &out, &opt);
+        return fastfilters_fir_gradmag3d_aniso(&in, sigmas, ratios, &out, &opt);
     }
 };
 
 struct ConvolveLaPlacian : ConvolveBase {
-    double sigma;
+    AxisValues sigma;
 
-    ConvolveLaPlacian(double sigma) : sigma(sigma)
+    ConvolveLaPlacian(AxisValues sigma) : sigma(sigma)
     {
     }
 
     bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &out)
     {
+        const double *sigmas = sigma.get(2);
+        const float *ratios = axis_window_ratios(2);
         py::gil_scoped_release release;
-        return fastfilters_fir_laplacian2d(&in, sigma, &out, &opt);
+        return fastfilters_fir_laplacian2d_aniso(&in, sigmas, ratios, &out, &opt);
     }
 
     bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &out)
     {
+        const double *sigmas = sigma.get(3);
+        const float *ratios = axis_window_ratios(3);
         py::gil_scoped_release release;
-        return fastfilters_fir_laplacian3d(&in, sigma, &out, &opt);
+        return fastfilters_fir_laplacian3d_aniso(&in, sigmas, ratios, &out, &opt);
     }
 };
 
 struct ConvolveHessian : ConvolveBase {
-    double sigma;
+    AxisValues sigma;
+
+    ConvolveHessian(AxisValues sigma) : sigma(sigma)
+    {
+    }
 
-    ConvolveHessian(double sigma) : sigma(sigma)
+    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &ev_small, fastfilters_array2d_t &ev_big)
     {
+        const double *sigmas = sigma.get(2);
+        const float *ratios = axis_window_ratios(2);
+        py::gil_scoped_release release;
+        return fastfilters_fir_hog2d_eigenvalues_aniso(&in, sigmas, ratios, &ev_small, &ev_big, &opt);
     }
 
-    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &xx, fastfilters_array2d_t &xy,
-                    fastfilters_array2d_t &yy)
+    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &ev0, fastfilters_array3d_t &ev1,
+                    fastfilters_array3d_t &ev2)
     {
+        const double *sigmas = sigma.get(3);
+        const float *ratios = axis_window_ratios(3);
         py::gil_scoped_release release;
-        return fastfilters_fir_hog2d(&in, sigma, &xx, &xy, &yy, &opt);
+        return fastfilters_fir_hog3d_eigenvalues_aniso(&in, sigmas, ratios, &ev0, &ev1, &ev2, &opt);
     }
 
-    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &xx, fastfilters_array3d_t &yy,
-                    fastfilters_array3d_t &zz, fastfilters_array3d_t &xy, fastfilters_array3d_t &xz,
-                    fastfilters_array3d_t &yz)
+    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t *const *evs, fastfilters_array2d_t *const *vecs)
     {
+        const double *sigmas = sigma.get(2);
+        const float *ratios = axis_window_ratios(2);
         py::gil_scoped_release release;
-        return fastfilters_fir_hog3d(&in, sigma, &xx, &yy, &zz, &xy, &xz, &yz, &opt);
+        return fastfilters_fir_hog2d_eigenvectors_aniso(&in, sigmas, ratios, evs, vecs, &opt);
+    }
+
+    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t *const *evs, fastfilters_array3d_t *const *vecs)
+    {
+        const double *sigmas = sigma.get(3);
+        const float *ratios = axis_window_ratios(3);
+        py::gil_scoped_release release;
+        return fastfilters_fir_hog3d_eigenvectors_aniso(&in, sigmas, ratios, evs, vecs, &opt);
     }
 };
 
 struct ConvolveST : ConvolveBase {
-    double sigma_inner, sigma_outer;
+    AxisValues sigma_inner, sigma_outer;
+
+    ConvolveST(AxisValues sigma_inner, AxisValues sigma_outer) : sigma_inner(sigma_inner), sigma_outer(sigma_outer)
+    {
+    }
+
+    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &ev_small, fastfilters_array2d_t &ev_big)
+    {
+        const double *inner = sigma_inner.get(2);
+        const double *outer = sigma_outer.get(2);
+        const float *ratios = axis_window_ratios(2);
+        py::gil_scoped_release release;
+        return fastfilters_fir_structure_tensor2d_eigenvalues_aniso(&in, inner, outer, ratios, &ev_small, &ev_big,
+                                                                    &opt);
+    }
+
+    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &ev0, fastfilters_array3d_t &ev1,
+                    fastfilters_array3d_t &ev2)
+    {
+        const double *inner = sigma_inner.get(3);
+        const double *outer = sigma_outer.get(3);
+        const float *ratios = axis_window_ratios(3);
+        py::gil_scoped_release release;
+        return fastfilters_fir_structure_tensor3d_eigenvalues_aniso(&in, inner, outer, ratios, &ev0, &ev1, &ev2,
+                                                                    &opt);
+    }
+
+    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t *const *evs, fastfilters_array2d_t *const *vecs)
+    {
+        const double *inner = sigma_inner.get(2);
+        const double *outer = sigma_outer.get(2);
+        const float *ratios = axis_window_ratios(2);
+        py::gil_scoped_release release;
+        return fastfilters_fir_structure_tensor2d_eigenvectors_aniso(&in, inner, outer, ratios, evs, vecs, &opt);
+    }
+
+    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t *const *evs, fastfilters_array3d_t *const *vecs)
+    {
+        const double *inner = sigma_inner.get(3);
+        const double *outer = sigma_outer.get(3);
+        const float *ratios = axis_window_ratios(3);
+        py::gil_scoped_release release;
+        return fastfilters_fir_structure_tensor3d_eigenvectors_aniso(&in, inner, outer, ratios, evs, vecs, &opt);
+    }
+};
+
+struct HessianMeasure : ConvolveBase {
+    std::vector<double> sigmas;
+    fastfilters_hessian_measure_t measure;
+
+    HessianMeasure(fastfilters_hessian_measure_type_t type, const std::vector<double> &sigmas, bool dark, float alpha,
+                   float beta, float c)
+        : sigmas(sigmas)
+    {
+        measure.type = type;
+        measure.dark = dark;
+        measure.alpha = alpha;
+        measure.beta = beta;
+        measure.c = c;
+    }
 
-    ConvolveST(double sigma_inner, double sigma_outer) : sigma_inner(sigma_inner), sigma_outer(sigma_outer)
+    // the output follows the rules of the eigenvalue arrays: rows (2D) or planes (3D) may be padded
+    size_t strided_axes(unsigned /*ndim*/)
     {
+        return 1;
     }
 
-    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &xx, fastfilters_array2d_t &xy,
-                    fastfilters_array2d_t &yy)
+    bool operator()(fastfilters_array2d_t &in, fastfilters_array2d_t &out)
     {
         py::gil_scoped_release release;
-        return fastfilters_fir_structure_tensor2d(&in, sigma_inner, sigma_outer, &xx, &xy, &yy, &opt);
+        return fastfilters_fir_hessian_measure2d(&in, sigmas.data(), sigmas.size(), &measure, &out, &opt);
     }
 
-    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &xx, fastfilters_array3d_t &yy,
-                    fastfilters_array3d_t &zz, fastfilters_array3d_t &xy, fastfilters_array3d_t &xz,
-                    fastfilters_array3d_t &yz)
+    bool operator()(fastfilters_array3d_t &in, fastfilters_array3d_t &out)
     {
         py::gil_scoped_release release;
-        return fastfilters_fir_structure_tensor3d(&in, sigma_inner, sigma_outer, &xx, &yy, &zz, &xy, &xz, &yz, &opt);
+        return fastfilters_fir_hessian_measure3d(&in, sigmas.data(), sigmas.size(), &measure, &out, &opt);
     }
 };
 
-template <class ConvolveFunctor>
-py::array_t<float> filter_ev_2d_binding(py::array_t<float, py::array::c_style | py::array::forcecast> &input,
-                                        ConvolveFunctor &fn)
+// The eigenvalues are written channel-first into the result, the tensor itself is never stored at full size.
+// The eigenvalue arrays only have to be dense within each row (2D) or plane (3D), so the eigenvalue axis and the
+// outermost image axis of out may have any stride. Everything else follows the C-contiguous input.
+template <class ConvolveFunctor> py::array filter_ev_2d_binding(InputArray &input, ConvolveFunctor &fn, py::object out)
 {
     fastfilters_array2d_t ff;
-    fastfilters_array2d_t ff_out_xx, ff_out_yy, ff_out_xy;
+    fastfilters_array2d_t ff_ev_small, ff_ev_big;
 
-    auto out_xx = array_like(input);
-    auto out_yy = array_like(input);
-    auto out_xy = array_like(input);
+    input.convert(ff);
 
-    convert_py2ff(input, ff);
+    std::vector<size_t> shape = input.shape();
+    shape.insert(shape.begin(), 2);
+    OutputArray result(out, shape, FASTFILTERS_TYPE_FLOAT32, 2);
 
-    convert_py2ff(out_xx, ff_out_xx);
-    convert_py2ff(out_yy, ff_out_yy);
-    convert_py2ff(out_xy, ff_out_xy);
+    ff_ev_small = ff_ev_big = ff;
+    ff_ev_small.type = ff_ev_big.type = FASTFILTERS_TYPE_FLOAT32;
+    ff_ev_small.stride_y = ff_ev_big.stride_y = result.stride(1);
+    ff_ev_small.ptr = result.ptr();
+    ff_ev_big.ptr = result.ptr() + result.stride(0);
 
-    if (!fn(ff, ff_out_xx, ff_out_xy, ff_out_yy))
+    if (!fn(ff, ff_ev_small, ff_ev_big))
         throw std::logic_error("convolution failed.");
 
-    const size_t n_pixels = ff.n_x * ff.n_y * ff.n_channels;
+    return result.finish();
+}
 
-    std::vector<size_t> shape;
-    std::vector<size_t> strides;
+template <class ConvolveFunctor> py::array filter_ev_3d_binding(InputArray &input, ConvolveFunctor &fn, py::object out)
+{
+    fastfilters_array3d_t ff;
+    fastfilters_array3d_t ff_ev0, ff_ev1, ff_ev2;
 
-    unsigned int n_dim = 3;
+    input.convert(ff);
 
-    if (ff.n_channels == 1) {
-        n_dim = 3;
+    std::vector<size_t> shape = input.shape();
+    shape.insert(shape.begin(), 3);
+    OutputArray result(out, shape, FASTFILTERS_TYPE_FLOAT32, 2);
 
-        shape.push_back(2);
-        shape.push_back(ff.n_y);
-        shape.push_back(ff.n_x);
+    ff_ev0 = ff_ev1 = ff_ev2 = ff;
+    ff_ev0.type = ff_ev1.type = ff_ev2.type = FASTFILTERS_TYPE_FLOAT32;
+    ff_ev0.stride_z = ff_ev1.stride_z = ff_ev2.stride_z = result.stride(1);
+    ff_ev0.ptr = result.ptr();
+    ff_ev1.ptr = result.ptr() + result.stride(0);
+    ff_ev2.ptr = result.ptr() + 2 * result.stride(0);
 
-        strides.push_back(sizeof(float) * ff.n_y * ff.n_x);
-        strides.push_back(sizeof(float) * ff.n_x);
-        strides.push_back(sizeof(float));
-    } else {
-        n_dim = 4;
+    if (!fn(ff, ff_ev0, ff_ev1, ff_ev2))
+        throw std::logic_error("convolution failed.");
 
-        shape.push_back(2);
-        shape.push_back(ff.n_y);
-        shape.push_back(ff.n_x);
-        shape.push_back(ff.n_channels);
+    return result.finish();
+}
 
-        strides.push_back(sizeof(float) * ff.n_channels * ff.n_y * ff.n_x);
-        strides.push_back(sizeof(float) * ff.n_channels * ff.n_x);
-        strides.push_back(sizeof(float) * ff.n_channels);
-        strides.push_back(sizeof(float));
+// Eigenvalues (ndim, ...) and eigenvectors (ndim, ndim, ...) channel-first like filter_ev_2d_binding, vectors[j][k] is
+// the component along numpy axis j of the k-th eigenvector. out is None or a (values, vectors) tuple of arrays in that
+// layout, their eigenvalue and component axes may have any stride.
+template <unsigned ndim, typename ConvolveFunctor>
+py::tuple filter_evec_binding(InputArray &input, ConvolveFunctor &fn, py::object out)
+{
+    typedef typename std::conditional<ndim == 2, fastfilters_array2d_t, fastfilters_array3d_t>::type ff_array_t;
+    ff_array_t ff;
+    ff_array_t ff_evs[ndim], ff_vecs[ndim * ndim];
+    ff_array_t *evs[ndim], *vecs[ndim * ndim];
+    py::object out_values = py::none(), out_vectors = py::none();
+
+    if (!out.is_none()) {
+        if (!py::isinstance<py::tuple>(out) || py::len(out) != 2)
+            throw std::invalid_argument("out must be a tuple (values, vectors).");
+
+        py::tuple t = py::reinterpret_borrow<py::tuple>(out);
+        out_values = t[0];
+        out_vectors = t[1];
     }
 
-    auto result =
-        py::array(py::buffer_info(nullptr, sizeof(float), py::format_descriptor<float>::value, n_dim, shape, strides));
-    py::buffer_info info_out = result.request();
+    input.convert(ff);
 
-    float *xx = ff_out_xx.ptr;
-    float *xy = ff_out_xy.ptr;
-    float *yy = ff_out_yy.ptr;
+    std::vector<size_t> shape = input.shape();
+    shape.insert(shape.begin(), ndim);
+    OutputArray values(out_values, shape, FASTFILTERS_TYPE_FLOAT32, 1);
+    shape.insert(shape.begin(), ndim);
+    OutputArray vectors(out_vectors, shape, FASTFILTERS_TYPE_FLOAT32, 2);
 
-    float *outptr = (float *)info_out.ptr;
-    float *ev_small = outptr;
-    float *ev_big = outptr + n_pixels;
+    for (unsigned k = 0; k < ndim; ++k) {
+        ff_evs[k] = ff;
+        ff_evs[k].type = FASTFILTERS_TYPE_FLOAT32;
+        ff_evs[k].ptr = values.ptr() + k * values.stride(0);
+        evs[k] = &ff_evs[k];
 
-    fastfilters_linalg_ev2d(xx, xy, yy, ev_small, ev_big, n_pixels);
+        // the library counts components x first, the reverse of the numpy axes
+        for (unsigned c = 0; c < ndim; ++c) {
+            ff_array_t &vec = ff_vecs[k * ndim + c];
 
-    return result;
-}
+            vec = ff;
+            vec.type = FASTFILTERS_TYPE_FLOAT32;
+            vec.ptr = vectors.ptr() + (ndim - 1 - c) * vectors.stride(0) + k * vectors.stride(1);
+            vecs[k * ndim + c] = &vec;
+        }
+    }
 
-template <class ConvolveFunctor>
-py::array_t<float> filter_ev_3d_binding(py::array_t<float, py::array::c_style | py::array::forcecast> &input,
-                                        ConvolveFunctor &fn)
-{
-    fastfilters_array3d_t ff;
-    fastfilters_array3d_t ff_out_xx, ff_out_yy, ff_out_zz, ff_out_xy, ff_out_xz, ff_out_yz;
+    if (!fn(ff, evs, vecs))
+        throw std::logic_error("convolution failed.");
 
-    auto out_xx = array_like(input);
-    auto out_yy = array_like(input);
-    auto out_zz = array_like(input);
-    auto out_xy = array_like(input);
-    auto out_xz = array_like(input);
-    auto out_yz = array_like(input);
+    return py::make_tuple(values.finish(), vectors.finish());
+}
 
-    convert_py2ff(input, ff);
+template <unsigned ndim, typename ConvolveFunctor>
+py::array filter_binding(InputArray &input, ConvolveFunctor &fn, py::object out)
+{
+    typedef typename std::conditional<ndim == 2, fastfilters_array2d_t, fastfilters_array3d_t>::type ff_array_t;
+    ff_array_t ff;
+    ff_array_t ff_out;
 
-    convert_py2ff(out_xx, ff_out_xx);
-    convert_py2ff(out_yy, ff_out_yy);
-    convert_py2ff(out_zz, ff_out_zz);
-    convert_py2ff(out_xy, ff_out_xy);
-    convert_py2ff(out_xz, ff_out_xz);
-    convert_py2ff(out_yz, ff_out_yz);
+    OutputArray result(out, input.shape(), FASTFILTERS_TYPE_FLOAT32, fn.strided_axes(ndim));
+    input.convert(ff);
+    convert_py2ff(result.array, ff_out);
 
-    if (!fn(ff, ff_out_xx, ff_out_yy, ff_out_zz, ff_out_xy, ff_out_xz, ff_out_yz))
+    if (!fn(ff, ff_out))
         throw std::logic_error("convolution failed.");
 
-    std::vector<size_t> shape;
-    std::vector<size_t> strides;
+    return result.finish();
+}
 
-    const size_t n_pixels = ff.n_z * ff.n_x * ff.n_y * ff.n_channels;
+inline bool filter_bank(const fastfilters_array2d_t &in, const std::vector<fastfilters_feature_t> &features,
+                        float *outptr, fastfilters_type_t out_type, const fastfilters_options_t &opt)
+{
+    return fastfilters_fir_filter_bank2d_ex(&in, features.data(), features.size(), outptr, out_type, &opt);
+}
 
-    unsigned int n_dim = 4;
+inline bool filter_bank(const fastfilters_array3d_t &in, const std::vector<fastfilters_feature_t> &features,
+                        float *outptr, fastfilters_type_t out_type, const fastfilters_options_t &opt)
+{
+    return fastfilters_fir_filter_bank3d_ex(&in, features.data(), features.size(), outptr, out_type, &opt);
+}
 
-    if (ff.n_channels == 1) {
-        n_dim = 4;
+inline fastfilters_type_t stacked_output_type(const std::string &dtype)
+{
+    if (dtype == "float32")
+        return FASTFILTERS_TYPE_FLOAT32;
+    if (dtype == "float16")
+        return FASTFILTERS_TYPE_FLOAT16;
+    throw std::invalid_argument("dtype must be float32 or float16.");
+}
 
-        shape.push_back(3);
-        shape.push_back(ff.n_z);
-        shape.push_back(ff.n_y);
-        shape.push_back(ff.n_x);
+template <unsigned ndim>
+py::array filter_bank_binding(py::object array, const std::vector<fastfilters_feature_type_t> &types,
+                               const std::vector<double> &sigmas, const std::vector<double> &sigmas_outer,
+                               float window_ratio, py::object out, const std::string &dtype)
+{
+    typedef typename std::conditional<ndim == 2, fastfilters_array2d_t, fastfilters_array3d_t>::type ff_array_t;
+    ff_array_t ff;
 
-        strides.push_back(sizeof(float) * ff.n_z * ff.n_y * ff.n_x);
-        strides.push_back(sizeof(float) * ff.n_y * ff.n_x);
-        strides.push_back(sizeof(float) * ff.n_x);
-        strides.push_back(sizeof(float));
-    } else {
-        n_dim = 5;
+    if (types.size() != sigmas.size() || types.size() != sigmas_outer.size())
+        throw std::logic_error("types, sigmas and sigmas_outer must have the same length.");
 
-        shape.push_back(3);
-        shape.push_back(ff.n_z);
-        shape.push_back(ff.n_y);
-        shape.push_back(ff.n_x);
-        shape.push_back(ff.n_channels);
+    const fastfilters_type_t out_type = stacked_output_type(dtype);
 
-        strides.push_back(sizeof(float) * ff.n_channels * ff.n_x * ff.n_y * ff.n_z);
-        strides.push_back(sizeof(float) * ff.n_channels * ff.n_x * ff.n_y);
-        strides.push_back(sizeof(float) * ff.n_channels * ff.n_x);
-        strides.push_back(sizeof(float) * ff.n_channels);
-        strides.push_back(sizeof(float));
+    std::vector<fastfilters_feature_t> features(types.size());
+    size_t n_outputs = 0;
+    for (size_t i = 0; i < types.size(); ++i) {
+        features[i].type = types[i];
+        features[i].sigma = sigmas[i];
+        features[i].sigma_outer = sigmas_outer[i];
+        n_outputs += fastfilters_feature_get_n_outputs(types[i], ndim);
     }
 
-    auto result =
-        py::array(py::buffer_info(nullptr, sizeof(float), py::format_descriptor<float>::value, n_dim, shape, strides));
-    py::buffer_info info_out = result.request();
+    InputArray input(array);
+    input.convert(ff);
 
-    float *xx = ff_out_xx.ptr;
-    float *yy = ff_out_yy.ptr;
-    float *zz = ff_out_zz.ptr;
-    float *xy = ff_out_xy.ptr;
-    float *xz = ff_out_xz.ptr;
-    float *yz = ff_out_yz.ptr;
+    std::vector<size_t> shape = input.shape();
+    shape.insert(shape.begin(), n_outputs);
+    OutputArray result(out, shape, out_type);
+    float *outptr = result.ptr();
 
-    float *outptr = (float *)info_out.ptr;
-    float *ev0 = outptr;
-    float *ev1 = outptr + n_pixels;
-    float *ev2 = outptr + 2 * n_pixels;
+    fastfilters_options_t opt;
+    opt.window_ratio = window_ratio;
+    opt.exact_fir = false;
 
-    fastfilters_linalg_ev3d(zz, yz, xz, yy, xy, xx, ev0, ev1, ev2, n_pixels);
-    // fastfilters_linalg_ev3d(xx, xy, yy, xz, yz, zz, ev0, ev1, ev2, n_pixels);
-    // fastfilters_linalg_ev3d(xx, xy, xz, yy, yz, zz, ev0, ev1, ev2, n_pixels);
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = filter_bank(ff, features, outptr, out_type, opt);
+    }
 
-    return result;
+    if (!ok)
+        throw std::logic_error("filter bank failed.");
+
+    return result.finish();
 }
 
-template <unsigned ndim, typename ConvolveFunctor>
-py::array_t<float> filter_binding(py::array_t<float, py::array::c_style | py::array::forcecast> &input,
-                                  ConvolveFunctor &fn)
+inline bool scale_space(const fastfilters_array2d_t &in, const std::vector<double> &sigmas, bool dog, float *outptr,
+                        fastfilters_type_t out_type, const fastfilters_options_t &opt)
+{
+    return fastfilters_fir_scale_space2d_ex(&in, sigmas.data(), sigmas.size(), dog, outptr, out_type, &opt);
+}
+
+inline bool scale_space(const fastfilters_array3d_t &in, const std::vector<double> &sigmas, bool dog, float *outptr,
+                        fastfilters_type_t out_type, const fastfilters_options_t &opt)
+{
+    return fastfilters_fir_scale_space3d_ex(&in, sigmas.data(), sigmas.size(), dog, outptr, out_type, &opt);
+}
+
+template <unsigned ndim>
+py::array scale_space_binding(py::object array, const std::vector<double> &sigmas, bool dog, float window_ratio,
+                              py::object out, const std::string &dtype)
 {
     typedef typename std::conditional<ndim == 2, fastfilters_array2d_t, fastfilters_array3d_t>::type ff_array_t;
     ff_array_t ff;
-    ff_array_t ff_out;
 
-    auto result = array_like(input);
-    convert_py2ff(input, ff);
-    convert_py2ff(result, ff_out);
+    if (sigmas.size() < (dog ? 2u : 1u))
+        throw std::invalid_argument(dog ? "dog needs at least two sigmas." : "sigmas must not be empty.");
+    for (size_t i = 0; i < sigmas.size(); ++i)
+        if (!(sigmas[i] > 0.0) || (i > 0 && !(sigmas[i] > sigmas[i - 1])))
+            throw std::invalid_argument("sigmas must be positive and strictly increasing.");
 
-    if (!fn(ff, ff_out))
-        throw std::logic_error("convolution failed.");
+    const fastfilters_type_t out_type = stacked_output_type(dtype);
 
-    return result;
+    InputArray input(array);
+    input.convert(ff);
+
+    std::vector<size_t> shape = input.shape();
+    shape.insert(shape.begin(), dog ? sigmas.size() - 1 : sigmas.size());
+    OutputArray result(out, shape, out_type);
+    float *outptr = result.ptr();
+
+    fastfilters_options_t opt;
+    opt.window_ratio = window_ratio;
+    opt.exact_fir = false;
+
+    bool ok;
+    {
+        py::gil_scoped_release release;
+        ok = scale_space(ff, sigmas, dog, outptr, out_type, opt);
+    }
+
+    if (!ok)
+        throw std::logic_error("scale space failed.");
+
+    return result.finish();
+}
+
+template <unsigned ndim>
+py::array hessian_measure_binding(py::object array, fastfilters_hessian_measure_type_t type,
+                                  const std::vector<double> &sigmas, bool dark, float alpha, float beta, float c,
+                                  float window_ratio, py::object out, bool exact_fir)
+{
+    if (sigmas.empty())
+        throw std::invalid_argument("sigmas must not be empty.");
+
+    InputArray input(array);
+    HessianMeasure fn(type, sigmas, dark, alpha, beta, c);
+    fn.set_window_ratio(window_ratio);
+    fn.set_exact_fir(exact_fir);
+    return filter_binding<ndim>(input, fn, out);
 }
 
 template <typename T> py::arg arg_wrapper()
@@ -512,41 +898,79 @@ template <typename T> py::arg arg_wrapper()
     return py::arg("arg"); // FIXME
 }
 
-template <typename ConvolveFunctor, typename... args> void bind2d3d(py::module &m, const std::string prefix)
+template <typename ConvolveFunctor, typename WindowRatio, typename... args>
+void bind2d3d(py::module &m, const std::string prefix)
 {
     m.def((prefix + "2d").c_str(),
-          [](py::array_t<float, py::array::c_style | py::array::forcecast> &input, args... E, float window_ratio) {
-
+          [](py::object array, args... E, WindowRatio window_ratio, py::object out, bool exact_fir) {
+              InputArray input(array);
               ConvolveFunctor fn(E...);
               fn.set_window_ratio(window_ratio);
-              return filter_binding<2>(input, fn);
+              fn.set_exact_fir(exact_fir);
+              return filter_binding<2>(input, fn, out);
           },
-          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = 0.0);
+          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = WindowRatio(),
+          py::arg("out") = py::none(), py::arg("exact_fir") = false);
     m.def((prefix + "3d").c_str(),
-          [](py::array_t<float, py::array::c_style | py::array::forcecast> &input, args... E, float window_ratio) {
+          [](py::object array, args... E, WindowRatio window_ratio, py::object out, bool exact_fir) {
+              InputArray input(array);
               ConvolveFunctor fn(E...);
               fn.set_window_ratio(window_ratio);
-              return filter_binding<3>(input, fn);
+              fn.set_exact_fir(exact_fir);
+              return filter_binding<3>(input, fn, out);
           },
-          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = 0.0);
+          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = WindowRatio(),
+          py::arg("out") = py::none(), py::arg("exact_fir") = false);
 }
 
-template <typename ConvolveFunctor, typename... args> void bind2d3d_ev(py::module &m, const std::string prefix)
+template <typename ConvolveFunctor, typename WindowRatio, typename... args>
+void bind2d3d_ev(py::module &m, const std::string prefix)
 {
     m.def((prefix + "2d").c_str(),
-          [](py::array_t<float, py::array::c_style | py::array::forcecast> &input, args... E, float window_ratio) {
+          [](py::object array, args... E, WindowRatio window_ratio, py::object out, bool exact_fir) {
+              InputArray input(array);
               ConvolveFunctor fn(E...);
               fn.set_window_ratio(window_ratio);
-              return filter_ev_2d_binding(input, fn);
+              fn.set_exact_fir(exact_fir);
+              return filter_ev_2d_binding(input, fn, out);
           },
-          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = 0.0);
+          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = WindowRatio(),
+          py::arg("out") = py::none(), py::arg("exact_fir") = false);
     m.def((prefix + "3d").c_str(),
-          [](py::array_t<float, py::array::c_style | py::array::forcecast> &input, args... E, float window_ratio) {
+          [](py::object array, args... E, WindowRatio window_ratio, py::object out, bool exact_fir) {
+              InputArray input(array);
               ConvolveFunctor fn(E...);
               fn.set_window_ratio(window_ratio);
-              return filter_ev_3d_binding(input, fn);
+              fn.set_exact_fir(exact_fir);
+              return filter_ev_3d_binding(input, fn, out);
           },
-          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = 0.0);
+          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = WindowRatio(),
+          py::arg("out") = py::none(), py::arg("exact_fir") = false);
+}
+
+template <typename ConvolveFunctor, typename WindowRatio, typename... args>
+void bind2d3d_evec(py::module &m, const std::string prefix)
+{
+    m.def((prefix + "2d_eigenvectors").c_str(),
+          [](py::object array, args... E, WindowRatio window_ratio, py::object out, bool exact_fir) {
+              InputArray input(array);
+              ConvolveFunctor fn(E...);
+              fn.set_window_ratio(window_ratio);
+              fn.set_exact_fir(exact_fir);
+              return filter_evec_binding<2>(input, fn, out);
+          },
+          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = WindowRatio(),
+          py::arg("out") = py::none(), py::arg("exact_fir") = false);
+    m.def((prefix + "3d_eigenvectors").c_str(),
+          [](py::object array, args... E, WindowRatio window_ratio, py::object out, bool exact_fir) {
+              InputArray input(array);
+              ConvolveFunctor fn(E...);
+              fn.set_window_ratio(window_ratio);
+              fn.set_exact_fir(exact_fir);
+              return filter_evec_binding<3>(input, fn, out);
+          },
+          py::arg("input"), arg_wrapper<args *>()..., py::arg("window_ratio") = WindowRatio(),
+          py::arg("out") = py::none(), py::arg("exact_fir") = false);
 }
 };
 
@@ -581,17 +1005,92 @@ PYBIND11_MODULE(core, m_fastfilters)
 
     py::class_<FIRKernel>(m_fastfilters, "FIRKernel")
         .def(py::init<unsigned, double>())
+        .def(py::init<std::vector<float>>())
         .def("len", &FIRKernel::len)
         .def_readonly("sigma", &FIRKernel::sigma)
         .def_readonly("order", &FIRKernel::order);
 
-    m_fastfilters.def("linalg_ev2d", &linalg_ev2d);
-    m_fastfilters.def("convolve_fir", &convolve_fir, py::arg("input"), py::arg("kernels"));
-
-    bind2d3d<ConvolveGaussian, unsigned, double>(m_fastfilters, "gaussian");
-    bind2d3d<ConvolveGradMag, double>(m_fastfilters, "gradmag");
-    bind2d3d<ConvolveLaPlacian, double>(m_fastfilters, "laplacian");
+    m_fastfilters.def("set_num_threads",
+                      [](unsigned int n_threads) {
+                          if (!fastfilters_set_num_threads(n_threads))
+                              throw std::runtime_error("fastfilters_set_num_threads failed.");
+                      },
+                      py::arg("n_threads"));
+    m_fastfilters.def("get_num_threads", &fastfilters_get_num_threads);
+    m_fastfilters.def("clear_kernel_cache", &fastfilters_kernel_cache_clear);
+    m_fastfilters.def("set_iir_crossover", &fastfilters_iir_set_crossover, py::arg("sigma"));
+    m_fastfilters.def("get_iir_crossover", &fastfilters_iir_get_crossover);
+    m_fastfilters.def("memory_pool_configure", &fastfilters_memory_pool_configure, py::arg("enable"),
+                      py::arg("huge_pages") = false);
+    m_fastfilters.def("memory_trim", &fastfilters_memory_trim);
+    m_fastfilters.def("memory_stats", []() {
+        fastfilters_memory_stats_t stats;
+        fastfilters_memory_stats(&stats);
+
+        py::dict result;
+        result["allocations"] = stats.allocations;
+        result["pool_hits"] = stats.pool_hits;
+        result["bytes_in_use"] = stats.bytes_in_use;
+        result["bytes_cached"] = stats.bytes_cached;
+        return result;
+    });
 
-    bind2d3d_ev<ConvolveHessian, double>(m_fastfilters, "hog");
-    bind2d3d_ev<ConvolveST, double, double>(m_fastfilters, "st");
+    m_fastfilters.def("linalg_ev2d", &linalg_ev2d);
+    m_fastfilters.def("convolve_fir", &convolve_fir, py::arg("input"), py::arg("kernels"), py::arg("out") = py::none());
+
+    bind2d3d<ConvolveGaussian, float, unsigned, double>(m_fastfilters, "gaussian");
+    bind2d3d<ConvolveGradMag, float, double>(m_fastfilters, "gradmag");
+    bind2d3d<ConvolveLaPlacian, float, double>(m_fastfilters, "laplacian");
+
+    bind2d3d_ev<ConvolveHessian, float, double>(m_fastfilters, "hog");
+    bind2d3d_ev<ConvolveST, float, double, double>(m_fastfilters, "st");
+    bind2d3d_evec<ConvolveHessian, float, double>(m_fastfilters, "hog");
+    bind2d3d_evec<ConvolveST, float, double, double>(m_fastfilters, "st");
+
+    // anisotropic overloads with one sigma and window ratio per axis in x, y(, z) order
+    typedef std::vector<double> axes_t;
+    typedef std::vector<float> ratios_t;
+    bind2d3d<ConvolveGaussian, ratios_t, unsigned, axes_t>(m_fastfilters, "gaussian");
+    bind2d3d<ConvolveGradMag, ratios_t, axes_t>(m_fastfilters, "gradmag");
+    bind2d3d<ConvolveLaPlacian, ratios_t, axes_t>(m_fastfilters, "laplacian");
+
+    bind2d3d_ev<ConvolveHessian, ratios_t, axes_t>(m_fastfilters, "hog");
+    bind2d3d_ev<ConvolveST, ratios_t, axes_t, axes_t>(m_fastfilters, "st");
+    bind2d3d_evec<ConvolveHessian, ratios_t, axes_t>(m_fastfilters, "hog");
+    bind2d3d_evec<ConvolveST, ratios_t, axes_t, axes_t>(m_fastfilters, "st");
+
+    py::enum_<fastfilters_feature_type_t>(m_fastfilters, "FeatureType")
+        .value("gaussian", FASTFILTERS_FEATURE_GAUSSIAN)
+        .value("gradmag", FASTFILTERS_FEATURE_GRADMAG)
+        .value("laplacian", FASTFILTERS_FEATURE_LAPLACIAN)
+        .value("hog_ev", FASTFILTERS_FEATURE_HOG_EV)
+        .value("st_ev", FASTFILTERS_FEATURE_ST_EV);
+
+    py::enum_<fastfilters_hessian_measure_type_t>(m_fastfilters, "HessianMeasure")
+        .value("vesselness", FASTFILTERS_HESSIAN_VESSELNESS)
+        .value("blobness", FASTFILTERS_HESSIAN_BLOBNESS)
+        .value("ridge", FASTFILTERS_HESSIAN_RIDGE);
+
+    m_fastfilters.def("hessian_measure2d", &hessian_measure_binding<2>, py::arg("input"), py::arg("type"),
+                      py::arg("sigmas"), py::arg("dark") = false, py::arg("alpha") = 0.5, py::arg("beta") = 0.5,
+                      py::arg("c") = 0.0, py::arg("window_ratio") = 0.0, py::arg("out") = py::none(),
+                      py::arg("exact_fir") = false);
+    m_fastfilters.def("hessian_measure3d", &hessian_measure_binding<3>, py::arg("input"), py::arg("type"),
+                      py::arg("sigmas"), py::arg("dark") = false, py::arg("alpha") = 0.5, py::arg("beta") = 0.5,
+                      py::arg("c") = 0.0, py::arg("window_ratio") = 0.0, py::arg("out") = py::none(),
+                      py::arg("exact_fir") = false);
+
+    m_fastfilters.def("filter_bank2d", &filter_bank_binding<2>, py::arg("input"), py::arg("types"), py::arg("sigmas"),
+                      py::arg("sigmas_outer"), py::arg("window_ratio") = 0.0, py::arg("out") = py::none(),
+                      py::arg("dtype") = "float32");
+    m_fastfilters.def("filter_bank3d", &filter_bank_binding<3>, py::arg("input"), py::arg("types"), py::arg("sigmas"),
+                      py::arg("sigmas_outer"), py::arg("window_ratio") = 0.0, py::arg("out") = py::none(),
+                      py::arg("dtype") = "float32");
+
+    m_fastfilters.def("scale_space2d", &scale_space_binding<2>, py::arg("input"), py::arg("sigmas"),
+                      py::arg("dog") = false, py::arg("window_ratio") = 0.0, py::arg("out") = py::none(),
+                      py::arg("dtype") = "float32");
+    m_fastfilters.def("scale_space3d", &scale_space_binding<3>, py::arg("input"), py::arg("sigmas"),
+                      py::arg("dog") = false, py::arg("window_ratio") = 0.0, py::arg("out") = py::none(),
+                      py::arg("dtype") = "float32");
 }
@@ -0,0 +1,26 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import ok_
+
+def test_anisotropic_equal_sigmas():
+    for a in [np.random.randn(123, 97).astype(np.float32), np.random.randn(31, 43, 29).astype(np.float32)]:
+        n = a.ndim
+        for fn, args in [(ff.gaussianSmoothing, (2.0,)), (ff.gaussianGradientMagnitude, (1.5,)),
+                         (ff.laplacianOfGaussian, (1.5,)), (ff.hessianOfGaussianEigenvalues, (1.5,)),
+                         (ff.structureTensorEigenvalues, (1.0, 2.0))]:
+            ok_(np.array_equal(fn(a, *args), fn(a, *[[s] * n for s in args])))
+
+def test_anisotropic_gaussian():
+    a = np.random.randn(31, 43, 29).astype(np.float32)
+    sigmas = (0.7, 1.5, 2.5)
+    # kernels are passed x first, the sigmas follow the numpy axis order
+    kernels = [ff.core.FIRKernel(0, s) for s in reversed(sigmas)]
+    ok_(np.allclose(ff.gaussianSmoothing(a, sigmas), ff.core.convolve_fir(a, kernels), atol=1e-6))
+
+    kernels = [ff.core.FIRKernel(1, s) for s in reversed(sigmas)]
+    ok_(np.allclose(ff.gaussianDerivative(a, sigmas, 1), ff.core.convolve_fir(a, kernels), atol=1e-6))
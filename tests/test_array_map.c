@@ -0,0 +1,148 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// fastfilters_array3d_map round trips through files in the working directory: data written to a writable mapping is
+// in the file after unmapping, a read-only mapping sees it, and a convolution from a mapped input into a mapped output
+// gives the same result as in memory.
+
+#define N_X 45
+#define N_Y 31
+#define N_Z 19
+#define N_CHANNELS 2
+
+static const char *const g_in_path = "test_array_map_in.raw";
+static const char *const g_out_path = "test_array_map_out.raw";
+
+static long file_size(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long size = -1;
+
+    if (f && fseek(f, 0, SEEK_END) == 0)
+        size = ftell(f);
+    if (f)
+        fclose(f);
+
+    return size;
+}
+
+static void check_write_read(void)
+{
+    const size_t n = N_X * N_Y * N_Z * N_CHANNELS;
+    uint16_t *data = malloc(n * sizeof(uint16_t));
+
+    for (size_t i = 0; i < n; ++i)
+        data[i] = (uint16_t)(i * 2654435761u >> 16);
+
+    remove(g_in_path);
+
+    // a read-only mapping needs an existing file of the full size
+    CHECK(fastfilters_array3d_map(g_in_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_UINT16, false) == NULL);
+
+    fastfilters_array3d_t *v =
+        fastfilters_array3d_map(g_in_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_UINT16, true);
+    CHECK(v != NULL);
+    if (!v)
+        goto out;
+
+    CHECK(v->n_x == N_X && v->n_y == N_Y && v->n_z == N_Z && v->n_channels == N_CHANNELS);
+    CHECK(v->stride_x == N_CHANNELS && v->stride_y == N_X * N_CHANNELS && v->stride_z == N_X * N_Y * N_CHANNELS);
+    CHECK(v->type == FASTFILTERS_TYPE_UINT16);
+
+    memcpy(v->ptr, data, n * sizeof(uint16_t));
+    fastfilters_array3d_unmap(v);
+    CHECK(file_size(g_in_path) == (long)(n * sizeof(uint16_t)));
+
+    v = fastfilters_array3d_map(g_in_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_UINT16, false);
+    CHECK(v != NULL && !memcmp(v->ptr, data, n * sizeof(uint16_t)));
+    if (v)
+        fastfilters_array3d_unmap(v);
+
+    // writable mappings of existing files keep their contents, larger ones grow the file
+    v = fastfilters_array3d_map(g_in_path, N_X, N_Y, N_Z + 1, N_CHANNELS, FASTFILTERS_TYPE_UINT16, true);
+    CHECK(v != NULL && !memcmp(v->ptr, data, n * sizeof(uint16_t)));
+    if (v)
+        fastfilters_array3d_unmap(v);
+    CHECK(file_size(g_in_path) == (long)((n + N_X * N_Y * N_CHANNELS) * sizeof(uint16_t)));
+
+out:
+    free(data);
+    remove(g_in_path);
+}
+
+static void check_convolve(void)
+{
+    const size_t n = N_X * N_Y * N_Z * N_CHANNELS;
+    float *data = test_alloc_random(n, 9);
+    float *ref = test_alloc(n);
+    fastfilters_kernel_fir_t kx = fastfilters_kernel_fir_gaussian(0, 1.5, 0.0f);
+    fastfilters_kernel_fir_t ky = fastfilters_kernel_fir_gaussian(1, 1.2, 0.0f);
+    fastfilters_kernel_fir_t kz = fastfilters_kernel_fir_gaussian(2, 1.0, 0.0f);
+
+    fastfilters_array3d_t in = test_array3d(data, N_X, N_Y, N_Z, N_CHANNELS);
+    fastfilters_array3d_t out = test_array3d(ref, N_X, N_Y, N_Z, N_CHANNELS);
+    CHECK(fastfilters_fir_convolve3d(&in, kx, ky, kz, &out, NULL));
+
+    remove(g_in_path);
+    remove(g_out_path);
+
+    fastfilters_array3d_t *min =
+        fastfilters_array3d_map(g_in_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_FLOAT32, true);
+    CHECK(min != NULL);
+    if (!min)
+        goto out;
+    memcpy(min->ptr, data, n * sizeof(float));
+    fastfilters_array3d_unmap(min);
+
+    min = fastfilters_array3d_map(g_in_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_FLOAT32, false);
+    fastfilters_array3d_t *mout =
+        fastfilters_array3d_map(g_out_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_FLOAT32, true);
+    CHECK(min != NULL && mout != NULL);
+    if (min && mout)
+        CHECK(fastfilters_fir_convolve3d(min, kx, ky, kz, mout, NULL));
+    if (min)
+        fastfilters_array3d_unmap(min);
+    if (mout)
+        fastfilters_array3d_unmap(mout);
+
+    mout = fastfilters_array3d_map(g_out_path, N_X, N_Y, N_Z, N_CHANNELS, FASTFILTERS_TYPE_FLOAT32, false);
+    CHECK(mout != NULL && test_equal(mout->ptr, ref, n));
+    if (mout)
+        fastfilters_array3d_unmap(mout);
+
+out:
+    fastfilters_kernel_fir_free(kx);
+    fastfilters_kernel_fir_free(ky);
+    fastfilters_kernel_fir_free(kz);
+    free(data);
+    free(ref);
+    remove(g_in_path);
+    remove(g_out_path);
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    check_write_read();
+    check_convolve();
+
+    return test_result("test_array_map");
+}
@@ -0,0 +1,297 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// fastfilters_fir_convolve_block2d/3d: the image is cut into blocks, every block is filtered with halos copied from
+// the image and has to match the same region of fastfilters_fir_convolve2d/3d over the whole image. Vector loops split
+// block lines differently from image lines, so float32 results agree within TOLERANCE of the kernel gain and float16
+// ones within one rounding step.
+// The tilings give blocks with both halos, with one side at the image border (mirrored) and blocks spanning the whole
+// axis (mirrored on both sides), with odd sizes and with the minimal size of twice the kernel length.
+
+#define TOLERANCE 1e-6
+
+#define N_X 61
+#define N_Y 47
+#define N_Z 29
+
+typedef struct {
+    size_t start[3];
+    size_t size[3];
+} box_t;
+
+static size_t type_size(fastfilters_type_t type)
+{
+    return type == FASTFILTERS_TYPE_FLOAT32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+// copy box out of the dense image of the given shape into a dense array
+static float *copy_box(const float *image, const size_t *shape, size_t n_channels, const box_t *box)
+{
+    float *out = test_alloc(box->size[0] * box->size[1] * box->size[2] * n_channels);
+    const size_t row = box->size[0] * n_channels;
+
+    for (size_t z = 0; z < box->size[2]; ++z)
+        for (size_t y = 0; y < box->size[1]; ++y)
+            memcpy(out + (z * box->size[1] + y) * row,
+                   image + (((box->start[2] + z) * shape[1] + box->start[1] + y) * shape[0] + box->start[0]) *
+                               n_channels,
+                   row * sizeof(float));
+
+    return out;
+}
+
+// half floats as integers that are ordered like their values, adjacent values differ by one
+static int32_t half_order(uint16_t h)
+{
+    return h & 0x8000 ? -(int32_t)(h & 0x7fff) : (int32_t)h;
+}
+
+// compare a dense block with its box in the dense full result: float32 within tolerance, float16 within one step
+static bool block_matches(const void *full, const void *block, const size_t *shape, size_t n_channels,
+                          fastfilters_type_t type, double tolerance, const box_t *box)
+{
+    const size_t row = box->size[0] * n_channels;
+
+    for (size_t z = 0; z < box->size[2]; ++z) {
+        for (size_t y = 0; y < box->size[1]; ++y) {
+            const size_t offset =
+                (((box->start[2] + z) * shape[1] + box->start[1] + y) * shape[0] + box->start[0]) * n_channels;
+            const size_t block_offset = (z * box->size[1] + y) * row;
+
+            for (size_t i = 0; i < row; ++i) {
+                if (type == FASTFILTERS_TYPE_FLOAT32) {
+                    if (!(fabs(((const float *)full)[offset + i] - ((const float *)block)[block_offset + i]) <=
+                          tolerance))
+                        return false;
+                } else if (abs(half_order(((const uint16_t *)full)[offset + i]) -
+                               half_order(((const uint16_t *)block)[block_offset + i])) > 1) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// next block along an axis of length n starting at pos, with at most block_size pixels; a rest shorter than the
+// minimal block is merged into the last one
+static size_t next_block(size_t pos, size_t n, size_t block_size, size_t min_size)
+{
+    size_t size = n - pos < block_size ? n - pos : block_size;
+
+    if (n - pos - size < min_size)
+        size = n - pos;
+
+    return size;
+}
+
+// filters the block box of the image with halos, the result is dense with elements of out_type
+static bool filter_block(const float *image, const size_t *shape, size_t n_channels, unsigned int ndim,
+                         const fastfilters_kernel_fir_t *k, const box_t *box, fastfilters_type_t out_type, void *out)
+{
+    fastfilters_array3d_t halos[6];
+    float *halo_data[6] = {NULL};
+    size_t margin[3][2];
+
+    memset(halos, 0, sizeof(halos));
+
+    for (unsigned int i = 0; i < ndim; ++i) {
+        margin[i][0] = box->start[i] > 0 ? k[i]->len : 0;
+        margin[i][1] = box->start[i] + box->size[i] < shape[i] ? k[i]->len : 0;
+    }
+
+    for (unsigned int i = 0; i < ndim; ++i) {
+        for (unsigned int side = 0; side < 2; ++side) {
+            if (!margin[i][side])
+                continue;
+
+            // earlier axes include their halos (the corners), later axes only span the block
+            box_t hbox = *box;
+            for (unsigned int j = 0; j < i; ++j) {
+                hbox.start[j] -= margin[j][0];
+                hbox.size[j] += margin[j][0] + margin[j][1];
+            }
+            hbox.start[i] = side ? box->start[i] + box->size[i] : box->start[i] - k[i]->len;
+            hbox.size[i] = k[i]->len;
+
+            halo_data[2 * i + side] = copy_box(image, shape, n_channels, &hbox);
+            halos[2 * i + side] =
+                test_array3d(halo_data[2 * i + side], hbox.size[0], hbox.size[1], hbox.size[2], n_channels);
+        }
+    }
+
+    float *in = copy_box(image, shape, n_channels, box);
+    fastfilters_array3d_t in3 = test_array3d(in, box->size[0], box->size[1], box->size[2], n_channels);
+    fastfilters_array3d_t out3 = test_array3d(out, box->size[0], box->size[1], box->size[2], n_channels);
+    out3.type = out_type;
+    bool result;
+
+    if (ndim == 3) {
+        result = fastfilters_fir_convolve_block3d(&in3, halos, k[0], k[1], k[2], &out3, NULL);
+    } else {
+        fastfilters_array2d_t in2 = test_array2d(in, box->size[0], box->size[1], n_channels);
+        fastfilters_array2d_t out2 = test_array2d(out, box->size[0], box->size[1], n_channels);
+        fastfilters_array2d_t halos2[4];
+        out2.type = out_type;
+
+        for (unsigned int i = 0; i < 4; ++i) {
+            halos2[i] = test_array2d(halos[i].ptr, halos[i].n_x, halos[i].n_y, n_channels);
+            halos2[i].ptr = halos[i].ptr;
+        }
+
+        result = fastfilters_fir_convolve_block2d(&in2, halos2, k[0], k[1], &out2, NULL);
+    }
+
+    free(in);
+    for (unsigned int i = 0; i < 6; ++i)
+        free(halo_data[i]);
+
+    return result;
+}
+
+static bool filter_full(const float *image, const size_t *shape, size_t n_channels, unsigned int ndim,
+                        const fastfilters_kernel_fir_t *k, fastfilters_type_t out_type, void *out)
+{
+    if (ndim == 3) {
+        fastfilters_array3d_t in = test_array3d((float *)image, shape[0], shape[1], shape[2], n_channels);
+        fastfilters_array3d_t o = test_array3d(out, shape[0], shape[1], shape[2], n_channels);
+        o.type = out_type;
+        return fastfilters_fir_convolve3d(&in, k[0], k[1], k[2], &o, NULL);
+    }
+
+    fastfilters_array2d_t in = test_array2d((float *)image, shape[0], shape[1], n_channels);
+    fastfilters_array2d_t o = test_array2d(out, shape[0], shape[1], n_channels);
+    o.type = out_type;
+    return fastfilters_fir_convolve2d(&in, k[0], k[1], &o, NULL);
+}
+
+// tiles the image with blocks of block_sizes[tiling[i]] along axis i, 0 is the whole axis and 1 the minimal size
+static void check_tiling(const float *image, const void *full, const size_t *shape, size_t n_channels,
+                         unsigned int ndim, const fastfilters_kernel_fir_t *k, const unsigned int *tiling,
+                         fastfilters_type_t out_type)
+{
+    size_t block_size[3] = {1, 1, 1}, min_size[3] = {1, 1, 1};
+    const size_t elem_size = type_size(out_type);
+    double tolerance = TOLERANCE;
+
+    for (unsigned int i = 0; i < ndim; ++i) {
+        tolerance *= test_kernel_gain(k[i]);
+        const size_t sizes[3] = {shape[i], 2 * k[i]->len, 2 * k[i]->len + 3};
+        block_size[i] = sizes[tiling[i]];
+        min_size[i] = 2 * k[i]->len;
+    }
+
+    box_t box;
+    for (box.start[2] = 0; box.start[2] < shape[2]; box.start[2] += box.size[2]) {
+        box.size[2] = next_block(box.start[2], shape[2], block_size[2], min_size[2]);
+        for (box.start[1] = 0; box.start[1] < shape[1]; box.start[1] += box.size[1]) {
+            box.size[1] = next_block(box.start[1], shape[1], block_size[1], min_size[1]);
+            for (box.start[0] = 0; box.start[0] < shape[0]; box.start[0] += box.size[0]) {
+                box.size[0] = next_block(box.start[0], shape[0], block_size[0], min_size[0]);
+
+                void *out = malloc(box.size[0] * box.size[1] * box.size[2] * n_channels * elem_size);
+                const bool ok = filter_block(image, shape, n_channels, ndim, k, &box, out_type, out);
+
+                CHECK_MSG(ok && block_matches(full, out, shape, n_channels, out_type, tolerance, &box),
+                          "%uD, %zu channels, type %d, block at %zu %zu %zu of %zu x %zu x %zu %s", ndim, n_channels,
+                          (int)out_type, box.start[0], box.start[1], box.start[2], box.size[0], box.size[1],
+                          box.size[2], ok ? "differs" : "failed");
+                free(out);
+            }
+        }
+    }
+}
+
+static void check_image(unsigned int ndim, size_t n_channels, const fastfilters_kernel_fir_t *k,
+                        fastfilters_type_t out_type, uint32_t seed)
+{
+    const size_t shape[3] = {N_X, N_Y, ndim == 3 ? N_Z : 1};
+    const size_t n = shape[0] * shape[1] * shape[2] * n_channels;
+    float *image = test_alloc_random(n, seed);
+    void *full = malloc(n * type_size(out_type));
+
+    CHECK(filter_full(image, shape, n_channels, ndim, k, out_type, full));
+
+    unsigned int tiling[3] = {0, 0, 0};
+    for (tiling[2] = 0; tiling[2] < (ndim == 3 ? 3u : 1u); ++tiling[2])
+        for (tiling[1] = 0; tiling[1] < 3; ++tiling[1])
+            for (tiling[0] = 0; tiling[0] < 3; ++tiling[0])
+                check_tiling(image, full, shape, n_channels, ndim, k, tiling, out_type);
+
+    free(image);
+    free(full);
+}
+
+// blocks shorter than twice the kernel length and halos of the wrong size are rejected
+static void check_invalid(const fastfilters_kernel_fir_t *k)
+{
+    const size_t len = k[0]->len;
+    float *in = test_alloc_random(N_X * N_Y, 3);
+    float *halo = test_alloc_random(N_X * N_Y, 4);
+    float *out = test_alloc(N_X * N_Y);
+
+    fastfilters_array2d_t small_in = test_array2d(in, 2 * len - 1, N_Y, 1);
+    fastfilters_array2d_t small_out = test_array2d(out, 2 * len - 1, N_Y, 1);
+    CHECK(!fastfilters_fir_convolve_block2d(&small_in, NULL, k[0], k[1], &small_out, NULL));
+
+    fastfilters_array2d_t block_in = test_array2d(in, 2 * len, N_Y, 1);
+    fastfilters_array2d_t block_out = test_array2d(out, 2 * len, N_Y, 1);
+    fastfilters_array2d_t halos[4];
+    memset(halos, 0, sizeof(halos));
+    halos[0] = test_array2d(halo, len + 1, N_Y, 1);
+    CHECK(!fastfilters_fir_convolve_block2d(&block_in, halos, k[0], k[1], &block_out, NULL));
+    halos[0] = test_array2d(halo, len, N_Y, 1);
+    CHECK(fastfilters_fir_convolve_block2d(&block_in, halos, k[0], k[1], &block_out, NULL));
+
+    free(in);
+    free(halo);
+    free(out);
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    // symmetric, antisymmetric and general kernels of different lengths per axis
+    const float general_coefs[7] = {0.05f, -0.1f, 0.3f, 0.5f, 0.2f, 0.15f, -0.02f};
+    fastfilters_kernel_fir_t gaussians[3] = {
+        fastfilters_kernel_fir_gaussian(0, 1.7, 0.0f),
+        fastfilters_kernel_fir_gaussian(1, 1.2, 0.0f),
+        fastfilters_kernel_fir_gaussian(2, 0.9, 0.0f),
+    };
+    fastfilters_kernel_fir_t general = fastfilters_kernel_fir_create(general_coefs, 3, FASTFILTERS_KERNEL_GENERAL);
+    fastfilters_kernel_fir_t mixed[3] = {general, gaussians[1], general};
+
+    for (unsigned int ndim = 2; ndim <= 3; ++ndim) {
+        check_image(ndim, 1, gaussians, FASTFILTERS_TYPE_FLOAT32, 10 + ndim);
+        check_image(ndim, 3, gaussians, FASTFILTERS_TYPE_FLOAT32, 20 + ndim);
+        check_image(ndim, 2, mixed, FASTFILTERS_TYPE_FLOAT32, 30 + ndim);
+        check_image(ndim, 1, gaussians, FASTFILTERS_TYPE_FLOAT16, 40 + ndim);
+    }
+
+    check_invalid(gaussians);
+
+    for (unsigned int i = 0; i < 3; ++i)
+        fastfilters_kernel_fir_free(gaussians[i]);
+    fastfilters_kernel_fir_free(general);
+
+    return test_result("test_block");
+}
@@ -0,0 +1,194 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// fastfilters_fir_convolve3d_chunked has to be bit-identical to fastfilters_fir_convolve3d on the whole volume for
+// every slab size, including odd ones, ones below the kernel length (raised to twice the kernel length) and ones larger
+// than the volume, with the volume ends mirrored and the slab ends read from the overlap. The callbacks check that only
+// planes inside the volume are read and every output plane is written exactly once.
+
+#define N_X 37
+#define N_Y 29
+
+typedef struct {
+    const char *in;
+    char *out;
+    size_t in_plane;
+    size_t out_plane;
+    size_t n_z;
+    unsigned int *writes;
+    bool fail_read;
+    bool bad_range;
+} volume_t;
+
+static bool volume_read(void *ctx, size_t z, size_t n_z, void *buf)
+{
+    volume_t *v = ctx;
+
+    if (v->fail_read)
+        return false;
+    if (z + n_z > v->n_z || n_z == 0) {
+        v->bad_range = true;
+        return false;
+    }
+
+    memcpy(buf, v->in + z * v->in_plane, n_z * v->in_plane);
+    return true;
+}
+
+static bool volume_write(void *ctx, size_t z, size_t n_z, const void *buf)
+{
+    volume_t *v = ctx;
+
+    if (z + n_z > v->n_z || n_z == 0) {
+        v->bad_range = true;
+        return false;
+    }
+
+    memcpy(v->out + z * v->out_plane, buf, n_z * v->out_plane);
+    for (size_t i = 0; i < n_z; ++i)
+        v->writes[z + i]++;
+    return true;
+}
+
+// random elements of type, integers cover their whole range
+static void *random_volume(size_t n, fastfilters_type_t type, uint32_t seed)
+{
+    const float *values = test_alloc_random(n, seed);
+    void *data = malloc(n * fastfilters_type_size(type));
+
+    for (size_t i = 0; i < n; ++i) {
+        switch (type) {
+        case FASTFILTERS_TYPE_UINT8:
+            ((uint8_t *)data)[i] = (uint8_t)((values[i] + 1.0f) * 127.5f);
+            break;
+        case FASTFILTERS_TYPE_UINT16:
+            ((uint16_t *)data)[i] = (uint16_t)((values[i] + 1.0f) * 32767.5f);
+            break;
+        case FASTFILTERS_TYPE_FLOAT64:
+            ((double *)data)[i] = values[i];
+            break;
+        default:
+            ((float *)data)[i] = values[i];
+            break;
+        }
+    }
+
+    free((void *)values);
+    return data;
+}
+
+static void check_volume(size_t n_z, size_t n_channels, const fastfilters_kernel_fir_t *k, fastfilters_type_t in_type,
+                         fastfilters_type_t out_type, uint32_t seed)
+{
+    const size_t len_z = k[2]->len;
+    const size_t slab_planes[] = {0, 1, len_z ? len_z - 1 : 0, len_z, 2 * len_z, 2 * len_z + 1, 7, 13, n_z - 1, n_z,
+                                  n_z + 5};
+    const size_t plane = N_X * N_Y * n_channels;
+    const size_t n = plane * n_z;
+
+    void *in = random_volume(n, in_type, seed);
+    void *ref = malloc(n * fastfilters_type_size(out_type));
+    void *out = malloc(n * fastfilters_type_size(out_type));
+    unsigned int *writes = malloc(n_z * sizeof(unsigned int));
+
+    fastfilters_array3d_t in_array = test_array3d(in, N_X, N_Y, n_z, n_channels);
+    fastfilters_array3d_t ref_array = test_array3d(ref, N_X, N_Y, n_z, n_channels);
+    in_array.type = in_type;
+    ref_array.type = out_type;
+    CHECK(fastfilters_fir_convolve3d(&in_array, k[0], k[1], k[2], &ref_array, NULL));
+
+    volume_t v = {.in = in,
+                  .out = out,
+                  .in_plane = plane * fastfilters_type_size(in_type),
+                  .out_plane = plane * fastfilters_type_size(out_type),
+                  .n_z = n_z,
+                  .writes = writes};
+    const fastfilters_volume_io_t io = {.n_x = N_X,
+                                        .n_y = N_Y,
+                                        .n_z = n_z,
+                                        .n_channels = n_channels,
+                                        .in_type = in_type,
+                                        .out_type = out_type,
+                                        .read = volume_read,
+                                        .write = volume_write,
+                                        .ctx = &v};
+
+    for (unsigned int s = 0; s < ARRAY_LENGTH(slab_planes); ++s) {
+        memset(out, 0xff, n * fastfilters_type_size(out_type));
+        memset(writes, 0, n_z * sizeof(unsigned int));
+        v.bad_range = false;
+
+        const bool ok = fastfilters_fir_convolve3d_chunked(&io, slab_planes[s], k[0], k[1], k[2], NULL);
+        bool written_once = true;
+        for (size_t z = 0; z < n_z; ++z)
+            written_once = written_once && writes[z] == 1;
+
+        CHECK_MSG(ok && !v.bad_range && written_once && !memcmp(out, ref, n * fastfilters_type_size(out_type)),
+                  "n_z %zu, %zu channels, len_z %zu, types %d -> %d, slab_planes %zu: %s", n_z, n_channels,
+                  k[2]->len, (int)in_type, (int)out_type, slab_planes[s],
+                  !ok ? "failed" : v.bad_range ? "bad range" : !written_once ? "planes not written once" : "differs");
+    }
+
+    // errors of the callbacks are passed on
+    v.fail_read = true;
+    CHECK(!fastfilters_fir_convolve3d_chunked(&io, 0, k[0], k[1], k[2], NULL));
+
+    free(in);
+    free(ref);
+    free(out);
+    free(writes);
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    const float general_coefs[7] = {0.05f, -0.1f, 0.3f, 0.5f, 0.2f, 0.15f, -0.02f};
+    fastfilters_kernel_fir_t general = fastfilters_kernel_fir_create(general_coefs, 3, FASTFILTERS_KERNEL_GENERAL);
+    fastfilters_kernel_fir_t kx = fastfilters_kernel_fir_gaussian(0, 1.3, 0.0f);
+    fastfilters_kernel_fir_t ky = fastfilters_kernel_fir_gaussian(1, 1.1, 0.0f);
+
+    // kernels along z of length 6 (symmetric), 4 (antisymmetric), 3 (general) and 1
+    fastfilters_kernel_fir_t kz[4] = {
+        fastfilters_kernel_fir_gaussian(0, 2.0, 0.0f),
+        fastfilters_kernel_fir_gaussian(1, 1.1, 0.0f),
+        general,
+        fastfilters_kernel_fir_gaussian(0, 0.3, 0.0f),
+    };
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(kz); ++i) {
+        const fastfilters_kernel_fir_t k[3] = {kx, ky, kz[i]};
+
+        check_volume(41, 1, k, FASTFILTERS_TYPE_FLOAT32, FASTFILTERS_TYPE_FLOAT32, 10 + i);
+        check_volume(23, 3, k, FASTFILTERS_TYPE_UINT8, FASTFILTERS_TYPE_FLOAT32, 20 + i);
+        check_volume(19, 2, k, FASTFILTERS_TYPE_UINT16, FASTFILTERS_TYPE_FLOAT16, 30 + i);
+        check_volume(17, 1, k, FASTFILTERS_TYPE_FLOAT64, FASTFILTERS_TYPE_BFLOAT16, 40 + i);
+        // volumes thinner than twice the kernel length are a single mirrored slab, mirroring needs more planes than the
+        // kernel length
+        check_volume(kz[i]->len + 1, 1, k, FASTFILTERS_TYPE_FLOAT32, FASTFILTERS_TYPE_FLOAT32, 50 + i);
+    }
+
+    fastfilters_kernel_fir_free(kx);
+    fastfilters_kernel_fir_free(ky);
+    for (unsigned int i = 0; i < ARRAY_LENGTH(kz); ++i)
+        fastfilters_kernel_fir_free(kz[i]);
+
+    return test_result("test_chunked");
+}
@@ -0,0 +1,266 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// Kernel dispatch of every compiled implementation that the cpu supports: fastfilters_fir_resolve fills all six
+// entries for symmetric and antisymmetric kernels of every length, lengths up to the unrolled ones get their own
+// jump table entry and longer kernels share the runtime length one. Every length also runs the inner and outer
+// passes with mirror, optimistic and ptr borders against a double precision reference, and the inner pass with
+// optimistic borders for 1 to 7 channels.
+
+typedef bool (*pass_fn_t)(const float *, size_t, size_t, size_t, size_t, float *, size_t, fastfilters_kernel_fir_t,
+                          fastfilters_border_treatment_t, fastfilters_border_treatment_t, const float *,
+                          const float *, size_t);
+
+typedef struct {
+    const char *name;
+    fastfilters_fir_impl_t impl;
+    pass_fn_t inner, outer;
+    fastfilters_cpu_feature_t feature;
+    bool needs_feature;
+    // kernels up to this length have their own jump table entries
+    size_t n_unrolled;
+} impl_level_t;
+
+// same levels as fastfilters_bench
+static const impl_level_t g_levels[] = {
+    {"nosimd", FASTFILTERS_FIR_IMPL_NOSIMD, fastfilters_fir_convolve_fir_inner, fastfilters_fir_convolve_fir_outer,
+     FASTFILTERS_CPU_AVX, false, FF_UNROLL},
+#ifndef _USE_SIMDE_ON_ARM_
+    {"avx", FASTFILTERS_FIR_IMPL_AVX, fastfilters_fir_convolve_fir_inner_avx, fastfilters_fir_convolve_fir_outer_avx,
+     FASTFILTERS_CPU_AVX, true, FF_UNROLL - 1},
+    {"avxfma", FASTFILTERS_FIR_IMPL_AVXFMA, fastfilters_fir_convolve_fir_inner_avxfma,
+     fastfilters_fir_convolve_fir_outer_avxfma, FASTFILTERS_CPU_FMA, true, FF_UNROLL - 1},
+#ifdef HAVE_AVX512F
+    {"avx512", FASTFILTERS_FIR_IMPL_AVX512, fastfilters_fir_convolve_fir_inner_avx512,
+     fastfilters_fir_convolve_fir_outer_avx512, FASTFILTERS_CPU_AVX512F, true, 0},
+#endif
+#else
+    {"avxfma", FASTFILTERS_FIR_IMPL_AVXFMA, fastfilters_fir_convolve_fir_inner_avxfma,
+     fastfilters_fir_convolve_fir_outer_avxfma, FASTFILTERS_CPU_FMA, false, FF_UNROLL - 1},
+#ifdef HAVE_NEON
+    {"neon", FASTFILTERS_FIR_IMPL_NEON, fastfilters_fir_convolve_fir_inner_neon,
+     fastfilters_fir_convolve_fir_outer_neon, FASTFILTERS_CPU_NEON, true, 0},
+#endif
+#endif
+};
+
+static const char *g_border_names[] = {"mirror", "optimistic", "ptr"};
+
+#define MAX_LEN (FF_UNROLL + 3)
+#define N_OUTER 37
+
+static fastfilters_kernel_fir_t g_kernels[2][MAX_LEN + 1];
+
+static impl_fn_t dispatch_entry(const fastfilters_fir_dispatch_t *d, bool outer, fastfilters_border_treatment_t b)
+{
+    switch (b) {
+    case FASTFILTERS_BORDER_MIRROR:
+        return outer ? d->fn_outer_mirror : d->fn_inner_mirror;
+    case FASTFILTERS_BORDER_OPTIMISTIC:
+        return outer ? d->fn_outer_optimistic : d->fn_inner_optimistic;
+    case FASTFILTERS_BORDER_PTR:
+        return outer ? d->fn_outer_ptr : d->fn_inner_ptr;
+    }
+
+    return NULL;
+}
+
+static void check_tables(const impl_level_t *level)
+{
+    for (unsigned int outer = 0; outer < 2; ++outer) {
+        for (unsigned int b = 0; b < ARRAY_LENGTH(g_border_names); ++b) {
+            for (unsigned int s = 0; s < 2; ++s) {
+                const fastfilters_border_treatment_t border = (fastfilters_border_treatment_t)b;
+                const impl_fn_t runtime = dispatch_entry(&g_kernels[s][MAX_LEN]->dispatch[level->impl], outer, border);
+
+                CHECK_MSG(runtime != NULL, "%s: no %s %s entry", level->name, g_border_names[b],
+                          outer ? "outer" : "inner");
+
+                for (size_t len = 1; len <= MAX_LEN; ++len) {
+                    const fastfilters_kernel_fir_t k = g_kernels[s][len];
+                    const impl_fn_t fn = dispatch_entry(&k->dispatch[level->impl], outer, border);
+                    const impl_fn_t other =
+                        dispatch_entry(&g_kernels[!s][len]->dispatch[level->impl], outer, border);
+
+                    CHECK_MSG(fn != NULL && fn != other, "%s: %s %s entry of length %zu, %s", level->name,
+                              g_border_names[b], outer ? "outer" : "inner", len, s ? "symmetric" : "antisymmetric");
+
+                    if (len > level->n_unrolled) {
+                        CHECK_MSG(fn == runtime, "%s: length %zu does not use the runtime length entry", level->name,
+                                  len);
+                        continue;
+                    }
+
+                    CHECK_MSG(fn != runtime, "%s: unrolled length %zu uses the runtime length entry", level->name,
+                              len);
+                    for (size_t len2 = 1; len2 < len; ++len2)
+                        CHECK_MSG(fn != dispatch_entry(&g_kernels[s][len2]->dispatch[level->impl], outer, border),
+                                  "%s: lengths %zu and %zu share an entry", level->name, len2, len);
+                }
+            }
+        }
+    }
+}
+
+// inner pass over n_lines lines of n pixels with n_channels channels. Every line is stored with len extra pixels on
+// both sides, which optimistic borders read in place and ptr borders get pointers to.
+static void check_inner(const impl_level_t *level, fastfilters_kernel_fir_t k, size_t n, size_t n_channels,
+                        fastfilters_border_treatment_t border)
+{
+    const size_t len = k->len;
+    const size_t n_lines = 5;
+    const size_t line_stride = (n + 2 * len) * n_channels + 2;
+    const size_t out_stride = n * n_channels + 1;
+    float *ext = test_alloc_random(n_lines * line_stride, (uint32_t)(len * 131 + n));
+    float *out = test_alloc(n_lines * out_stride);
+    double *expected = malloc(n_lines * out_stride * sizeof(double));
+    double norm = 0.0;
+
+    for (ptrdiff_t t = -(ptrdiff_t)len; t <= (ptrdiff_t)len; ++t)
+        norm += fabs(test_kernel_tap(k, t));
+
+    for (size_t l = 0; l < n_lines; ++l)
+        for (size_t i = 0; i < n; ++i)
+            for (size_t c = 0; c < n_channels; ++c) {
+                const float *line = ext + l * line_stride + len * n_channels;
+                double sum = 0.0;
+
+                for (ptrdiff_t t = -(ptrdiff_t)len; t <= (ptrdiff_t)len; ++t) {
+                    ptrdiff_t j = (ptrdiff_t)i + t;
+                    if (border == FASTFILTERS_BORDER_MIRROR)
+                        j = (ptrdiff_t)test_mirror(j, n);
+                    sum += test_kernel_tap(k, t) * line[j * (ptrdiff_t)n_channels + (ptrdiff_t)c];
+                }
+
+                expected[l * out_stride + i * n_channels + c] = sum;
+            }
+
+    CHECK(level->inner(ext + len * n_channels, n, n_channels, n_lines, line_stride, out, out_stride, k, border, border,
+                       ext, ext + (len + n) * n_channels, line_stride));
+
+    double diff = 0.0;
+    for (size_t l = 0; l < n_lines; ++l)
+        for (size_t i = 0; i < n * n_channels; ++i)
+            diff = fmax(diff, fabs(out[l * out_stride + i] - expected[l * out_stride + i]));
+
+    CHECK_MSG(diff <= 1e-6 * norm, "%s: inner %s, length %zu, %s, %zu pixels, %zu channels: max diff %g",
+              level->name, g_border_names[border], len, k->is_symmetric ? "symmetric" : "antisymmetric", n,
+              n_channels, diff);
+
+    free(expected);
+    free(out);
+    free(ext);
+}
+
+// outer pass over N_OUTER columns of n rows, again with len extra rows above and below
+static void check_outer(const impl_level_t *level, fastfilters_kernel_fir_t k, size_t n,
+                        fastfilters_border_treatment_t border)
+{
+    const size_t len = k->len;
+    const size_t row_stride = N_OUTER + 5;
+    const size_t out_stride = N_OUTER + 3;
+    float *ext = test_alloc_random((n + 2 * len) * row_stride, (uint32_t)(len * 137 + n));
+    float *out = test_alloc(n * out_stride);
+    const float *rows = ext + len * row_stride;
+    double diff = 0.0, norm = 0.0;
+
+    for (ptrdiff_t t = -(ptrdiff_t)len; t <= (ptrdiff_t)len; ++t)
+        norm += fabs(test_kernel_tap(k, t));
+
+    CHECK(level->outer(rows, n, row_stride, N_OUTER, 1, out, out_stride, k, border, border, ext,
+                       ext + (len + n) * row_stride, row_stride));
+
+    for (size_t i = 0; i < n; ++i)
+        for (size_t x = 0; x < N_OUTER; ++x) {
+            double sum = 0.0;
+
+            for (ptrdiff_t t = -(ptrdiff_t)len; t <= (ptrdiff_t)len; ++t) {
+                ptrdiff_t j = (ptrdiff_t)i + t;
+                if (border == FASTFILTERS_BORDER_MIRROR)
+                    j = (ptrdiff_t)test_mirror(j, n);
+                sum += test_kernel_tap(k, t) * rows[j * (ptrdiff_t)row_stride + (ptrdiff_t)x];
+            }
+
+            diff = fmax(diff, fabs(out[i * out_stride + x] - sum));
+        }
+
+    CHECK_MSG(diff <= 1e-6 * norm, "%s: outer %s, length %zu, %s, %zu rows: max diff %g", level->name,
+              g_border_names[border], len, k->is_symmetric ? "symmetric" : "antisymmetric", n, diff);
+
+    free(out);
+    free(ext);
+}
+
+int main(void)
+{
+    fastfilters_init();
+    CHECK(fastfilters_abi_version() == FASTFILTERS_ABI_VERSION);
+
+    for (unsigned int s = 0; s < 2; ++s)
+        for (size_t len = 1; len <= MAX_LEN; ++len) {
+            float *coefs = test_alloc_random(len + 1, (uint32_t)(len * 7 + s + 1));
+            g_kernels[s][len] = fastfilters_kernel_fir_create(
+                coefs, (unsigned int)len, s ? FASTFILTERS_KERNEL_SYMMETRIC : FASTFILTERS_KERNEL_ANTISYMMETRIC);
+            free(coefs);
+        }
+
+    for (unsigned int l = 0; l < ARRAY_LENGTH(g_levels); ++l) {
+        const impl_level_t *level = &g_levels[l];
+
+        if (level->needs_feature && !fastfilters_cpu_check(level->feature)) {
+            fprintf(stderr, "test_dispatch: %s not supported by this cpu, skipped\n", level->name);
+            continue;
+        }
+
+        check_tables(level);
+
+        for (unsigned int s = 0; s < 2; ++s)
+            for (size_t len = 1; len <= MAX_LEN; ++len) {
+                // the shortest lines every border mode supports, and lines long enough for full vectors
+                const size_t sizes[] = {2 * len + 1, 67 + len};
+
+                for (unsigned int b = 0; b < ARRAY_LENGTH(g_border_names); ++b)
+                    for (unsigned int i = 0; i < ARRAY_LENGTH(sizes); ++i) {
+                        const fastfilters_border_treatment_t border = (fastfilters_border_treatment_t)b;
+
+                        check_inner(level, g_kernels[s][len], sizes[i], 1, border);
+                        check_inner(level, g_kernels[s][len], sizes[i], 3, border);
+                        check_outer(level, g_kernels[s][len], sizes[i], border);
+                    }
+            }
+
+        // optimistic left borders read the pixels before the line for x < len. The avx kernels computed those offsets
+        // unsigned, so they wrapped around and read far outside the line; every channel count has its own loop.
+        for (size_t n_channels = 1; n_channels <= 7; ++n_channels)
+            for (unsigned int s = 0; s < 2; ++s) {
+                const size_t lens[] = {1, FF_UNROLL, MAX_LEN};
+
+                for (unsigned int i = 0; i < ARRAY_LENGTH(lens); ++i)
+                    check_inner(level, g_kernels[s][lens[i]], 67 + lens[i], n_channels,
+                                FASTFILTERS_BORDER_OPTIMISTIC);
+            }
+    }
+
+    for (unsigned int s = 0; s < 2; ++s)
+        for (size_t len = 1; len <= MAX_LEN; ++len)
+            fastfilters_kernel_fir_free(g_kernels[s][len]);
+
+    return test_result("test_dispatch");
+}
@@ -0,0 +1,34 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def test_dtypes():
+    for shape in [(123, 97), (31, 43, 29)]:
+        values = np.random.randint(0, 200, size=shape)
+        for dtype in [np.uint8, np.uint16, np.int16, np.float64]:
+            a = values.astype(dtype)
+            f = a.astype(np.float32)
+
+            for fn, args in [(ff.gaussianSmoothing, (2.0,)), (ff.gaussianGradientMagnitude, (1.5,)),
+                             (ff.laplacianOfGaussian, (1.5,)), (ff.hessianOfGaussianEigenvalues, (1.5,)),
+                             (ff.structureTensorEigenvalues, (1.0, 2.0))]:
+                res = fn(a, *args)
+                eq_(res.dtype, np.float32)
+                ok_(np.allclose(res, fn(f, *args), rtol=1e-5, atol=1e-4))
+
+            matrix = [[True, False], [False, True], [True, True], [False, True], [True, False]]
+            ok_(np.allclose(ff.filterBank(a, [1.0, 2.0], matrix), ff.filterBank(f, [1.0, 2.0], matrix),
+                            rtol=1e-5, atol=1e-4))
+
+def test_dtypes_strided():
+    a = np.random.randint(0, 60000, size=(80, 90)).astype(np.uint16)[::2, ::3]
+    ok_(np.allclose(ff.gaussianSmoothing(a, 1.5), ff.gaussianSmoothing(a.astype(np.float32), 1.5), rtol=1e-5))
+
+def test_dtypes_converted():
+    a = np.random.randint(0, 100, size=(64, 64)).astype(np.int32)
+    ok_(np.allclose(ff.gaussianSmoothing(a, 1.5), ff.gaussianSmoothing(a.astype(np.float32), 1.5), rtol=1e-5))
@@ -0,0 +1,83 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def hessian(a, sigma):
+    n = a.ndim
+    h = np.empty(a.shape + (n, n), dtype=np.float32)
+    for i in range(n):
+        for j in range(i, n):
+            order = [0] * n
+            order[i] += 1
+            order[j] += 1
+            # gaussianDerivative takes one order for all axes, so build the mixed derivatives from FIR kernels
+            kernels = [ff.core.FIRKernel(o, sigma) for o in reversed(order)]
+            h[..., i, j] = h[..., j, i] = ff.core.convolve_fir(a, kernels)
+    return h
+
+def test_hessian_eigenvectors():
+    for a in [np.random.rand(83, 71).astype(np.float32), np.random.rand(37, 29, 31).astype(np.float32)]:
+        n = a.ndim
+        values, vectors = ff.hessianOfGaussianEigenvectors(a, 1.5)
+        eq_(values.shape, a.shape + (n,))
+        eq_(vectors.shape, a.shape + (n, n))
+        ok_(np.allclose(values, ff.hessianOfGaussianEigenvalues(a, 1.5), atol=1e-5))
+        ok_(np.all(np.diff(values, axis=-1) <= 0))
+
+        # unit vectors with H v = lambda v
+        h = hessian(a, 1.5)
+        scale = np.max(np.abs(h))
+        ok_(np.allclose(np.sum(vectors ** 2, axis=-2), 1, atol=1e-5))
+        residual = np.einsum('...ij,...jk->...ik', h, vectors) - vectors * values[..., np.newaxis, :]
+        ok_(np.max(np.abs(residual)) <= 2e-3 * scale)
+
+def test_structure_tensor_eigenvectors():
+    for a in [np.random.rand(83, 71).astype(np.float32), np.random.rand(37, 29, 31).astype(np.float32)]:
+        values, vectors = ff.structureTensorEigenvectors(a, 1.0, 2.0)
+        ok_(np.allclose(values, ff.structureTensorEigenvalues(a, 1.0, 2.0), atol=1e-5))
+        ok_(np.allclose(np.einsum('...ji,...jk->...ik', vectors, vectors), np.eye(a.ndim), atol=1e-5))
+
+def test_eigenvectors_out():
+    for a in [np.random.rand(83, 71).astype(np.float32), np.random.rand(37, 29, 31).astype(np.float32)]:
+        n = a.ndim
+        ref_values, ref_vectors = ff.hessianOfGaussianEigenvectors(a, 1.5)
+        values = np.empty(a.shape + (n,), dtype=np.float32)
+        vectors = np.empty(a.shape + (n, n), dtype=np.float32)
+        res_values, res_vectors = ff.hessianOfGaussianEigenvectors(a, 1.5, out=(values, vectors))
+        ok_(np.shares_memory(res_values, values) and np.shares_memory(res_vectors, vectors))
+        ok_(np.array_equal(values, ref_values))
+        ok_(np.array_equal(vectors, ref_vectors))
+
+        # channel-first storage is what the bindings write to without a copy
+        ref_values, ref_vectors = ff.structureTensorEigenvectors(a, 1.0, 2.0)
+        values = np.empty((n,) + a.shape, dtype=np.float32)
+        vectors = np.empty((n, n) + a.shape, dtype=np.float32)
+        ff.structureTensorEigenvectors(a, 1.0, 2.0, out=(np.moveaxis(values, 0, -1), np.moveaxis(vectors, (0, 1), (-2, -1))))
+        ok_(np.array_equal(np.moveaxis(values, 0, -1), ref_values))
+        ok_(np.array_equal(np.moveaxis(vectors, (0, 1), (-2, -1)), ref_vectors))
+
+def test_eigenvectors_singleton():
+    try:
+        import vigra
+    except ImportError:
+        return
+
+    a = np.random.rand(40, 1, 30).astype(np.float32)
+    ref_values, ref_vectors = ff.hessianOfGaussianEigenvectors(a[:, 0], 1.5)
+    tagged = vigra.taggedView(a, 'yzx')
+
+    values, vectors = ff.hessianOfGaussianEigenvectors(tagged, 1.5)
+    eq_(values.shape, (40, 1, 30, 2))
+    eq_(vectors.shape, (40, 1, 30, 2, 2))
+    ok_(np.array_equal(values[:, 0], ref_values))
+    ok_(np.array_equal(vectors[:, 0], ref_vectors))
+
+    out = (np.empty((40, 1, 30, 2), dtype=np.float32), np.empty((40, 1, 30, 2, 2), dtype=np.float32))
+    ff.hessianOfGaussianEigenvectors(tagged, 1.5, out=out)
+    ok_(np.array_equal(out[0], values))
+    ok_(np.array_equal(out[1], vectors))
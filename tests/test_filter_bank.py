@@ -0,0 +1,51 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def reference(a, sigma):
+    return [ff.gaussianSmoothing(a, sigma),
+            ff.laplacianOfGaussian(a, sigma),
+            ff.gaussianGradientMagnitude(a, sigma),
+            ff.hessianOfGaussianEigenvalues(a, sigma),
+            ff.structureTensorEigenvalues(a, 0.5 * sigma, sigma)]
+
+def test_filter_bank():
+    sigmas = [0.7, 1.6, 3.5, 5.0]
+    matrix = [[True, True, False, True],
+              [False, True, True, True],
+              [False, True, True, True],
+              [False, True, True, False],
+              [False, True, False, True]]
+
+    for a in [np.random.randn(211, 187).astype(np.float32), np.random.randn(41, 53, 47).astype(np.float32)]:
+        res = ff.filterBank(a, sigmas, matrix)
+
+        expected = []
+        for i in range(len(ff.filterBankFeatures)):
+            for j, sigma in enumerate(sigmas):
+                if matrix[i][j]:
+                    r = reference(a, sigma)[i]
+                    expected.append(r.reshape(a.shape + (-1,)))
+        expected = np.concatenate(expected, axis=-1)
+
+        eq_(res.shape, expected.shape)
+        ok_(np.allclose(res, expected, atol=1e-5))
+
+def test_filter_bank_float16():
+    sigmas = [1.0, 2.5]
+    matrix = [[True, True], [True, False], [False, True], [True, True], [False, True]]
+
+    for a in [np.random.randn(131, 97).astype(np.float32), np.random.randn(29, 37, 31).astype(np.float32)]:
+        expected = ff.filterBank(a, sigmas, matrix)
+        res = ff.filterBank(a, sigmas, matrix, dtype=np.float16)
+
+        eq_(res.dtype, np.float16)
+        ok_(np.array_equal(res, expected.astype(np.float16)))
+
+        out = np.empty(expected.shape, dtype=np.float16)
+        ok_(np.array_equal(ff.filterBank(a, sigmas, matrix, out=out), res))
@@ -0,0 +1,32 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import ok_
+
+def correlate_axis(a, coefs, axis):
+    r = len(coefs) // 2
+    pad = [(0, 0)] * a.ndim
+    pad[axis] = (r, r)
+    p = np.pad(a.astype(np.float64), pad, mode='reflect')
+    res = np.zeros(a.shape)
+    for i, c in enumerate(coefs):
+        res += c * np.take(p, np.arange(i, i + a.shape[axis]), axis=axis)
+    return res
+
+def test_custom_kernels():
+    box = [1.0 / 5] * 5
+    binomial = [1.0 / 16, 4.0 / 16, 6.0 / 16, 4.0 / 16, 1.0 / 16]
+    scharr = [-0.5, 0.0, 0.5]
+    general = [0.1, -0.4, 1.0, 0.25, 0.05, -0.2, 0.3]
+    identity = ff.core.FIRKernel([0.0, 1.0, 0.0])
+
+    for a in [np.random.randn(123, 97).astype(np.float32), np.random.randn(31, 43, 29).astype(np.float32)]:
+        for coefs in [box, binomial, scharr, general]:
+            for axis in range(a.ndim):
+                # kernels are passed x first
+                kernels = [ff.core.FIRKernel(coefs) if i == a.ndim - 1 - axis else identity for i in range(a.ndim)]
+                ok_(np.allclose(ff.core.convolve_fir(a, kernels), correlate_axis(a, coefs, axis), atol=1e-5))
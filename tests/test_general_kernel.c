@@ -0,0 +1,93 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// General kernels run as a symmetric plus an antisymmetric pass (see fastfilters_kernel_fir_create). The taps
+// [1, 2, 3] for k = -1, 0, 1 give out[i] = in[i - 1] + 2 * in[i] + 3 * in[i + 1]; a delta and a ramp along x (inner
+// pass) and y (outer pass) are checked against hand-written values, which pins the orientation of the odd part. The
+// large images span several tiles of fir_run_general. All values are small integers and exact in float.
+
+// a delta at 4 spreads to 3, 2, 1 at 3, 4, 5
+static const float g_delta[9] = {0, 0, 0, 3, 2, 1, 0, 0, 0};
+
+// 0 .. 7 is 6 * i + 2 inside, mirrored borders read 1 left of 0 and 6 right of 7
+static const float g_ramp[8] = {4, 8, 14, 20, 26, 32, 38, 38};
+
+// in is the line repeated n_lines times along the axis not filtered; axis 0 filters x, axis 1 filters y
+static void check_line(fastfilters_kernel_fir_t general, fastfilters_kernel_fir_t identity, unsigned int axis,
+                       const float *line, const float *expected, size_t len, size_t n_lines)
+{
+    const size_t n_x = axis == 0 ? len : n_lines;
+    const size_t n_y = axis == 0 ? n_lines : len;
+    float *in = test_alloc(n_x * n_y);
+    float *out = test_alloc(n_x * n_y);
+
+    for (size_t y = 0; y < n_y; ++y)
+        for (size_t x = 0; x < n_x; ++x)
+            in[y * n_x + x] = line[axis == 0 ? x : y];
+
+    fastfilters_array2d_t a = test_array2d(in, n_x, n_y, 1);
+    fastfilters_array2d_t o = test_array2d(out, n_x, n_y, 1);
+    CHECK(fastfilters_fir_convolve2d(&a, axis == 0 ? general : identity, axis == 0 ? identity : general, &o, NULL));
+
+    size_t n_wrong = 0;
+    for (size_t y = 0; y < n_y; ++y)
+        for (size_t x = 0; x < n_x; ++x)
+            if (out[y * n_x + x] != expected[axis == 0 ? x : y])
+                n_wrong++;
+    CHECK_MSG(n_wrong == 0, "axis %u, len %zu, %zu lines: %zu wrong pixels", axis, len, n_lines, n_wrong);
+
+    free(out);
+    free(in);
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    const float general_coefs[3] = {1, 2, 3};
+    const float identity_coefs[2] = {1, 0};
+    fastfilters_kernel_fir_t general = fastfilters_kernel_fir_create(general_coefs, 1, FASTFILTERS_KERNEL_GENERAL);
+    fastfilters_kernel_fir_t identity = fastfilters_kernel_fir_create(identity_coefs, 1, FASTFILTERS_KERNEL_SYMMETRIC);
+    CHECK(general && identity);
+
+    float delta[9] = {0};
+    delta[4] = 1;
+    float ramp[8];
+    for (unsigned int i = 0; i < 8; ++i)
+        ramp[i] = (float)i;
+
+    const unsigned int thread_counts[] = {1, 4};
+    const size_t line_counts[] = {7, 5000, 20000};
+    for (unsigned int t = 0; t < ARRAY_LENGTH(thread_counts); ++t) {
+        CHECK(fastfilters_set_num_threads(thread_counts[t]));
+
+        for (unsigned int axis = 0; axis < 2; ++axis) {
+            for (unsigned int i = 0; i < ARRAY_LENGTH(line_counts); ++i) {
+                check_line(general, identity, axis, delta, g_delta, ARRAY_LENGTH(delta), line_counts[i]);
+                check_line(general, identity, axis, ramp, g_ramp, ARRAY_LENGTH(ramp), line_counts[i]);
+            }
+        }
+    }
+
+    fastfilters_kernel_fir_free(general);
+    fastfilters_kernel_fir_free(identity);
+
+    return test_result("test_general_kernel");
+}
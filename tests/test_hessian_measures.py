@@ -0,0 +1,41 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import ok_
+
+def frangi(ev, alpha, beta, c):
+    # eigenvalues sorted by magnitude along the last axis
+    l = np.take_along_axis(ev, np.argsort(np.abs(ev), axis=-1), axis=-1)
+    a = np.abs(l)
+    with np.errstate(divide='ignore', invalid='ignore'):
+        if l.shape[-1] == 2:
+            v = np.exp(-(a[..., 0] / a[..., 1]) ** 2 / (2 * beta ** 2))
+            v[l[..., 1] >= 0] = 0
+        else:
+            ra = a[..., 1] / a[..., 2]
+            rb2 = a[..., 0] ** 2 / (a[..., 1] * a[..., 2])
+            v = (1 - np.exp(-ra ** 2 / (2 * alpha ** 2))) * np.exp(-rb2 / (2 * beta ** 2))
+            v[(l[..., 1] >= 0) | (l[..., 2] >= 0)] = 0
+    return v * (1 - np.exp(-np.sum(l ** 2, axis=-1) / (2 * c ** 2)))
+
+def test_vesselness():
+    for a in [np.random.rand(97, 83).astype(np.float32), np.random.rand(41, 37, 33).astype(np.float32)]:
+        scales = [1.0, 2.0]
+        ref = np.max([frangi(ff.hessianOfGaussianEigenvalues(a, s) * s ** 2, 0.5, 0.5, 0.5) for s in scales], axis=0)
+        res = ff.vesselness(a, scales, c=0.5)
+        ok_(np.max(ref) > 0)
+        ok_(np.allclose(res, ref, atol=1e-4 * np.max(ref)))
+
+        # dark structures of the image are the bright ones of its negative
+        dark = ff.vesselness(a, scales, c=0.5, dark=True)
+        ok_(np.allclose(dark, ff.vesselness(-a, scales, c=0.5), atol=1e-4 * np.max(dark)))
+
+def test_blobness():
+    a = np.random.rand(41, 37, 33).astype(np.float32)
+    ev = ff.hessianOfGaussianEigenvalues(a, 1.5) * 1.5 ** 2
+    ref = np.where(ev[..., 0] < 0, ev[..., 0] ** 2 / np.abs(ev[..., 2]), 0)
+    ok_(np.allclose(ff.blobness(a, 1.5), ref, atol=1e-4 * np.max(ref)))
@@ -0,0 +1,95 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// fastfilters_fir_hog3d runs the shared z passes first (see fastfilters_fir_convolve3d_multi), the unfused composition
+// in fastfilters_fir_convolve3d goes x, y, z. Both have to agree within float rounding: HOG_TOLERANCE relative to the
+// largest magnitude of each component, also for multiple channels.
+#define HOG_TOLERANCE 1e-6
+
+typedef struct {
+    size_t n_x, n_y, n_z, n_channels;
+    double sigma;
+} hog_case_t;
+
+static const hog_case_t g_cases[] = {
+    {67, 53, 41, 1, 1.0}, {67, 53, 41, 1, 2.5}, {45, 38, 31, 2, 1.5}, {129, 71, 37, 1, 4.0}, {33, 29, 27, 3, 0.7},
+};
+
+static float max_abs(const float *a, size_t n)
+{
+    float m = 0.0f;
+
+    for (size_t i = 0; i < n; ++i)
+        if (fabsf(a[i]) > m)
+            m = fabsf(a[i]);
+
+    return m;
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    // components in the order of the fastfilters_fir_hog3d outputs, as derivative orders along x, y, z
+    const unsigned orders[6][3] = {{2, 0, 0}, {0, 2, 0}, {0, 0, 2}, {1, 1, 0}, {1, 0, 1}, {0, 1, 1}};
+
+    for (unsigned int c = 0; c < ARRAY_LENGTH(g_cases); ++c) {
+        const hog_case_t *hc = &g_cases[c];
+        const size_t n = hc->n_x * hc->n_y * hc->n_z * hc->n_channels;
+        float *in = test_alloc_random(n, 77 + c);
+        float *outs[6];
+        fastfilters_array3d_t out_arrays[6];
+        fastfilters_kernel_fir_t k[3];
+
+        fastfilters_array3d_t a = test_array3d(in, hc->n_x, hc->n_y, hc->n_z, hc->n_channels);
+
+        for (unsigned int i = 0; i < 6; ++i) {
+            outs[i] = test_alloc(n);
+            out_arrays[i] = test_array3d(outs[i], hc->n_x, hc->n_y, hc->n_z, hc->n_channels);
+        }
+
+        for (unsigned int order = 0; order < 3; ++order)
+            k[order] = fastfilters_kernel_fir_gaussian(order, hc->sigma, 0.0);
+
+        CHECK(fastfilters_fir_hog3d(&a, hc->sigma, &out_arrays[0], &out_arrays[1], &out_arrays[2], &out_arrays[3],
+                                    &out_arrays[4], &out_arrays[5], NULL));
+
+        float *ref = test_alloc(n);
+        fastfilters_array3d_t r = test_array3d(ref, hc->n_x, hc->n_y, hc->n_z, hc->n_channels);
+
+        for (unsigned int i = 0; i < 6; ++i) {
+            CHECK(fastfilters_fir_convolve3d(&a, k[orders[i][0]], k[orders[i][1]], k[orders[i][2]], &r, NULL));
+
+            const float diff = test_max_abs_diff(outs[i], ref, n);
+            const float scale = max_abs(ref, n);
+            CHECK_MSG(diff <= HOG_TOLERANCE * scale, "case %u component %u: max diff %g, largest magnitude %g", c, i,
+                      diff, scale);
+        }
+
+        for (unsigned int order = 0; order < 3; ++order)
+            fastfilters_kernel_fir_free(k[order]);
+        for (unsigned int i = 0; i < 6; ++i)
+            free(outs[i]);
+        free(ref);
+        free(in);
+    }
+
+    return test_result("test_hog");
+}
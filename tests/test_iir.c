@@ -0,0 +1,130 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// The gaussian filters switch to the Young - van Vliet recursion at the default crossover of 6. Below it, or with
+// exact_fir in the options, they have to match the double precision fir reference within FIR_TOLERANCE of the kernel
+// gain times the input range. The recursion has to agree with the fir result within g_iir_tolerance[order] of the
+// largest magnitude of the fir result (derivatives are taken along all axes).
+#define FIR_TOLERANCE 1e-6
+#define CROSSOVER 6.0
+
+static const double g_iir_tolerance[3] = {1e-2, 3e-2, 4e-2};
+static const double g_sigmas[] = {3.0, 6.0, 9.5};
+
+static float max_abs(const float *a, size_t n)
+{
+    float m = 0.0f;
+
+    for (size_t i = 0; i < n; ++i)
+        if (fabsf(a[i]) > m)
+            m = fabsf(a[i]);
+
+    return m;
+}
+
+static bool gaussian(const float *in, float *out, const size_t *shape, unsigned int ndim, unsigned int order,
+                     double sigma, const fastfilters_options_t *options)
+{
+    if (ndim == 2) {
+        fastfilters_array2d_t a = test_array2d((float *)in, shape[0], shape[1], 1);
+        fastfilters_array2d_t o = test_array2d(out, shape[0], shape[1], 1);
+        return fastfilters_fir_gaussian2d(&a, order, sigma, &o, options);
+    }
+
+    fastfilters_array3d_t a = test_array3d((float *)in, shape[0], shape[1], shape[2], 1);
+    fastfilters_array3d_t o = test_array3d(out, shape[0], shape[1], shape[2], 1);
+    return fastfilters_fir_gaussian3d(&a, order, sigma, &o, options);
+}
+
+static void check_shape(const size_t *shape, unsigned int ndim, uint32_t seed)
+{
+    const size_t n = shape[0] * shape[1] * (ndim == 3 ? shape[2] : 1);
+    float *in = test_alloc_random(n, seed);
+    float *ref = test_alloc(n);
+    float *fir = test_alloc(n);
+    float *iir = test_alloc(n);
+
+    // a box of steps on top of the noise gives every derivative a strong response, its edges and the image borders
+    // exercise the decay of the recursion
+    for (size_t i = 0; i < n; ++i) {
+        size_t rest = i;
+        bool inside = true;
+
+        for (unsigned int d = 0; d < ndim; ++d) {
+            const size_t c = rest % shape[d];
+            rest /= shape[d];
+            inside = inside && c >= shape[d] / 4 && c < shape[d] * 3 / 4;
+        }
+
+        in[i] = 0.5f * in[i] + (inside ? 10.5f : 0.5f);
+    }
+
+    for (unsigned int s = 0; s < ARRAY_LENGTH(g_sigmas); ++s) {
+        for (unsigned int order = 0; order < 3; ++order) {
+            const double sigma = g_sigmas[s];
+            fastfilters_kernel_fir_t k = fastfilters_kernel_fir_gaussian(order, sigma, 0.0f);
+            double gain = 1.0;
+            for (unsigned int i = 0; i < ndim; ++i)
+                gain *= test_kernel_gain(k);
+
+            test_reference(in, ref, shape[0], shape[1], ndim == 3 ? shape[2] : 1, 1, k, k, ndim == 3 ? k : NULL);
+            fastfilters_kernel_fir_free(k);
+
+            const fastfilters_options_t exact = {.exact_fir = true};
+            CHECK(gaussian(in, fir, shape, ndim, order, sigma, &exact));
+            const float fir_diff = test_max_abs_diff(fir, ref, n);
+            CHECK_MSG(fir_diff <= FIR_TOLERANCE * gain * max_abs(in, n), "%uD fir, order %u, sigma %g: differs by %g",
+                      ndim, order, sigma, fir_diff);
+
+            // a crossover of 0 turns the recursion off as well
+            fastfilters_iir_set_crossover(0.0);
+            CHECK(gaussian(in, iir, shape, ndim, order, sigma, NULL));
+            CHECK_MSG(test_equal(iir, fir, n), "%uD crossover 0, order %u, sigma %g: not the fir result", ndim, order,
+                      sigma);
+            fastfilters_iir_set_crossover(CROSSOVER);
+
+            CHECK(gaussian(in, iir, shape, ndim, order, sigma, NULL));
+            CHECK_MSG(test_equal(iir, fir, n) == (sigma < CROSSOVER), "%uD default, order %u, sigma %g: %s kernels",
+                      ndim, order, sigma, sigma < CROSSOVER ? "iir" : "fir");
+            const float iir_diff = test_max_abs_diff(iir, fir, n);
+            CHECK_MSG(iir_diff <= g_iir_tolerance[order] * max_abs(fir, n),
+                      "%uD iir, order %u, sigma %g: differs by %g", ndim, order, sigma, iir_diff);
+        }
+    }
+
+    free(in);
+    free(ref);
+    free(fir);
+    free(iir);
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    CHECK(fastfilters_iir_get_crossover() == CROSSOVER);
+
+    const size_t shape2d[2] = {160, 143};
+    const size_t shape3d[3] = {61, 57, 49};
+    check_shape(shape2d, 2, 5);
+    check_shape(shape3d, 3, 6);
+
+    return test_result("test_iir");
+}
@@ -0,0 +1,41 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def box_image(shape):
+    # noise with a box of steps, so that every derivative has a strong response
+    a = np.random.rand(*shape).astype(np.float32)
+    a[tuple(slice(n // 4, n * 3 // 4) for n in shape)] += 10.0
+    return a
+
+def test_iir_default():
+    eq_(ff.get_iir_crossover(), 6.0)
+    # relative to the peak of the fir response, derivatives are taken along all axes
+    tolerance = [1e-2, 3e-2, 4e-2]
+
+    for a in [box_image((160, 143)), box_image((61, 57, 49))]:
+        for sigma in [3.0, 6.0, 9.5]:
+            for order in [0, 1, 2]:
+                res = ff.gaussianDerivative(a, sigma, order)
+                ref = ff.gaussianDerivative(a, sigma, order, exact_fir=True)
+                ok_(np.array_equal(res, ref) == (sigma < 6.0))
+                ok_(np.max(np.abs(res - ref)) <= tolerance[order] * np.max(np.abs(ref)))
+
+def test_iir_crossover():
+    old_crossover = ff.get_iir_crossover()
+    a = box_image((160, 143))
+
+    try:
+        ff.set_iir_crossover(0.0)
+        eq_(ff.get_iir_crossover(), 0.0)
+        ok_(np.array_equal(ff.gaussianSmoothing(a, 10.0), ff.gaussianSmoothing(a, 10.0, exact_fir=True)))
+
+        ff.set_iir_crossover(2.0)
+        ok_(not np.array_equal(ff.gaussianSmoothing(a, 3.0), ff.gaussianSmoothing(a, 3.0, exact_fir=True)))
+    finally:
+        ff.set_iir_crossover(old_crossover)
@@ -0,0 +1,193 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+#include "parallel.h"
+
+// Gaussian kernel LRU cache: repeated requests share one kernel, the least recently used entry is evicted once all
+// FF_KERNEL_CACHE_SIZE slots are taken, invalidating and clearing only drop the cache's reference, and concurrent
+// callers always get kernels with the right coefficients while entries are evicted under them.
+
+#define N_SIGMAS (FF_KERNEL_CACHE_SIZE + FF_KERNEL_CACHE_SIZE / 2)
+
+typedef struct {
+    unsigned int order;
+    double sigma;
+    size_t len;
+    float *coefs;
+} kernel_ref_t;
+
+static kernel_ref_t g_refs[N_SIGMAS];
+
+static double filler_sigma(unsigned int i)
+{
+    return 1.1 + 0.1 * i;
+}
+
+static void check_hits(void)
+{
+    fastfilters_kernel_cache_clear();
+
+    fastfilters_kernel_fir_t a = fastfilters_kernel_fir_gaussian(0, 1.7, 0.0);
+    CHECK(a && a->refcount == 2);
+
+    fastfilters_kernel_fir_t b = fastfilters_kernel_fir_gaussian(0, 1.7, 0.0);
+    CHECK(b == a);
+    CHECK(a->refcount == 3);
+
+    // every parameter is part of the key
+    fastfilters_kernel_fir_t c = fastfilters_kernel_fir_gaussian(1, 1.7, 0.0);
+    fastfilters_kernel_fir_t d = fastfilters_kernel_fir_gaussian(0, 1.7, 2.0);
+    fastfilters_kernel_fir_t e = fastfilters_kernel_fir_gaussian(0, 1.75, 0.0);
+    CHECK(c != a && d != a && e != a && c != d && c != e && d != e);
+
+    fastfilters_kernel_fir_free(b);
+    fastfilters_kernel_fir_free(a);
+    CHECK(a->refcount == 1);
+
+    // the cache keeps the kernel alive after its last user is gone
+    CHECK(fastfilters_kernel_fir_gaussian(0, 1.7, 0.0) == a);
+    fastfilters_kernel_fir_free(a);
+
+    fastfilters_kernel_fir_free(c);
+    fastfilters_kernel_fir_free(d);
+    fastfilters_kernel_fir_free(e);
+}
+
+static void check_eviction(void)
+{
+    fastfilters_kernel_fir_t fillers[FF_KERNEL_CACHE_SIZE - 1];
+
+    fastfilters_kernel_cache_clear();
+
+    // a plus the fillers take every slot, all of them are also held here
+    fastfilters_kernel_fir_t a = fastfilters_kernel_fir_gaussian(0, 1.0, 0.0);
+    for (unsigned int i = 0; i < ARRAY_LENGTH(fillers); ++i)
+        fillers[i] = fastfilters_kernel_fir_gaussian(0, filler_sigma(i), 0.0);
+
+    CHECK(a->refcount == 2);
+    for (unsigned int i = 0; i < ARRAY_LENGTH(fillers); ++i)
+        CHECK(fillers[i]->refcount == 2);
+
+    // using a makes fillers[0] the least recently used entry
+    CHECK(fastfilters_kernel_fir_gaussian(0, 1.0, 0.0) == a);
+    fastfilters_kernel_fir_free(a);
+
+    fastfilters_kernel_fir_t extra = fastfilters_kernel_fir_gaussian(0, 9.0, 0.0);
+    CHECK(fillers[0]->refcount == 1);
+    CHECK(a->refcount == 2);
+    for (unsigned int i = 1; i < ARRAY_LENGTH(fillers); ++i)
+        CHECK(fillers[i]->refcount == 2);
+
+    // an evicted kernel is created anew and pushes out the next oldest entry
+    fastfilters_kernel_fir_t again = fastfilters_kernel_fir_gaussian(0, filler_sigma(0), 0.0);
+    CHECK(again != fillers[0]);
+    CHECK(fastfilters_kernel_fir_equal(again, fillers[0]));
+    CHECK(fillers[1]->refcount == 1);
+    CHECK(a->refcount == 2 && extra->refcount == 2);
+
+    // dropping entries leaves the kernels to their other owners
+    fastfilters_kernel_cache_invalidate(0, 1.0, 0.0);
+    CHECK(a->refcount == 1);
+    fastfilters_kernel_fir_t b = fastfilters_kernel_fir_gaussian(0, 1.0, 0.0);
+    CHECK(b != a && fastfilters_kernel_fir_equal(a, b));
+
+    fastfilters_kernel_cache_clear();
+    CHECK(a->refcount == 1 && b->refcount == 1 && extra->refcount == 1 && again->refcount == 1);
+    for (unsigned int i = 0; i < ARRAY_LENGTH(fillers); ++i)
+        CHECK(fillers[i]->refcount == 1);
+
+    fastfilters_kernel_fir_free(a);
+    fastfilters_kernel_fir_free(b);
+    fastfilters_kernel_fir_free(extra);
+    fastfilters_kernel_fir_free(again);
+    for (unsigned int i = 0; i < ARRAY_LENGTH(fillers); ++i)
+        fastfilters_kernel_fir_free(fillers[i]);
+}
+
+// more distinct kernels than cache slots, so that requests keep evicting each other
+static bool concurrent_caller(void *arg)
+{
+    uint32_t state = (uint32_t)(uintptr_t)arg;
+    bool ok = true;
+
+    for (unsigned int i = 0; i < 4000 && ok; ++i) {
+        const unsigned int r = (unsigned int)((test_random(&state) + 1.0f) * 0.5f * N_SIGMAS) % N_SIGMAS;
+        const kernel_ref_t *ref = &g_refs[r];
+
+        fastfilters_kernel_fir_t k = fastfilters_kernel_fir_gaussian(ref->order, ref->sigma, 0.0);
+        ok = k && k->len == ref->len && memcmp(k->coefs, ref->coefs, (ref->len + 1) * sizeof(float)) == 0;
+
+        if (i % 97 == 0)
+            fastfilters_kernel_cache_invalidate(ref->order, ref->sigma, 0.0);
+        if (i % 1009 == 0)
+            fastfilters_kernel_cache_clear();
+
+        if (k)
+            fastfilters_kernel_fir_free(k);
+    }
+
+    return ok;
+}
+
+static void check_concurrent_callers(void)
+{
+    fastfilters_task_t tasks[3];
+
+    fastfilters_kernel_cache_clear();
+
+    for (unsigned int i = 0; i < N_SIGMAS; ++i) {
+        g_refs[i].order = i % 3;
+        g_refs[i].sigma = 0.8 + 0.15 * i;
+
+        fastfilters_kernel_fir_t k = fastfilters_kernel_fir_gaussian(g_refs[i].order, g_refs[i].sigma, 0.0);
+        g_refs[i].len = k->len;
+        g_refs[i].coefs = test_alloc(k->len + 1);
+        memcpy(g_refs[i].coefs, k->coefs, (k->len + 1) * sizeof(float));
+        fastfilters_kernel_fir_free(k);
+    }
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        fastfilters_task_start(&tasks[i], concurrent_caller, (void *)(uintptr_t)(i + 2));
+
+    CHECK(concurrent_caller((void *)(uintptr_t)1));
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        CHECK(fastfilters_task_join(&tasks[i]));
+
+    // every kernel handed out was released again, the cache holds the only references
+    for (unsigned int i = 0; i < N_SIGMAS; ++i) {
+        fastfilters_kernel_fir_t k = fastfilters_kernel_fir_gaussian(g_refs[i].order, g_refs[i].sigma, 0.0);
+        CHECK(k->refcount == 2);
+        fastfilters_kernel_fir_free(k);
+        free(g_refs[i].coefs);
+    }
+
+    fastfilters_kernel_cache_clear();
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    check_hits();
+    check_eviction();
+    check_concurrent_callers();
+
+    return test_result("test_kernel_cache");
+}
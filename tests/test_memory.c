@@ -0,0 +1,160 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+#include "parallel.h"
+
+// The temporary buffer pool: off by default, once enabled freed blocks are reused by later allocations of the same
+// size class, the caches stay within FF_POOL_SHARD_BYTES and trimming or disabling the pool releases them.
+
+#define BLOCK_BYTES ((size_t)1024 * 1024)
+
+static fastfilters_memory_stats_t stats(void)
+{
+    fastfilters_memory_stats_t s;
+    fastfilters_memory_stats(&s);
+    return s;
+}
+
+static void check_disabled(void)
+{
+    const fastfilters_memory_stats_t before = stats();
+    CHECK(before.bytes_cached == 0);
+
+    for (unsigned int i = 0; i < 4; ++i) {
+        void *ptr = fastfilters_memory_align(32, BLOCK_BYTES);
+        CHECK(ptr != NULL);
+        fastfilters_memory_align_free(ptr);
+    }
+
+    const fastfilters_memory_stats_t after = stats();
+    CHECK(after.allocations == before.allocations + 4);
+    CHECK(after.pool_hits == before.pool_hits);
+    CHECK(after.bytes_cached == 0);
+    CHECK(after.bytes_in_use == before.bytes_in_use);
+}
+
+static void check_reuse(void)
+{
+    fastfilters_memory_pool_configure(true, false);
+    const fastfilters_memory_stats_t before = stats();
+
+    void *ptr = fastfilters_memory_align(32, BLOCK_BYTES);
+    CHECK(ptr != NULL && ((uintptr_t)ptr & 31) == 0);
+    CHECK(stats().bytes_in_use >= before.bytes_in_use + BLOCK_BYTES);
+    fastfilters_memory_align_free(ptr);
+
+    const fastfilters_memory_stats_t cached = stats();
+    CHECK(cached.bytes_in_use == before.bytes_in_use);
+    CHECK(cached.bytes_cached >= BLOCK_BYTES);
+
+    // a slightly smaller request of the same size class gets the cached block
+    void *again = fastfilters_memory_align(64, BLOCK_BYTES - 100);
+    const fastfilters_memory_stats_t hit = stats();
+    CHECK(again == ptr);
+    CHECK(hit.pool_hits == before.pool_hits + 1);
+    CHECK(hit.bytes_cached == before.bytes_cached);
+    fastfilters_memory_align_free(again);
+
+    // trimming releases all cached blocks
+    fastfilters_memory_trim();
+    CHECK(stats().bytes_cached == 0);
+
+    // the caches stay within their limit, blocks above the largest size class are never cached
+    void *blocks[2 * FF_POOL_SHARD_BYTES / BLOCK_BYTES];
+    for (unsigned int i = 0; i < ARRAY_LENGTH(blocks); ++i)
+        blocks[i] = fastfilters_memory_align(32, BLOCK_BYTES);
+    for (unsigned int i = 0; i < ARRAY_LENGTH(blocks); ++i)
+        fastfilters_memory_align_free(blocks[i]);
+    CHECK(stats().bytes_cached <= FF_POOL_SHARD_BYTES);
+    fastfilters_memory_trim();
+
+    void *large = fastfilters_memory_align(32, ((size_t)1 << FF_POOL_MAX_SHIFT) + 1);
+    CHECK(large != NULL);
+    fastfilters_memory_align_free(large);
+    CHECK(stats().bytes_cached == 0);
+
+    // filters reuse their buffers on repeated calls
+    const size_t n_x = 300, n_y = 200;
+    float *in = test_alloc_random(n_x * n_y, 5);
+    float *out = test_alloc(n_x * n_y);
+    fastfilters_array2d_t a = test_array2d(in, n_x, n_y, 1);
+    fastfilters_array2d_t o = test_array2d(out, n_x, n_y, 1);
+
+    CHECK(fastfilters_fir_gaussian2d(&a, 1, 2.0, &o, NULL));
+    const fastfilters_memory_stats_t first = stats();
+    CHECK(first.bytes_cached > 0);
+    CHECK(fastfilters_fir_gaussian2d(&a, 1, 2.0, &o, NULL));
+    CHECK(stats().pool_hits > first.pool_hits);
+
+    free(in);
+    free(out);
+
+    // disabling the pool releases the cached blocks as well
+    fastfilters_memory_pool_configure(false, false);
+    CHECK(stats().bytes_cached == 0);
+    CHECK(stats().bytes_in_use == before.bytes_in_use);
+}
+
+static bool alloc_free_loop(void *arg)
+{
+    (void)arg;
+
+    for (unsigned int i = 0; i < 2000; ++i) {
+        void *ptr = fastfilters_memory_align(32, BLOCK_BYTES);
+        if (!ptr)
+            return false;
+        fastfilters_memory_align_free(ptr);
+    }
+
+    return true;
+}
+
+// blocks freed while the pool is being disabled must not stay cached afterwards
+static void check_concurrent_disable(void)
+{
+    fastfilters_task_t tasks[4];
+    const size_t in_use = stats().bytes_in_use;
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        fastfilters_task_start(&tasks[i], alloc_free_loop, NULL);
+
+    for (unsigned int i = 0; i < 200; ++i) {
+        fastfilters_memory_pool_configure(true, false);
+        fastfilters_memory_pool_configure(false, false);
+        CHECK_MSG(stats().bytes_cached == 0, "%zu bytes cached after disabling the pool", stats().bytes_cached);
+    }
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        CHECK(fastfilters_task_join(&tasks[i]));
+
+    CHECK(stats().bytes_cached == 0);
+    CHECK(stats().bytes_in_use == in_use);
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    check_disabled();
+    check_reuse();
+    check_disabled();
+    check_concurrent_disable();
+
+    return test_result("test_memory");
+}
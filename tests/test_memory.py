@@ -0,0 +1,36 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def test_memory_pool():
+    a = np.random.rand(200, 300).astype(np.float32)
+
+    # off by default, nothing stays cached
+    before = ff.memory_stats()
+    ff.gaussianSmoothing(a, 2.0)
+    after = ff.memory_stats()
+    eq_(after["bytes_cached"], 0)
+    eq_(after["pool_hits"], before["pool_hits"])
+    ok_(after["allocations"] > before["allocations"])
+
+    try:
+        ff.memory_pool_configure(True)
+        ff.gaussianSmoothing(a, 2.0)
+        first = ff.memory_stats()
+        ok_(first["bytes_cached"] > 0)
+
+        ff.gaussianSmoothing(a, 2.0)
+        second = ff.memory_stats()
+        ok_(second["pool_hits"] > first["pool_hits"])
+
+        ff.memory_trim()
+        eq_(ff.memory_stats()["bytes_cached"], 0)
+    finally:
+        ff.memory_pool_configure(False)
+
+    eq_(ff.memory_stats()["bytes_cached"], 0)
@@ -0,0 +1,80 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+import warnings
+from nose.tools import eq_, ok_, raises
+
+def test_out():
+    for a in [np.random.randn(123, 97).astype(np.float32), np.random.randn(31, 43, 29).astype(np.float32)]:
+        for fn, args in [(ff.gaussianSmoothing, (2.0,)), (ff.gaussianGradientMagnitude, (1.5,)),
+                         (ff.laplacianOfGaussian, (1.5,)), (ff.gaussianDerivative, (2.0, 1))]:
+            ref = fn(a, *args)
+
+            out = np.empty_like(a)
+            res = fn(a, *args, out=out)
+            ok_(res is out)
+            ok_(np.array_equal(out, ref))
+
+            # strided destination
+            big = np.zeros(tuple(2 * s for s in a.shape), dtype=np.float32)
+            view = big[(slice(None, None, 2),) * a.ndim]
+            fn(a, *args, out=view)
+            ok_(np.array_equal(view, ref))
+
+        n = a.ndim
+        for fn, args in [(ff.hessianOfGaussianEigenvalues, (1.5,)), (ff.structureTensorEigenvalues, (1.0, 2.0))]:
+            ref = fn(a, *args)
+            out = np.empty(a.shape + (n,), dtype=np.float32)
+            fn(a, *args, out=out)
+            ok_(np.array_equal(out, ref))
+
+            # workspace= is deprecated and ignored
+            workspace = np.empty(a.size * (3 if n == 2 else 6), dtype=np.float32)
+            with warnings.catch_warnings(record=True) as caught:
+                warnings.simplefilter("always")
+                res = fn(a, *args, workspace=workspace)
+            ok_(any(issubclass(w.category, DeprecationWarning) for w in caught))
+            ok_(np.array_equal(res, ref))
+
+            # channel-first storage is what the bindings write to without a copy
+            out = np.empty((n,) + a.shape, dtype=np.float32)
+            fn(a, *args, out=np.rollaxis(out, 0, n + 1))
+            ok_(np.array_equal(np.rollaxis(out, 0, n + 1), ref))
+
+def test_out_row_strided():
+    # padded rows (2D) and planes (3D) are passed to the library by their strides, the padding stays untouched
+    a = np.random.randn(123, 97).astype(np.float32)
+    for fn, args in [(ff.gaussianSmoothing, (2.0,)), (ff.gaussianDerivative, (1.5, 1)), (ff.vesselness, ([1.0, 2.0],))]:
+        ref = fn(a, *args)
+        big = np.full((a.shape[0], a.shape[1] + 5), 7.0, dtype=np.float32)
+        view = big[:, :a.shape[1]]
+        res = fn(a, *args, out=view)
+        ok_(res is view)
+        ok_(np.array_equal(view, ref))
+        ok_(np.all(big[:, a.shape[1]:] == 7.0))
+
+    for a in [np.random.randn(123, 97).astype(np.float32), np.random.randn(31, 43, 29).astype(np.float32)]:
+        n = a.ndim
+        for fn, args in [(ff.hessianOfGaussianEigenvalues, (1.5,)), (ff.structureTensorEigenvalues, (1.0, 2.0))]:
+            ref = fn(a, *args)
+
+            # channel-first storage with padding along the outermost image axis
+            big = np.full((n + 1, a.shape[0], a.shape[1] + 3) + a.shape[2:], 7.0, dtype=np.float32)
+            store = big[::2 if n == 2 else 1][:n, :, :a.shape[1]]
+            fn(a, *args, out=np.rollaxis(store, 0, n + 1))
+            ok_(np.array_equal(np.rollaxis(store, 0, n + 1), ref))
+            ok_(np.all(big[:, :, a.shape[1]:] == 7.0))
+
+@raises(ValueError)
+def test_out_shape():
+    a = np.random.randn(64, 64).astype(np.float32)
+    ff.gaussianSmoothing(a, 1.0, out=np.empty((64, 63), dtype=np.float32))
+
+@raises(ValueError)
+def test_out_dtype():
+    a = np.random.randn(64, 64).astype(np.float32)
+    ff.gaussianSmoothing(a, 1.0, out=np.empty((64, 64), dtype=np.float64))
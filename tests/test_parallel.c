@@ -0,0 +1,263 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "test_util.h"
+#include "parallel.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Thread pool (fastfilters_set_num_threads, fastfilters_parallel_for) and the column tiled outer pass: every chunk
+// runs exactly once, failures propagate, concurrent and nested callers work, and convolutions of planes wider than
+// one outer tile match a double precision reference bit-identically for every thread count.
+
+#define N_ITEMS 10007
+
+typedef struct {
+    unsigned char count[N_ITEMS];
+    size_t fail_at;
+    bool nested;
+} for_ctx_t;
+
+static bool count_items(void *ctx, size_t begin, size_t end)
+{
+    for_ctx_t *c = ctx;
+
+    for (size_t i = begin; i < end; ++i)
+        c->count[i]++;
+
+    return !(c->fail_at >= begin && c->fail_at < end);
+}
+
+static bool count_nested(void *ctx, size_t begin, size_t end)
+{
+    for_ctx_t *c = ctx;
+    for_ctx_t inner;
+
+    memset(&inner, 0, sizeof(inner));
+    inner.fail_at = (size_t)-1;
+
+    if (!fastfilters_parallel_for(end - begin, 3, count_items, &inner))
+        return false;
+
+    for (size_t i = 0; i < end - begin; ++i)
+        if (inner.count[i] != 1)
+            return false;
+
+    return count_items(c, begin, end);
+}
+
+static void check_parallel_for(size_t chunk_size, bool nested)
+{
+    for_ctx_t *ctx = calloc(1, sizeof(for_ctx_t));
+    ctx->fail_at = (size_t)-1;
+
+    CHECK(fastfilters_parallel_for(N_ITEMS, chunk_size, nested ? count_nested : count_items, ctx));
+
+    size_t wrong = 0;
+    for (size_t i = 0; i < N_ITEMS; ++i)
+        if (ctx->count[i] != 1)
+            wrong++;
+    CHECK_MSG(wrong == 0, "%zu items not run exactly once, chunk size %zu", wrong, chunk_size);
+
+    memset(ctx->count, 0, sizeof(ctx->count));
+    ctx->fail_at = N_ITEMS / 2;
+    CHECK(!fastfilters_parallel_for(N_ITEMS, chunk_size, count_items, ctx));
+
+    free(ctx);
+}
+
+static bool concurrent_caller(void *arg)
+{
+    for (unsigned int i = 0; i < 20; ++i) {
+        for_ctx_t *ctx = calloc(1, sizeof(for_ctx_t));
+        ctx->fail_at = (size_t)-1;
+
+        bool ok = fastfilters_parallel_for(N_ITEMS, 17, count_items, ctx);
+        for (size_t j = 0; j < N_ITEMS && ok; ++j)
+            ok = ctx->count[j] == 1;
+
+        free(ctx);
+        if (!ok)
+            return false;
+    }
+
+    (void)arg;
+    return true;
+}
+
+static void check_concurrent_callers(void)
+{
+    fastfilters_task_t tasks[3];
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        fastfilters_task_start(&tasks[i], concurrent_caller, NULL);
+
+    CHECK(concurrent_caller(NULL));
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        CHECK(fastfilters_task_join(&tasks[i]));
+}
+
+static bool resize_pool(void *arg)
+{
+    const unsigned int *n_threads = arg;
+
+    for (unsigned int i = 0; i < 20; ++i) {
+        if (!fastfilters_set_num_threads(n_threads[i % 2]) || !concurrent_caller(NULL))
+            return false;
+    }
+
+    return true;
+}
+
+// callers that resize the pool while others run loops on it
+static void check_concurrent_resize(void)
+{
+    static const unsigned int n_threads[][2] = {{1, 3}, {2, 4}, {3, 1}};
+    fastfilters_task_t tasks[ARRAY_LENGTH(n_threads)];
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        fastfilters_task_start(&tasks[i], resize_pool, (void *)n_threads[i]);
+
+    CHECK(concurrent_caller(NULL));
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(tasks); ++i)
+        CHECK(fastfilters_task_join(&tasks[i]));
+
+    const unsigned int n = fastfilters_get_num_threads();
+    CHECK_MSG(n == 1 || n == 3 || n == 4, "%u threads after resizing", n);
+}
+
+static void check_chunk_size(unsigned int n_threads)
+{
+    const size_t sizes[] = {1, 15, 16, 1000, 4099};
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(sizes); ++i) {
+        const size_t n = sizes[i];
+        const size_t chunk = fastfilters_parallel_chunk_size(n, 1, 16);
+
+        CHECK(chunk > 0 && chunk <= n);
+        CHECK(chunk == n || chunk % 16 == 0);
+        if (n_threads == 1)
+            CHECK(chunk == n);
+    }
+}
+
+typedef struct {
+    size_t n_x, n_y, n_z, n_channels;
+    double sigma;
+    unsigned int order;
+} conv_case_t;
+
+// n_x is wider than one outer tile of every cpu level for the kernel lengths of these sigmas
+static const conv_case_t g_cases[] = {
+    {4099, 23, 0, 1, 5.0, 0}, {4099, 23, 0, 1, 2.0, 1}, {3001, 19, 0, 3, 3.0, 2},
+    {1543, 17, 13, 1, 2.5, 0}, {97, 61, 29, 2, 1.5, 1},
+};
+
+static float *run_case(const conv_case_t *c, const float *in)
+{
+    const size_t n = c->n_x * c->n_y * (c->n_z ? c->n_z : 1) * c->n_channels;
+    float *out = test_alloc(n);
+    fastfilters_kernel_fir_t k = fastfilters_kernel_fir_gaussian(c->order, c->sigma, 0.0);
+    bool ok;
+
+    if (c->n_z) {
+        fastfilters_array3d_t a = test_array3d((float *)in, c->n_x, c->n_y, c->n_z, c->n_channels);
+        fastfilters_array3d_t o = test_array3d(out, c->n_x, c->n_y, c->n_z, c->n_channels);
+        ok = fastfilters_fir_convolve3d(&a, k, k, k, &o, NULL);
+    } else {
+        fastfilters_array2d_t a = test_array2d((float *)in, c->n_x, c->n_y, c->n_channels);
+        fastfilters_array2d_t o = test_array2d(out, c->n_x, c->n_y, c->n_channels);
+        ok = fastfilters_fir_convolve2d(&a, k, k, &o, NULL);
+    }
+
+    CHECK(ok);
+    fastfilters_kernel_fir_free(k);
+    return out;
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    const unsigned int thread_counts[] = {1, 2, 3, 8};
+
+    CHECK(fastfilters_set_num_threads(1));
+    CHECK(fastfilters_get_num_threads() == 1);
+
+#ifndef _WIN32
+    CHECK(fastfilters_set_num_threads(0));
+    CHECK(fastfilters_get_num_threads() == (unsigned int)sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+
+    for (unsigned int t = 0; t < ARRAY_LENGTH(thread_counts); ++t) {
+        CHECK(fastfilters_set_num_threads(thread_counts[t]));
+        CHECK(fastfilters_get_num_threads() == thread_counts[t]);
+        // setting the same count again keeps the pool
+        CHECK(fastfilters_set_num_threads(thread_counts[t]));
+        CHECK(fastfilters_get_num_threads() == thread_counts[t]);
+
+        check_chunk_size(thread_counts[t]);
+        check_parallel_for(1, false);
+        check_parallel_for(16, false);
+        check_parallel_for(fastfilters_parallel_chunk_size(N_ITEMS, 1, 16), false);
+        check_parallel_for(N_ITEMS, false);
+        check_parallel_for(64, true);
+        check_concurrent_callers();
+    }
+
+    check_concurrent_resize();
+
+    for (unsigned int i = 0; i < ARRAY_LENGTH(g_cases); ++i) {
+        const conv_case_t *c = &g_cases[i];
+        const size_t n = c->n_x * c->n_y * (c->n_z ? c->n_z : 1) * c->n_channels;
+        float *in = test_alloc_random(n, 1234 + i);
+        float *expected = test_alloc(n);
+        fastfilters_kernel_fir_t k = fastfilters_kernel_fir_gaussian(c->order, c->sigma, 0.0);
+
+        test_reference(in, expected, c->n_x, c->n_y, c->n_z ? c->n_z : 1, c->n_channels, k, k, c->n_z ? k : NULL);
+        fastfilters_kernel_fir_free(k);
+
+        CHECK(fastfilters_set_num_threads(1));
+        float *ref = run_case(c, in);
+        CHECK_MSG(test_max_abs_diff(ref, expected, n) < 1e-5, "case %u: max diff %g to the reference", i,
+                  test_max_abs_diff(ref, expected, n));
+
+        for (unsigned int t = 1; t < ARRAY_LENGTH(thread_counts); ++t) {
+            CHECK(fastfilters_set_num_threads(thread_counts[t]));
+            float *res = run_case(c, in);
+            CHECK_MSG(test_equal(res, ref, n), "case %u differs with %u threads", i, thread_counts[t]);
+            free(res);
+        }
+
+        free(ref);
+        free(expected);
+        free(in);
+    }
+
+    CHECK(fastfilters_set_num_threads(1));
+
+    return test_result("test_parallel");
+}
@@ -0,0 +1,26 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def test_scale_space():
+    for a in [np.random.rand(97, 83).astype(np.float32), np.random.rand(41, 37, 33).astype(np.float32)]:
+        # 0.7 -> 1.0 is below the smallest incremental step and restarts from the input
+        sigmas = [0.7, 1.0, 1.6, 2.5, 4.0]
+        ref = np.stack([ff.gaussianSmoothing(a, s) for s in sigmas], axis=-1)
+
+        res = ff.scaleSpace(a, sigmas)
+        eq_(res.shape, a.shape + (len(sigmas),))
+        ok_(np.allclose(res, ref, atol=2e-3))
+
+        dog = ff.differenceOfGaussians(a, sigmas)
+        eq_(dog.shape, a.shape + (len(sigmas) - 1,))
+        ok_(np.allclose(dog, np.diff(ref, axis=-1), atol=2e-3))
+
+        half = ff.differenceOfGaussians(a, sigmas, dtype=np.float16)
+        eq_(half.dtype, np.float16)
+        ok_(np.allclose(half, dog, atol=2e-3))
@@ -0,0 +1,165 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+// The vectorized linalg and convolution code is selected at init from the cpu features. Every selection has to match
+// the scalar one (or, on aarch64, the SIMDe translated avx one that stands in for it) within float rounding: the
+// results with all features disabled are compared against the ones with the best supported features. This is the
+// check that runs the NEON paths, under qemu when cross compiling.
+#define EV_TOLERANCE 1e-5
+#define CONV_TOLERANCE 1e-6
+
+#define N_X 61
+#define N_Y 37
+#define N_Z 23
+#define N_LINALG (N_X * N_Y)
+
+static const fastfilters_cpu_feature_t g_features[] = {
+    FASTFILTERS_CPU_AVX, FASTFILTERS_CPU_FMA, FASTFILTERS_CPU_AVX2, FASTFILTERS_CPU_AVX512F, FASTFILTERS_CPU_NEON,
+};
+
+enum {
+    R_EV2D,
+    R_EV3D = R_EV2D + 2,
+    R_ADD = R_EV3D + 3,
+    R_ADD3,
+    R_MUL,
+    R_ADDSQRT,
+    R_ADDSQRT3,
+    R_CONV2D,
+    R_CONV3D,
+    N_RESULTS
+};
+
+static const char *const g_result_names[N_RESULTS] = {
+    "ev2d[0]", "ev2d[1]", "ev3d[0]", "ev3d[1]", "ev3d[2]", "add", "add3", "mul", "addsqrt", "addsqrt3", "conv2d",
+    "conv3d",
+};
+
+static void select_features(bool enable)
+{
+    for (unsigned int i = 0; i < ARRAY_LENGTH(g_features); ++i)
+        fastfilters_cpu_enable(g_features[i], enable);
+
+    fastfilters_linalg_init();
+    fastfilters_fir_init();
+}
+
+static size_t result_size(unsigned int r)
+{
+    return r == R_CONV3D ? N_X * N_Y * N_Z : N_LINALG;
+}
+
+static void run(float *const *in, const fastfilters_kernel_fir_t *k, float **res)
+{
+    fastfilters_linalg_ev2d(in[0], in[1], in[2], res[R_EV2D], res[R_EV2D + 1], N_LINALG);
+    fastfilters_linalg_ev3d(in[0], in[1], in[2], in[3], in[4], in[5], res[R_EV3D], res[R_EV3D + 1], res[R_EV3D + 2],
+                            N_LINALG);
+
+    fastfilters_array2d_t a = test_array2d(in[0], N_X, N_Y, 1);
+    fastfilters_array2d_t b = test_array2d(in[1], N_X, N_Y, 1);
+    fastfilters_array2d_t c = test_array2d(in[2], N_X, N_Y, 1);
+    fastfilters_array2d_t out;
+
+    out = test_array2d(res[R_ADD], N_X, N_Y, 1);
+    fastfilters_combine_add2d(&a, &b, &out);
+    out = test_array2d(res[R_MUL], N_X, N_Y, 1);
+    fastfilters_combine_mul2d(&a, &b, &out);
+    out = test_array2d(res[R_ADDSQRT], N_X, N_Y, 1);
+    fastfilters_combine_addsqrt2d(&a, &b, &out);
+
+    // the three operand forms only exist in 3D, a single plane is enough for them
+    fastfilters_array3d_t a3 = test_array3d(in[0], N_X, N_Y, 1, 1);
+    fastfilters_array3d_t b3 = test_array3d(in[1], N_X, N_Y, 1, 1);
+    fastfilters_array3d_t c3 = test_array3d(in[2], N_X, N_Y, 1, 1);
+    fastfilters_array3d_t out3;
+
+    out3 = test_array3d(res[R_ADD3], N_X, N_Y, 1, 1);
+    fastfilters_combine_add3d(&a3, &b3, &c3, &out3);
+    out3 = test_array3d(res[R_ADDSQRT3], N_X, N_Y, 1, 1);
+    fastfilters_combine_addsqrt3d(&a3, &b3, &c3, &out3);
+
+    out = test_array2d(res[R_CONV2D], N_X, N_Y, 1);
+    CHECK(fastfilters_fir_convolve2d(&c, k[0], k[1], &out, NULL));
+
+    fastfilters_array3d_t vol = test_array3d(in[6], N_X, N_Y, N_Z, 1);
+    out3 = test_array3d(res[R_CONV3D], N_X, N_Y, N_Z, 1);
+    CHECK(fastfilters_fir_convolve3d(&vol, k[0], k[1], k[2], &out3, NULL));
+}
+
+int main(void)
+{
+    fastfilters_init();
+
+    // addsqrt needs non-negative operands, the eigenvalue inputs are arbitrary symmetric matrices
+    float *in[7];
+    for (unsigned int i = 0; i < 6; ++i) {
+        in[i] = test_alloc_random(N_LINALG, 11 + i);
+        if (i < 3)
+            for (size_t j = 0; j < N_LINALG; ++j)
+                in[i][j] = fabsf(in[i][j]);
+    }
+    in[6] = test_alloc_random(N_X * N_Y * N_Z, 17);
+
+    fastfilters_kernel_fir_t k[3] = {
+        fastfilters_kernel_fir_gaussian(0, 1.5, 3.0f),
+        fastfilters_kernel_fir_gaussian(1, 2.5, 3.0f),
+        fastfilters_kernel_fir_gaussian(2, 0.8, 3.0f),
+    };
+    const double gain2d = test_kernel_gain(k[0]) * test_kernel_gain(k[1]);
+    const double gain3d = gain2d * test_kernel_gain(k[2]);
+
+    float *scalar[N_RESULTS], *simd[N_RESULTS];
+    for (unsigned int r = 0; r < N_RESULTS; ++r) {
+        scalar[r] = test_alloc(result_size(r));
+        simd[r] = test_alloc(result_size(r));
+    }
+
+    select_features(false);
+    run(in, k, scalar);
+    select_features(true);
+    run(in, k, simd);
+
+    for (unsigned int r = 0; r < N_RESULTS; ++r) {
+        double tolerance;
+
+        if (r < R_ADD)
+            tolerance = EV_TOLERANCE * 4.0;
+        else if (r == R_CONV2D)
+            tolerance = CONV_TOLERANCE * gain2d;
+        else if (r == R_CONV3D)
+            tolerance = CONV_TOLERANCE * gain3d;
+        else
+            tolerance = CONV_TOLERANCE * 4.0;
+
+        const float diff = test_max_abs_diff(scalar[r], simd[r], result_size(r));
+        CHECK_MSG(diff <= tolerance, "%s differs by %g", g_result_names[r], diff);
+    }
+
+    for (unsigned int r = 0; r < N_RESULTS; ++r) {
+        free(scalar[r]);
+        free(simd[r]);
+    }
+    for (unsigned int i = 0; i < 3; ++i)
+        fastfilters_kernel_fir_free(k[i]);
+    for (unsigned int i = 0; i < 7; ++i)
+        free(in[i]);
+
+    return test_result("test_simd");
+}
@@ -0,0 +1,212 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#include "test_util.h"
+
+#include <pthread.h>
+
+// fastfilters_fir_convolve2d_sum/3d_sum (gradient magnitude and laplacian): the fused passes agree with the composition
+// of the separate convolutions within float rounding, also over several blocks of the slowest axis and for input that
+// is converted from uint8, and no temporary they allocate is as large as the image.
+#define SUM_TOLERANCE 1e-5
+
+// allocator that tracks the bytes handed out and their peak
+typedef struct {
+    pthread_mutex_t lock;
+    size_t in_use;
+    size_t peak;
+} alloc_count_t;
+
+static alloc_count_t g_count = {PTHREAD_MUTEX_INITIALIZER, 0, 0};
+
+#define COUNT_HEADER 32
+
+static void *count_alloc(size_t size)
+{
+    char *ptr = malloc(size + COUNT_HEADER);
+    if (!ptr)
+        return NULL;
+
+    memcpy(ptr, &size, sizeof(size));
+
+    pthread_mutex_lock(&g_count.lock);
+    g_count.in_use += size;
+    if (g_count.in_use > g_count.peak)
+        g_count.peak = g_count.in_use;
+    pthread_mutex_unlock(&g_count.lock);
+
+    return ptr + COUNT_HEADER;
+}
+
+static void count_free(void *ptr)
+{
+    size_t size;
+
+    if (!ptr)
+        return;
+
+    ptr = (char *)ptr - COUNT_HEADER;
+    memcpy(&size, ptr, sizeof(size));
+
+    pthread_mutex_lock(&g_count.lock);
+    g_count.in_use -= size;
+    pthread_mutex_unlock(&g_count.lock);
+
+    free(ptr);
+}
+
+// restarts peak tracking from the bytes currently in use, which are returned
+static size_t count_reset(void)
+{
+    pthread_mutex_lock(&g_count.lock);
+    g_count.peak = g_count.in_use;
+    const size_t in_use = g_count.in_use;
+    pthread_mutex_unlock(&g_count.lock);
+
+    return in_use;
+}
+
+static size_t count_peak(void)
+{
+    pthread_mutex_lock(&g_count.lock);
+    const size_t peak = g_count.peak;
+    pthread_mutex_unlock(&g_count.lock);
+
+    return peak;
+}
+
+typedef struct {
+    size_t n_x, n_y, n_z, n_channels;
+    double sigma;
+    // 1: square root of the summed squared first derivatives, 2: sum of the second derivatives
+    unsigned order;
+    fastfilters_type_t in_type;
+} sum_case_t;
+
+static const sum_case_t g_cases[] = {
+    {37, 29, 1, 1, 2.0, 1, FASTFILTERS_TYPE_FLOAT32},    {1024, 1024, 1, 1, 1.5, 1, FASTFILTERS_TYPE_FLOAT32},
+    {300, 700, 1, 2, 3.0, 2, FASTFILTERS_TYPE_FLOAT32},  {500, 900, 1, 1, 1.0, 1, FASTFILTERS_TYPE_UINT8},
+    {33, 29, 27, 1, 1.5, 2, FASTFILTERS_TYPE_FLOAT32},   {128, 128, 96, 1, 1.0, 1, FASTFILTERS_TYPE_FLOAT32},
+    {96, 80, 64, 2, 2.0, 2, FASTFILTERS_TYPE_FLOAT32},   {128, 96, 80, 1, 1.5, 1, FASTFILTERS_TYPE_UINT8},
+};
+
+static float max_abs(const float *a, size_t n)
+{
+    float m = 0.0f;
+
+    for (size_t i = 0; i < n; ++i)
+        if (fabsf(a[i]) > m)
+            m = fabsf(a[i]);
+
+    return m;
+}
+
+static void check_case(unsigned int c, const sum_case_t *sc)
+{
+    const bool is_3d = sc->n_z > 1;
+    const unsigned ndim = is_3d ? 3 : 2;
+    const size_t n = sc->n_x * sc->n_y * sc->n_z * sc->n_channels;
+    float *in = test_alloc_random(n, 31 + c);
+    uint8_t *in_u8 = NULL;
+    float *out = test_alloc(n);
+    float *ref = test_alloc(n);
+    float *term = test_alloc(n);
+    fastfilters_kernel_fir_t k[3];
+    fastfilters_kernel_fir_t kernels[3][3];
+
+    if (sc->in_type == FASTFILTERS_TYPE_UINT8) {
+        in_u8 = malloc(n);
+        for (size_t i = 0; i < n; ++i) {
+            in_u8[i] = (uint8_t)(127.5f * (in[i] + 1.0f));
+            in[i] = in_u8[i];
+        }
+    }
+
+    for (unsigned int order = 0; order < 3; ++order)
+        k[order] = fastfilters_kernel_fir_gaussian(order, sc->sigma, 0.0);
+
+    for (unsigned int t = 0; t < ndim; ++t)
+        for (unsigned int axis = 0; axis < ndim; ++axis)
+            kernels[t][axis] = k[axis == t ? sc->order : 0];
+
+    // reference: separate convolutions of every term, combined afterwards
+    for (size_t i = 0; i < n; ++i)
+        ref[i] = 0.0f;
+    for (unsigned int t = 0; t < ndim; ++t) {
+        test_reference(in, term, sc->n_x, sc->n_y, sc->n_z, sc->n_channels, kernels[t][0], kernels[t][1],
+                       is_3d ? kernels[t][2] : NULL);
+        for (size_t i = 0; i < n; ++i)
+            ref[i] += sc->order == 1 ? term[i] * term[i] : term[i];
+    }
+    if (sc->order == 1)
+        for (size_t i = 0; i < n; ++i)
+            ref[i] = sqrtf(ref[i]);
+
+    const size_t before = count_reset();
+    if (is_3d) {
+        fastfilters_array3d_t a = test_array3d(in_u8 ? (float *)in_u8 : in, sc->n_x, sc->n_y, sc->n_z, sc->n_channels);
+        fastfilters_array3d_t o = test_array3d(out, sc->n_x, sc->n_y, sc->n_z, sc->n_channels);
+        a.type = sc->in_type;
+
+        CHECK(fastfilters_fir_convolve3d_sum(&a, (const fastfilters_kernel_fir_t(*)[3])kernels, 3, sc->order == 1,
+                                             &o));
+    } else {
+        fastfilters_kernel_fir_t kernels2d[2][2] = {{kernels[0][0], kernels[0][1]}, {kernels[1][0], kernels[1][1]}};
+        fastfilters_array2d_t a = test_array2d(in_u8 ? (float *)in_u8 : in, sc->n_x, sc->n_y, sc->n_channels);
+        fastfilters_array2d_t o = test_array2d(out, sc->n_x, sc->n_y, sc->n_channels);
+        a.type = sc->in_type;
+
+        CHECK(fastfilters_fir_convolve2d_sum(&a, (const fastfilters_kernel_fir_t(*)[2])kernels2d, 2,
+                                             sc->order == 1, &o));
+    }
+    const size_t peak = count_peak() - before;
+
+    const float diff = test_max_abs_diff(out, ref, n);
+    const float scale = max_abs(ref, n);
+    CHECK_MSG(diff <= SUM_TOLERANCE * scale, "case %u: max diff %g, largest magnitude %g", c, diff, scale);
+
+    // the old carriers were full-size volumes, small images may still need a block that covers all of them
+    if (n * sizeof(float) >= 4 * FF_SUM_BLOCK_BYTES)
+        CHECK_MSG(peak < n * sizeof(float), "case %u: %zu bytes of temporaries for a %zu byte image", c, peak,
+                  n * sizeof(float));
+
+    for (unsigned int order = 0; order < 3; ++order)
+        fastfilters_kernel_fir_free(k[order]);
+    free(in_u8);
+    free(term);
+    free(ref);
+    free(out);
+    free(in);
+}
+
+int main(void)
+{
+    fastfilters_init_ex(count_alloc, count_free);
+
+    const unsigned int thread_counts[] = {1, 4};
+    for (unsigned int t = 0; t < ARRAY_LENGTH(thread_counts); ++t) {
+        CHECK(fastfilters_set_num_threads(thread_counts[t]));
+
+        for (unsigned int c = 0; c < ARRAY_LENGTH(g_cases); ++c)
+            check_case(c, &g_cases[c]);
+    }
+
+    fastfilters_init_ex(NULL, NULL);
+
+    return test_result("test_sum");
+}
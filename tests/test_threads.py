@@ -0,0 +1,29 @@
+from __future__ import print_function
+
+import sys
+print("\nexecuting test file", __file__, file=sys.stderr)
+exec(compile(open('set_paths.py', "rb").read(), 'set_paths.py', 'exec'))
+import fastfilters as ff
+import numpy as np
+from nose.tools import eq_, ok_
+
+def test_threads():
+    a2 = np.random.randn(523, 611).astype(np.float32)
+    a3 = np.random.randn(37, 91, 83).astype(np.float32)
+
+    old_threads = ff.get_num_threads()
+
+    try:
+        ff.set_num_threads(1)
+        eq_(ff.get_num_threads(), 1)
+        ref = [ff.gaussianDerivative(a, sigma, order) for a in [a2, a3] for sigma in [1.0, 5.0] for order in [0, 1, 2]]
+
+        for n_threads in [2, 3, 8]:
+            ff.set_num_threads(n_threads)
+            eq_(ff.get_num_threads(), n_threads)
+            res = [ff.gaussianDerivative(a, sigma, order) for a in [a2, a3] for sigma in [1.0, 5.0] for order in [0, 1, 2]]
+
+            for r, e in zip(res, ref):
+                ok_(np.array_equal(r, e))
+    finally:
+        ff.set_num_threads(old_threads)
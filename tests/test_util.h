@@ -0,0 +1,224 @@
+// fastfilters
+// Copyright (c) 2016 Sven Peter
+// sven.peter@iwr.uni-heidelberg.de or mail@svenpeter.me
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+// Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+#ifndef FASTFILTERS_TEST_UTIL_H
+#define FASTFILTERS_TEST_UTIL_H
+
+// Helpers of the native tests. They are linked against the library objects like fastfilters_bench so that internal
+// functions can be checked as well; each test is a main() that fails if any CHECK did.
+
+#include "fastfilters.h"
+#include "common.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int g_test_failures = 0;
+
+#define CHECK(cond)                                                                                                    \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                   \
+            g_test_failures++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+#define CHECK_MSG(cond, ...)                                                                                           \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond);                                   \
+            fprintf(stderr, __VA_ARGS__);                                                                              \
+            fprintf(stderr, "\n");                                                                                     \
+            g_test_failures++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+static inline int test_result(const char *name)
+{
+    if (g_test_failures)
+        fprintf(stderr, "%s: %u checks failed\n", name, g_test_failures);
+    else
+        fprintf(stderr, "%s: ok\n", name);
+
+    return g_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// deterministic xorshift noise in [-1, 1)
+static inline float test_random(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return (float)(*state >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+static inline float *test_alloc(size_t n)
+{
+    float *ptr = malloc((n ? n : 1) * sizeof(float));
+
+    if (!ptr) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
+
+static inline float *test_alloc_random(size_t n, uint32_t seed)
+{
+    float *ptr = test_alloc(n);
+    uint32_t state = seed ? seed : 1;
+
+    for (size_t i = 0; i < n; ++i)
+        ptr[i] = test_random(&state);
+
+    return ptr;
+}
+
+static inline float test_max_abs_diff(const float *a, const float *b, size_t n)
+{
+    float diff = 0.0f;
+
+    for (size_t i = 0; i < n; ++i)
+        if (!(fabsf(a[i] - b[i]) <= diff))
+            diff = isnan(a[i] - b[i]) ? INFINITY : fabsf(a[i] - b[i]);
+
+    return diff;
+}
+
+static inline bool test_equal(const float *a, const float *b, size_t n)
+{
+    return memcmp(a, b, n * sizeof(float)) == 0;
+}
+
+// dense float32 arrays with n_channels interleaved channels
+static inline fastfilters_array2d_t test_array2d(float *ptr, size_t n_x, size_t n_y, size_t n_channels)
+{
+    fastfilters_array2d_t a = {ptr, n_x, n_y, n_channels, n_x * n_channels, n_channels, FASTFILTERS_TYPE_FLOAT32};
+    return a;
+}
+
+static inline fastfilters_array3d_t test_array3d(float *ptr, size_t n_x, size_t n_y, size_t n_z, size_t n_channels)
+{
+    fastfilters_array3d_t a = {ptr,        n_x, n_y, n_z, n_channels, n_x * n_channels, n_x * n_y * n_channels,
+                               n_channels, FASTFILTERS_TYPE_FLOAT32};
+    return a;
+}
+
+// index i mirrored into 0 .. n - 1 without repeating the border pixel, like the library's mirror borders
+static inline size_t test_mirror(ptrdiff_t i, size_t n)
+{
+    if (n == 1)
+        return 0;
+
+    while (i < 0 || i >= (ptrdiff_t)n) {
+        if (i < 0)
+            i = -i;
+        if (i >= (ptrdiff_t)n)
+            i = 2 * ((ptrdiff_t)n - 1) - i;
+    }
+
+    return (size_t)i;
+}
+
+// tap of kernel at offset k in -len .. len, see fastfilters_kernel_fir_create
+static inline double test_kernel_tap(const fastfilters_kernel_fir_t kernel, ptrdiff_t k)
+{
+    const size_t a = (size_t)(k < 0 ? -k : k);
+    double tap = kernel->coefs[a];
+
+    if (!kernel->is_symmetric && k < 0)
+        tap = -tap;
+    if (kernel->odd)
+        tap += test_kernel_tap(kernel->odd, k);
+
+    return tap;
+}
+
+// sum of the absolute taps, bounds the magnification of the input range and of float rounding errors
+static inline double test_kernel_gain(const fastfilters_kernel_fir_t kernel)
+{
+    double sum = 0.0;
+
+    for (ptrdiff_t k = -(ptrdiff_t)kernel->len; k <= (ptrdiff_t)kernel->len; ++k)
+        sum += fabs(test_kernel_tap(kernel, k));
+
+    return sum;
+}
+
+// mirrored double precision convolution of a dense n_x * n_y * n_z volume of n_channels channels along axis (0 = x)
+static inline void test_convolve_axis(double *data, const size_t *shape, size_t n_channels, unsigned int axis,
+                                      const fastfilters_kernel_fir_t kernel)
+{
+    const ptrdiff_t klen = (ptrdiff_t)kernel->len;
+    const size_t len = shape[axis];
+    size_t stride = n_channels;
+    for (unsigned int i = 0; i < axis; ++i)
+        stride *= shape[i];
+
+    const size_t n = shape[0] * shape[1] * shape[2] * n_channels;
+    double *line = malloc(len * sizeof(double));
+
+    for (size_t start = 0; start < n; ++start) {
+        // every line once, at its first element
+        if ((start / stride) % len != 0)
+            continue;
+
+        for (size_t i = 0; i < len; ++i) {
+            double sum = 0.0;
+            for (ptrdiff_t k = -klen; k <= klen; ++k)
+                sum += test_kernel_tap(kernel, k) * data[start + test_mirror((ptrdiff_t)i + k, len) * stride];
+            line[i] = sum;
+        }
+
+        for (size_t i = 0; i < len; ++i)
+            data[start + i * stride] = line[i];
+    }
+
+    free(line);
+}
+
+// reference of fastfilters_fir_convolve2d/3d on dense arrays, kz is NULL in 2D
+static inline void test_reference(const float *in, float *out, size_t n_x, size_t n_y, size_t n_z, size_t n_channels,
+                                  const fastfilters_kernel_fir_t kx, const fastfilters_kernel_fir_t ky,
+                                  const fastfilters_kernel_fir_t kz)
+{
+    const size_t shape[3] = {n_x, n_y, n_z};
+    const size_t n = n_x * n_y * n_z * n_channels;
+    double *data = malloc(n * sizeof(double));
+
+    for (size_t i = 0; i < n; ++i)
+        data[i] = in[i];
+
+    test_convolve_axis(data, shape, n_channels, 0, kx);
+    test_convolve_axis(data, shape, n_channels, 1, ky);
+    if (kz)
+        test_convolve_axis(data, shape, n_channels, 2, kz);
+
+    for (size_t i = 0; i < n; ++i)
+        out[i] = (float)data[i];
+
+    free(data);
+}
+
+#endif
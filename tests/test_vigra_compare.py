@@ -15,7 +15,7 @@ def test_vigra_compare():
 
     for order in [0,1,2]:
         for sigma in sigmas:
-            res_ff = ff.gaussianDerivative(a, sigma, order, window_size=3.5)
+            res_ff = ff.gaussianDerivative(a, sigma, order, window_size=3.5, exact_fir=True)
             res_vigra = vigra.filters.gaussianDerivative(a, sigma, [order,order], window_size=3.5)
 
             print("gaussian ", order, sigma, np.max(np.abs(res_ff - res_vigra)))
@@ -25,7 +25,7 @@ def test_vigra_compare():
 
 
     for sigma in sigmas:
-        res_ff = ff.hessianOfGaussianEigenvalues(a, sigma, window_size=3.5)
+        res_ff = ff.hessianOfGaussianEigenvalues(a, sigma, window_size=3.5, exact_fir=True)
         res_vigra = vigra.filters.hessianOfGaussianEigenvalues(a, sigma, window_size=3.5)
         print("HOG", sigma, np.max(np.abs(res_ff - res_vigra)))
 
@@ -34,7 +34,7 @@ def test_vigra_compare():
 
 
     for sigma in sigmas:
-        res_ff = ff.gaussianGradientMagnitude(a, sigma, window_size=3.5)
+        res_ff = ff.gaussianGradientMagnitude(a, sigma, window_size=3.5, exact_fir=True)
         res_vigra = vigra.filters.gaussianGradientMagnitude(a, sigma, window_size=3.5)
         print("gradmag2d ", order, sigma, np.max(np.abs(res_ff - res_vigra)))
 
@@ -43,7 +43,7 @@ def test_vigra_compare():
 
 
     for sigma in sigmas:
-        res_ff = ff.laplacianOfGaussian(a, sigma, window_size=3.5)
+        res_ff = ff.laplacianOfGaussian(a, sigma, window_size=3.5, exact_fir=True)
         res_vigra = vigra.filters.laplacianOfGaussian(a, sigma, window_size=3.5)
         print("laplacian2d ", order, sigma, np.max(np.abs(res_ff - res_vigra)))
 
@@ -15,7 +15,7 @@ def test_vigra_compare3d():
 
     for order in [0,1,2]:
         for sigma in sigmas:
-            res_ff = ff.gaussianDerivative(a, sigma, order)
+            res_ff = ff.gaussianDerivative(a, sigma, order, exact_fir=True)
             res_vigra = vigra.filters.gaussianDerivative(a, sigma, [order,order,order])
 
             print("gaussian ", order, sigma, np.max(np.abs(res_ff - res_vigra)), np.sum(np.abs(res_ff-res_vigra))/np.size(res_vigra))
@@ -25,7 +25,7 @@ def test_vigra_compare3d():
 
 
     for sigma in sigmas:
-        res_ff = ff.gaussianGradientMagnitude(a, sigma)
+        res_ff = ff.gaussianGradientMagnitude(a, sigma, exact_fir=True)
         res_vigra = vigra.filters.gaussianGradientMagnitude(a, sigma)
         print("gradmag3d ", order, sigma, np.max(np.abs(res_ff - res_vigra)), np.sum(np.abs(res_ff-res_vigra))/np.size(res_vigra))
 
@@ -33,7 +33,7 @@ def test_vigra_compare3d():
             raise Exception("FAIL: gradmag3d ", order, sigma, np.max(np.abs(res_ff - res_vigra)))
 
     for sigma in sigmas:
-        res_ff = ff.laplacianOfGaussian(a, sigma)
+        res_ff = ff.laplacianOfGaussian(a, sigma, exact_fir=True)
         res_vigra = vigra.filters.laplacianOfGaussian(a, sigma)
         print("laplacian3d ", order, sigma, np.max(np.abs(res_ff - res_vigra)), np.sum(np.abs(res_ff-res_vigra))/np.size(res_vigra))
 
@@ -41,7 +41,7 @@ def test_vigra_compare3d():
             raise Exception("FAIL: laplacian3d ", order, sigma, np.max(np.abs(res_ff - res_vigra)))
 
     for sigma in sigmas:
-        res_ff = ff.hessianOfGaussianEigenvalues(a, sigma)
+        res_ff = ff.hessianOfGaussianEigenvalues(a, sigma, exact_fir=True)
         res_vigra = vigra.filters.hessianOfGaussianEigenvalues(a, sigma)
         print("HOG", sigma, np.max(np.abs(res_ff - res_vigra)), np.sum(np.abs(res_ff-res_vigra))/np.size(res_vigra), np.sum(np.abs(res_ff-res_vigra))/np.size(res_vigra))
 
@@ -15,7 +15,7 @@ def test_vigra_compare_rgb():
 
     for order in [0,1,2]:
         for sigma in sigmas:
-            res_ff = ff.gaussian2d(a, order, sigma)
+            res_ff = ff.gaussian2d(a, order, sigma, exact_fir=True)
             res_vigra = np.zeros_like(a)
 
             for c in range(avigra.shape[2]):
@@ -28,7 +28,7 @@ def test_vigra_compare_rgb():
 
 
     for sigma in sigmas:
-        res_ff = ff.gradmag2d(a, sigma)
+        res_ff = ff.gradmag2d(a, sigma, exact_fir=True)
         res_vigra = np.array(vigra.filters.gaussianGradientMagnitude(avigra, sigma, accumulate=False))
         print("gradmag2d ", sigma, np.max(np.abs(res_ff - res_vigra)))
 
@@ -38,7 +38,7 @@ def test_vigra_compare_rgb():
 
 
     for sigma in sigmas:
-        res_ff = ff.laplacian2d(a, sigma)
+        res_ff = ff.laplacian2d(a, sigma, exact_fir=True)
         res_vigra = np.array(vigra.filters.laplacianOfGaussian(avigra, sigma))
         print("laplacian2d ", sigma, np.max(np.abs(res_ff - res_vigra)))
 